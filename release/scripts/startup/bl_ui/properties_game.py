@@ -521,6 +521,12 @@ class SCENE_PT_game_physics(SceneButtonsPanel, Panel):
             sub = col.row()
             sub.prop(gs, "deactivation_time", text="Time")
 
+            col = layout.column()
+            col.prop(gs, "use_physics_multithreading", text="Multithreading")
+            sub = col.column()
+            sub.active = gs.use_physics_multithreading
+            sub.prop(gs, "physics_threads", text="Threads")
+
             col = layout.column()
             col.prop(gs, "use_occlusion_culling", text="Occlusion Culling")
             sub = col.column()
@@ -37,8 +37,9 @@ extern "C" {
 
 /* Task Scheduler
  * 
- * Central scheduler that holds running threads ready to execute tasks. A single
- * queue holds the task from all pools.
+ * Central scheduler that holds running threads ready to execute tasks. By default
+ * a single queue holds the task from all pools, the scheduler can also use a
+ * lock-free deque per thread with idle threads stealing tasks from the others.
  *
  * Init/exit must be called before/after any task pools are created/freed, and
  * must be called from the main threads. All other scheduler and pool functions
@@ -51,7 +52,17 @@ enum {
 	TASK_SCHEDULER_SINGLE_THREAD = 1
 };
 
+typedef enum TaskSchedulerQueue {
+	/* Single queue guarded by a mutex shared by all threads. */
+	TASK_SCHEDULER_QUEUE_GLOBAL,
+	/* Lock-free deque per thread, tasks pushed from the main thread or a worker thread
+	 * go to its deque and idle threads steal tasks from random threads. Tasks pushed from
+	 * other threads and background tasks still use the global queue. */
+	TASK_SCHEDULER_QUEUE_WORK_STEALING
+} TaskSchedulerQueue;
+
 TaskScheduler *BLI_task_scheduler_create(int num_threads);
+TaskScheduler *BLI_task_scheduler_create_ex(int num_threads, TaskSchedulerQueue queue);
 void BLI_task_scheduler_free(TaskScheduler *scheduler);
 
 int BLI_task_scheduler_num_threads(TaskScheduler *scheduler);
@@ -78,6 +89,7 @@ typedef enum TaskPriority {
 typedef struct TaskPool TaskPool;
 typedef void (*TaskRunFunction)(TaskPool *__restrict pool, void *taskdata, int threadid);
 typedef void (*TaskFreeFunction)(TaskPool *__restrict pool, void *taskdata, int threadid);
+typedef void (*TaskRunRangeFunction)(TaskPool *__restrict pool, void *taskdata, int start, int stop, int threadid);
 
 TaskPool *BLI_task_pool_create(TaskScheduler *scheduler, void *userdata);
 TaskPool *BLI_task_pool_create_background(TaskScheduler *scheduler, void *userdata);
@@ -92,6 +104,12 @@ void BLI_task_pool_push(TaskPool *pool, TaskRunFunction run,
 void BLI_task_pool_push_from_thread(TaskPool *pool, TaskRunFunction run,
         void *taskdata, bool free_taskdata, TaskPriority priority, int thread_id);
 
+/* Push a range of items split in tasks of grain_size items, each task runs the
+ * function once for its sub-range [start, stop). The task data is shared by all
+ * the tasks. A grain size of 0 chooses it from the number of threads. */
+void BLI_task_pool_push_range(TaskPool *pool, TaskRunRangeFunction run,
+        void *taskdata, int start, int stop, int grain_size, TaskPriority priority);
+
 /* work and wait until all tasks are done */
 void BLI_task_pool_work_and_wait(TaskPool *pool);
 /* cancel all tasks, keep worker threads running */
@@ -24,6 +24,7 @@
  * A generic task system which can be used for any task based subsystem.
  */
 
+#include <stddef.h>
 #include <stdlib.h>
 
 #include "MEM_guardedalloc.h"
@@ -61,6 +62,13 @@
  */
 #define DELAYED_QUEUE_SIZE 4096
 
+/* Number of tasks which fit in a thread deque of the work stealing scheduler,
+ * must be a power of two.
+ *
+ * Tasks pushed to a full deque go to the global queue.
+ */
+#define STEALING_DEQUE_SIZE 4096
+
 #ifndef NDEBUG
 #  define ASSERT_THREAD_ID(scheduler, thread_id)                              \
 	do {                                                                      \
@@ -89,6 +97,10 @@ typedef struct Task {
 	bool free_taskdata;
 	TaskFreeFunction freedata;
 	TaskPool *pool;
+
+	/* Used instead of run by the tasks of BLI_task_pool_push_range. */
+	TaskRunRangeFunction run_range;
+	int start, stop;
 } Task;
 
 /* This is a per-thread storage of pre-allocated tasks.
@@ -209,20 +221,42 @@ struct TaskScheduler {
 	int num_threads;
 	bool background_thread_only;
 
+	TaskSchedulerQueue queue_type;
+
 	ListBase queue;
 	ThreadMutex queue_mutex;
 	ThreadCondition queue_cond;
 
+	/* Number of work stealing threads waiting on queue_cond. */
+	size_t num_sleeping;
+
 	volatile bool do_exit;
 
 	/* NOTE: In pthread's TLS we store the whole TaskThread structure. */
 	pthread_key_t tls_id_key;
 };
 
+/* Chase-Lev work stealing deque with a fixed size.
+ *
+ * Only the owner thread pushes and pops tasks at the bottom, other threads steal
+ * tasks at the top. The indices only grow, they are wrapped to access the tasks.
+ */
+typedef struct TaskDeque {
+	size_t top;
+	/* Keep the stolen and the owner ends in separate cache lines. */
+	char pad[64 - sizeof(size_t)];
+	size_t bottom;
+	Task *tasks[STEALING_DEQUE_SIZE];
+} TaskDeque;
+
 typedef struct TaskThread {
 	TaskScheduler *scheduler;
 	int id;
 	TaskThreadLocalStorage tls;
+	/* Only allocated by the work stealing scheduler. */
+	TaskDeque *deque;
+	/* State of the random generator used to choose the stolen threads. */
+	uint32_t steal_seed;
 } TaskThread;
 
 /* Helper */
@@ -238,6 +272,16 @@ BLI_INLINE void task_data_free(Task *task, const int thread_id)
 	}
 }
 
+BLI_INLINE void task_run(Task *task, const int thread_id)
+{
+	if (task->run_range) {
+		task->run_range(task->pool, task->taskdata, task->start, task->stop, thread_id);
+	}
+	else {
+		task->run(task->pool, task->taskdata, thread_id);
+	}
+}
+
 BLI_INLINE void initialize_task_tls(TaskThreadLocalStorage *tls)
 {
 	memset(tls, 0, sizeof(TaskThreadLocalStorage));
@@ -329,13 +373,23 @@ static void task_free(TaskPool *pool, Task *task, const int thread_id)
 
 static void task_pool_num_decrease(TaskPool *pool, size_t done)
 {
+	/* Decrease without lock while tasks remain, the last decrease must be done
+	 * with the lock as the pool can be freed as soon as it has no tasks.
+	 */
+	size_t num = pool->num;
+	while (num > done) {
+		const size_t prev = atomic_cas_z((size_t *)&pool->num, num, num - done);
+		if (prev == num) {
+			return;
+		}
+		num = prev;
+	}
+
 	BLI_mutex_lock(&pool->num_mutex);
 
 	BLI_assert(pool->num >= done);
 
-	pool->num -= done;
-
-	if (pool->num == 0)
+	if (atomic_sub_and_fetch_z((size_t *)&pool->num, done) == 0)
 		BLI_condition_notify_all(&pool->num_cond);
 
 	BLI_mutex_unlock(&pool->num_mutex);
@@ -345,7 +399,7 @@ static void task_pool_num_increase(TaskPool *pool, size_t new)
 {
 	BLI_mutex_lock(&pool->num_mutex);
 
-	pool->num += new;
+	atomic_add_and_fetch_z((size_t *)&pool->num, new);
 	BLI_condition_notify_all(&pool->num_cond);
 
 	BLI_mutex_unlock(&pool->num_mutex);
@@ -415,12 +469,189 @@ BLI_INLINE void handle_local_queue(TaskThreadLocalStorage *tls,
 		 * pool tasks.
 		 */
 		TaskPool *local_pool = local_task->pool;
-		local_task->run(local_pool, local_task->taskdata, thread_id);
+		task_run(local_task, thread_id);
 		task_free(local_pool, local_task, thread_id);
 	}
 	BLI_assert(!tls->do_delayed_push);
 }
 
+/* Work stealing */
+
+static bool task_deque_push(TaskDeque *deque, Task *task)
+{
+	const size_t bottom = deque->bottom;
+	const size_t top = atomic_add_and_fetch_z(&deque->top, 0);
+
+	if (bottom - top >= STEALING_DEQUE_SIZE) {
+		return false;
+	}
+
+	deque->tasks[bottom & (STEALING_DEQUE_SIZE - 1)] = task;
+	/* Full barrier, the task is visible to the thieves before the new bottom. */
+	atomic_add_and_fetch_z(&deque->bottom, 1);
+
+	return true;
+}
+
+static Task *task_deque_pop(TaskDeque *deque)
+{
+	/* Reserve the bottom task before looking at the top. */
+	const size_t bottom = atomic_sub_and_fetch_z(&deque->bottom, 1);
+	const size_t top = atomic_add_and_fetch_z(&deque->top, 0);
+
+	if ((ptrdiff_t)(bottom - top) < 0) {
+		/* Empty deque. */
+		atomic_add_and_fetch_z(&deque->bottom, 1);
+		return NULL;
+	}
+
+	Task *task = deque->tasks[bottom & (STEALING_DEQUE_SIZE - 1)];
+	if (bottom != top) {
+		/* Thieves can't reach this task. */
+		return task;
+	}
+
+	/* Last task, race against the thieves for it. */
+	if (atomic_cas_z(&deque->top, top, top + 1) != top) {
+		task = NULL;
+	}
+	atomic_add_and_fetch_z(&deque->bottom, 1);
+
+	return task;
+}
+
+static Task *task_deque_steal(TaskDeque *deque)
+{
+	while (true) {
+		const size_t top = atomic_add_and_fetch_z(&deque->top, 0);
+		const size_t bottom = atomic_add_and_fetch_z(&deque->bottom, 0);
+
+		if ((ptrdiff_t)(bottom - top) <= 0) {
+			return NULL;
+		}
+
+		Task *task = deque->tasks[top & (STEALING_DEQUE_SIZE - 1)];
+		if (atomic_cas_z(&deque->top, top, top + 1) == top) {
+			return task;
+		}
+		/* Another thread took the task, try the next one. */
+	}
+}
+
+BLI_INLINE bool task_scheduler_use_stealing(TaskScheduler *scheduler)
+{
+	return scheduler->queue_type == TASK_SCHEDULER_QUEUE_WORK_STEALING;
+}
+
+/* Return the thread of the scheduler calling this function, NULL if it's not the
+ * main thread or a worker thread. */
+static TaskThread *task_scheduler_current_thread(TaskScheduler *scheduler)
+{
+	if (BLI_thread_is_main()) {
+		return &scheduler->task_threads[0];
+	}
+	return pthread_getspecific(scheduler->tls_id_key);
+}
+
+static Task *task_scheduler_steal(TaskScheduler *scheduler, TaskThread *thread)
+{
+	const int num_deques = scheduler->num_threads + 1;
+
+	/* Xorshift, start from a random thread to spread the thieves. */
+	uint32_t seed = thread->steal_seed;
+	seed ^= seed << 13;
+	seed ^= seed >> 17;
+	seed ^= seed << 5;
+	thread->steal_seed = seed;
+
+	int victim = (int)(seed % (uint32_t)num_deques);
+	for (int i = 0; i < num_deques; ++i, victim = (victim + 1) % num_deques) {
+		if (victim == thread->id) {
+			continue;
+		}
+
+		Task *task = task_deque_steal(scheduler->task_threads[victim].deque);
+		if (task) {
+			return task;
+		}
+	}
+
+	return NULL;
+}
+
+static void task_scheduler_wake_stealing(TaskScheduler *scheduler)
+{
+	/* The deque push and this test are both full barriers, a thread going to sleep
+	 * either sees the new task or is counted here. */
+	if (atomic_add_and_fetch_z(&scheduler->num_sleeping, 0) != 0) {
+		BLI_mutex_lock(&scheduler->queue_mutex);
+		BLI_condition_notify_one(&scheduler->queue_cond);
+		BLI_mutex_unlock(&scheduler->queue_mutex);
+	}
+}
+
+static Task *task_scheduler_thread_wait_pop_stealing(TaskScheduler *scheduler, TaskThread *thread)
+{
+	while (true) {
+		Task *task = task_deque_pop(thread->deque);
+		if (!task) {
+			task = task_scheduler_steal(scheduler, thread);
+		}
+		if (task) {
+			return task;
+		}
+
+		BLI_mutex_lock(&scheduler->queue_mutex);
+
+		if (scheduler->do_exit) {
+			BLI_mutex_unlock(&scheduler->queue_mutex);
+			return NULL;
+		}
+
+		task = scheduler->queue.first;
+		if (task) {
+			BLI_remlink(&scheduler->queue, task);
+		}
+		else {
+			atomic_add_and_fetch_z(&scheduler->num_sleeping, 1);
+			/* Check again the deques now that pushing threads will wake us. */
+			task = task_scheduler_steal(scheduler, thread);
+			if (!task) {
+				BLI_condition_wait(&scheduler->queue_cond, &scheduler->queue_mutex);
+			}
+			atomic_sub_and_fetch_z(&scheduler->num_sleeping, 1);
+		}
+
+		BLI_mutex_unlock(&scheduler->queue_mutex);
+
+		if (task) {
+			return task;
+		}
+	}
+}
+
+static void *task_scheduler_thread_run_stealing(TaskThread *thread)
+{
+	TaskScheduler *scheduler = thread->scheduler;
+	const int thread_id = thread->id;
+	Task *task;
+
+	while ((task = task_scheduler_thread_wait_pop_stealing(scheduler, thread))) {
+		TaskPool *pool = task->pool;
+
+		/* Tasks of a canceled pool can't be removed from the deques, skip them. */
+		if (!pool->do_cancel) {
+			task_run(task, thread_id);
+		}
+
+		task_free(pool, task, thread_id);
+
+		task_pool_num_decrease(pool, 1);
+	}
+
+	return NULL;
+}
+
 static void *task_scheduler_thread_run(void *thread_p)
 {
 	TaskThread *thread = (TaskThread *) thread_p;
@@ -431,13 +662,17 @@ static void *task_scheduler_thread_run(void *thread_p)
 
 	pthread_setspecific(scheduler->tls_id_key, thread);
 
+	if (task_scheduler_use_stealing(scheduler)) {
+		return task_scheduler_thread_run_stealing(thread);
+	}
+
 	/* keep popping off tasks */
 	while (task_scheduler_thread_wait_pop(scheduler, &task)) {
 		TaskPool *pool = task->pool;
 
 		/* run task */
 		BLI_assert(!tls->do_delayed_push);
-		task->run(pool, task->taskdata, thread_id);
+		task_run(task, thread_id);
 		BLI_assert(!tls->do_delayed_push);
 
 		/* delete task */
@@ -454,6 +689,11 @@ static void *task_scheduler_thread_run(void *thread_p)
 }
 
 TaskScheduler *BLI_task_scheduler_create(int num_threads)
+{
+	return BLI_task_scheduler_create_ex(num_threads, TASK_SCHEDULER_QUEUE_GLOBAL);
+}
+
+TaskScheduler *BLI_task_scheduler_create_ex(int num_threads, TaskSchedulerQueue queue)
 {
 	TaskScheduler *scheduler = MEM_callocN(sizeof(TaskScheduler), "TaskScheduler");
 
@@ -477,14 +717,27 @@ TaskScheduler *BLI_task_scheduler_create(int num_threads)
 	if (num_threads == 0) {
 		scheduler->background_thread_only = true;
 		num_threads = 1;
+		/* The background thread can't steal the tasks of the main thread. */
+		queue = TASK_SCHEDULER_QUEUE_GLOBAL;
 	}
 
-	scheduler->task_threads = MEM_mallocN(sizeof(TaskThread) * (num_threads + 1),
+	scheduler->queue_type = queue;
+
+	scheduler->task_threads = MEM_callocN(sizeof(TaskThread) * (num_threads + 1),
 	                                      "TaskScheduler task threads");
 
 	/* Initialize TLS for main thread. */
+	scheduler->task_threads[0].scheduler = scheduler;
 	initialize_task_tls(&scheduler->task_threads[0].tls);
 
+	if (task_scheduler_use_stealing(scheduler)) {
+		for (int i = 0; i < num_threads + 1; i++) {
+			TaskThread *thread = &scheduler->task_threads[i];
+			thread->deque = MEM_callocN(sizeof(TaskDeque), "TaskScheduler deque");
+			thread->steal_seed = 2654435761u * (uint32_t)(i + 1);
+		}
+	}
+
 	pthread_key_create(&scheduler->tls_id_key, NULL);
 
 	/* launch threads that will be waiting for work */
@@ -538,6 +791,17 @@ void BLI_task_scheduler_free(TaskScheduler *scheduler)
 		for (int i = 0; i < scheduler->num_threads + 1; ++i) {
 			TaskThreadLocalStorage *tls = &scheduler->task_threads[i].tls;
 			free_task_tls(tls);
+
+			TaskDeque *deque = scheduler->task_threads[i].deque;
+			if (deque) {
+				/* Delete leftover tasks. */
+				Task *task;
+				while ((task = task_deque_pop(deque))) {
+					task_data_free(task, 0);
+					MEM_freeN(task);
+				}
+				MEM_freeN(deque);
+			}
 		}
 
 		MEM_freeN(scheduler->task_threads);
@@ -561,10 +825,8 @@ int BLI_task_scheduler_num_threads(TaskScheduler *scheduler)
 	return scheduler->num_threads + 1;
 }
 
-static void task_scheduler_push(TaskScheduler *scheduler, Task *task, TaskPriority priority)
+static void task_scheduler_queue_push(TaskScheduler *scheduler, Task *task, TaskPriority priority)
 {
-	task_pool_num_increase(task->pool, 1);
-
 	/* add task to queue */
 	BLI_mutex_lock(&scheduler->queue_mutex);
 
@@ -577,6 +839,42 @@ static void task_scheduler_push(TaskScheduler *scheduler, Task *task, TaskPriori
 	BLI_mutex_unlock(&scheduler->queue_mutex);
 }
 
+static void task_scheduler_push(TaskScheduler *scheduler, Task *task, TaskPriority priority)
+{
+	task_pool_num_increase(task->pool, 1);
+
+	task_scheduler_queue_push(scheduler, task, priority);
+}
+
+/* Push a task to the deque of the calling thread, return false if the global
+ * queue must be used instead. */
+static bool task_scheduler_push_stealing(TaskScheduler *scheduler, Task *task)
+{
+	TaskPool *pool = task->pool;
+
+	/* Background pools may never be waited and must stay available to any thread. */
+	if (pool->run_in_background) {
+		return false;
+	}
+
+	TaskThread *thread = task_scheduler_current_thread(scheduler);
+	if (!thread) {
+		return false;
+	}
+
+	/* No lock, the pool waiters don't look for new tasks in the deques. */
+	atomic_add_and_fetch_z((size_t *)&pool->num, 1);
+
+	if (!task_deque_push(thread->deque, task)) {
+		task_scheduler_queue_push(scheduler, task, TASK_PRIORITY_LOW);
+		return true;
+	}
+
+	task_scheduler_wake_stealing(scheduler);
+
+	return true;
+}
+
 static void task_scheduler_push_all(TaskScheduler *scheduler,
                                     TaskPool *pool,
                                     Task **tasks,
@@ -625,6 +923,26 @@ static void task_scheduler_clear(TaskScheduler *scheduler, TaskPool *pool)
 
 /* Task Pool */
 
+/* Pop the next task of a pool from the deque of the calling thread, the tasks of
+ * other pools are moved to the global queue as running them could deadlock. */
+static Task *task_scheduler_pop_pool_stealing(TaskScheduler *scheduler, TaskPool *pool)
+{
+	TaskThread *thread = task_scheduler_current_thread(scheduler);
+	if (!thread) {
+		return NULL;
+	}
+
+	Task *task;
+	while ((task = task_deque_pop(thread->deque))) {
+		if (task->pool == pool) {
+			return task;
+		}
+		task_scheduler_queue_push(scheduler, task, TASK_PRIORITY_HIGH);
+	}
+
+	return NULL;
+}
+
 static TaskPool *task_pool_create_ex(TaskScheduler *scheduler,
                                      void *userdata,
                                      const bool is_background,
@@ -770,18 +1088,20 @@ BLI_INLINE bool task_can_use_local_queues(TaskPool *pool, int thread_id)
 	return (thread_id != -1 && (thread_id != pool->thread_id || pool->do_work));
 }
 
-static void task_pool_push(
-        TaskPool *pool, TaskRunFunction run, void *taskdata,
-        bool free_taskdata, TaskFreeFunction freedata, TaskPriority priority,
-        int thread_id)
+static Task *task_pool_alloc_task(TaskPool *pool, int thread_id)
+{
+	if (thread_id == -1 && task_scheduler_use_stealing(pool->scheduler)) {
+		/* Use the memory pool of the calling thread when it's known. */
+		TaskThread *thread = task_scheduler_current_thread(pool->scheduler);
+		if (thread && (thread->id != 0 || pool->thread_id == 0)) {
+			thread_id = thread->id;
+		}
+	}
+	return task_alloc(pool, thread_id);
+}
+
+static void task_pool_push_task(TaskPool *pool, Task *task, TaskPriority priority, int thread_id)
 {
-	/* Allocate task and fill it's properties. */
-	Task *task = task_alloc(pool, thread_id);
-	task->run = run;
-	task->taskdata = taskdata;
-	task->free_taskdata = free_taskdata;
-	task->freedata = freedata;
-	task->pool = pool;
 	/* For suspended pools we put everything yo a global queue first
 	 * and exit as soon as possible.
 	 *
@@ -793,6 +1113,14 @@ static void task_pool_push(
 		atomic_fetch_and_add_z(&pool->num_suspended, 1);
 		return;
 	}
+	/* The deques of the work stealing scheduler replace the local queues. */
+	if (task_scheduler_use_stealing(pool->scheduler)) {
+		if (task_scheduler_push_stealing(pool->scheduler, task)) {
+			return;
+		}
+		task_scheduler_push(pool->scheduler, task, priority);
+		return;
+	}
 	/* Populate to any local queue first, this is cheapest push ever. */
 	if (task_can_use_local_queues(pool, thread_id)) {
 		ASSERT_THREAD_ID(pool->scheduler, thread_id);
@@ -821,6 +1149,23 @@ static void task_pool_push(
 	task_scheduler_push(pool->scheduler, task, priority);
 }
 
+static void task_pool_push(
+        TaskPool *pool, TaskRunFunction run, void *taskdata,
+        bool free_taskdata, TaskFreeFunction freedata, TaskPriority priority,
+        int thread_id)
+{
+	/* Allocate task and fill it's properties. */
+	Task *task = task_pool_alloc_task(pool, thread_id);
+	task->run = run;
+	task->taskdata = taskdata;
+	task->free_taskdata = free_taskdata;
+	task->freedata = freedata;
+	task->pool = pool;
+	task->run_range = NULL;
+
+	task_pool_push_task(pool, task, priority, thread_id);
+}
+
 void BLI_task_pool_push_ex(
         TaskPool *pool, TaskRunFunction run, void *taskdata,
         bool free_taskdata, TaskFreeFunction freedata, TaskPriority priority)
@@ -840,6 +1185,77 @@ void BLI_task_pool_push_from_thread(TaskPool *pool, TaskRunFunction run,
 	task_pool_push(pool, run, taskdata, free_taskdata, NULL, priority, thread_id);
 }
 
+void BLI_task_pool_push_range(TaskPool *pool, TaskRunRangeFunction run,
+        void *taskdata, int start, int stop, int grain_size, TaskPriority priority)
+{
+	if (start >= stop) {
+		return;
+	}
+
+	if (grain_size <= 0) {
+		/* Enough tasks to balance the threads without too much overhead. */
+		const int num_tasks = BLI_task_scheduler_num_threads(pool->scheduler) * 4;
+		grain_size = max_ii(1, (stop - start + num_tasks - 1) / num_tasks);
+	}
+
+	for (int i = start; i < stop; i += grain_size) {
+		Task *task = task_pool_alloc_task(pool, -1);
+		task->run = NULL;
+		task->taskdata = taskdata;
+		task->free_taskdata = false;
+		task->freedata = NULL;
+		task->pool = pool;
+		task->run_range = run;
+		task->start = i;
+		task->stop = min_ii(i + grain_size, stop);
+
+		task_pool_push_task(pool, task, priority, -1);
+	}
+}
+
+static void task_pool_work_and_wait_stealing(TaskPool *pool)
+{
+	TaskScheduler *scheduler = pool->scheduler;
+
+	BLI_mutex_lock(&pool->num_mutex);
+
+	while (pool->num != 0) {
+		BLI_mutex_unlock(&pool->num_mutex);
+
+		/* Run first the tasks pushed by this thread, the others are stolen by
+		 * the worker threads. */
+		Task *task = task_scheduler_pop_pool_stealing(scheduler, pool);
+
+		if (!task) {
+			/* find task from this pool in the global queue. if we get a task from
+			 * another pool, we can get into deadlock */
+			BLI_mutex_lock(&scheduler->queue_mutex);
+			for (task = scheduler->queue.first; task; task = task->next) {
+				if (task->pool == pool) {
+					BLI_remlink(&scheduler->queue, task);
+					break;
+				}
+			}
+			BLI_mutex_unlock(&scheduler->queue_mutex);
+		}
+
+		if (task) {
+			task_run(task, pool->thread_id);
+			task_free(pool, task, pool->thread_id);
+			task_pool_num_decrease(pool, 1);
+		}
+
+		BLI_mutex_lock(&pool->num_mutex);
+		if (pool->num == 0)
+			break;
+
+		if (!task)
+			BLI_condition_wait(&pool->num_cond, &pool->num_mutex);
+	}
+
+	BLI_mutex_unlock(&pool->num_mutex);
+}
+
 void BLI_task_pool_work_and_wait(TaskPool *pool)
 {
 	TaskThreadLocalStorage *tls = get_task_tls(pool, pool->thread_id);
@@ -861,6 +1277,11 @@ void BLI_task_pool_work_and_wait(TaskPool *pool)
 
 	ASSERT_THREAD_ID(pool->scheduler, pool->thread_id);
 
+	if (task_scheduler_use_stealing(scheduler)) {
+		task_pool_work_and_wait_stealing(pool);
+		return;
+	}
+
 	BLI_mutex_lock(&pool->num_mutex);
 
 	while (pool->num != 0) {
@@ -889,7 +1310,7 @@ void BLI_task_pool_work_and_wait(TaskPool *pool)
 		if (found_task) {
 			/* run task */
 			BLI_assert(!tls->do_delayed_push);
-			work_task->run(pool, work_task->taskdata, pool->thread_id);
+			task_run(work_task, pool->thread_id);
 			BLI_assert(!tls->do_delayed_push);
 
 			/* delete task */
@@ -1632,6 +1632,7 @@ static void draw_actuator_edit_object(uiLayout *layout, PointerRNA *ptr)
 			row = uiLayoutRow(layout, false);
 			uiItemR(row, ptr, "object", 0, NULL, ICON_NONE);
 			uiItemR(row, ptr, "time", 0, NULL, ICON_NONE);
+			uiItemR(row, ptr, "use_replica_pool", UI_ITEM_R_TOGGLE, NULL, ICON_NONE);
 
 			split = uiLayoutSplit(layout, 0.9, false);
 			row = uiLayoutRow(split, false);
@@ -455,6 +455,8 @@ typedef struct bActuator {
 /* editObjectActuator->flag for replace mesh actuator */
 #define ACT_EDOB_REPLACE_MESH_NOGFX		2 /* use for replace mesh actuator */
 #define ACT_EDOB_REPLACE_MESH_PHYS		4
+/* editObjectActuator->flag for add object actuator */
+#define ACT_EDOB_ADD_OBJECT_POOL		8 /* recycle the removed added objects */
 
 /* editObjectActuator->dyn_operation */
 #define ACT_EDOB_RESTORE_DYN	0
@@ -900,7 +900,7 @@ typedef struct GameData {
 	short showShadowFrustum;
 
 	/* Scene LoD */
-	short lodflag, pad2;
+	short lodflag, physicsThreads;
 	int scehysteresis;
 	int pad3;
 
@@ -953,6 +953,7 @@ typedef struct GameData {
 #endif
 #define GAME_PYTHON_CONSOLE					(1 << 20)
 #define GAME_GLSL_NO_ENV_LIGHTING			(1 << 21)
+#define GAME_PHYSICS_MULTITHREADING			(1 << 22)
 /* Note: GameData.flag is now an int (max 32 flags). A short could only take 16 flags */
 
 #define GAME_DEBUG_DISABLE	0
@@ -1479,6 +1479,12 @@ static void rna_def_edit_object_actuator(BlenderRNA *brna)
 	                         "Replace the physics mesh (triangle bounds only - compound shapes not supported)");
 	RNA_def_property_update(prop, NC_LOGIC, NULL);
 
+	prop = RNA_def_property(srna, "use_replica_pool", PROP_BOOLEAN, PROP_NONE);
+	RNA_def_property_boolean_sdna(prop, NULL, "flag", ACT_EDOB_ADD_OBJECT_POOL);
+	RNA_def_property_ui_text(prop, "Pool",
+	                         "Recycle the removed added objects instead of freeing them (objects without children only)");
+	RNA_def_property_update(prop, NC_LOGIC, NULL);
+
 	prop = RNA_def_property(srna, "use_3d_tracking", PROP_BOOLEAN, PROP_NONE);
 	RNA_def_property_boolean_sdna(prop, NULL, "flag", ACT_TRACK_3D);
 	RNA_def_property_ui_text(prop, "3D", "Enable 3D tracking");
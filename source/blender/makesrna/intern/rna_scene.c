@@ -4764,6 +4764,20 @@ static void rna_def_scene_game_data(BlenderRNA *brna)
 	                         "higher value give better physics precision");
 	RNA_def_property_update(prop, NC_SCENE, NULL);
 
+	prop = RNA_def_property(srna, "use_physics_multithreading", PROP_BOOLEAN, PROP_NONE);
+	RNA_def_property_boolean_sdna(prop, NULL, "flag", GAME_PHYSICS_MULTITHREADING);
+	RNA_def_property_ui_text(prop, "Multithreading",
+	                         "Solve the collisions and the simulation islands on several threads");
+	RNA_def_property_update(prop, NC_SCENE, NULL);
+
+	prop = RNA_def_property(srna, "physics_threads", PROP_INT, PROP_NONE);
+	RNA_def_property_int_sdna(prop, NULL, "physicsThreads");
+	RNA_def_property_range(prop, 0, 64);
+	RNA_def_property_ui_text(prop, "Physics Threads",
+	                         "Maximum number of threads used by the physics, 0 to use all the engine threads, "
+	                         "the simulation doesn't depend on this number");
+	RNA_def_property_update(prop, NC_SCENE, NULL);
+
 	prop = RNA_def_property(srna, "time_scale", PROP_FLOAT, PROP_NONE);
 	RNA_def_property_float_sdna(prop, NULL, "timeScale");
 	RNA_def_property_ui_range(prop, 0.001, 10000.0, 2, 3);
@@ -0,0 +1,260 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file gameengine/Common/CM_Profiler.cpp
+ *  \ingroup common
+ */
+
+#include "CM_Profiler.h"
+#include "CM_Thread.h"
+#include "CM_Message.h"
+
+#include "PIL_time.h"
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+
+/// Thread identifier of the frame events, the next ones are used by the tracks.
+static const unsigned int frameThreadId = 1000;
+
+bool CM_Profiler::m_enabled = false;
+std::vector<CM_Profiler::Frame> CM_Profiler::m_frames;
+unsigned int CM_Profiler::m_currentFrame = 0;
+unsigned int CM_Profiler::m_numFinishedFrames = 0;
+std::vector<std::string> CM_Profiler::m_tracks;
+
+static CM_ThreadSpinLock profilerLock;
+
+void CM_Profiler::Enable(unsigned int numFrames)
+{
+	// Keep the current frame in addition of the finished frames.
+	m_frames.clear();
+	m_frames.resize(std::max(numFrames, 1u) + 1);
+	m_currentFrame = 0;
+	m_numFinishedFrames = 0;
+	m_frames[0].m_start = GetTime();
+
+	m_enabled = true;
+}
+
+void CM_Profiler::Disable()
+{
+	m_enabled = false;
+	m_frames.clear();
+}
+
+double CM_Profiler::GetTime()
+{
+	return PIL_check_seconds_timer();
+}
+
+unsigned int CM_Profiler::GetThreadId()
+{
+	static std::atomic<unsigned int> numThreads(0);
+	static thread_local unsigned int threadId = numThreads++;
+
+	return threadId;
+}
+
+unsigned int CM_Profiler::GetTrackId(const std::string& name)
+{
+	profilerLock.Lock();
+
+	std::vector<std::string>::iterator it = std::find(m_tracks.begin(), m_tracks.end(), name);
+	const unsigned int index = it - m_tracks.begin();
+	if (it == m_tracks.end()) {
+		m_tracks.push_back(name);
+	}
+
+	profilerLock.Unlock();
+
+	return frameThreadId + 1 + index;
+}
+
+void CM_Profiler::NextFrame()
+{
+	if (!m_enabled) {
+		return;
+	}
+
+	const double now = GetTime();
+
+	profilerLock.Lock();
+
+	m_frames[m_currentFrame].m_end = now;
+	m_currentFrame = (m_currentFrame + 1) % m_frames.size();
+	++m_numFinishedFrames;
+
+	Frame& frame = m_frames[m_currentFrame];
+	frame.m_start = now;
+	// Clear but keep the memory of the reused frame.
+	frame.m_events.clear();
+
+	profilerLock.Unlock();
+}
+
+void CM_Profiler::AddEvent(const std::string& name, const char *category, double start, double end, unsigned int thread)
+{
+	profilerLock.Lock();
+
+	// The profiler could be disabled since the beginning of the timing.
+	if (m_enabled) {
+		m_frames[m_currentFrame].m_events.push_back({name, category, start, end - start, thread});
+	}
+
+	profilerLock.Unlock();
+}
+
+static void writeJsonString(std::ofstream& file, const std::string& str)
+{
+	file << "\"";
+	for (const char c : str) {
+		switch (c) {
+			case '"':
+			{
+				file << "\\\"";
+				break;
+			}
+			case '\\':
+			{
+				file << "\\\\";
+				break;
+			}
+			default:
+			{
+				if ((unsigned char)c < 0x20) {
+					file << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (int)c << std::dec;
+				}
+				else {
+					file << c;
+				}
+				break;
+			}
+		}
+	}
+	file << "\"";
+}
+
+static void writeTraceEvent(std::ofstream& file, bool& first, const std::string& name, const char *category,
+		double start, double duration, unsigned int thread)
+{
+	file << (first ? "\n" : ",\n") << "{\"name\":";
+	writeJsonString(file, name);
+	// Times are written in microseconds.
+	file << ",\"cat\":\"" << category << "\",\"ph\":\"X\",\"ts\":" << start * 1.0e6 << ",\"dur\":" << duration * 1.0e6
+		 << ",\"pid\":0,\"tid\":" << thread << "}";
+	first = false;
+}
+
+static void writeThreadName(std::ofstream& file, bool& first, const std::string& name, unsigned int thread)
+{
+	file << (first ? "\n" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << thread
+		 << ",\"args\":{\"name\":";
+	writeJsonString(file, name);
+	file << "}}";
+	first = false;
+}
+
+bool CM_Profiler::WriteChromeTrace(const std::string& filename)
+{
+	std::ofstream file(filename);
+	if (!file) {
+		CM_Error("can't open profiler trace file: " << filename);
+		return false;
+	}
+
+	profilerLock.Lock();
+
+	const unsigned int size = m_frames.size();
+	const unsigned int numFrames = std::min(m_numFinishedFrames, size - 1);
+
+	file << std::fixed << std::setprecision(3);
+	file << "{\"traceEvents\":[";
+
+	bool first = true;
+	writeThreadName(file, first, "Frames", frameThreadId);
+	for (unsigned int i = 0, numTracks = m_tracks.size(); i < numTracks; ++i) {
+		writeThreadName(file, first, m_tracks[i], frameThreadId + 1 + i);
+	}
+
+	// Iterate from the oldest finished frame.
+	for (unsigned int i = 0; i < numFrames; ++i) {
+		const unsigned int index = (m_currentFrame + size - numFrames + i) % size;
+		const Frame& frame = m_frames[index];
+
+		writeTraceEvent(file, first, "Frame " + std::to_string(m_numFinishedFrames - numFrames + i), "frame",
+				frame.m_start, frame.m_end - frame.m_start, frameThreadId);
+
+		for (const Event& event : frame.m_events) {
+			writeTraceEvent(file, first, event.m_name, event.m_category, event.m_start, event.m_duration, event.m_thread);
+		}
+	}
+
+	profilerLock.Unlock();
+
+	file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+	if (!file) {
+		CM_Error("failed to write profiler trace file: " << filename);
+		return false;
+	}
+
+	return true;
+}
+
+CM_ProfilerPhase::CM_ProfilerPhase()
+	:m_start(0.0),
+	m_track(CM_Profiler::GetThreadId()),
+	m_active(false)
+{
+}
+
+void CM_ProfilerPhase::SetTrack(const std::string& name)
+{
+	m_track = CM_Profiler::GetTrackId(name);
+}
+
+void CM_ProfilerPhase::Begin(const std::string& name)
+{
+	if (!m_active && !CM_Profiler::IsEnabled()) {
+		return;
+	}
+
+	const double now = CM_Profiler::GetTime();
+	if (m_active) {
+		CM_Profiler::AddEvent(m_name, "phase", m_start, now, m_track);
+	}
+
+	m_active = CM_Profiler::IsEnabled();
+	if (m_active) {
+		m_name = name;
+		m_start = now;
+	}
+}
+
+void CM_ProfilerPhase::End()
+{
+	if (m_active) {
+		CM_Profiler::AddEvent(m_name, "phase", m_start, CM_Profiler::GetTime(), m_track);
+		m_active = false;
+	}
+}
@@ -0,0 +1,153 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file CM_Profiler.h
+ *  \ingroup common
+ */
+
+#ifndef __CM_PROFILER_H__
+#define __CM_PROFILER_H__
+
+#include <string>
+#include <vector>
+
+/** \brief Frame profiler recording named timings per thread.
+ *
+ * The timings of the last frames are kept in a ring buffer and can be written to
+ * a Chrome trace event file (chrome://tracing). When the profiler is disabled the
+ * recording functions only cost a test of a global flag.
+ */
+class CM_Profiler
+{
+public:
+	/// A timing recorded by the profiler, times are in seconds.
+	struct Event
+	{
+		std::string m_name;
+		const char *m_category;
+		double m_start;
+		double m_duration;
+		unsigned int m_thread;
+	};
+
+private:
+	struct Frame
+	{
+		double m_start;
+		double m_end;
+		std::vector<Event> m_events;
+	};
+
+	static bool m_enabled;
+	/// Ring buffer of the recorded frames.
+	static std::vector<Frame> m_frames;
+	/// Index of the frame currently recorded in the ring buffer.
+	static unsigned int m_currentFrame;
+	/// Total number of frames finished since the profiler was enabled.
+	static unsigned int m_numFinishedFrames;
+	/// Names of the tracks, a track is shown as a thread.
+	static std::vector<std::string> m_tracks;
+
+public:
+	/** Enable the recording of the timings.
+	 * \param numFrames The number of frames kept in the ring buffer.
+	 */
+	static void Enable(unsigned int numFrames);
+	/// Disable the recording and free the recorded frames.
+	static void Disable();
+
+	inline static bool IsEnabled()
+	{
+		return m_enabled;
+	}
+
+	/// Return the time used by the profiler in seconds.
+	static double GetTime();
+	/// Return a small identifier of the calling thread.
+	static unsigned int GetThreadId();
+	/// Return the thread identifier of a named track, the track is created if needed.
+	static unsigned int GetTrackId(const std::string& name);
+
+	/// Finish the current frame and start recording the next one.
+	static void NextFrame();
+	/// Record a timing in the current frame, can be called from any thread.
+	static void AddEvent(const std::string& name, const char *category, double start, double end, unsigned int thread);
+
+	/** Write the recorded frames, excepted the current one, to a Chrome trace event file.
+	 * \return False if the file couldn't be written.
+	 */
+	static bool WriteChromeTrace(const std::string& filename);
+};
+
+/** \brief Record the time spent in its scope.
+ *
+ * The name is computed by a functor only when the profiler is enabled.
+ */
+class CM_ProfilerScope
+{
+private:
+	bool m_active;
+	const char *m_category;
+	std::string m_name;
+	double m_start;
+
+public:
+	template <class NameFunc>
+	CM_ProfilerScope(const char *category, NameFunc nameFunc)
+		:m_active(CM_Profiler::IsEnabled())
+	{
+		if (m_active) {
+			m_category = category;
+			m_name = nameFunc();
+			m_start = CM_Profiler::GetTime();
+		}
+	}
+
+	~CM_ProfilerScope()
+	{
+		if (m_active) {
+			CM_Profiler::AddEvent(m_name, m_category, m_start, CM_Profiler::GetTime(), CM_Profiler::GetThreadId());
+		}
+	}
+};
+
+/** \brief Record consecutive phases, each phase ends when the next one begins.
+ *
+ * The phases are recorded in their own track instead of the thread which began them
+ * as they can overlap the phases of other tracks.
+ */
+class CM_ProfilerPhase
+{
+private:
+	std::string m_name;
+	double m_start;
+	unsigned int m_track;
+	bool m_active;
+
+public:
+	CM_ProfilerPhase();
+
+	void SetTrack(const std::string& name);
+
+	void Begin(const std::string& name);
+	void End();
+};
+
+#endif  // __CM_PROFILER_H__
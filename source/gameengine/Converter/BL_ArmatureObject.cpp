@@ -61,6 +61,8 @@ extern "C" {
 
 #include "CM_Message.h"
 
+#include <algorithm>
+
 /**
  * Move here pose function for game engine so that we can mix with GE objects
  * Principle is as follow:
@@ -213,7 +215,12 @@ BL_ArmatureObject::BL_ArmatureObject(void *sgReplicationInfo,
 	m_timestep(0.040),
 	m_vert_deform_type(vert_deform_type),
 	m_drawDebug(false),
-	m_lastapplyframe(0.0)
+	m_lastapplyframe(0.0),
+	m_lodSourcePose(nullptr),
+	m_lodTargetPose(nullptr),
+	m_lodSourceTime(-1.0),
+	m_lodTargetTime(-1.0),
+	m_lodOffset(0)
 {
 	m_controlledConstraints = new CListValue<BL_ArmatureConstraint>();
 	m_poseChannels = new CListValue<BL_ArmatureChannel>();
@@ -235,6 +242,8 @@ BL_ArmatureObject::~BL_ArmatureObject()
 	m_poseChannels->Release();
 	m_controlledConstraints->Release();
 
+	ClearLodPoses();
+
 	if (m_objArma) {
 		BKE_libblock_free(G.main, m_objArma->data);
 		/* avoid BKE_libblock_free(G.main, m_objArma)
@@ -391,6 +400,12 @@ void BL_ArmatureObject::ProcessReplica()
 	m_objArma = BKE_object_copy(G.main, m_objArma);
 	m_objArma->data = BKE_armature_copy(G.main, tmp);
 	m_pose = m_objArma->pose;
+
+	// The stored poses are owned by the original armature.
+	m_lodSourcePose = nullptr;
+	m_lodTargetPose = nullptr;
+	m_lodSourceTime = -1.0;
+	m_lodTargetTime = -1.0;
 }
 
 int BL_ArmatureObject::GetGameObjectType() const
@@ -483,6 +498,66 @@ bool BL_ArmatureObject::UpdateTimestep(double curtime)
 	return false;
 }
 
+unsigned int BL_ArmatureObject::GetAnimationLodOffset() const
+{
+	return m_lodOffset;
+}
+
+void BL_ArmatureObject::SetAnimationLodOffset(unsigned int offset)
+{
+	m_lodOffset = offset;
+}
+
+void BL_ArmatureObject::StoreLodPose(double curtime)
+{
+	// The animations can be updated several times in the same frame.
+	if (curtime == m_lodTargetTime) {
+		return;
+	}
+
+	if (!m_lodTargetPose) {
+		game_copy_pose(&m_lodSourcePose, m_pose, 0);
+		game_copy_pose(&m_lodTargetPose, m_pose, 0);
+		m_lodSourceTime = m_lodTargetTime = curtime;
+		return;
+	}
+
+	std::swap(m_lodSourcePose, m_lodTargetPose);
+	extract_pose_from_pose(m_lodTargetPose, m_pose);
+	m_lodSourceTime = m_lodTargetTime;
+	m_lodTargetTime = curtime;
+}
+
+void BL_ArmatureObject::ClearLodPoses()
+{
+	if (m_lodSourcePose) {
+		BKE_pose_free(m_lodSourcePose);
+		m_lodSourcePose = nullptr;
+	}
+	if (m_lodTargetPose) {
+		BKE_pose_free(m_lodTargetPose);
+		m_lodTargetPose = nullptr;
+	}
+	m_lodSourceTime = -1.0;
+	m_lodTargetTime = -1.0;
+}
+
+bool BL_ArmatureObject::InterpolateLodPose(double curtime)
+{
+	if (!m_lodTargetPose || m_lodTargetTime <= m_lodSourceTime) {
+		return false;
+	}
+
+	/* The target pose is reached one update interval after its evaluation, the poses
+	 * are then always interpolated between two evaluated poses. */
+	const float fac = CLAMPIS((curtime - m_lodTargetTime) / (m_lodTargetTime - m_lodSourceTime), 0.0, 1.0);
+	extract_pose_from_pose(m_pose, m_lodSourcePose);
+	game_blend_poses(m_pose, m_lodTargetPose, fac, BL_Action::ACT_BLEND_BLEND);
+	UpdateTimestep(curtime);
+
+	return true;
+}
+
 bArmature *BL_ArmatureObject::GetArmature()
 {
 	return (bArmature *)m_objArma->data;
@@ -73,6 +73,14 @@ protected:
 
 	double m_lastapplyframe;
 
+	/// The two last poses evaluated by the animation level of detail, used to interpolate the skipped frames.
+	bPose *m_lodSourcePose;
+	bPose *m_lodTargetPose;
+	double m_lodSourceTime;
+	double m_lodTargetTime;
+	/// Frame offset used to spread the updates of the throttled armatures.
+	unsigned int m_lodOffset;
+
 public:
 	BL_ArmatureObject(void *sgReplicationInfo,
 	                  SG_Callbacks callbacks,
@@ -101,6 +109,18 @@ public:
 
 	bool UpdateTimestep(double curtime);
 
+	unsigned int GetAnimationLodOffset() const;
+	void SetAnimationLodOffset(unsigned int offset);
+	/// Store the current pose as the last pose evaluated by the animation level of detail.
+	void StoreLodPose(double curtime);
+	/// Discard the stored poses, used when the armature is updated every frame.
+	void ClearLodPoses();
+	/** Set the pose to the interpolation of the two last stored poses, the interpolation
+	 * is delayed by one update interval to never extrapolate.
+	 * \return False if less than two poses are stored.
+	 */
+	bool InterpolateLodPose(double curtime);
+
 	bArmature *GetArmature();
 	const bArmature *GetArmature() const;
 	const Scene *GetScene() const;
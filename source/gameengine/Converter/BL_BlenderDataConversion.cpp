@@ -1338,7 +1338,7 @@ static void bl_ConvertBlenderObject_Single(
 	{
 		// blender has an additional 'parentinverse' offset in each object
 		SG_Callbacks callback(nullptr,nullptr,nullptr,KX_Scene::KX_ScenegraphUpdateFunc,KX_Scene::KX_ScenegraphRescheduleFunc);
-		SG_Node* parentinversenode = new SG_Node(nullptr,kxscene,callback);
+		SG_Node* parentinversenode = new SG_Node(nullptr,kxscene,callback,kxscene->GetTransformPool());
 
 		// define a normal parent relationship for this node.
 		KX_NormalParentRelation * parent_relation = KX_NormalParentRelation::New();
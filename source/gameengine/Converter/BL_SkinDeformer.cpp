@@ -65,10 +65,20 @@ extern "C" {
 
 #include "BLI_blenlib.h"
 #include "BLI_math.h"
+#include "BLI_task.h"
+
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
 
 #define __NLA_DEFNORMALS
 //#undef __NLA_DEFNORMALS
 
+/// Minimum number of vertices to split the skinning in tasks.
+static const unsigned int skinParallelThreshold = 8192;
+/// Number of vertices skinned by a task.
+static const unsigned int skinTaskChunkSize = 2048;
+
 static short get_deformflags(Object *bmeshobj)
 {
 	short flags = ARM_DEF_VGROUP;
@@ -187,6 +197,9 @@ void BL_SkinDeformer::ProcessReplica()
 	m_lastArmaUpdate = -1.0;
 	m_releaseobject = false;
 	m_dfnrToPC = nullptr;
+	// The influences are compiled again with the pose channels of the replica armature.
+	m_skinVerts.clear();
+	m_skinMatrices.clear();
 }
 
 void BL_SkinDeformer::BlenderDeformVerts()
@@ -210,13 +223,127 @@ void BL_SkinDeformer::BlenderDeformVerts()
 #endif
 }
 
+void BL_SkinDeformer::BuildSkinVerts(int defbase_tot)
+{
+	const MDeformVert *dverts = m_bmesh->dvert;
+	m_skinVerts.resize(m_bmesh->totvert);
+
+	for (int i = 0; i < m_bmesh->totvert; ++i) {
+		const MDeformVert& dv = dverts[i];
+		SkinVertex& skinVert = m_skinVerts[i];
+		skinVert.m_numInfluences = 0;
+
+		for (int j = 0; j < dv.totweight; ++j) {
+			const MDeformWeight& dw = dv.dw[j];
+			const int index = dw.def_nr;
+
+			if (index >= defbase_tot || !m_dfnrToPC[index] || dw.weight == 0.0f) {
+				continue;
+			}
+
+			// Insert the influence sorted by weight, the weakest influence is dropped when the vertex is full.
+			unsigned int k = skinVert.m_numInfluences;
+			if (k == MAX_SKIN_INFLUENCES) {
+				if (dw.weight <= skinVert.m_weights[k - 1]) {
+					continue;
+				}
+				--k;
+			}
+			else {
+				++skinVert.m_numInfluences;
+			}
+
+			for (; k > 0 && skinVert.m_weights[k - 1] < dw.weight; --k) {
+				skinVert.m_groups[k] = skinVert.m_groups[k - 1];
+				skinVert.m_weights[k] = skinVert.m_weights[k - 1];
+			}
+			skinVert.m_groups[k] = index;
+			skinVert.m_weights[k] = dw.weight;
+		}
+
+		float contrib = 0.0f;
+		for (unsigned int j = 0; j < skinVert.m_numInfluences; ++j) {
+			contrib += skinVert.m_weights[j];
+		}
+		for (unsigned int j = 0; j < skinVert.m_numInfluences; ++j) {
+			skinVert.m_weights[j] /= contrib;
+		}
+	}
+}
+
+void BL_SkinDeformer::SkinVerts(unsigned int start, unsigned int end)
+{
+	const MVert *mverts = m_bmesh->mvert;
+
+	for (unsigned int i = start; i < end; ++i) {
+		const SkinVertex& skinVert = m_skinVerts[i];
+		if (skinVert.m_numInfluences == 0) {
+			continue;
+		}
+
+		float *co = m_transverts[i];
+		const short *no = mverts[i].no;
+		// The normal is rotated by the most influent deform group.
+		const SkinMatrix& normmat = m_skinMatrices[skinVert.m_groups[0]];
+
+#ifdef __SSE2__
+		const __m128 x = _mm_set1_ps(co[0]);
+		const __m128 y = _mm_set1_ps(co[1]);
+		const __m128 z = _mm_set1_ps(co[2]);
+		__m128 pos = _mm_setzero_ps();
+
+		for (unsigned int j = 0; j < skinVert.m_numInfluences; ++j) {
+			const SkinMatrix& mat = m_skinMatrices[skinVert.m_groups[j]];
+			const __m128 vec = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(mat.m_position[0]), x), _mm_mul_ps(_mm_loadu_ps(mat.m_position[1]), y)),
+				_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(mat.m_position[2]), z), _mm_loadu_ps(mat.m_position[3])));
+			pos = _mm_add_ps(pos, _mm_mul_ps(vec, _mm_set1_ps(skinVert.m_weights[j])));
+		}
+
+		const __m128 nor = _mm_add_ps(
+			_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(normmat.m_normal[0]), _mm_set1_ps(no[0])),
+			           _mm_mul_ps(_mm_loadu_ps(normmat.m_normal[1]), _mm_set1_ps(no[1]))),
+			_mm_mul_ps(_mm_loadu_ps(normmat.m_normal[2]), _mm_set1_ps(no[2])));
+
+		float result[4];
+		_mm_storeu_ps(result, pos);
+		copy_v3_v3(co, result);
+		_mm_storeu_ps(result, nor);
+		copy_v3_v3(m_transnors[i], result);
+#else
+		float pos[3] = {0.0f, 0.0f, 0.0f};
+
+		for (unsigned int j = 0; j < skinVert.m_numInfluences; ++j) {
+			const SkinMatrix& mat = m_skinMatrices[skinVert.m_groups[j]];
+			const float weight = skinVert.m_weights[j];
+			for (unsigned short k = 0; k < 3; ++k) {
+				pos[k] += (mat.m_position[0][k] * co[0] + mat.m_position[1][k] * co[1] +
+				           mat.m_position[2][k] * co[2] + mat.m_position[3][k]) * weight;
+			}
+		}
+
+		for (unsigned short k = 0; k < 3; ++k) {
+			m_transnors[i][k] = normmat.m_normal[0][k] * no[0] + normmat.m_normal[1][k] * no[1] + normmat.m_normal[2][k] * no[2];
+		}
+		copy_v3_v3(co, pos);
+#endif  // __SSE2__
+	}
+}
+
+void BL_SkinDeformer::SkinVertsTask(void *userdata, const int iter)
+{
+	BL_SkinDeformer *deformer = (BL_SkinDeformer *)userdata;
+	const unsigned int start = iter * skinTaskChunkSize;
+	deformer->SkinVerts(start, std::min(start + skinTaskChunkSize, (unsigned int)deformer->m_bmesh->totvert));
+}
+
 void BL_SkinDeformer::BGEDeformVerts()
 {
 	Object *par_arma = m_armobj->GetArmatureObject();
 	MDeformVert *dverts = m_bmesh->dvert;
 	bDeformGroup *dg;
 	int defbase_tot;
-	Eigen::Matrix4f pre_mat, post_mat, chan_mat, norm_chan_mat;
+	Eigen::Matrix4f pre_mat, post_mat;
 
 	if (!dverts)
 		return;
@@ -235,68 +362,40 @@ void BL_SkinDeformer::BGEDeformVerts()
 			if (m_dfnrToPC[i] && m_dfnrToPC[i]->bone->flag & BONE_NO_DEFORM)
 				m_dfnrToPC[i] = nullptr;
 		}
+
+		BuildSkinVerts(defbase_tot);
 	}
 
 	post_mat = Eigen::Matrix4f::Map((float *)m_obmat).inverse() * Eigen::Matrix4f::Map((float *)m_armobj->GetArmatureObject()->obmat);
 	pre_mat = post_mat.inverse();
 
-	MDeformVert *dv = dverts;
-	MDeformWeight *dw;
-
-	for (int i = 0; i < m_bmesh->totvert; ++i, dv++) {
-		float contrib = 0.0f, weight, max_weight = -1.0f;
-		bPoseChannel *pchan = nullptr;
-		Eigen::Vector3f normorg(m_bmesh->mvert[i].no[0], m_bmesh->mvert[i].no[1], m_bmesh->mvert[i].no[2]);
-		Eigen::Map<Eigen::Vector3f> norm = Eigen::Vector3f::Map(m_transnors[i]);
-		Eigen::Vector4f vec(0.0f, 0.0f, 0.0f, 1.0f);
-		Eigen::Vector4f co(m_transverts[i][0],
-		                   m_transverts[i][1],
-		                   m_transverts[i][2],
-		                   1.0f);
-
-		if (!dv->totweight)
+	// Combine the pose channel matrices with the mesh to armature space matrices once per deform group.
+	m_skinMatrices.resize(defbase_tot);
+	for (int i = 0; i < defbase_tot; ++i) {
+		bPoseChannel *pchan = m_dfnrToPC[i];
+		if (!pchan) {
 			continue;
+		}
 
-		co = pre_mat * co;
-
-		dw = dv->dw;
-
-		for (unsigned int j = dv->totweight; j != 0; j--, dw++) {
-			const int index = dw->def_nr;
-
-			if (index < defbase_tot && (pchan = m_dfnrToPC[index])) {
-				weight = dw->weight;
-
-				if (weight) {
-					chan_mat = Eigen::Matrix4f::Map((float *)pchan->chan_mat);
-
-					// Update Vertex Position
-					vec.noalias() += (chan_mat * co - co) * weight;
-
-					// Save the most influential channel so we can use it to update the vertex normal
-					if (weight > max_weight)
-					{
-						max_weight = weight;
-						norm_chan_mat = chan_mat;
-					}
-
-					contrib += weight;
-				}
+		const Eigen::Matrix4f chan_mat = Eigen::Matrix4f::Map((float *)pchan->chan_mat);
+		SkinMatrix& skinmat = m_skinMatrices[i];
+		Eigen::Matrix4f::Map(&skinmat.m_position[0][0]) = post_mat * chan_mat * pre_mat;
+		for (unsigned short j = 0; j < 3; ++j) {
+			for (unsigned short k = 0; k < 3; ++k) {
+				skinmat.m_normal[j][k] = chan_mat(k, j);
 			}
+			skinmat.m_normal[j][3] = 0.0f;
 		}
+	}
 
-		// Update Vertex Normal
-		norm = norm_chan_mat.topLeftCorner<3, 3>() * normorg;
-
-		co.noalias() += vec / contrib;
-		co[3] = 1.0f; // Make sure we have a 1 for the w component!
-
-		co = post_mat * co;
-
-		m_transverts[i][0] = co[0];
-		m_transverts[i][1] = co[1];
-		m_transverts[i][2] = co[2];
+	const unsigned int totvert = m_bmesh->totvert;
+	if (totvert >= skinParallelThreshold) {
+		BLI_task_parallel_range(0, (totvert + skinTaskChunkSize - 1) / skinTaskChunkSize, this, SkinVertsTask, true);
+	}
+	else {
+		SkinVerts(0, totvert);
 	}
+
 	m_copyNormals = true;
 }
 
@@ -46,6 +46,8 @@
 
 #include "RAS_Deformer.h"
 
+#include <vector>
+
 struct Object;
 struct bPoseChannel;
 class RAS_MeshObject;
@@ -97,6 +99,29 @@ public:
 	}
 
 protected:
+	/// Maximum number of bone influences per vertex used by BGEDeformVerts.
+	static const unsigned int MAX_SKIN_INFLUENCES = 4;
+
+	/// Precompiled skinning influences of a vertex.
+	struct SkinVertex
+	{
+		/// Deform group indices of the influences sorted by decreasing weight.
+		unsigned short m_groups[MAX_SKIN_INFLUENCES];
+		/// Normalized weights of the influences.
+		float m_weights[MAX_SKIN_INFLUENCES];
+		/// Number of influences, a vertex without influence is not deformed.
+		unsigned int m_numInfluences;
+	};
+
+	/// Skinning matrices of a deform group, stored by columns.
+	struct SkinMatrix
+	{
+		/// Deformation of the vertex position in the mesh space.
+		float m_position[4][4];
+		/// Rotation of the vertex normal.
+		float m_normal[3][4];
+	};
+
 	BL_ArmatureObject *m_armobj; // Our parent object
 	float m_time;
 	double m_lastArmaUpdate;
@@ -107,9 +132,18 @@ protected:
 	bool m_copyNormals; // dirty flag so we know if Apply() needs to copy normal information (used for BGEDeformVerts())
 	bPoseChannel **m_dfnrToPC;
 	short m_deformflags;
+	/// Influences of each vertex, built with m_dfnrToPC.
+	std::vector<SkinVertex> m_skinVerts;
+	/// Matrices of each deform group for the current pose.
+	std::vector<SkinMatrix> m_skinMatrices;
 
 	void BlenderDeformVerts();
 	void BGEDeformVerts();
+	/// Compile the influences of each vertex from the deform weights.
+	void BuildSkinVerts(int defbase_tot);
+	/// Deform the positions and normals of a range of vertices.
+	void SkinVerts(unsigned int start, unsigned int end);
+	static void SkinVertsTask(void *userdata, const int iter);
 
 	void UpdateTransverts();
 };
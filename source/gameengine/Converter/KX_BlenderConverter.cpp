@@ -43,6 +43,7 @@
 #include "KX_PythonInit.h" // So we can handle adding new text datablocks for Python to import
 #include "KX_LibLoadStatus.h"
 #include "KX_BlenderScalarInterpolator.h"
+#include "BL_ActionData.h"
 #include "KX_BlenderConverter.h"
 #include "KX_BlenderSceneConverter.h"
 #include "BL_BlenderDataConversion.h"
@@ -82,6 +83,7 @@ extern "C" {
 }
 
 #include "BLI_task.h"
+#include "PIL_time.h"
 #include "CM_Message.h"
 
 KX_BlenderConverter::SceneSlot::SceneSlot() = default;
@@ -98,6 +100,9 @@ void KX_BlenderConverter::SceneSlot::Merge(KX_BlenderConverter::SceneSlot& other
 	m_interpolators.insert(m_interpolators.begin(),
 						   std::make_move_iterator(other.m_interpolators.begin()),
 						   std::make_move_iterator(other.m_interpolators.end()));
+	m_actionData.insert(m_actionData.begin(),
+						std::make_move_iterator(other.m_actionData.begin()),
+						std::make_move_iterator(other.m_actionData.end()));
 	m_materials.insert(m_materials.begin(),
 						   std::make_move_iterator(other.m_materials.begin()),
 						   std::make_move_iterator(other.m_materials.end()));
@@ -105,6 +110,7 @@ void KX_BlenderConverter::SceneSlot::Merge(KX_BlenderConverter::SceneSlot& other
 						 std::make_move_iterator(other.m_meshobjects.begin()),
 						 std::make_move_iterator(other.m_meshobjects.end()));
 	m_actionToInterp.insert(other.m_actionToInterp.begin(), other.m_actionToInterp.end());
+	m_actionToData.insert(other.m_actionToData.begin(), other.m_actionToData.end());
 }
 
 void KX_BlenderConverter::SceneSlot::Merge(const KX_BlenderSceneConverter& converter)
@@ -118,7 +124,8 @@ void KX_BlenderConverter::SceneSlot::Merge(const KX_BlenderSceneConverter& conve
 }
 
 KX_BlenderConverter::KX_BlenderConverter(Main *maggie, KX_KetsjiEngine *engine)
-	:m_maggie(maggie),
+	:m_mergeTimeBudget(0.0),
+	m_maggie(maggie),
 	m_ketsjiEngine(engine),
 	m_alwaysUseExpandFraming(false)
 {
@@ -227,7 +234,10 @@ void KX_BlenderConverter::ConvertScene(KX_Scene *destinationscene, RAS_Rasterize
 		m_alwaysUseExpandFraming,
 		libloading);
 
+	// The scenes can be converted concurrently.
+	m_threadinfo.m_sceneSlotsMutex.Lock();
 	m_sceneSlots.emplace(destinationscene, sceneConverter);
+	m_threadinfo.m_sceneSlotsMutex.Unlock();
 }
 
 /** This function removes all entities stored in the converter for that scene
@@ -252,7 +262,9 @@ void KX_BlenderConverter::RemoveScene(KX_Scene *scene)
 	scene->Release();
 
 	// delete the entities of this scene
+	m_threadinfo.m_sceneSlotsMutex.Lock();
 	m_sceneSlots.erase(scene);
+	m_threadinfo.m_sceneSlotsMutex.Unlock();
 }
 
 void KX_BlenderConverter::SetAlwaysUseExpandFraming(bool to_what)
@@ -262,14 +274,38 @@ void KX_BlenderConverter::SetAlwaysUseExpandFraming(bool to_what)
 
 void KX_BlenderConverter::RegisterInterpolatorList(KX_Scene *scene, BL_InterpolatorList *interpolator, bAction *for_act)
 {
+	m_threadinfo.m_sceneSlotsMutex.Lock();
 	SceneSlot& sceneSlot = m_sceneSlots[scene];
 	sceneSlot.m_interpolators.emplace_back(interpolator);
 	sceneSlot.m_actionToInterp[for_act] = interpolator;
+	m_threadinfo.m_sceneSlotsMutex.Unlock();
 }
 
 BL_InterpolatorList *KX_BlenderConverter::FindInterpolatorList(KX_Scene *scene, bAction *for_act)
 {
-	return m_sceneSlots[scene].m_actionToInterp[for_act];
+	m_threadinfo.m_sceneSlotsMutex.Lock();
+	BL_InterpolatorList *interpolator = m_sceneSlots[scene].m_actionToInterp[for_act];
+	m_threadinfo.m_sceneSlotsMutex.Unlock();
+
+	return interpolator;
+}
+
+void KX_BlenderConverter::RegisterActionData(KX_Scene *scene, BL_ActionData *data, bAction *for_act)
+{
+	m_threadinfo.m_sceneSlotsMutex.Lock();
+	SceneSlot& sceneSlot = m_sceneSlots[scene];
+	sceneSlot.m_actionData.emplace_back(data);
+	sceneSlot.m_actionToData[for_act] = data;
+	m_threadinfo.m_sceneSlotsMutex.Unlock();
+}
+
+BL_ActionData *KX_BlenderConverter::FindActionData(KX_Scene *scene, bAction *for_act)
+{
+	m_threadinfo.m_sceneSlotsMutex.Lock();
+	BL_ActionData *data = m_sceneSlots[scene].m_actionToData[for_act];
+	m_threadinfo.m_sceneSlotsMutex.Unlock();
+
+	return data;
 }
 
 Main *KX_BlenderConverter::CreateMainDynamic(const std::string& path)
@@ -297,32 +333,45 @@ Main *KX_BlenderConverter::GetMainDynamicPath(const std::string& path) const
 	return nullptr;
 }
 
-void KX_BlenderConverter::MergeAsyncLoads()
+bool KX_BlenderConverter::MergeAsyncScene()
 {
-	std::vector<KX_Scene *> *merge_scenes;
-
-	std::vector<KX_LibLoadStatus *>::iterator mit;
-	std::vector<KX_Scene *>::iterator sit;
-
 	m_threadinfo.m_mutex.Lock();
+	if (m_mergequeue.empty()) {
+		m_threadinfo.m_mutex.Unlock();
+		return false;
+	}
 
-	for (mit = m_mergequeue.begin(); mit != m_mergequeue.end(); ++mit) {
-		merge_scenes = (std::vector<KX_Scene *> *)(*mit)->GetData();
+	const MergeItem item = m_mergequeue.front();
+	m_mergequeue.pop_front();
+	// The conversion tasks can queue their scenes during the merge.
+	m_threadinfo.m_mutex.Unlock();
 
-		for (sit = merge_scenes->begin(); sit != merge_scenes->end(); ++sit) {
-			(*mit)->GetMergeScene()->MergeScene(*sit);
-			delete (*sit);
-		}
+	KX_LibLoadStatus *status = item.m_status;
+	if (item.m_scene) {
+		status->GetMergeScene()->MergeScene(item.m_scene);
+		delete item.m_scene;
+	}
 
-		delete merge_scenes;
-		(*mit)->SetData(nullptr);
+	if (status->AddMergedScene()) {
+		// All the scenes of the library are converted and merged.
+		delete (std::vector<Scene *> *)status->GetData();
+		status->SetData(nullptr);
 
-		(*mit)->Finish();
+		status->Finish();
 	}
 
-	m_mergequeue.clear();
+	return true;
+}
 
-	m_threadinfo.m_mutex.Unlock();
+void KX_BlenderConverter::MergeAsyncLoads()
+{
+	const double starttime = PIL_check_seconds_timer();
+
+	while (MergeAsyncScene()) {
+		if (m_mergeTimeBudget > 0.0 && (PIL_check_seconds_timer() - starttime) > m_mergeTimeBudget) {
+			break;
+		}
+	}
 }
 
 void KX_BlenderConverter::FinalizeAsyncLoads()
@@ -330,37 +379,39 @@ void KX_BlenderConverter::FinalizeAsyncLoads()
 	// Finish all loading libraries.
 	BLI_task_pool_work_and_wait(m_threadinfo.m_pool);
 	// Merge all libraries data in the current scene, to avoid memory leak of unmerged scenes.
-	MergeAsyncLoads();
+	while (MergeAsyncScene()) {
+	}
 }
 
-void KX_BlenderConverter::AddScenesToMergeQueue(KX_LibLoadStatus *status)
+void KX_BlenderConverter::AddSceneToMergeQueue(KX_LibLoadStatus *status, KX_Scene *scene)
 {
 	m_threadinfo.m_mutex.Lock();
-	m_mergequeue.push_back(status);
+	m_mergequeue.push_back({status, scene});
 	m_threadinfo.m_mutex.Unlock();
 }
 
-static void async_convert(TaskPool *pool, void *ptr, int UNUSED(threadid))
+double KX_BlenderConverter::GetMergeTimeBudget() const
 {
-	KX_Scene *new_scene = nullptr;
-	KX_LibLoadStatus *status = (KX_LibLoadStatus *)ptr;
-	std::vector<Scene *> *scenes = (std::vector<Scene *> *)status->GetData();
-	std::vector<KX_Scene *> *merge_scenes = new std::vector<KX_Scene *>(); // Deleted in MergeAsyncLoads
+	return m_mergeTimeBudget;
+}
 
-	for (unsigned int i = 0; i < scenes->size(); ++i) {
-		new_scene = status->GetEngine()->CreateScene((*scenes)[i], true);
+void KX_BlenderConverter::SetMergeTimeBudget(double budget)
+{
+	m_mergeTimeBudget = budget;
+}
 
-		if (new_scene) {
-			merge_scenes->push_back(new_scene);
-		}
+/// Convert a range of the scenes of a library, every scene is converted in its own task.
+static void async_convert(TaskPool *pool, void *ptr, int start, int stop, int UNUSED(threadid))
+{
+	KX_LibLoadStatus *status = (KX_LibLoadStatus *)ptr;
+	const std::vector<Scene *>& scenes = *(std::vector<Scene *> *)status->GetData();
 
-		status->AddProgress((1.0f / scenes->size()) * 0.9f); // We'll call conversion 90% and merging 10% for now
+	for (int i = start; i < stop; ++i) {
+		KX_Scene *new_scene = status->GetEngine()->CreateScene(scenes[i], true);
+		status->AddConvertedScene();
+		// The scene is merged as soon as possible without waiting for the other scenes.
+		status->GetConverter()->AddSceneToMergeQueue(status, new_scene);
 	}
-
-	delete scenes;
-	status->SetData(merge_scenes);
-
-	status->GetConverter()->AddScenesToMergeQueue(status);
 }
 
 KX_LibLoadStatus *KX_BlenderConverter::LinkBlendFileMemory(void *data, int length, const char *path, char *group, KX_Scene *scene_merge, char **err_str, short options)
@@ -470,7 +521,9 @@ KX_LibLoadStatus *KX_BlenderConverter::LinkBlendFile(BlendHandle *bpy_openlib, c
 			RAS_MeshObject *meshobj = BL_ConvertMesh((Mesh *)mesh, nullptr, scene_merge, sceneConverter, false); // For now only use the libloading option for scenes, which need to handle materials/shaders
 			scene_merge->GetLogicManager()->RegisterMeshName(meshobj->GetName(), meshobj);
 		}
+		m_threadinfo.m_sceneSlotsMutex.Lock();
 		m_sceneSlots[scene_merge].Merge(sceneConverter);
+		m_threadinfo.m_sceneSlotsMutex.Unlock();
 	}
 	else if (idcode == ID_AC) {
 		// Convert all actions
@@ -486,7 +539,7 @@ KX_LibLoadStatus *KX_BlenderConverter::LinkBlendFile(BlendHandle *bpy_openlib, c
 	else if (idcode == ID_SCE) {
 		// Merge all new linked in scene into the existing one
 		ID *scene;
-		// scenes gets deleted by the thread when it's done using it (look in async_convert())
+		// scenes gets deleted when all the scenes are merged (look in MergeAsyncScene())
 		std::vector<Scene *> *scenes = (options & LIB_LOAD_ASYNC) ? new std::vector<Scene *>() : nullptr;
 
 		for (scene = (ID *)main_newlib->scene.first; scene; scene = (ID *)scene->next) {
@@ -509,7 +562,15 @@ KX_LibLoadStatus *KX_BlenderConverter::LinkBlendFile(BlendHandle *bpy_openlib, c
 
 		if (options & LIB_LOAD_ASYNC) {
 			status->SetData(scenes);
-			BLI_task_pool_push(m_threadinfo.m_pool, async_convert, (void *)status, false, TASK_PRIORITY_LOW);
+			status->SetNumScenes(scenes->size());
+			if (scenes->empty()) {
+				// Nothing to convert, the status is finished by the next merge.
+				AddSceneToMergeQueue(status, nullptr);
+			}
+			else {
+				// Convert the scenes in parallel.
+				BLI_task_pool_push_range(m_threadinfo.m_pool, async_convert, (void *)status, 0, scenes->size(), 1, TASK_PRIORITY_LOW);
+			}
 		}
 
 #ifdef WITH_PYTHON
@@ -581,7 +642,9 @@ bool KX_BlenderConverter::FreeBlendFile(Main *maggie)
 		KX_Scene *scene = scenes->GetValue(sce_idx);
 		if (IS_TAGGED(scene->GetBlenderScene())) {
 			m_ketsjiEngine->RemoveScene(scene->GetName());
+			m_threadinfo.m_sceneSlotsMutex.Lock();
 			m_sceneSlots.erase(scene);
+			m_threadinfo.m_sceneSlotsMutex.Unlock();
 			sce_idx--;
 			numScenes--;
 		}
@@ -669,6 +732,8 @@ bool KX_BlenderConverter::FreeBlendFile(Main *maggie)
 		}
 	}
 
+	// Scenes of other libraries can be converted meanwhile.
+	m_threadinfo.m_sceneSlotsMutex.Lock();
 	for (std::map<KX_Scene *, SceneSlot>::iterator sit = m_sceneSlots.begin(), send = m_sceneSlots.end(); sit != send; ++sit) {
 		KX_Scene *scene = sit->first;
 		SceneSlot& sceneSlot = sit->second;
@@ -697,6 +762,17 @@ bool KX_BlenderConverter::FreeBlendFile(Main *maggie)
 			}
 		}
 
+		for (UniquePtrList<BL_ActionData>::iterator it = sceneSlot.m_actionData.begin(); it != sceneSlot.m_actionData.end(); ) {
+			bAction *action = (*it)->GetAction();
+			if (IS_TAGGED(action)) {
+				sceneSlot.m_actionToData.erase(action);
+				it = sceneSlot.m_actionData.erase(it);
+			}
+			else {
+				++it;
+			}
+		}
+
 		for (UniquePtrList<RAS_MeshObject>::iterator it =  sceneSlot.m_meshobjects.begin(); it !=  sceneSlot.m_meshobjects.end(); ) {
 			RAS_MeshObject *mesh = (*it).get();
 			if (IS_TAGGED(mesh->GetMesh())) {
@@ -710,6 +786,7 @@ bool KX_BlenderConverter::FreeBlendFile(Main *maggie)
 			}
 		}
 	}
+	m_threadinfo.m_sceneSlotsMutex.Unlock();
 
 #ifdef WITH_PYTHON
 	/* make sure this maggie is removed from the import list if it's there
@@ -732,7 +809,10 @@ bool KX_BlenderConverter::FreeBlendFile(const std::string& path)
 
 void KX_BlenderConverter::MergeScene(KX_Scene *to, KX_Scene *from)
 {
+	// The slot of the merged scene is not used by the conversion tasks anymore.
+	m_threadinfo.m_sceneSlotsMutex.Lock();
 	SceneSlot& sceneSlotFrom = m_sceneSlots[from];
+	m_threadinfo.m_sceneSlotsMutex.Unlock();
 
 	for (std::unique_ptr<KX_BlenderMaterial>& mat : sceneSlotFrom.m_materials) {
 		mat->ReplaceScene(to);
@@ -742,8 +822,10 @@ void KX_BlenderConverter::MergeScene(KX_Scene *to, KX_Scene *from)
 		meshobj->GenerateAttribLayers();
 	}
 
+	m_threadinfo.m_sceneSlotsMutex.Lock();
 	m_sceneSlots[to].Merge(sceneSlotFrom);
 	m_sceneSlots.erase(from);
+	m_threadinfo.m_sceneSlotsMutex.Unlock();
 
 	// Delete from scene's world info.
 	delete from->GetWorldInfo();
@@ -830,7 +912,9 @@ RAS_MeshObject *KX_BlenderConverter::ConvertMeshSpecial(KX_Scene *kx_scene, Main
 	RAS_MeshObject *meshobj = BL_ConvertMesh((Mesh *)me, nullptr, kx_scene, sceneConverter, false);
 	kx_scene->GetLogicManager()->RegisterMeshName(meshobj->GetName(), meshobj);
 
+	m_threadinfo.m_sceneSlotsMutex.Lock();
 	m_sceneSlots[kx_scene].Merge(sceneConverter);
+	m_threadinfo.m_sceneSlotsMutex.Unlock();
 
 	return meshobj;
 }
@@ -844,6 +928,7 @@ void KX_BlenderConverter::PrintStats()
 	unsigned int nummesh = 0;
 	unsigned int numinter = 0;
 
+	m_threadinfo.m_sceneSlotsMutex.Lock();
 	for (const auto& pair : m_sceneSlots) {
 		KX_Scene *scene = pair.first;
 		const SceneSlot& sceneSlot = pair.second;
@@ -858,8 +943,11 @@ void KX_BlenderConverter::PrintStats()
 		CM_Message("\t\t interpolators: " << sceneSlot.m_interpolators.size());
 	}
 
+	const unsigned int numscenes = m_sceneSlots.size();
+	m_threadinfo.m_sceneSlotsMutex.Unlock();
+
 	CM_Message(std::endl << "Total:");
-	CM_Message("\t scenes: " << m_sceneSlots.size());
+	CM_Message("\t scenes: " << numscenes);
 	CM_Message("\t materials: " << nummat);
 	CM_Message("\t meshes: " << nummesh);
 	CM_Message("\t interpolators: " << numinter);
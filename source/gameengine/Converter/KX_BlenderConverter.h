@@ -34,6 +34,7 @@
 
 #include <map>
 #include <vector>
+#include <deque>
 
 #ifdef _MSC_VER // MSVC doesn't support incomplete type in std::unique_ptr.
 #  include "KX_BlenderMaterial.h"
@@ -50,6 +51,7 @@ class KX_KetsjiEngine;
 class KX_LibLoadStatus;
 class KX_BlenderMaterial;
 class BL_InterpolatorList;
+class BL_ActionData;
 class SCA_IActuator;
 class SCA_IController;
 class RAS_MeshObject;
@@ -76,8 +78,10 @@ private:
 		UniquePtrList<KX_BlenderMaterial> m_materials;
 		UniquePtrList<RAS_MeshObject> m_meshobjects;
 		UniquePtrList<BL_InterpolatorList> m_interpolators;
+		UniquePtrList<BL_ActionData> m_actionData;
 
 		std::map<bAction *, BL_InterpolatorList *> m_actionToInterp;
+		std::map<bAction *, BL_ActionData *> m_actionToData;
 
 		SceneSlot();
 		SceneSlot(const KX_BlenderSceneConverter& converter);
@@ -91,12 +95,24 @@ private:
 
 	struct ThreadInfo {
 		TaskPool *m_pool;
+		/// Mutex of the merge queue.
 		CM_ThreadMutex m_mutex;
+		/// Mutex of the scene slots, filled by the conversion tasks.
+		CM_ThreadMutex m_sceneSlotsMutex;
 	} m_threadinfo;
 
+	/// A scene converted asynchronously waiting to be merged.
+	struct MergeItem {
+		KX_LibLoadStatus *m_status;
+		/// The converted scene, nullptr if the conversion failed.
+		KX_Scene *m_scene;
+	};
+
 	// Saved KX_LibLoadStatus objects
 	std::map<std::string, KX_LibLoadStatus *> m_status_map;
-	std::vector<KX_LibLoadStatus *> m_mergequeue;
+	std::deque<MergeItem> m_mergequeue;
+	/// Time in seconds spent to merge the converted scenes per logic frame, 0 for no limit.
+	double m_mergeTimeBudget;
 
 	Main *m_maggie;
 	std::vector<Main *> m_DynamicMaggie;
@@ -104,6 +120,9 @@ private:
 	KX_KetsjiEngine *m_ketsjiEngine;
 	bool m_alwaysUseExpandFraming;
 
+	/// Merge the first scene of the merge queue, return false if the queue is empty.
+	bool MergeAsyncScene();
+
 public:
 	KX_BlenderConverter(Main *maggie, KX_KetsjiEngine *engine);
 	virtual ~KX_BlenderConverter();
@@ -120,6 +139,9 @@ public:
 	void RegisterInterpolatorList(KX_Scene *scene, BL_InterpolatorList *interpolator, bAction *for_act);
 	BL_InterpolatorList *FindInterpolatorList(KX_Scene *scene, bAction *for_act);
 
+	void RegisterActionData(KX_Scene *scene, BL_ActionData *data, bAction *for_act);
+	BL_ActionData *FindActionData(KX_Scene *scene, bAction *for_act);
+
 	Scene *GetBlenderSceneForName(const std::string& name);
 	CListValue<CStringValue> *GetInactiveSceneNames();
 
@@ -138,9 +160,17 @@ public:
 
 	void MergeScene(KX_Scene *to, KX_Scene *from);
 
+	/** Merge the scenes converted asynchronously, the scenes are merged one by one
+	 * until the merge time budget is exceeded and the others are merged in the next frames.
+	 */
 	void MergeAsyncLoads();
+	/// Wait for all the conversions and merge all the converted scenes.
 	void FinalizeAsyncLoads();
-	void AddScenesToMergeQueue(KX_LibLoadStatus *status);
+	/// Add a converted scene to merge, called by the conversion tasks.
+	void AddSceneToMergeQueue(KX_LibLoadStatus *status, KX_Scene *scene);
+
+	double GetMergeTimeBudget() const;
+	void SetMergeTimeBudget(double budget);
 
 	void PrintStats();
 
@@ -37,6 +37,11 @@ KX_LibLoadStatus::KX_LibLoadStatus(class KX_BlenderConverter* kx_converter,
 			m_data(nullptr),
 			m_libname(path),
 			m_progress(0.0f),
+			m_numScenes(0),
+			m_convertedScenes(0),
+			m_mergedScenes(0),
+			m_convertProgress(0.0f),
+			m_mergeProgress(0.0f),
 			m_finished(false)
 #ifdef WITH_PYTHON
 			,
@@ -51,6 +56,8 @@ void KX_LibLoadStatus::Finish()
 {
 	m_finished = true;
 	m_progress = 1.f;
+	m_convertProgress = 1.f;
+	m_mergeProgress = 1.f;
 	m_endtime = PIL_check_seconds_timer();
 
 	RunFinishCallback();
@@ -136,6 +143,37 @@ void KX_LibLoadStatus::AddProgress(float progress)
 	RunProgressCallback();
 }
 
+void KX_LibLoadStatus::SetNumScenes(unsigned int num)
+{
+	m_numScenes = num;
+}
+
+void KX_LibLoadStatus::AddConvertedScene()
+{
+	m_progressLock.Lock();
+	m_convertProgress = (float)++m_convertedScenes / m_numScenes;
+	// We'll call conversion 90% and merging 10% for now.
+	m_progress = m_convertProgress * 0.9f + m_mergeProgress * 0.1f;
+	m_progressLock.Unlock();
+
+	RunProgressCallback();
+}
+
+bool KX_LibLoadStatus::AddMergedScene()
+{
+	m_progressLock.Lock();
+	++m_mergedScenes;
+	// A library without scenes is merged once.
+	const bool merged = (m_mergedScenes >= m_numScenes);
+	m_mergeProgress = merged ? 1.0f : (float)m_mergedScenes / m_numScenes;
+	m_progress = m_convertProgress * 0.9f + m_mergeProgress * 0.1f;
+	m_progressLock.Unlock();
+
+	RunProgressCallback();
+
+	return merged;
+}
+
 #ifdef WITH_PYTHON
 
 PyMethodDef KX_LibLoadStatus::Methods[] = 
@@ -147,6 +185,8 @@ PyAttributeDef KX_LibLoadStatus::Attributes[] = {
 	KX_PYATTRIBUTE_RW_FUNCTION("onFinish", KX_LibLoadStatus, pyattr_get_onfinish, pyattr_set_onfinish),
 	// KX_PYATTRIBUTE_RW_FUNCTION("onProgress", KX_LibLoadStatus, pyattr_get_onprogress, pyattr_set_onprogress),
 	KX_PYATTRIBUTE_FLOAT_RO("progress", KX_LibLoadStatus, m_progress),
+	KX_PYATTRIBUTE_FLOAT_RO("convertProgress", KX_LibLoadStatus, m_convertProgress),
+	KX_PYATTRIBUTE_FLOAT_RO("mergeProgress", KX_LibLoadStatus, m_mergeProgress),
 	KX_PYATTRIBUTE_STRING_RO("libraryName", KX_LibLoadStatus, m_libname),
 	KX_PYATTRIBUTE_RO_FUNCTION("timeTaken", KX_LibLoadStatus, pyattr_get_timetaken),
 	KX_PYATTRIBUTE_BOOL_RO("finished", KX_LibLoadStatus, m_finished),
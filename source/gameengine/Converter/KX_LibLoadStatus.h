@@ -28,6 +28,7 @@
 #define __KX_LIBLOADSTATUS_H__
 
 #include "EXP_PyObjectPlus.h"
+#include "CM_Thread.h"
 
 class KX_LibLoadStatus : public PyObjectPlus
 {
@@ -40,6 +41,15 @@ private:
 	std::string						m_libname;
 
 	float	m_progress;
+	/// Number of scenes to convert and merge.
+	unsigned int m_numScenes;
+	unsigned int m_convertedScenes;
+	unsigned int m_mergedScenes;
+	/// Progress of the conversion and merge stages.
+	float	m_convertProgress;
+	float	m_mergeProgress;
+	/// Lock of the progress, the scenes are converted in parallel.
+	CM_ThreadSpinLock m_progressLock;
 	double	m_starttime;
 	double	m_endtime;
 
@@ -77,6 +87,12 @@ public:
 	float GetProgress();
 	void AddProgress(float progress);
 
+	void SetNumScenes(unsigned int num);
+	/// Called by the conversion tasks when a scene is converted.
+	void AddConvertedScene();
+	/// Called when a converted scene is merged, return true if all the scenes are merged.
+	bool AddMergedScene();
+
 #ifdef WITH_PYTHON
 	static PyObject*	pyattr_get_onfinish(PyObjectPlus *self_v, const KX_PYATTRIBUTE_DEF *attrdef);
 	static int			pyattr_set_onfinish(PyObjectPlus *self_v, const KX_PYATTRIBUTE_DEF *attrdef, PyObject *value);
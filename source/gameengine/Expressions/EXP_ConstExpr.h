@@ -33,6 +33,11 @@ public:
 	virtual double GetNumber();
 	virtual CValue *Calculate();
 
+	inline CValue *GetValue() const
+	{
+		return m_value;
+	}
+
 private:
 	CValue *m_value;
 };
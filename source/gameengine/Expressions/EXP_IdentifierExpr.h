@@ -46,6 +46,16 @@ public:
 
 	virtual CValue *Calculate();
 	virtual unsigned char GetExpressionID();
+
+	inline CValue *GetContext() const
+	{
+		return m_idContext;
+	}
+
+	inline const std::string& GetIdentifier() const
+	{
+		return m_identifier;
+	}
 };
 
 #endif  // __EXP_IDENTIFIEREXPR_H__
@@ -35,6 +35,23 @@ public:
 
 	virtual unsigned char GetExpressionID();
 	virtual CValue *Calculate();
+
+	inline CExpression *GetGuard() const
+	{
+		return m_guard;
+	}
+
+	/// Return the expression evaluated when the guard is true.
+	inline CExpression *GetTrueExpression() const
+	{
+		return m_e1;
+	}
+
+	/// Return the expression evaluated when the guard is false.
+	inline CExpression *GetFalseExpression() const
+	{
+		return m_e2;
+	}
 };
 
 #endif  // __EXP_IFEXPR_H__
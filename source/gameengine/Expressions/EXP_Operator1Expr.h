@@ -31,6 +31,16 @@ public:
 	virtual unsigned char GetExpressionID();
 	virtual CValue *Calculate();
 
+	inline VALUE_OPERATOR GetOperator() const
+	{
+		return m_op;
+	}
+
+	inline CExpression *GetOperand() const
+	{
+		return m_lhs;
+	}
+
 private:
 	VALUE_OPERATOR m_op;
 	CExpression *m_lhs;
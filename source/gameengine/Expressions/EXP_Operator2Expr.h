@@ -32,6 +32,21 @@ public:
 	virtual unsigned char GetExpressionID();
 	virtual CValue *Calculate();
 
+	inline VALUE_OPERATOR GetOperator() const
+	{
+		return m_op;
+	}
+
+	inline CExpression *GetLeftOperand() const
+	{
+		return m_lhs;
+	}
+
+	inline CExpression *GetRightOperand() const
+	{
+		return m_rhs;
+	}
+
 protected:
 	CExpression *m_rhs;
 	CExpression *m_lhs;
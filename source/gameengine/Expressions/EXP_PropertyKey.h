@@ -0,0 +1,87 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file EXP_PropertyKey.h
+ *  \ingroup expressions
+ */
+
+#ifndef __EXP_PROPERTYKEY_H__
+#define __EXP_PROPERTYKEY_H__
+
+#include <string>
+
+/** \brief Interned name of a property.
+ * All the property names are stored once in a global table and identified by an
+ * integer, comparing or hashing two keys doesn't touch the names. Code looking up
+ * the same property frequently should construct its key once and keep it.
+ * Every thread caches the names it already used, the global table is only locked
+ * for a name new to the thread. The table never shrinks, it grows with the number
+ * of distinct names ever used.
+ */
+class CPropertyKey
+{
+private:
+	/// Index of the name in the global table, INVALID_ID for a key without name.
+	unsigned int m_id;
+
+	static const unsigned int INVALID_ID = (unsigned int)-1;
+
+public:
+	/// Construct an invalid key, not equal to any property name.
+	CPropertyKey()
+		:m_id(INVALID_ID)
+	{
+	}
+
+	/// Construct the key of a name, the name is added to the global table if needed.
+	explicit CPropertyKey(const std::string& name);
+
+	/** Find the key of an already used name without adding it to the global table.
+	 * \return An invalid key if the name was never used, no property can be named this way.
+	 */
+	static CPropertyKey Find(const std::string& name);
+
+	inline bool IsValid() const
+	{
+		return (m_id != INVALID_ID);
+	}
+
+	inline unsigned int GetId() const
+	{
+		return m_id;
+	}
+
+	/// Return the name of the key, the key must be valid.
+	const std::string& GetName() const;
+
+	inline bool operator==(const CPropertyKey& other) const
+	{
+		return (m_id == other.m_id);
+	}
+
+	inline bool operator!=(const CPropertyKey& other) const
+	{
+		return (m_id != other.m_id);
+	}
+};
+
+#endif  // __EXP_PROPERTYKEY_H__
@@ -0,0 +1,90 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file EXP_PropertyMap.h
+ *  \ingroup expressions
+ */
+
+#ifndef __EXP_PROPERTYMAP_H__
+#define __EXP_PROPERTYMAP_H__
+
+#include "EXP_PropertyKey.h"
+
+#include <vector>
+
+class CValue;
+
+/** \brief Properties of a value indexed by their interned key.
+ * The keys and values are stored in two dense arrays, an open addressing table with
+ * linear probing maps a key to its index in these arrays. Removing a property moves
+ * the last property in its place, the index of a property is not stable.
+ * The map doesn't manage the reference count of the values.
+ */
+class CPropertyMap
+{
+private:
+	std::vector<CPropertyKey> m_keys;
+	std::vector<CValue *> m_values;
+	/// Index in m_keys plus one of each slot, 0 for an empty slot. The size is a power of two.
+	std::vector<unsigned int> m_slots;
+
+	inline unsigned int GetHomeSlot(const CPropertyKey& key) const
+	{
+		return (key.GetId() * 2654435769u) & (m_slots.size() - 1);
+	}
+
+	/// Return the slot containing the key, or the empty slot where the key should be inserted.
+	unsigned int FindSlot(const CPropertyKey& key) const;
+	void Rehash(unsigned int numSlots);
+
+public:
+	CPropertyMap();
+	~CPropertyMap() = default;
+
+	inline unsigned int GetSize() const
+	{
+		return m_keys.size();
+	}
+
+	inline const CPropertyKey& GetKey(unsigned int index) const
+	{
+		return m_keys[index];
+	}
+
+	inline CValue *GetValue(unsigned int index) const
+	{
+		return m_values[index];
+	}
+
+	/// Return the value of a key, nullptr if the key is not in the map.
+	CValue *Get(const CPropertyKey& key) const;
+	/** Set the value of a key.
+	 * \return The previous value of the key or nullptr.
+	 */
+	CValue *Set(const CPropertyKey& key, CValue *value);
+	/** Remove a key from the map.
+	 * \return The removed value or nullptr if the key was not in the map.
+	 */
+	CValue *Remove(const CPropertyKey& key);
+};
+
+#endif  // __EXP_PROPERTYMAP_H__
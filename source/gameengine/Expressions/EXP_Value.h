@@ -25,7 +25,9 @@
 
 #include "CM_RefCount.h"
 
-#include <map> // Array functionality for the property list.
+#include "EXP_PropertyKey.h"
+
+#include <map>
 #include <vector>
 #include <string> // std::string class.
 
@@ -34,6 +36,8 @@
 #define trace(exp) ((void)nullptr)
 #endif
 
+class CPropertyMap;
+
 enum VALUE_OPERATOR {
 	VALUE_MOD_OPERATOR,         // %
 	VALUE_ADD_OPERATOR,         // +
@@ -126,16 +130,22 @@ public:
 	/// Set property <ioProperty>, overwrites and releases a previous property with the same name if needed.
 	virtual void SetProperty(const std::string& name, CValue *ioProperty);
 	virtual CValue *GetProperty(const std::string & inName);
+	/// Same as the functions using a name but without looking up the key of the name.
+	void SetProperty(const CPropertyKey& key, CValue *ioProperty);
+	CValue *GetProperty(const CPropertyKey& key);
 	/// Get text description of property with name <inName>, returns an empty string if there is no property named <inName>.
 	const std::string GetPropertyText(const std::string & inName);
 	float GetPropertyNumber(const std::string& inName, float defnumber);
 	/// Remove the property named <inName>, returns true if the property was succesfully removed, false if property was not found or could not be removed.
 	virtual bool RemoveProperty(const std::string& inName);
+	bool RemoveProperty(const CPropertyKey& key);
 	virtual std::vector<std::string>    GetPropertyNames();
 	/// Clear all properties.
 	virtual void ClearProperties();
+	/// Replace all properties by replicas of the properties of <other>.
+	void CopyProperties(CValue *other);
 
-	/// Get property number <inIndex>.
+	/// Get property number <inIndex>, the properties are not sorted.
 	virtual CValue *GetProperty(int inIndex);
 	/// Get the amount of properties assiocated with this value.
 	virtual int GetPropertyCount();
@@ -174,7 +184,7 @@ protected:
 
 private:
 	/// Properties for user/game etc.
-	std::map<std::string, CValue *> *m_pNamedPropertyArray;
+	CPropertyMap *m_pNamedPropertyArray;
 	bool m_error;
 };
 
@@ -0,0 +1,144 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file PropertyKey.cpp
+ *  \ingroup expressions
+ */
+
+#include "EXP_PropertyKey.h"
+
+#include "CM_Thread.h"
+
+#include "BLI_utildefines.h"
+
+#include <unordered_map>
+#include <deque>
+#include <vector>
+
+/** The global table of the property names.
+ * The table only grows: an id must stay valid as long as a key or a property uses it, and the
+ * keys are stored in static variables and in any object. Its size is bounded by the number of
+ * distinct names ever used: the names of the converted properties, of the logic bricks and of
+ * the properties set from python. Only scripts building new names in a loop make it grow during
+ * the game, each name costing a string and a map entry in the table and in the thread caches.
+ */
+struct PropertyKeyTable
+{
+	std::unordered_map<std::string, unsigned int> m_ids;
+	/// The names indexed by key id, a deque keeps the returned names references valid.
+	std::deque<std::string> m_names;
+	/// Names are added from the LibLoad conversion thread too.
+	CM_ThreadSpinLock m_mutex;
+};
+
+/** Per thread copy of the table entries already used by a thread, read without lock.
+ * The entries of the global table are never removed or moved, the copies stay valid.
+ */
+struct PropertyKeyCache
+{
+	std::unordered_map<std::string, unsigned int> m_ids;
+	/// Pointers to the names of the global table indexed by key id, nullptr if not cached.
+	std::vector<const std::string *> m_names;
+};
+
+/// Table created at its first use to be usable from the static keys construction.
+static PropertyKeyTable& getTable()
+{
+	static PropertyKeyTable table;
+	return table;
+}
+
+static thread_local PropertyKeyCache cache;
+
+CPropertyKey::CPropertyKey(const std::string& name)
+{
+	std::unordered_map<std::string, unsigned int>::const_iterator cacheit = cache.m_ids.find(name);
+	if (cacheit != cache.m_ids.end()) {
+		m_id = cacheit->second;
+		return;
+	}
+
+	PropertyKeyTable& table = getTable();
+
+	table.m_mutex.Lock();
+	std::unordered_map<std::string, unsigned int>::iterator it = table.m_ids.find(name);
+	if (it != table.m_ids.end()) {
+		m_id = it->second;
+	}
+	else {
+		m_id = table.m_names.size();
+		table.m_ids.emplace(name, m_id);
+		table.m_names.push_back(name);
+	}
+	table.m_mutex.Unlock();
+
+	cache.m_ids.emplace(name, m_id);
+}
+
+CPropertyKey CPropertyKey::Find(const std::string& name)
+{
+	CPropertyKey key;
+
+	std::unordered_map<std::string, unsigned int>::const_iterator cacheit = cache.m_ids.find(name);
+	if (cacheit != cache.m_ids.end()) {
+		key.m_id = cacheit->second;
+		return key;
+	}
+
+	PropertyKeyTable& table = getTable();
+
+	table.m_mutex.Lock();
+	std::unordered_map<std::string, unsigned int>::iterator it = table.m_ids.find(name);
+	if (it != table.m_ids.end()) {
+		key.m_id = it->second;
+	}
+	table.m_mutex.Unlock();
+
+	// The unknown names are not cached, they could be added later by an other thread.
+	if (key.IsValid()) {
+		cache.m_ids.emplace(name, key.m_id);
+	}
+
+	return key;
+}
+
+const std::string& CPropertyKey::GetName() const
+{
+	BLI_assert(IsValid());
+
+	if (m_id < cache.m_names.size() && cache.m_names[m_id]) {
+		return *cache.m_names[m_id];
+	}
+
+	PropertyKeyTable& table = getTable();
+
+	table.m_mutex.Lock();
+	const std::string& name = table.m_names[m_id];
+	table.m_mutex.Unlock();
+
+	if (m_id >= cache.m_names.size()) {
+		cache.m_names.resize(m_id + 1, nullptr);
+	}
+	cache.m_names[m_id] = &name;
+
+	return name;
+}
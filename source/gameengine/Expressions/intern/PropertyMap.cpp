@@ -0,0 +1,131 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file PropertyMap.cpp
+ *  \ingroup expressions
+ */
+
+#include "EXP_PropertyMap.h"
+
+/// Initial number of slots, must be a power of two.
+static const unsigned int propertyMapMinSlots = 8;
+
+CPropertyMap::CPropertyMap()
+	:m_slots(propertyMapMinSlots, 0)
+{
+}
+
+unsigned int CPropertyMap::FindSlot(const CPropertyKey& key) const
+{
+	const unsigned int mask = m_slots.size() - 1;
+	unsigned int slot = GetHomeSlot(key);
+	// The table is never full, the loop always finds an empty slot.
+	while (m_slots[slot] != 0 && m_keys[m_slots[slot] - 1] != key) {
+		slot = (slot + 1) & mask;
+	}
+
+	return slot;
+}
+
+void CPropertyMap::Rehash(unsigned int numSlots)
+{
+	m_slots.assign(numSlots, 0);
+
+	const unsigned int mask = numSlots - 1;
+	for (unsigned int i = 0, size = m_keys.size(); i < size; ++i) {
+		unsigned int slot = GetHomeSlot(m_keys[i]);
+		while (m_slots[slot] != 0) {
+			slot = (slot + 1) & mask;
+		}
+		m_slots[slot] = i + 1;
+	}
+}
+
+CValue *CPropertyMap::Get(const CPropertyKey& key) const
+{
+	const unsigned int index = m_slots[FindSlot(key)];
+	return (index != 0) ? m_values[index - 1] : nullptr;
+}
+
+CValue *CPropertyMap::Set(const CPropertyKey& key, CValue *value)
+{
+	unsigned int slot = FindSlot(key);
+	const unsigned int index = m_slots[slot];
+	if (index != 0) {
+		CValue *oldvalue = m_values[index - 1];
+		m_values[index - 1] = value;
+		return oldvalue;
+	}
+
+	// Keep the load factor under one half.
+	if ((m_keys.size() + 1) * 2 > m_slots.size()) {
+		Rehash(m_slots.size() * 2);
+		slot = FindSlot(key);
+	}
+
+	m_keys.push_back(key);
+	m_values.push_back(value);
+	m_slots[slot] = m_keys.size();
+
+	return nullptr;
+}
+
+CValue *CPropertyMap::Remove(const CPropertyKey& key)
+{
+	unsigned int slot = FindSlot(key);
+	const unsigned int index = m_slots[slot];
+	if (index == 0) {
+		return nullptr;
+	}
+
+	CValue *value = m_values[index - 1];
+
+	// Shift back the following entries of the probe sequence to fill the removed slot.
+	const unsigned int mask = m_slots.size() - 1;
+	unsigned int next = slot;
+	while (true) {
+		next = (next + 1) & mask;
+		if (m_slots[next] == 0) {
+			break;
+		}
+
+		const unsigned int home = GetHomeSlot(m_keys[m_slots[next] - 1]);
+		// Move the entry if its home slot is not between the free slot and its current slot.
+		if ((next > slot) ? (home <= slot || home > next) : (home <= slot && home > next)) {
+			m_slots[slot] = m_slots[next];
+			slot = next;
+		}
+	}
+	m_slots[slot] = 0;
+
+	// Move the last property in place of the removed one.
+	const unsigned int last = m_keys.size();
+	if (index != last) {
+		m_slots[FindSlot(m_keys[last - 1])] = index;
+		m_keys[index - 1] = m_keys[last - 1];
+		m_values[index - 1] = m_values[last - 1];
+	}
+	m_keys.pop_back();
+	m_values.pop_back();
+
+	return value;
+}
@@ -24,6 +24,9 @@
 #include "EXP_StringValue.h"
 #include "EXP_ErrorValue.h"
 #include "EXP_ListValue.h"
+#include "EXP_PropertyMap.h"
+
+#include <algorithm>
 
 #ifdef WITH_PYTHON
 
@@ -148,6 +151,11 @@ std::string CValue::op2str(VALUE_OPERATOR op)
 
 /// Set property <ioProperty>, overwrites and releases a previous property with the same name if needed.
 void CValue::SetProperty(const std::string & name, CValue *ioProperty)
+{
+	SetProperty(CPropertyKey(name), ioProperty);
+}
+
+void CValue::SetProperty(const CPropertyKey& key, CValue *ioProperty)
 {
 	// Check if somebody is setting an empty property.
 	if (ioProperty == nullptr) {
@@ -155,34 +163,39 @@ void CValue::SetProperty(const std::string & name, CValue *ioProperty)
 		return;
 	}
 
-	// Try to replace property (if so -> exit as soon as we replaced it).
-	if (m_pNamedPropertyArray) {
-		CValue *oldval = (*m_pNamedPropertyArray)[name];
-		if (oldval) {
-			oldval->Release();
-		}
-	}
 	// Make sure we have a property array.
-	else {
-		m_pNamedPropertyArray = new std::map<std::string, CValue *>;
+	if (!m_pNamedPropertyArray) {
+		m_pNamedPropertyArray = new CPropertyMap();
 	}
 
-	// Add property at end of array.
-	(*m_pNamedPropertyArray)[name] = ioProperty->AddRef();
+	// Replace the property and release the previous one if any.
+	CValue *oldval = m_pNamedPropertyArray->Set(key, ioProperty->AddRef());
+	if (oldval) {
+		oldval->Release();
+	}
 }
 
 /// Get pointer to a property with name <inName>, returns nullptr if there is no property named <inName>.
 CValue *CValue::GetProperty(const std::string & inName)
 {
 	if (m_pNamedPropertyArray) {
-		std::map<std::string, CValue *>::iterator it = m_pNamedPropertyArray->find(inName);
-		if (it != m_pNamedPropertyArray->end()) {
-			return (*it).second;
+		// A name without key was never used by any property.
+		const CPropertyKey key = CPropertyKey::Find(inName);
+		if (key.IsValid()) {
+			return m_pNamedPropertyArray->Get(key);
 		}
 	}
 	return nullptr;
 }
 
+CValue *CValue::GetProperty(const CPropertyKey& key)
+{
+	if (m_pNamedPropertyArray) {
+		return m_pNamedPropertyArray->Get(key);
+	}
+	return nullptr;
+}
+
 /// Get text description of property with name <inName>, returns an empty string if there is no property named <inName>.
 const std::string CValue::GetPropertyText(const std::string & inName)
 {
@@ -208,13 +221,22 @@ float CValue::GetPropertyNumber(const std::string& inName, float defnumber)
 
 /// Remove the property named <inName>, returns true if the property was succesfully removed, false if property was not found or could not be removed.
 bool CValue::RemoveProperty(const std::string& inName)
+{
+	const CPropertyKey key = CPropertyKey::Find(inName);
+	if (key.IsValid()) {
+		return RemoveProperty(key);
+	}
+
+	return false;
+}
+
+bool CValue::RemoveProperty(const CPropertyKey& key)
 {
 	// Check if there are properties at all which can be removed.
 	if (m_pNamedPropertyArray) {
-		std::map<std::string, CValue *>::iterator it = m_pNamedPropertyArray->find(inName);
-		if (it != m_pNamedPropertyArray->end()) {
-			((*it).second)->Release();
-			m_pNamedPropertyArray->erase(it);
+		CValue *val = m_pNamedPropertyArray->Remove(key);
+		if (val) {
+			val->Release();
 			return true;
 		}
 	}
@@ -222,20 +244,23 @@ bool CValue::RemoveProperty(const std::string& inName)
 	return false;
 }
 
-/// Get Property Names.
+/// Get Property Names, sorted by name.
 std::vector<std::string> CValue::GetPropertyNames()
 {
 	std::vector<std::string> result;
 	if (!m_pNamedPropertyArray) {
 		return result;
 	}
-	result.reserve(m_pNamedPropertyArray->size());
 
-	std::map<std::string, CValue *>::iterator it;
-	for (it = m_pNamedPropertyArray->begin(); (it != m_pNamedPropertyArray->end()); it++)
-	{
-		result.push_back((*it).first);
+	const unsigned int size = m_pNamedPropertyArray->GetSize();
+	result.reserve(size);
+
+	for (unsigned int i = 0; i < size; ++i) {
+		result.push_back(m_pNamedPropertyArray->GetKey(i).GetName());
 	}
+
+	std::sort(result.begin(), result.end());
+
 	return result;
 }
 
@@ -248,10 +273,8 @@ void CValue::ClearProperties()
 	}
 
 	// Remove all properties.
-	std::map<std::string, CValue *>::iterator it;
-	for (it = m_pNamedPropertyArray->begin(); (it != m_pNamedPropertyArray->end()); it++)
-	{
-		CValue *tmpval = (*it).second;
+	for (unsigned int i = 0, size = m_pNamedPropertyArray->GetSize(); i < size; ++i) {
+		CValue *tmpval = m_pNamedPropertyArray->GetValue(i);
 		tmpval->Release();
 	}
 
@@ -260,29 +283,33 @@ void CValue::ClearProperties()
 	m_pNamedPropertyArray = nullptr;
 }
 
-/// Get property number <inIndex>.
-CValue *CValue::GetProperty(int inIndex)
+void CValue::CopyProperties(CValue *other)
 {
-	int count = 0;
-	CValue *result = nullptr;
+	ClearProperties();
 
-	if (m_pNamedPropertyArray) {
-		std::map<std::string, CValue *>::iterator it;
-		for (it = m_pNamedPropertyArray->begin(); (it != m_pNamedPropertyArray->end()); it++) {
-			if (count++ == inIndex) {
-				result = (*it).second;
-				break;
-			}
+	if (other->m_pNamedPropertyArray) {
+		m_pNamedPropertyArray = new CPropertyMap(*other->m_pNamedPropertyArray);
+		for (unsigned int i = 0, size = m_pNamedPropertyArray->GetSize(); i < size; ++i) {
+			CValue *val = m_pNamedPropertyArray->GetValue(i)->GetReplica();
+			m_pNamedPropertyArray->Set(m_pNamedPropertyArray->GetKey(i), val);
 		}
 	}
-	return result;
+}
+
+/// Get property number <inIndex>.
+CValue *CValue::GetProperty(int inIndex)
+{
+	if (m_pNamedPropertyArray && inIndex >= 0 && inIndex < (int)m_pNamedPropertyArray->GetSize()) {
+		return m_pNamedPropertyArray->GetValue(inIndex);
+	}
+	return nullptr;
 }
 
 /// Get the amount of properties assiocated with this value.
 int CValue::GetPropertyCount()
 {
 	if (m_pNamedPropertyArray) {
-		return m_pNamedPropertyArray->size();
+		return m_pNamedPropertyArray->GetSize();
 	}
 	else {
 		return 0;
@@ -304,14 +331,11 @@ void CValue::ProcessReplica()
 
 	// Copy all props.
 	if (m_pNamedPropertyArray) {
-		std::map<std::string, CValue *> *pOldArray = m_pNamedPropertyArray;
-		m_pNamedPropertyArray = nullptr;
-		std::map<std::string, CValue *>::iterator it;
-		for (it = pOldArray->begin(); (it != pOldArray->end()); it++)
-		{
-			CValue *val = (*it).second->GetReplica();
-			SetProperty((*it).first, val);
-			val->Release();
+		// The keys are kept, only the values are replaced by their replica.
+		m_pNamedPropertyArray = new CPropertyMap(*m_pNamedPropertyArray);
+		for (unsigned int i = 0, size = m_pNamedPropertyArray->GetSize(); i < size; ++i) {
+			CValue *val = m_pNamedPropertyArray->GetValue(i)->GetReplica();
+			m_pNamedPropertyArray->Set(m_pNamedPropertyArray->GetKey(i), val);
 		}
 	}
 }
@@ -408,20 +432,14 @@ CValue *CValue::ConvertPythonToValue(PyObject *pyobj, const bool do_type_excepti
 
 PyObject *CValue::ConvertKeysToPython(void)
 {
-	if (m_pNamedPropertyArray) {
-		PyObject *pylist = PyList_New(m_pNamedPropertyArray->size());
-		Py_ssize_t i = 0;
+	const std::vector<std::string> names = GetPropertyNames();
+	PyObject *pylist = PyList_New(names.size());
 
-		std::map<std::string, CValue *>::iterator it;
-		for (it = m_pNamedPropertyArray->begin(); (it != m_pNamedPropertyArray->end()); it++) {
-			PyList_SET_ITEM(pylist, i++, PyUnicode_FromStdString((*it).first));
-		}
-
-		return pylist;
-	}
-	else {
-		return PyList_New(0);
+	for (unsigned int i = 0, size = names.size(); i < size; ++i) {
+		PyList_SET_ITEM(pylist, i, PyUnicode_FromStdString(names[i]));
 	}
+
+	return pylist;
 }
 
 #endif  // WITH_PYTHON
@@ -84,6 +84,13 @@ bool SCA_AlwaysSensor::IsPositiveTrigger()
 
 
 
+bool SCA_AlwaysSensor::IsEvaluationIndependent() const
+{
+	return true;
+}
+
+
+
 bool SCA_AlwaysSensor::Evaluate()
 {
 	/* Nice! :) */
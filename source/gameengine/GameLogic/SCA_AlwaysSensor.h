@@ -46,6 +46,7 @@ public:
 	virtual ~SCA_AlwaysSensor();
 	virtual CValue* GetReplica();
 	virtual bool Evaluate();
+	virtual bool IsEvaluationIndependent() const;
 	virtual bool IsPositiveTrigger();
 	virtual void Init();
 };
@@ -38,6 +38,13 @@
 #include "SCA_LogicManager.h"
 #include "SCA_ISensor.h"
 
+#include "BLI_task.h"
+#include "BLI_threads.h"
+
+/// Minimum number of independent sensors evaluated in parallel.
+static const unsigned int sensorsParallelThreshold = 256;
+static const unsigned int sensorsTaskChunkSize = 64;
+
 SCA_BasicEventManager::SCA_BasicEventManager(class SCA_LogicManager* logicmgr)
 	: SCA_EventManager(logicmgr, BASIC_EVENTMGR)
 {
@@ -47,12 +54,54 @@ SCA_BasicEventManager::~SCA_BasicEventManager()
 {
 }
 
+void SCA_BasicEventManager::EvaluateSensorsTask(TaskPool *pool, void *taskdata, int start, int stop, int UNUSED(threadid))
+{
+	SCA_BasicEventManager *manager = (SCA_BasicEventManager *)taskdata;
+	for (unsigned int i = start; i < stop; ++i) {
+		manager->m_independentResults[i] = manager->m_independentSensors[i]->Evaluate();
+	}
+}
+
 void SCA_BasicEventManager::NextFrame()
 {
+	TaskScheduler *scheduler = m_logicmgr->GetTaskScheduler();
+	if (scheduler && BLI_thread_is_main() && BLI_task_scheduler_num_threads(scheduler) > 1) {
+		SG_DList::iterator<SCA_ISensor> it(m_sensors);
+		for (it.begin(); !it.end(); ++it) {
+			SCA_ISensor *sensor = *it;
+			if (sensor->NeedEvaluation() && sensor->IsEvaluationIndependent()) {
+				m_independentSensors.push_back(sensor);
+			}
+		}
+
+		if (m_independentSensors.size() >= sensorsParallelThreshold) {
+			m_independentResults.resize(m_independentSensors.size());
+
+			TaskPool *pool = BLI_task_pool_create(scheduler, nullptr);
+			BLI_task_pool_push_range(pool, EvaluateSensorsTask, this, 0, m_independentSensors.size(), sensorsTaskChunkSize,
+			                         TASK_PRIORITY_HIGH);
+			BLI_task_pool_work_and_wait(pool);
+			BLI_task_pool_free(pool);
+		}
+		else {
+			m_independentSensors.clear();
+		}
+	}
+
+	// The controllers are activated in the order of the sensors.
+	unsigned int independentIndex = 0;
 	SG_DList::iterator<SCA_ISensor> it(m_sensors);
 	for (it.begin();!it.end();++it)
 	{
-		(*it)->Activate(m_logicmgr);
+		SCA_ISensor *sensor = *it;
+		if (independentIndex < m_independentSensors.size() && m_independentSensors[independentIndex] == sensor) {
+			sensor->Activate(m_logicmgr, m_independentResults[independentIndex++]);
+		}
+		else {
+			sensor->Activate(m_logicmgr);
+		}
 	}
+
+	m_independentSensors.clear();
 }
 
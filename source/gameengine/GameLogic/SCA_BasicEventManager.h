@@ -37,8 +37,23 @@
 
 #include "SCA_EventManager.h"
 
+struct TaskPool;
+class SCA_ISensor;
+
+/** Event manager of the sensors evaluated every frame without external event.
+ * The sensors with an independent evaluation are evaluated in parallel before
+ * activating the controllers of all the sensors in order.
+ */
 class SCA_BasicEventManager : public SCA_EventManager
 {
+private:
+	/// Sensors to evaluate in parallel, in the order of the sensor list.
+	std::vector<SCA_ISensor *> m_independentSensors;
+	/// Result of the evaluation of every independent sensor.
+	std::vector<unsigned char> m_independentResults;
+
+	static void EvaluateSensorsTask(TaskPool *pool, void *taskdata, int start, int stop, int threadid);
+
 public:
 	SCA_BasicEventManager(class SCA_LogicManager* logicmgr);
 	~SCA_BasicEventManager();
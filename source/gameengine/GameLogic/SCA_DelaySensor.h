@@ -54,6 +54,7 @@ public:
 	virtual ~SCA_DelaySensor();
 	virtual CValue* GetReplica();
 	virtual bool Evaluate();
+	virtual bool IsEvaluationIndependent() const;
 	virtual bool IsPositiveTrigger();
 	virtual void Init();
 
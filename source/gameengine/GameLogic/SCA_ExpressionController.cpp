@@ -37,11 +37,19 @@
 #include "SCA_ISensor.h"
 #include "SCA_LogicManager.h"
 #include "EXP_BoolValue.h"
+#include "EXP_FloatValue.h"
+#include "EXP_ConstExpr.h"
+#include "EXP_IdentifierExpr.h"
+#include "EXP_IfExpr.h"
+#include "EXP_Operator1Expr.h"
+#include "EXP_Operator2Expr.h"
 #include "EXP_InputParser.h"
 #include "MT_Transform.h" // for fuzzyZero
 
 #include "CM_Message.h"
 
+#include <cmath>
+
 /* ------------------------------------------------------------------------- */
 /* Native functions                                                          */
 /* ------------------------------------------------------------------------- */
@@ -69,6 +77,7 @@ CValue* SCA_ExpressionController::GetReplica()
 	SCA_ExpressionController* replica = new SCA_ExpressionController(*this);
 	replica->m_exprText = m_exprText;
 	replica->m_exprCache = nullptr;
+	replica->m_program.clear();
 	// this will copy properties and so on...
 	replica->ProcessReplica();
 
@@ -85,10 +94,550 @@ void SCA_ExpressionController::Delete()
 		m_exprCache->Release();
 		m_exprCache = nullptr;
 	}
+	m_program.clear();
 	Release();
 }
 
 
+/// Operation on numbers of which one at least is a float, as done by CFloatValue and CIntValue.
+template <class Left, class Right>
+static bool CalcFloat(VALUE_OPERATOR op, Left lhs, Right rhs, float& fret, bool& bret, bool& isbool)
+{
+	isbool = false;
+	switch (op) {
+		case VALUE_MOD_OPERATOR:
+		{
+			fret = fmod(lhs, rhs);
+			return true;
+		}
+		case VALUE_ADD_OPERATOR:
+		{
+			fret = lhs + rhs;
+			return true;
+		}
+		case VALUE_SUB_OPERATOR:
+		{
+			fret = lhs - rhs;
+			return true;
+		}
+		case VALUE_MUL_OPERATOR:
+		{
+			fret = lhs * rhs;
+			return true;
+		}
+		case VALUE_DIV_OPERATOR:
+		{
+			if (rhs == 0) {
+				return false;
+			}
+			fret = lhs / rhs;
+			return true;
+		}
+		default:
+		{
+			break;
+		}
+	}
+
+	isbool = true;
+	switch (op) {
+		case VALUE_EQL_OPERATOR:
+		{
+			bret = (lhs == rhs);
+			return true;
+		}
+		case VALUE_NEQ_OPERATOR:
+		{
+			bret = (lhs != rhs);
+			return true;
+		}
+		case VALUE_GRE_OPERATOR:
+		{
+			bret = (lhs > rhs);
+			return true;
+		}
+		case VALUE_LES_OPERATOR:
+		{
+			bret = (lhs < rhs);
+			return true;
+		}
+		case VALUE_GEQ_OPERATOR:
+		{
+			bret = (lhs >= rhs);
+			return true;
+		}
+		case VALUE_LEQ_OPERATOR:
+		{
+			bret = (lhs <= rhs);
+			return true;
+		}
+		default:
+		{
+			// Logical operators are not allowed on numbers.
+			return false;
+		}
+	}
+}
+
+bool SCA_ExpressionController::CalcUnary(VALUE_OPERATOR op, const Register& val, Register& ret)
+{
+	switch (val.m_type) {
+		case REGISTER_BOOL:
+		{
+			if (op != VALUE_NOT_OPERATOR) {
+				return false;
+			}
+			ret.m_type = REGISTER_BOOL;
+			ret.m_bool = !val.m_bool;
+			return true;
+		}
+		case REGISTER_INT:
+		{
+			switch (op) {
+				case VALUE_NEG_OPERATOR:
+				{
+					ret.m_type = REGISTER_INT;
+					ret.m_int = -val.m_int;
+					return true;
+				}
+				case VALUE_POS_OPERATOR:
+				{
+					ret.m_type = REGISTER_INT;
+					ret.m_int = val.m_int;
+					return true;
+				}
+				case VALUE_NOT_OPERATOR:
+				{
+					ret.m_type = REGISTER_BOOL;
+					ret.m_bool = (val.m_int == 0);
+					return true;
+				}
+				default:
+				{
+					return false;
+				}
+			}
+		}
+		case REGISTER_FLOAT:
+		{
+			switch (op) {
+				case VALUE_NEG_OPERATOR:
+				{
+					ret.m_type = REGISTER_FLOAT;
+					ret.m_float = -val.m_float;
+					return true;
+				}
+				case VALUE_POS_OPERATOR:
+				{
+					ret.m_type = REGISTER_FLOAT;
+					ret.m_float = val.m_float;
+					return true;
+				}
+				case VALUE_NOT_OPERATOR:
+				{
+					ret.m_type = REGISTER_BOOL;
+					ret.m_bool = (val.m_float == 0.0f);
+					return true;
+				}
+				default:
+				{
+					return false;
+				}
+			}
+		}
+	}
+
+	return false;
+}
+
+bool SCA_ExpressionController::CalcBinary(VALUE_OPERATOR op, const Register& lhs, const Register& rhs, Register& ret)
+{
+	// Booleans are only combined with booleans.
+	if ((lhs.m_type == REGISTER_BOOL) != (rhs.m_type == REGISTER_BOOL)) {
+		return false;
+	}
+
+	if (lhs.m_type == REGISTER_BOOL) {
+		ret.m_type = REGISTER_BOOL;
+		switch (op) {
+			case VALUE_AND_OPERATOR:
+			{
+				ret.m_bool = (lhs.m_bool && rhs.m_bool);
+				return true;
+			}
+			case VALUE_OR_OPERATOR:
+			{
+				ret.m_bool = (lhs.m_bool || rhs.m_bool);
+				return true;
+			}
+			case VALUE_EQL_OPERATOR:
+			{
+				ret.m_bool = (lhs.m_bool == rhs.m_bool);
+				return true;
+			}
+			case VALUE_NEQ_OPERATOR:
+			{
+				ret.m_bool = (lhs.m_bool != rhs.m_bool);
+				return true;
+			}
+			default:
+			{
+				return false;
+			}
+		}
+	}
+
+	if (lhs.m_type == REGISTER_INT && rhs.m_type == REGISTER_INT) {
+		const cInt a = lhs.m_int;
+		const cInt b = rhs.m_int;
+		ret.m_type = REGISTER_INT;
+		switch (op) {
+			case VALUE_MOD_OPERATOR:
+			{
+				if (b == 0) {
+					return false;
+				}
+				ret.m_int = a % b;
+				return true;
+			}
+			case VALUE_ADD_OPERATOR:
+			{
+				ret.m_int = a + b;
+				return true;
+			}
+			case VALUE_SUB_OPERATOR:
+			{
+				ret.m_int = a - b;
+				return true;
+			}
+			case VALUE_MUL_OPERATOR:
+			{
+				ret.m_int = a * b;
+				return true;
+			}
+			case VALUE_DIV_OPERATOR:
+			{
+				if (b == 0) {
+					return false;
+				}
+				ret.m_int = a / b;
+				return true;
+			}
+			default:
+			{
+				break;
+			}
+		}
+
+		ret.m_type = REGISTER_BOOL;
+		switch (op) {
+			case VALUE_EQL_OPERATOR:
+			{
+				ret.m_bool = (a == b);
+				return true;
+			}
+			case VALUE_NEQ_OPERATOR:
+			{
+				ret.m_bool = (a != b);
+				return true;
+			}
+			case VALUE_GRE_OPERATOR:
+			{
+				ret.m_bool = (a > b);
+				return true;
+			}
+			case VALUE_LES_OPERATOR:
+			{
+				ret.m_bool = (a < b);
+				return true;
+			}
+			case VALUE_GEQ_OPERATOR:
+			{
+				ret.m_bool = (a >= b);
+				return true;
+			}
+			case VALUE_LEQ_OPERATOR:
+			{
+				ret.m_bool = (a <= b);
+				return true;
+			}
+			default:
+			{
+				return false;
+			}
+		}
+	}
+
+	float fret;
+	bool bret;
+	bool isbool;
+	bool success;
+	if (lhs.m_type == REGISTER_INT) {
+		success = CalcFloat(op, lhs.m_int, rhs.m_float, fret, bret, isbool);
+	}
+	else if (rhs.m_type == REGISTER_INT) {
+		success = CalcFloat(op, lhs.m_float, rhs.m_int, fret, bret, isbool);
+	}
+	else {
+		success = CalcFloat(op, lhs.m_float, rhs.m_float, fret, bret, isbool);
+	}
+
+	if (!success) {
+		return false;
+	}
+
+	if (isbool) {
+		ret.m_type = REGISTER_BOOL;
+		ret.m_bool = bret;
+	}
+	else {
+		ret.m_type = REGISTER_FLOAT;
+		ret.m_float = fret;
+	}
+	return true;
+}
+
+void SCA_ExpressionController::CompileExpression()
+{
+	m_program.clear();
+	m_constants.clear();
+	m_properties.clear();
+	m_registers.clear();
+	m_programSensors = m_linkedsensors;
+
+	if (!CompileExpression(m_exprCache, 0)) {
+		m_program.clear();
+	}
+}
+
+bool SCA_ExpressionController::CompileExpression(CExpression *expr, unsigned int dst)
+{
+	if (dst >= m_registers.size()) {
+		m_registers.resize(dst + 1);
+	}
+
+	switch (expr->GetExpressionID()) {
+		case CExpression::CCONSTEXPRESSIONID:
+		{
+			CValue *value = static_cast<CConstExpr *>(expr)->GetValue();
+			Register reg;
+			switch (value->GetValueType()) {
+				case VALUE_BOOL_TYPE:
+				{
+					reg.m_type = REGISTER_BOOL;
+					reg.m_bool = static_cast<CBoolValue *>(value)->GetBool();
+					break;
+				}
+				case VALUE_INT_TYPE:
+				{
+					reg.m_type = REGISTER_INT;
+					reg.m_int = static_cast<CIntValue *>(value)->GetInt();
+					break;
+				}
+				case VALUE_FLOAT_TYPE:
+				{
+					reg.m_type = REGISTER_FLOAT;
+					reg.m_float = static_cast<CFloatValue *>(value)->GetFloat();
+					break;
+				}
+				default:
+				{
+					// Strings, errors and empty values are left to the expression tree.
+					return false;
+				}
+			}
+
+			m_program.push_back({OP_LOAD_CONSTANT, VALUE_NO_OPERATOR, dst, (unsigned int)m_constants.size(), 0});
+			m_constants.push_back(reg);
+			return true;
+		}
+		case CExpression::CIDENTIFIEREXPRESSIONID:
+		{
+			CIdentifierExpr *idexpr = static_cast<CIdentifierExpr *>(expr);
+			const std::string& name = idexpr->GetIdentifier();
+			// Only the identifiers resolved by FindIdentifier without sub context are compiled.
+			if (idexpr->GetContext() != this || name.find('.') != std::string::npos) {
+				return false;
+			}
+
+			for (unsigned int i = 0, size = m_programSensors.size(); i < size; ++i) {
+				if (m_programSensors[i]->GetName() == name) {
+					m_program.push_back({OP_LOAD_SENSOR, VALUE_NO_OPERATOR, dst, i, 0});
+					return true;
+				}
+			}
+
+			m_program.push_back({OP_LOAD_PROPERTY, VALUE_NO_OPERATOR, dst, (unsigned int)m_properties.size(), 0});
+			m_properties.emplace_back(name);
+			return true;
+		}
+		case CExpression::COPERATOR1EXPRESSIONID:
+		{
+			COperator1Expr *opexpr = static_cast<COperator1Expr *>(expr);
+			if (!CompileExpression(opexpr->GetOperand(), dst)) {
+				return false;
+			}
+
+			m_program.push_back({OP_UNARY, opexpr->GetOperator(), dst, dst, 0});
+			return true;
+		}
+		case CExpression::COPERATOR2EXPRESSIONID:
+		{
+			COperator2Expr *opexpr = static_cast<COperator2Expr *>(expr);
+			if (!CompileExpression(opexpr->GetLeftOperand(), dst) ||
+				!CompileExpression(opexpr->GetRightOperand(), dst + 1))
+			{
+				return false;
+			}
+
+			m_program.push_back({OP_BINARY, opexpr->GetOperator(), dst, dst, dst + 1});
+			return true;
+		}
+		case CExpression::CIFEXPRESSIONID:
+		{
+			CIfExpr *ifexpr = static_cast<CIfExpr *>(expr);
+			if (!CompileExpression(ifexpr->GetGuard(), dst)) {
+				return false;
+			}
+
+			const unsigned int jumpfalse = m_program.size();
+			m_program.push_back({OP_JUMP_IF_FALSE, VALUE_NO_OPERATOR, 0, dst, 0});
+			if (!CompileExpression(ifexpr->GetTrueExpression(), dst)) {
+				return false;
+			}
+
+			const unsigned int jumpend = m_program.size();
+			m_program.push_back({OP_JUMP, VALUE_NO_OPERATOR, 0, 0, 0});
+			m_program[jumpfalse].m_arg2 = m_program.size();
+			if (!CompileExpression(ifexpr->GetFalseExpression(), dst)) {
+				return false;
+			}
+
+			m_program[jumpend].m_arg1 = m_program.size();
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool SCA_ExpressionController::RunProgram(bool& result)
+{
+	SCA_IObject *parent = GetParent();
+	Register *registers = m_registers.data();
+
+	for (unsigned int pc = 0, size = m_program.size(); pc < size; ) {
+		const Instruction& inst = m_program[pc++];
+		switch (inst.m_code) {
+			case OP_LOAD_CONSTANT:
+			{
+				registers[inst.m_dst] = m_constants[inst.m_arg1];
+				break;
+			}
+			case OP_LOAD_SENSOR:
+			{
+				Register& reg = registers[inst.m_dst];
+				reg.m_type = REGISTER_BOOL;
+				reg.m_bool = m_programSensors[inst.m_arg1]->GetState();
+				break;
+			}
+			case OP_LOAD_PROPERTY:
+			{
+				CValue *prop = parent->GetProperty(m_properties[inst.m_arg1]);
+				if (!prop) {
+					return false;
+				}
+
+				Register& reg = registers[inst.m_dst];
+				switch (prop->GetValueType()) {
+					case VALUE_BOOL_TYPE:
+					{
+						reg.m_type = REGISTER_BOOL;
+						reg.m_bool = static_cast<CBoolValue *>(prop)->GetBool();
+						break;
+					}
+					case VALUE_INT_TYPE:
+					{
+						reg.m_type = REGISTER_INT;
+						reg.m_int = static_cast<CIntValue *>(prop)->GetInt();
+						break;
+					}
+					case VALUE_FLOAT_TYPE:
+					{
+						reg.m_type = REGISTER_FLOAT;
+						reg.m_float = static_cast<CFloatValue *>(prop)->GetFloat();
+						break;
+					}
+					default:
+					{
+						return false;
+					}
+				}
+				break;
+			}
+			case OP_UNARY:
+			{
+				Register ret;
+				if (!CalcUnary(inst.m_op, registers[inst.m_arg1], ret)) {
+					return false;
+				}
+				registers[inst.m_dst] = ret;
+				break;
+			}
+			case OP_BINARY:
+			{
+				Register ret;
+				if (!CalcBinary(inst.m_op, registers[inst.m_arg1], registers[inst.m_arg2], ret)) {
+					return false;
+				}
+				registers[inst.m_dst] = ret;
+				break;
+			}
+			case OP_JUMP_IF_FALSE:
+			{
+				const Register& guard = registers[inst.m_arg1];
+				if (guard.m_type != REGISTER_BOOL) {
+					return false;
+				}
+				if (!guard.m_bool) {
+					pc = inst.m_arg2;
+				}
+				break;
+			}
+			case OP_JUMP:
+			{
+				pc = inst.m_arg1;
+				break;
+			}
+		}
+	}
+
+	// Same conversion as CValue::GetNumber.
+	const Register& reg = registers[0];
+	double number;
+	switch (reg.m_type) {
+		case REGISTER_BOOL:
+		{
+			number = (double)reg.m_bool;
+			break;
+		}
+		case REGISTER_INT:
+		{
+			number = (double)reg.m_int;
+			break;
+		}
+		case REGISTER_FLOAT:
+		default:
+		{
+			number = reg.m_float;
+			break;
+		}
+	}
+
+	result = !MT_fuzzyZero((float)number);
+	return true;
+}
+
 void SCA_ExpressionController::Trigger(SCA_LogicManager* logicmgr)
 {
 
@@ -98,22 +647,32 @@ void SCA_ExpressionController::Trigger(SCA_LogicManager* logicmgr)
 		CParser parser;
 		parser.SetContext(this->AddRef());
 		m_exprCache = parser.ProcessText(m_exprText);
+		if (m_exprCache) {
+			CompileExpression();
+		}
 	}
 	if (m_exprCache)
 	{
-		CValue* value = m_exprCache->Calculate();
-		if (value)
-		{
-			if (value->IsError())
-			{
-				CM_LogicBrickError(this, value->GetText());
-			} else
+		// The sensor identifiers are resolved against the linked sensors.
+		if (!m_program.empty() && m_programSensors != m_linkedsensors) {
+			CompileExpression();
+		}
+
+		if (m_program.empty() || !RunProgram(expressionresult)) {
+			CValue* value = m_exprCache->Calculate();
+			if (value)
 			{
-				float num = (float)value->GetNumber();
-				expressionresult = !MT_fuzzyZero(num);
-			}
-			value->Release();
+				if (value->IsError())
+				{
+					CM_LogicBrickError(this, value->GetText());
+				} else
+				{
+					float num = (float)value->GetNumber();
+					expressionresult = !MT_fuzzyZero(num);
+				}
+				value->Release();
 
+			}
 		}
 	}
 
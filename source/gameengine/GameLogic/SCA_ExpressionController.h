@@ -36,15 +36,88 @@
 #define __SCA_EXPRESSIONCONTROLLER_H__
 
 #include "SCA_IController.h"
+#include "EXP_IntValue.h"
+#include "EXP_PropertyKey.h"
 
 class CExpression;
 
+/** \brief Controller activating its actuators when an expression is true.
+ *
+ * The parsed expression is compiled to a flat list of instructions working on unboxed
+ * registers, the sensor and property identifiers are resolved once during the compilation.
+ * Strings, errors and invalid operations are not handled by the compiled program, the
+ * expression tree is then evaluated instead to produce the same result and error messages.
+ */
 class SCA_ExpressionController : public SCA_IController
 {
-//	Py_Header
+private:
+	enum RegisterType {
+		REGISTER_BOOL,
+		REGISTER_INT,
+		REGISTER_FLOAT
+	};
+
+	/// An unboxed value of the compiled expression.
+	struct Register
+	{
+		RegisterType m_type;
+		union {
+			bool m_bool;
+			cInt m_int;
+			float m_float;
+		};
+	};
+
+	enum OpCode {
+		/// m_dst = constant m_arg1.
+		OP_LOAD_CONSTANT,
+		/// m_dst = state of the linked sensor m_arg1.
+		OP_LOAD_SENSOR,
+		/// m_dst = value of the parent property m_arg1.
+		OP_LOAD_PROPERTY,
+		/// m_dst = m_op m_arg1.
+		OP_UNARY,
+		/// m_dst = m_arg1 m_op m_arg2.
+		OP_BINARY,
+		/// Go to instruction m_arg2 if m_arg1 is false.
+		OP_JUMP_IF_FALSE,
+		/// Go to instruction m_arg1.
+		OP_JUMP
+	};
+
+	struct Instruction
+	{
+		OpCode m_code;
+		VALUE_OPERATOR m_op;
+		unsigned int m_dst;
+		unsigned int m_arg1;
+		unsigned int m_arg2;
+	};
+
 	std::string			m_exprText;
 	CExpression*		m_exprCache;
 
+	/// Compiled expression, empty if the expression can't be compiled.
+	std::vector<Instruction> m_program;
+	std::vector<Register> m_constants;
+	std::vector<CPropertyKey> m_properties;
+	std::vector<Register> m_registers;
+	/// Linked sensors used to resolve the identifiers of the program.
+	std::vector<SCA_ISensor *> m_programSensors;
+
+	/// Compile the expression cache, the program is left empty in case of failure.
+	void CompileExpression();
+	/// Compile an expression storing its result in register dst.
+	bool CompileExpression(CExpression *expr, unsigned int dst);
+	/** Run the compiled program.
+	 * \param result Set to the truth of the expression if the program succeeded.
+	 * \return False if the expression tree must be evaluated instead.
+	 */
+	bool RunProgram(bool& result);
+
+	static bool CalcUnary(VALUE_OPERATOR op, const Register& val, Register& ret);
+	static bool CalcBinary(VALUE_OPERATOR op, const Register& lhs, const Register& rhs, Register& ret);
+
 public:
 	SCA_ExpressionController(SCA_IObject* gameobj,
 							 const std::string& exprtext);
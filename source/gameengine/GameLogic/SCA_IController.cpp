@@ -32,6 +32,7 @@
 #include "SCA_IController.h"
 #include "SCA_IActuator.h"
 #include "SCA_ISensor.h"
+#include "SCA_LogicManager.h"
 #include "EXP_ListWrapper.h"
 
 #include "CM_Message.h"
@@ -41,7 +42,8 @@
 SCA_IController::SCA_IController(SCA_IObject *gameobj)
 	:SCA_ILogicBrick(gameobj),
 	m_statemask(0),
-	m_justActivated(false)
+	m_justActivated(false),
+	m_logicOperation(LOGIC_NONE)
 {
 }
 
@@ -196,6 +198,61 @@ void SCA_IController::Activate(SG_DList& head)
 	}
 }
 
+bool SCA_IController::CalculateLogicOperation() const
+{
+	switch (m_logicOperation) {
+		case LOGIC_AND:
+		case LOGIC_NAND:
+		{
+			bool result = true;
+			for (SCA_ISensor *sensor : m_linkedsensors) {
+				if (!sensor->GetState()) {
+					result = false;
+					break;
+				}
+			}
+			return (m_logicOperation == LOGIC_AND) ? result : !result;
+		}
+		case LOGIC_OR:
+		case LOGIC_NOR:
+		{
+			bool result = false;
+			for (SCA_ISensor *sensor : m_linkedsensors) {
+				if (sensor->GetState()) {
+					result = true;
+					break;
+				}
+			}
+			return (m_logicOperation == LOGIC_OR) ? result : !result;
+		}
+		case LOGIC_XOR:
+		case LOGIC_XNOR:
+		{
+			// True if exactly one sensor is positive.
+			unsigned short positive = 0;
+			for (SCA_ISensor *sensor : m_linkedsensors) {
+				if (sensor->GetState() && ++positive > 1) {
+					break;
+				}
+			}
+			const bool result = (positive == 1);
+			return (m_logicOperation == LOGIC_XOR) ? result : !result;
+		}
+		default:
+		{
+			BLI_assert(false);
+			return false;
+		}
+	}
+}
+
+void SCA_IController::ActivateActuators(SCA_LogicManager *logicmgr, bool result)
+{
+	for (SCA_IActuator *actuator : m_linkedactuators) {
+		logicmgr->AddActiveActuator(actuator, result);
+	}
+}
+
 #ifdef WITH_PYTHON
 
 /* Python api */
@@ -43,12 +43,30 @@ class SCA_IController : public SCA_ILogicBrick
 {
 	Py_Header
 
+public:
+	/// Operation of the controllers only combining the states of their sensors.
+	enum LogicOperation {
+		/// The controller is only evaluated by Trigger.
+		LOGIC_NONE = 0,
+		LOGIC_AND,
+		LOGIC_OR,
+		LOGIC_NAND,
+		LOGIC_NOR,
+		LOGIC_XOR,
+		LOGIC_XNOR,
+		LOGIC_MAX
+	};
+
 protected:
 	std::vector<SCA_ISensor *> m_linkedsensors;
 	std::vector<SCA_IActuator *> m_linkedactuators;
 	unsigned int m_statemask;
 	bool m_justActivated;
 	bool m_bookmark;
+	/** Set by the controllers without side effects, the logic manager then evaluates
+	 * them in batches instead of calling Trigger.
+	 */
+	LogicOperation m_logicOperation;
 
 public:
 	SCA_IController(SCA_IObject *gameobj);
@@ -56,6 +74,16 @@ public:
 
 	virtual void Trigger(SCA_LogicManager *logicmgr) = 0;
 
+	inline LogicOperation GetLogicOperation() const
+	{
+		return m_logicOperation;
+	}
+
+	/// Return the result of the logic operation on the states of the linked sensors.
+	bool CalculateLogicOperation() const;
+	/// Send the result of the controller to all the linked actuators.
+	void ActivateActuators(SCA_LogicManager *logicmgr, bool result);
+
 	void LinkToSensor(SCA_ISensor *sensor);
 	void LinkToActuator(SCA_IActuator *);
 	std::vector<SCA_ISensor *>& GetLinkedSensors();
@@ -150,6 +150,19 @@ void SCA_IObject::UnregisterObject(SCA_IObject* obj)
 	}
 }
 
+void SCA_IObject::UnlinkAllClients()
+{
+	for (SCA_IActuator *actuator : m_registeredActuators) {
+		actuator->UnlinkObject(this);
+	}
+	m_registeredActuators.clear();
+
+	for (SCA_IObject *object : m_registeredObjects) {
+		object->UnlinkObject(this);
+	}
+	m_registeredObjects.clear();
+}
+
 void SCA_IObject::ReParentLogic()
 {
 	SCA_ActuatorList& oldactuators  = GetActuators();
@@ -141,6 +141,11 @@ public:
 	
 	void RegisterObject(SCA_IObject* objs);
 	void UnregisterObject(SCA_IObject* objs);
+	/**
+	 * Inform the registered actuators and objects that this object is not usable anymore
+	 * and clear the registrations, used when the object leaves the scene without being deleted.
+	 */
+	void UnlinkAllClients();
 	/**
 	 * UnlinkObject(...)
 	 * this object is informed that one of the object to which it holds a reference is deleted
@@ -183,6 +188,14 @@ public:
 	 */
 	void Resume(void);
 
+	/**
+	 * Return true if the object progress is suspended
+	 */
+	bool IsSuspended() const
+	{
+		return m_suspended;
+	}
+
 	/**
 	 * Set init state
 	 */
@@ -113,9 +113,19 @@ public:
 	/* level of individual sensors. Mapping the old activate()s is easy.     */
 	/* The IsPosTrig() also has to change, to keep things consistent.        */
 	void Activate(SCA_LogicManager *logicmgr);
+	/** Activate the controllers using the result of a previous call to Evaluate.
+	 * The sensor must need an evaluation.
+	 */
+	void Activate(SCA_LogicManager *logicmgr, bool result);
 	virtual bool Evaluate() = 0;
+	/** Return true if Evaluate only reads and writes the sensor own data,
+	 * such sensors can be evaluated concurrently.
+	 */
+	virtual bool IsEvaluationIndependent() const;
 	virtual bool IsPositiveTrigger();
 	virtual void Init();
+	/// Put the sensor in its initial state as if it was never evaluated.
+	void Reset();
 
 	virtual CValue *GetReplica() = 0;
 
@@ -152,6 +162,12 @@ public:
 	/// Is this sensor switched off?
 	bool IsSuspended();
 
+	/// Return true if the sensor is linked to a controller and not suspended.
+	inline bool NeedEvaluation() const
+	{
+		return (m_links && !m_suspended);
+	}
+
 	/// Get the state of the sensor: positive or negative.
 	bool GetState();
 
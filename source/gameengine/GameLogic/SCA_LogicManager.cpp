@@ -37,10 +37,20 @@
 #include "SCA_IActuator.h"
 #include "SCA_EventManager.h"
 #include "SCA_PythonController.h"
+
+#include "CM_Profiler.h"
+
+#include "BLI_task.h"
+#include "BLI_threads.h"
+
 #include <set>
 
+/// Minimum number of logic controllers evaluated in parallel.
+static const unsigned int logicControllersParallelThreshold = 256;
+static const unsigned int logicControllersTaskChunkSize = 64;
 
 SCA_LogicManager::SCA_LogicManager()
+	:m_taskScheduler(nullptr)
 {
 }
 
@@ -61,6 +71,16 @@ void SCA_LogicManager::RegisterEventManager(SCA_EventManager* eventmgr)
 	m_eventmanagers.push_back(eventmgr);
 }
 
+void SCA_LogicManager::SetTaskScheduler(TaskScheduler *scheduler)
+{
+	m_taskScheduler = scheduler;
+}
+
+TaskScheduler *SCA_LogicManager::GetTaskScheduler() const
+{
+	return m_taskScheduler;
+}
+
 
 
 void SCA_LogicManager::RegisterGameObjectName(const std::string& gameobjname,
@@ -75,6 +95,14 @@ void SCA_LogicManager::UnregisterGameObjectName(const std::string& gameobjname)
 	m_mapStringToGameObjects.erase(gameobjname);
 }
 
+void SCA_LogicManager::UnregisterGameObjectName(const std::string& gameobjname, CValue* gameobj)
+{
+	std::map<std::string, CValue *>::iterator it = m_mapStringToGameObjects.find(gameobjname);
+	if (it != m_mapStringToGameObjects.end() && it->second == gameobj) {
+		m_mapStringToGameObjects.erase(it);
+	}
+}
+
 
 void SCA_LogicManager::RegisterGameMeshName(const std::string& gamemeshname, void* blendobj)
 {
@@ -142,6 +170,23 @@ void SCA_LogicManager::RemoveActuator(SCA_IActuator* actuator)
 
 
 
+void SCA_LogicManager::DeactivateObjectLogic(SCA_IObject *gameobj)
+{
+	// Unregister the sensors of the active controllers.
+	gameobj->SetState(0);
+
+	for (SCA_IController *controller : gameobj->GetControllers()) {
+		controller->Deactivate();
+	}
+
+	for (SCA_IActuator *actuator : gameobj->GetActuators()) {
+		actuator->RemoveAllEvents();
+		actuator->Deactivate();
+	}
+}
+
+
+
 void SCA_LogicManager::RegisterToSensor(SCA_IController* controller,SCA_ISensor* sensor)
 {
 	sensor->LinkToController(controller);
@@ -171,10 +216,80 @@ void SCA_LogicManager::BeginFrame(double curtime, double fixedtime)
 			contr != nullptr;
 			contr = (SCA_IController*)obj->QRemove())
 		{
+			if (contr->GetLogicOperation() != SCA_IController::LOGIC_NONE) {
+				m_logicControllers.push_back(contr);
+				continue;
+			}
+
+			/* The previous logic controllers are evaluated first as this controller
+			 * can modify the sensors, actuators or controllers states. */
+			TriggerLogicControllers();
+
+			CM_ProfilerScope profile("controller", [contr]() { return contr->GetParent()->GetName() + "." + contr->GetName(); });
+
 			contr->Trigger(this);
 			contr->ClrJustActivated();
 		}
 	}
+
+	TriggerLogicControllers();
+}
+
+void SCA_LogicManager::EvaluateLogicControllersTask(TaskPool *pool, void *taskdata, int start, int stop, int UNUSED(threadid))
+{
+	SCA_LogicManager *logicmgr = (SCA_LogicManager *)taskdata;
+	for (unsigned int i = start; i < stop; ++i) {
+		const unsigned int index = logicmgr->m_logicOrder[i];
+		logicmgr->m_logicResults[index] = logicmgr->m_logicControllers[index]->CalculateLogicOperation();
+	}
+}
+
+void SCA_LogicManager::TriggerLogicControllers()
+{
+	const unsigned int size = m_logicControllers.size();
+	if (size == 0) {
+		return;
+	}
+
+	CM_ProfilerScope profile("controller", [size]() { return "logic controllers (" + std::to_string(size) + ")"; });
+
+	// Group the controllers by logic operation with a counting sort.
+	unsigned int offsets[SCA_IController::LOGIC_MAX + 1] = {0};
+	for (SCA_IController *contr : m_logicControllers) {
+		++offsets[contr->GetLogicOperation() + 1];
+	}
+	for (unsigned int i = 1; i <= SCA_IController::LOGIC_MAX; ++i) {
+		offsets[i] += offsets[i - 1];
+	}
+
+	m_logicOrder.resize(size);
+	for (unsigned int i = 0; i < size; ++i) {
+		m_logicOrder[offsets[m_logicControllers[i]->GetLogicOperation()]++] = i;
+	}
+
+	m_logicResults.resize(size);
+
+	if (size >= logicControllersParallelThreshold && m_taskScheduler && BLI_thread_is_main() &&
+		BLI_task_scheduler_num_threads(m_taskScheduler) > 1)
+	{
+		TaskPool *pool = BLI_task_pool_create(m_taskScheduler, nullptr);
+		BLI_task_pool_push_range(pool, EvaluateLogicControllersTask, this, 0, size, logicControllersTaskChunkSize,
+		                         TASK_PRIORITY_HIGH);
+		BLI_task_pool_work_and_wait(pool);
+		BLI_task_pool_free(pool);
+	}
+	else {
+		EvaluateLogicControllersTask(nullptr, this, 0, size, 0);
+	}
+
+	// The actuators are activated in the trigger order to keep the order of the active actuators.
+	for (unsigned int i = 0; i < size; ++i) {
+		SCA_IController *contr = m_logicControllers[i];
+		contr->ActivateActuators(this, m_logicResults[i]);
+		contr->ClrJustActivated();
+	}
+
+	m_logicControllers.clear();
 }
 
 
@@ -196,6 +311,9 @@ void SCA_LogicManager::UpdateFrame(double curtime)
 			SCA_IActuator* actua = *ia;
 			// increment first to allow removal of inactive actuators.
 			++ia;
+
+			CM_ProfilerScope profile("actuator", [actua]() { return actua->GetParent()->GetName() + "." + actua->GetName(); });
+
 			if (!actua->Update(curtime))
 			{
 				// this actuator is not active anymore, remove
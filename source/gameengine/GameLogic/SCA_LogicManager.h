@@ -43,15 +43,16 @@
 #include "EXP_Value.h"
 #include "SG_QList.h"
 
-typedef std::list<class SCA_IController*> controllerlist;
-typedef std::map<class SCA_ISensor*,controllerlist > sensormap_t;
+struct TaskPool;
+struct TaskScheduler;
 
 /**
  * This manager handles sensor, controllers and actuators.
  * logic executes each frame the following way:
  * find triggering sensors
  * build list of controllers that are triggered by these triggering sensors
- * process all triggered controllers
+ * process all triggered controllers, the controllers only combining their sensors
+ * states are grouped by logic operation and evaluated in batches
  * during this phase actuators can be added to the active actuator list
  * process all active actuators
  * clear triggering sensors
@@ -75,6 +76,15 @@ class SCA_LogicManager
 	//           element: SCA_IObject::m_activeControllers
 	SG_DList							m_triggeredControllerSet;
 
+	/// Triggered controllers with a logic operation waiting for their evaluation, in trigger order.
+	std::vector<class SCA_IController *>	m_logicControllers;
+	/// Indices of m_logicControllers sorted by logic operation.
+	std::vector<unsigned int>			m_logicOrder;
+	/// Result of every controller of m_logicControllers.
+	std::vector<unsigned char>			m_logicResults;
+
+	TaskScheduler						*m_taskScheduler;
+
 	// need to find better way for this
 	// also known as FactoryManager...
 	std::map<std::string, CValue *>	m_mapStringToGameObjects;
@@ -83,12 +93,21 @@ class SCA_LogicManager
 
 	std::map<std::string, void *>		m_map_gamemeshname_to_blendobj;
 	std::map<void *, CValue *>			m_map_blendobj_to_gameobj;
+
+	static void EvaluateLogicControllersTask(TaskPool *pool, void *taskdata, int start, int stop, int threadid);
+	/// Evaluate the waiting logic controllers and activate their actuators in trigger order.
+	void TriggerLogicControllers();
+
 public:
 	SCA_LogicManager();
 	virtual ~SCA_LogicManager();
 
 	//void	SetKeyboardManager(SCA_KeyboardManager* keyboardmgr) { m_keyboardmgr=keyboardmgr;}
 	void	RegisterEventManager(SCA_EventManager* eventmgr);
+
+	/// Set the scheduler used to evaluate the logic bricks in parallel, can be nullptr.
+	void	SetTaskScheduler(TaskScheduler *scheduler);
+	TaskScheduler	*GetTaskScheduler() const;
 	void	RegisterToSensor(SCA_IController* controller,
 							 class SCA_ISensor* sensor);
 	void	RegisterToActuator(SCA_IController* controller,
@@ -114,6 +133,12 @@ public:
 	void	RemoveSensor(SCA_ISensor* sensor);
 	void	RemoveController(SCA_IController* controller);
 	void	RemoveActuator(SCA_IActuator* actuator);
+
+	/**
+	 * Stop all the logic bricks of an object without unlinking them,
+	 * resetting the object state restarts the logic.
+	 */
+	void	DeactivateObjectLogic(SCA_IObject *gameobj);
 	
 
 	// for the scripting... needs a FactoryManager later (if we would have time... ;)
@@ -129,6 +154,8 @@ public:
 
 	void	RegisterGameObjectName(const std::string& gameobjname,CValue* gameobj);
 	void	UnregisterGameObjectName(const std::string& gameobjname);
+	/// Unregister the name only if it is registered for this object.
+	void	UnregisterGameObjectName(const std::string& gameobjname, CValue* gameobj);
 	class CValue*	GetGameObjectByName(const std::string& gameobjname);
 
 	void	RegisterGameMeshName(const std::string& gamemeshname, void* blendobj);
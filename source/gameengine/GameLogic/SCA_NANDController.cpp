@@ -46,6 +46,7 @@ SCA_NANDController::SCA_NANDController(SCA_IObject* gameobj)
 	:
 	SCA_IController(gameobj)
 {
+	m_logicOperation = LOGIC_NAND;
 }
 
 
@@ -58,26 +59,7 @@ SCA_NANDController::~SCA_NANDController()
 
 void SCA_NANDController::Trigger(SCA_LogicManager* logicmgr)
 {
-
-	bool sensorresult = false;
-
-	for (std::vector<SCA_ISensor*>::const_iterator is=m_linkedsensors.begin();
-	!(is==m_linkedsensors.end());is++)
-	{
-		SCA_ISensor* sensor = *is;
-		if (!sensor->GetState())
-		{
-			sensorresult = true;
-			break;
-		}
-	}
-	
-	for (std::vector<SCA_IActuator*>::const_iterator i=m_linkedactuators.begin();
-	!(i==m_linkedactuators.end());i++)
-	{
-		SCA_IActuator* actua = *i;
-		logicmgr->AddActiveActuator(actua,sensorresult);
-	}
+	ActivateActuators(logicmgr, CalculateLogicOperation());
 }
 
 
@@ -45,6 +45,7 @@
 SCA_ORController::SCA_ORController(SCA_IObject* gameobj)
 		:SCA_IController(gameobj)
 {
+	m_logicOperation = LOGIC_OR;
 }
 
 
@@ -67,24 +68,7 @@ CValue* SCA_ORController::GetReplica()
 
 void SCA_ORController::Trigger(SCA_LogicManager* logicmgr)
 {
-
-	bool sensorresult = false;
-	SCA_ISensor* sensor;
-
-	std::vector<SCA_ISensor*>::const_iterator is=m_linkedsensors.begin();
-	while ( (!sensorresult) && (!(is==m_linkedsensors.end())) )
-	{
-		sensor = *is;
-		if (sensor->GetState()) sensorresult = true;
-		is++;
-	}
-	
-	for (std::vector<SCA_IActuator*>::const_iterator i=m_linkedactuators.begin();
-	!(i==m_linkedactuators.end());i++)
-	{
-		SCA_IActuator* actua = *i;
-		logicmgr->AddActiveActuator(actua,sensorresult);
-	}
+	ActivateActuators(logicmgr, CalculateLogicOperation());
 }
 
 #ifdef WITH_PYTHON
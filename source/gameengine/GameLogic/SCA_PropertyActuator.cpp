@@ -48,6 +48,7 @@ SCA_PropertyActuator::SCA_PropertyActuator(SCA_IObject* gameobj,SCA_IObject* sou
    :	SCA_IActuator(gameobj, KX_ACT_PROPERTY),
 	m_type(acttype),
 	m_propname(propname),
+	m_propkey(propname),
 	m_exprtxt(expr),
 	m_sourceObj(sourceObj)
 {
@@ -76,7 +77,7 @@ bool SCA_PropertyActuator::Update()
 		if (m_type==KX_ACT_PROP_LEVEL)
 		{
 			CValue* newval = new CBoolValue(false);
-			CValue* oldprop = propowner->GetProperty(m_propname);
+			CValue* oldprop = propowner->GetProperty(m_propkey);
 			if (oldprop)
 			{
 				oldprop->SetValue(newval);
@@ -96,7 +97,7 @@ bool SCA_PropertyActuator::Update()
 	{
 		/* don't use */
 		CValue* newval;
-		CValue* oldprop = propowner->GetProperty(m_propname);
+		CValue* oldprop = propowner->GetProperty(m_propkey);
 		if (oldprop)
 		{
 			newval = new CBoolValue((oldprop->GetNumber()==0.0) ? true:false);
@@ -104,20 +105,20 @@ bool SCA_PropertyActuator::Update()
 		} else
 		{	/* as not been assigned, evaluate as false, so assign true */
 			newval = new CBoolValue(true);
-			propowner->SetProperty(m_propname,newval);
+			propowner->SetProperty(m_propkey,newval);
 		}
 		newval->Release();
 	}
 	else if (m_type==KX_ACT_PROP_LEVEL)
 	{
 		CValue* newval = new CBoolValue(true);
-		CValue* oldprop = propowner->GetProperty(m_propname);
+		CValue* oldprop = propowner->GetProperty(m_propkey);
 		if (oldprop)
 		{
 			oldprop->SetValue(newval);
 		} else
 		{
-			propowner->SetProperty(m_propname,newval);
+			propowner->SetProperty(m_propkey,newval);
 		}
 		newval->Release();
 	}
@@ -129,20 +130,20 @@ bool SCA_PropertyActuator::Update()
 			{
 				
 				CValue* newval = userexpr->Calculate();
-				CValue* oldprop = propowner->GetProperty(m_propname);
+				CValue* oldprop = propowner->GetProperty(m_propkey);
 				if (oldprop)
 				{
 					oldprop->SetValue(newval);
 				} else
 				{
-					propowner->SetProperty(m_propname,newval);
+					propowner->SetProperty(m_propkey,newval);
 				}
 				newval->Release();
 				break;
 			}
 		case KX_ACT_PROP_ADD:
 			{
-				CValue* oldprop = propowner->GetProperty(m_propname);
+				CValue* oldprop = propowner->GetProperty(m_propkey);
 				if (oldprop)
 				{
 					// int waarde = (int)oldprop->GetNumber();  /*unused*/
@@ -167,7 +168,7 @@ bool SCA_PropertyActuator::Update()
 					{
 						CValue *val = copyprop->GetReplica();
 						GetParent()->SetProperty(
-							 m_propname,
+							 m_propkey,
 							 val);
 						val->Release();
 
@@ -262,12 +263,23 @@ PyTypeObject SCA_PropertyActuator::Type = {
 	py_base_new
 };
 
+int SCA_PropertyActuator::CheckPropName(PyObjectPlus *self, const PyAttributeDef *attrdef)
+{
+	if (CheckProperty(self, attrdef) != 0) {
+		return 1;
+	}
+
+	SCA_PropertyActuator *act = static_cast<SCA_PropertyActuator *>(self);
+	act->m_propkey = CPropertyKey(act->m_propname);
+	return 0;
+}
+
 PyMethodDef SCA_PropertyActuator::Methods[] = {
 	{nullptr,nullptr} //Sentinel
 };
 
 PyAttributeDef SCA_PropertyActuator::Attributes[] = {
-	KX_PYATTRIBUTE_STRING_RW_CHECK("propName",0,MAX_PROP_NAME,false,SCA_PropertyActuator,m_propname,CheckProperty),
+	KX_PYATTRIBUTE_STRING_RW_CHECK("propName",0,MAX_PROP_NAME,false,SCA_PropertyActuator,m_propname,CheckPropName),
 	KX_PYATTRIBUTE_STRING_RW("value",0,100,false,SCA_PropertyActuator,m_exprtxt),
 	KX_PYATTRIBUTE_INT_RW("mode", KX_ACT_PROP_NODEF+1, KX_ACT_PROP_MAX-1, false, SCA_PropertyActuator, m_type), /* ATTR_TODO add constents to game logic dict */
 	KX_PYATTRIBUTE_NULL	//Sentinel
@@ -50,6 +50,8 @@ class SCA_PropertyActuator : public SCA_IActuator
 
 	int			m_type;
 	std::string	m_propname;
+	/// Key of m_propname, resolved at construction and when the name is changed from python.
+	CPropertyKey m_propkey;
 	std::string	m_exprtxt;
 	SCA_IObject* m_sourceObj; // for copy property actuator
 
@@ -81,7 +83,11 @@ public:
 	/* --------------------------------------------------------------------- */
 	/* Python interface ---------------------------------------------------- */
 	/* --------------------------------------------------------------------- */
-	
+
+#ifdef WITH_PYTHON
+	/// Check the property name and update its key.
+	static int CheckPropName(PyObjectPlus *self, const PyAttributeDef *attrdef);
+#endif  // WITH_PYTHON
 };
 
 #endif  /* __KX_PROPERTYACTUATOR_DOC */
@@ -58,16 +58,44 @@ SCA_PropertySensor::SCA_PropertySensor(SCA_EventManager* eventmgr,
 	//pars.SetContext(this->AddRef());
 	//CValue* resultval = m_rightexpr->Calculate();
 
-	CValue* orgprop = GetParent()->FindIdentifier(m_checkpropname);
-	if (!orgprop->IsError())
+	UpdatePropertyKey();
+
+	CValue* orgprop = FindProperty();
+	if (orgprop)
 	{
 		m_previoustext = orgprop->GetText();
+		orgprop->Release();
 	}
-	orgprop->Release();
 
 	Init();
 }
 
+void SCA_PropertySensor::UpdatePropertyKey()
+{
+	// Sub properties are found by name with FindIdentifier.
+	if (m_checkpropname.find('.') == std::string::npos) {
+		m_checkpropkey = CPropertyKey(m_checkpropname);
+	}
+	else {
+		m_checkpropkey = CPropertyKey();
+	}
+}
+
+CValue *SCA_PropertySensor::FindProperty()
+{
+	if (m_checkpropkey.IsValid()) {
+		CValue *prop = GetParent()->GetProperty(m_checkpropkey);
+		return prop ? prop->AddRef() : nullptr;
+	}
+
+	CValue *prop = GetParent()->FindIdentifier(m_checkpropname);
+	if (prop->IsError()) {
+		prop->Release();
+		return nullptr;
+	}
+	return prop;
+}
+
 void SCA_PropertySensor::Init()
 {
 	m_recentresult = false;
@@ -131,8 +159,8 @@ bool	SCA_PropertySensor::CheckPropertyCondition()
 		ATTR_FALLTHROUGH;
 	case KX_PROPSENSOR_EQUAL:
 		{
-			CValue* orgprop = GetParent()->FindIdentifier(m_checkpropname);
-			if (!orgprop->IsError())
+			CValue* orgprop = FindProperty();
+			if (orgprop)
 			{
 				const std::string& testprop = orgprop->GetText();
 				// Force strings to upper case, to avoid confusion in
@@ -153,8 +181,8 @@ bool	SCA_PropertySensor::CheckPropertyCondition()
 					}
 				}
 				/* end patch */
+				orgprop->Release();
 			}
-			orgprop->Release();
 
 			if (reverse)
 				result = !result;
@@ -168,8 +196,8 @@ bool	SCA_PropertySensor::CheckPropertyCondition()
 		}
 	case KX_PROPSENSOR_INTERVAL:
 		{
-			CValue* orgprop = GetParent()->FindIdentifier(m_checkpropname);
-			if (!orgprop->IsError())
+			CValue* orgprop = FindProperty();
+			if (orgprop)
 			{
 				float min;
 				float max;
@@ -185,24 +213,24 @@ bool	SCA_PropertySensor::CheckPropertyCondition()
 				}
 
 				result = (min <= val) && (val <= max);
+				orgprop->Release();
 			}
-			orgprop->Release();
 
 		break;
 		}
 	case KX_PROPSENSOR_CHANGED:
 		{
-			CValue* orgprop = GetParent()->FindIdentifier(m_checkpropname);
+			CValue* orgprop = FindProperty();
 				
-			if (!orgprop->IsError())
+			if (orgprop)
 			{
 				if (m_previoustext != orgprop->GetText())
 				{
 					m_previoustext = orgprop->GetText();
 					result = true;
 				}
+				orgprop->Release();
 			}
-			orgprop->Release();
 
 			break;
 		}
@@ -211,8 +239,8 @@ bool	SCA_PropertySensor::CheckPropertyCondition()
 		ATTR_FALLTHROUGH;
 	case KX_PROPSENSOR_GREATERTHAN:
 		{
-			CValue* orgprop = GetParent()->FindIdentifier(m_checkpropname);
-			if (!orgprop->IsError())
+			CValue* orgprop = FindProperty();
+			if (orgprop)
 			{
 				float ref;
 				CM_StringTo(m_checkpropval, ref);
@@ -232,8 +260,8 @@ bool	SCA_PropertySensor::CheckPropertyCondition()
 					result = val > ref;
 				}
 
+				orgprop->Release();
 			}
-			orgprop->Release();
 
 			break;
 		}
@@ -269,6 +297,16 @@ int SCA_PropertySensor::validValueForProperty(PyObjectPlus *self, const PyAttrib
 	return 0;
 }
 
+int SCA_PropertySensor::CheckPropName(PyObjectPlus *self, const PyAttributeDef *attrdef)
+{
+	if (CheckProperty(self, attrdef) != 0) {
+		return 1;
+	}
+
+	static_cast<SCA_PropertySensor *>(self)->UpdatePropertyKey();
+	return 0;
+}
+
 /* Integration hooks ------------------------------------------------------- */
 PyTypeObject SCA_PropertySensor::Type = {
 	PyVarObject_HEAD_INIT(nullptr, 0)
@@ -298,7 +336,7 @@ PyMethodDef SCA_PropertySensor::Methods[] = {
 
 PyAttributeDef SCA_PropertySensor::Attributes[] = {
 	KX_PYATTRIBUTE_INT_RW("mode",KX_PROPSENSOR_NODEF,KX_PROPSENSOR_MAX-1,false,SCA_PropertySensor,m_checktype),
-	KX_PYATTRIBUTE_STRING_RW_CHECK("propName",0,MAX_PROP_NAME,false,SCA_PropertySensor,m_checkpropname,CheckProperty),
+	KX_PYATTRIBUTE_STRING_RW_CHECK("propName",0,MAX_PROP_NAME,false,SCA_PropertySensor,m_checkpropname,CheckPropName),
 	KX_PYATTRIBUTE_STRING_RW_CHECK("value",0,100,false,SCA_PropertySensor,m_checkpropval,validValueForProperty),
 	KX_PYATTRIBUTE_STRING_RW_CHECK("min",0,100,false,SCA_PropertySensor,m_checkpropval,validValueForProperty),
 	KX_PYATTRIBUTE_STRING_RW_CHECK("max",0,100,false,SCA_PropertySensor,m_checkpropmaxval,validValueForProperty),
@@ -43,6 +43,8 @@ class SCA_PropertySensor : public SCA_ISensor
 	std::string		m_checkpropval;
 	std::string		m_checkpropmaxval;
 	std::string		m_checkpropname;
+	/// Key of m_checkpropname, invalid if the name refers to a sub property ("prop.sub").
+	CPropertyKey	m_checkpropkey;
 	std::string		m_previoustext;
 	bool			m_lastresult;
 	bool			m_recentresult;
@@ -75,6 +77,10 @@ public:
 	virtual CValue* GetReplica();
 	virtual void Init();
 	bool	CheckPropertyCondition();
+	/// Return a new reference to the checked property, nullptr if not found.
+	CValue *FindProperty();
+	/// Resolve the key of m_checkpropname.
+	void UpdatePropertyKey();
 
 	virtual bool Evaluate();
 	virtual bool	IsPositiveTrigger();
@@ -90,6 +96,8 @@ public:
 	 * Test whether this is a sensible value (type check)
 	 */
 	static int validValueForProperty(PyObjectPlus *self, const PyAttributeDef*);
+	/// Check the property name and update its key.
+	static int CheckPropName(PyObjectPlus *self, const PyAttributeDef *attrdef);
 
 #endif
 };
@@ -56,6 +56,7 @@ SCA_RandomActuator::SCA_RandomActuator(SCA_IObject *gameobj,
                                        const std::string &propName)
     : SCA_IActuator(gameobj, KX_ACT_RANDOM),
       m_propname(propName),
+      m_propkey(propName),
 	  m_parameter1(para1),
 	  m_parameter2(para2),
 	  m_distribution(mode)
@@ -244,7 +245,7 @@ bool SCA_RandomActuator::Update()
 	}
 
 	/* Round up: assign it */
-	CValue *prop = GetParent()->GetProperty(m_propname);
+	CValue *prop = GetParent()->GetProperty(m_propkey);
 	if (prop) {
 		prop->SetValue(tmpval);
 	}
@@ -348,7 +349,7 @@ PyAttributeDef SCA_RandomActuator::Attributes[] = {
 	KX_PYATTRIBUTE_FLOAT_RO("para1",SCA_RandomActuator,m_parameter1),
 	KX_PYATTRIBUTE_FLOAT_RO("para2",SCA_RandomActuator,m_parameter2),
 	KX_PYATTRIBUTE_ENUM_RO("distribution",SCA_RandomActuator,m_distribution),
-	KX_PYATTRIBUTE_STRING_RW_CHECK("propName",0,MAX_PROP_NAME,false,SCA_RandomActuator,m_propname,CheckProperty),
+	KX_PYATTRIBUTE_STRING_RW_CHECK("propName",0,MAX_PROP_NAME,false,SCA_RandomActuator,m_propname,CheckPropName),
 	KX_PYATTRIBUTE_RW_FUNCTION("seed",SCA_RandomActuator,pyattr_get_seed,pyattr_set_seed),
 	KX_PYATTRIBUTE_NULL	//Sentinel
 };
@@ -372,6 +373,17 @@ int SCA_RandomActuator::pyattr_set_seed(PyObjectPlus *self, const struct KX_PYAT
 	}
 }
 
+int SCA_RandomActuator::CheckPropName(PyObjectPlus *self, const PyAttributeDef *attrdef)
+{
+	if (CheckProperty(self, attrdef) != 0) {
+		return 1;
+	}
+
+	SCA_RandomActuator *act = static_cast<SCA_RandomActuator *>(self);
+	act->m_propkey = CPropertyKey(act->m_propname);
+	return 0;
+}
+
 /* 11. setBoolConst */
 KX_PYMETHODDEF_DOC_VARARGS(SCA_RandomActuator, setBoolConst,
 "setBoolConst(value)\n"
@@ -41,6 +41,8 @@ class SCA_RandomActuator : public SCA_IActuator
 	Py_Header
 	/** Property to assign to */
 	std::string m_propname;
+	/** Key of m_propname */
+	CPropertyKey m_propkey;
 	
 	/** First parameter. The meaning of the parameters depends on the        
 	 *  distribution */
@@ -101,6 +103,9 @@ class SCA_RandomActuator : public SCA_IActuator
 	static PyObject *pyattr_get_seed(PyObjectPlus *self, const struct KX_PYATTRIBUTE_DEF *attrdef);
 	static int pyattr_set_seed(PyObjectPlus *self, const struct KX_PYATTRIBUTE_DEF *attrdef, PyObject *value);
 
+	/// Check the property name and update its key.
+	static int CheckPropName(PyObjectPlus *self, const PyAttributeDef *attrdef);
+
 	KX_PYMETHOD_DOC_VARARGS(SCA_RandomActuator, setBoolConst);
 	KX_PYMETHOD_DOC_NOARGS(SCA_RandomActuator, setBoolUniform);
 	KX_PYMETHOD_DOC_VARARGS(SCA_RandomActuator, setBoolBernouilli);
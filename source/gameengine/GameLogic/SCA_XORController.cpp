@@ -46,6 +46,7 @@ SCA_XORController::SCA_XORController(SCA_IObject* gameobj)
 	:
 	SCA_IController(gameobj)
 {
+	m_logicOperation = LOGIC_XOR;
 }
 
 
@@ -58,30 +59,7 @@ SCA_XORController::~SCA_XORController()
 
 void SCA_XORController::Trigger(SCA_LogicManager* logicmgr)
 {
-
-	bool sensorresult = false;
-
-	for (std::vector<SCA_ISensor*>::const_iterator is=m_linkedsensors.begin();
-	     !(is==m_linkedsensors.end());is++)
-	{
-		SCA_ISensor* sensor = *is;
-		if (sensor->GetState())
-		{
-			if (sensorresult == true)
-			{
-				sensorresult = false;
-				break;
-			}
-			sensorresult = true;
-		}
-	}
-	
-	for (std::vector<SCA_IActuator*>::const_iterator i=m_linkedactuators.begin();
-	     !(i==m_linkedactuators.end());i++)
-	{
-		SCA_IActuator* actua = *i;
-		logicmgr->AddActiveActuator(actua,sensorresult);
-	}
+	ActivateActuators(logicmgr, CalculateLogicOperation());
 }
 
 
@@ -125,6 +125,7 @@ extern "C"
 #include <boost/algorithm/string.hpp>
 
 #include "CM_Message.h"
+#include "CM_Profiler.h"
 
 const int kMinWindowWidth = 100;
 const int kMinWindowHeight = 100;
@@ -496,7 +497,12 @@ static void usage(const std::string& program, bool isBlenderPlayer)
 	CM_Message("       show_camera_frustum            0         Show debug camera frustum volume");
 	CM_Message("       show_shadow_frustum            0         Show debug light shadow frustum volume");
 	CM_Message("       ignore_deprecation_warnings    1         Ignore deprecation warnings" << std::endl);
-	CM_Message("  -p: override python main loop script");
+	CM_Message("  -p: override python main loop script" << std::endl);
+	CM_Message("  -t: write a profiler trace of the last frames at exit");
+	CM_Message("       --Optional parameters--");
+	CM_Message("       file   = Chrome trace event file (chrome://tracing)");
+	CM_Message("       frames = number of frames recorded (default: 300)");
+	CM_Message("       Example: -t trace.json  or  -t trace.json 60");
 	CM_Message(std::endl);
 	CM_Message("  - : all arguments after this are ignored, allowing python to access them from sys.argv");
 	CM_Message(std::endl);
@@ -665,6 +671,8 @@ int main(
 	int validArguments=0;
 	bool samplesParFound = false;
 	std::string pythonControllerFile;
+	std::string profileTraceFile;
+	unsigned int profileTraceFrames = 300;
 	GHOST_TUns16 aasamples = 0;
 	int alphaBackground = 0;
 	
@@ -1078,6 +1086,21 @@ int main(
 				pythonControllerFile = argv[i++];
 				break;
 			}
+			case 't': // write a profiler trace of the last frames
+			{
+				++i;
+				if ((i + 1) <= validArguments) {
+					profileTraceFile = argv[i++];
+					if ((i + 1) <= validArguments && argv[i][0] != '-') {
+						profileTraceFrames = atoi(argv[i++]);
+					}
+				}
+				else {
+					error = true;
+					CM_Error("no file supplied for -t");
+				}
+				break;
+			}
 			default:  //not recognized
 			{
 				CM_Warning("unknown argument: " << argv[i++]);
@@ -1103,6 +1126,10 @@ int main(
 		return 0;
 	}
 
+	if (!profileTraceFile.empty()) {
+		CM_Profiler::Enable(profileTraceFrames);
+	}
+
 #ifdef WIN32
 	if (scr_saver_mode != SCREEN_SAVER_MODE_CONFIGURATION)
 #endif
@@ -1411,6 +1438,11 @@ int main(
 						G.main = nullptr;
 					}
 				} while (!quitGame(exitcode));
+
+				if (!profileTraceFile.empty()) {
+					CM_Profiler::WriteChromeTrace(profileTraceFile);
+					CM_Profiler::Disable();
+				}
 			}
 
 			GPU_exit();
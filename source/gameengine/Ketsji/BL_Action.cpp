@@ -63,6 +63,7 @@ BL_Action::BL_Action(class KX_GameObject* gameobj)
 :
 	m_action(nullptr),
 	m_tmpaction(nullptr),
+	m_actionData(nullptr),
 	m_blendpose(nullptr),
 	m_blendinpose(nullptr),
 	m_obj(gameobj),
@@ -99,6 +100,19 @@ BL_Action::~BL_Action()
 	}
 }
 
+static BL_ActionData *GetActionData(bAction *action, KX_Scene *scene)
+{
+	KX_BlenderConverter *converter = KX_GetActiveEngine()->GetConverter();
+	BL_ActionData *data = converter->FindActionData(scene, action);
+
+	if (!data) {
+		data = new BL_ActionData(action, KX_GetActiveEngine()->GetActionSampleRate());
+		converter->RegisterActionData(scene, data, action);
+	}
+
+	return data;
+}
+
 void BL_Action::ClearControllerList()
 {
 	// Clear out the controller list
@@ -152,12 +166,16 @@ bool BL_Action::Play(const std::string& name,
 			&& m_priority == priority && m_speed == playback_speed)
 		return false;
 
-	// Keep a copy of the action for threading purposes
+	m_actionData = GetActionData(m_action, kxscene);
+
+	// Keep a copy of the action for threading purposes, unless all the curves are sampled.
 	if (m_tmpaction) {
 		BKE_libblock_free(G.main, m_tmpaction);
 		m_tmpaction = nullptr;
 	}
-	m_tmpaction = BKE_action_copy(G.main, m_action);
+	if (!m_actionData->IsSampled()) {
+		m_tmpaction = BKE_action_copy(G.main, m_action);
+	}
 
 	// First get rid of any old controllers
 	ClearControllerList();
@@ -220,10 +238,15 @@ bool BL_Action::Play(const std::string& name,
 	InitIPO();
 
 	// Setup blendin shapes/poses
+	m_actionSlots.clear();
 	if (m_obj->GetGameObjectType() == SCA_IObject::OBJ_ARMATURE)
 	{
 		BL_ArmatureObject *obj = (BL_ArmatureObject*)m_obj;
 		obj->GetPose(&m_blendinpose);
+
+		if (m_actionData->IsResolved()) {
+			m_actionData->Bind(obj->GetArmatureObject()->pose, nullptr, m_tmpaction, m_actionSlots);
+		}
 	}
 	else
 	{
@@ -232,6 +255,10 @@ bool BL_Action::Play(const std::string& name,
 		
 		if (shape_deformer && shape_deformer->GetKey())
 		{
+			if (m_actionData->IsResolved()) {
+				m_actionData->Bind(nullptr, shape_deformer->GetKey(), m_tmpaction, m_actionSlots);
+			}
+
 			obj->GetShape(m_blendinshape);
 
 			// Now that we have the previous blend shape saved, we can clear out the key to avoid any
@@ -428,7 +455,12 @@ void BL_Action::Update(float curtime, bool applyToObject)
 			obj->GetPose(&m_blendpose);
 
 		// Extract the pose from the action
-		obj->SetPoseByAction(m_tmpaction, m_localframe);
+		if (m_actionData->IsResolved()) {
+			m_actionData->Evaluate(m_actionSlots, m_localframe);
+		}
+		else {
+			obj->SetPoseByAction(m_tmpaction, m_localframe);
+		}
 
 		// Handle blending between armature actions
 		if (m_blendin && m_blendframe<m_blendin)
@@ -459,10 +491,15 @@ void BL_Action::Update(float curtime, bool applyToObject)
 		{
 			Key *key = shape_deformer->GetKey();
 
-			PointerRNA ptrrna;
-			RNA_id_pointer_create(&key->id, &ptrrna);
+			if (m_actionData->IsResolved()) {
+				m_actionData->Evaluate(m_actionSlots, m_localframe);
+			}
+			else {
+				PointerRNA ptrrna;
+				RNA_id_pointer_create(&key->id, &ptrrna);
 
-			animsys_evaluate_action(&ptrrna, m_tmpaction, nullptr, m_localframe);
+				animsys_evaluate_action(&ptrrna, m_tmpaction, nullptr, m_localframe);
+			}
 
 			// Handle blending between shape actions
 			if (m_blendin && m_blendframe < m_blendin)
@@ -30,11 +30,17 @@
 #include <string>
 #include <vector>
 
+#include "BL_ActionData.h"
+
 class BL_Action
 {
 private:
 	struct bAction* m_action;
 	struct bAction* m_tmpaction;
+	/// The compiled action, shared by the objects of the scene.
+	BL_ActionData *m_actionData;
+	/// The compiled action curves bound to the pose or the shape key of the object.
+	std::vector<BL_ActionData::Slot> m_actionSlots;
 	struct bPose* m_blendpose;
 	struct bPose* m_blendinpose;
 	std::vector<class SG_Controller*> m_sg_contr_list;
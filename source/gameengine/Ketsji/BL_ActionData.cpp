@@ -0,0 +1,320 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file gameengine/Ketsji/BL_ActionData.cpp
+ *  \ingroup ketsji
+ */
+
+#include "BL_ActionData.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+
+extern "C" {
+#include "DNA_action_types.h"
+#include "DNA_anim_types.h"
+#include "DNA_curve_types.h"
+#include "DNA_key_types.h"
+#include "BKE_action.h"
+#include "BKE_fcurve.h"
+#include "BLI_listbase.h"
+#include "BLI_string.h"
+}
+
+#include "MEM_guardedalloc.h"
+
+/// Properties of the pose channels animated by the actions.
+static const struct {
+	const char *m_name;
+	BL_ActionData::Property m_property;
+	int m_size;
+} channelProperties[] = {
+	{"location", BL_ActionData::PROP_LOCATION, 3},
+	{"rotation_euler", BL_ActionData::PROP_ROTATION_EULER, 3},
+	{"rotation_quaternion", BL_ActionData::PROP_ROTATION_QUATERNION, 4},
+	{"rotation_axis_angle", BL_ActionData::PROP_ROTATION_AXIS_ANGLE, 4},
+	{"scale", BL_ActionData::PROP_SCALE, 3}
+};
+
+/** Resolve the RNA path of a curve.
+ * \param skip Set to true if the curve animates an array element out of range and is ignored.
+ * \return False if the path is not supported.
+ */
+static bool resolvePath(FCurve *fcu, BL_ActionData::Curve& curve, bool& skip)
+{
+	const std::string path = fcu->rna_path;
+	const char *prefix;
+	if (path.compare(0, 12, "pose.bones[\"") == 0) {
+		prefix = "pose.bones[";
+	}
+	else if (path.compare(0, 12, "key_blocks[\"") == 0) {
+		prefix = "key_blocks[";
+	}
+	else {
+		return false;
+	}
+
+	const size_t pos = path.rfind("\"].");
+	if (pos == std::string::npos) {
+		return false;
+	}
+
+	char *name = BLI_str_quoted_substrN(fcu->rna_path, prefix);
+	if (!name) {
+		return false;
+	}
+	curve.m_name = name;
+	MEM_freeN(name);
+
+	const std::string propname = path.substr(pos + 3);
+	curve.m_arrayIndex = fcu->array_index;
+	skip = false;
+
+	if (prefix[0] == 'k') {
+		curve.m_property = BL_ActionData::PROP_SHAPE_VALUE;
+		return (propname == "value");
+	}
+
+	for (const auto& prop : channelProperties) {
+		if (propname == prop.m_name) {
+			curve.m_property = prop.m_property;
+			skip = (curve.m_arrayIndex < 0 || curve.m_arrayIndex >= prop.m_size);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+BL_ActionData::BL_ActionData(bAction *action, float sampleRate)
+	:m_action(action),
+	m_sampleRate(sampleRate),
+	m_resolved(true),
+	m_sampled(true)
+{
+	unsigned int index = 0;
+	for (FCurve *fcu = (FCurve *)action->curves.first; fcu; fcu = fcu->next, ++index) {
+		// Same tests as the animation system.
+		if ((fcu->grp && (fcu->grp->flag & AGRP_MUTED)) || (fcu->flag & (FCURVE_MUTED | FCURVE_DISABLED)) || !fcu->rna_path) {
+			continue;
+		}
+
+		// Drivers need the RNA.
+		if (fcu->driver) {
+			m_resolved = false;
+			break;
+		}
+
+		Curve curve;
+		bool skip;
+		if (!resolvePath(fcu, curve, skip)) {
+			m_resolved = false;
+			break;
+		}
+
+		if (skip) {
+			continue;
+		}
+
+		curve.m_index = index;
+		curve.m_firstSample = -1;
+		curve.m_numSamples = 0;
+		curve.m_startFrame = 0.0f;
+
+		if (m_sampleRate > 0.0f && IsSampleable(fcu)) {
+			float start, end;
+			calc_fcurve_range(fcu, &start, &end, false, false);
+
+			curve.m_firstSample = m_samples.size();
+			curve.m_numSamples = (unsigned int)std::ceil((end - start) * m_sampleRate) + 1;
+			curve.m_startFrame = start;
+			for (unsigned int i = 0; i < curve.m_numSamples; ++i) {
+				m_samples.push_back(EvaluateCurve(fcu, start + (float)i / m_sampleRate));
+			}
+		}
+		else {
+			m_sampled = false;
+		}
+
+		m_curves.push_back(curve);
+	}
+
+	if (!m_resolved) {
+		m_curves.clear();
+		m_samples.clear();
+		m_sampled = false;
+	}
+}
+
+BL_ActionData::~BL_ActionData()
+{
+}
+
+bool BL_ActionData::IsSampleable(FCurve *fcu)
+{
+	/* The modifiers and the extrapolation can change the values out of the sampled range
+	 * and constant interpolations can't be linearly interpolated. */
+	if (fcu->totvert == 0 || fcu->modifiers.first || fcu->extend != FCURVE_EXTRAPOLATE_CONSTANT) {
+		return false;
+	}
+
+	if (fcu->bezt) {
+		for (unsigned int i = 0; i < fcu->totvert; ++i) {
+			if (fcu->bezt[i].ipo == BEZT_IPO_CONST) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+float BL_ActionData::EvaluateCurve(FCurve *fcu, float frame)
+{
+	// Same as calculate_fcurve without driver.
+	if (fcu->totvert || list_has_suitable_fmodifier(&fcu->modifiers, 0, FMI_TYPE_GENERATE_CURVE)) {
+		return evaluate_fcurve(fcu, frame);
+	}
+	return 0.0f;
+}
+
+float BL_ActionData::GetSample(const Curve& curve, float frame) const
+{
+	const float *samples = &m_samples[curve.m_firstSample];
+	const float pos = (frame - curve.m_startFrame) * m_sampleRate;
+
+	if (pos <= 0.0f) {
+		return samples[0];
+	}
+
+	const unsigned int last = curve.m_numSamples - 1;
+	if (pos >= (float)last) {
+		return samples[last];
+	}
+
+	const unsigned int index = (unsigned int)pos;
+	const float fac = pos - (float)index;
+	return samples[index] + (samples[index + 1] - samples[index]) * fac;
+}
+
+bAction *BL_ActionData::GetAction() const
+{
+	return m_action;
+}
+
+bool BL_ActionData::IsResolved() const
+{
+	return m_resolved;
+}
+
+bool BL_ActionData::IsSampled() const
+{
+	return m_sampled;
+}
+
+void BL_ActionData::Bind(bPose *pose, Key *key, bAction *action, std::vector<Slot>& slots) const
+{
+	slots.clear();
+
+	std::vector<FCurve *> fcurves;
+	if (action) {
+		for (FCurve *fcu = (FCurve *)action->curves.first; fcu; fcu = fcu->next) {
+			fcurves.push_back(fcu);
+		}
+	}
+
+	for (const Curve& curve : m_curves) {
+		Slot slot;
+		slot.m_curve = &curve;
+		slot.m_fcurve = (curve.m_firstSample == -1) ? fcurves[curve.m_index] : nullptr;
+		slot.m_min = -FLT_MAX;
+		slot.m_max = FLT_MAX;
+
+		if (curve.m_property == PROP_SHAPE_VALUE) {
+			if (!key) {
+				continue;
+			}
+
+			KeyBlock *kb = (KeyBlock *)BLI_findstring(&key->block, curve.m_name.c_str(), offsetof(KeyBlock, name));
+			if (!kb) {
+				continue;
+			}
+
+			slot.m_value = &kb->curval;
+			slot.m_min = kb->slidermin;
+			slot.m_max = kb->slidermax;
+		}
+		else {
+			if (!pose) {
+				continue;
+			}
+
+			bPoseChannel *pchan = BKE_pose_channel_find_name(pose, curve.m_name.c_str());
+			if (!pchan) {
+				continue;
+			}
+
+			switch (curve.m_property) {
+				case PROP_LOCATION:
+				{
+					slot.m_value = &pchan->loc[curve.m_arrayIndex];
+					break;
+				}
+				case PROP_ROTATION_EULER:
+				{
+					slot.m_value = &pchan->eul[curve.m_arrayIndex];
+					break;
+				}
+				case PROP_ROTATION_QUATERNION:
+				{
+					slot.m_value = &pchan->quat[curve.m_arrayIndex];
+					break;
+				}
+				case PROP_ROTATION_AXIS_ANGLE:
+				{
+					// The RNA array is the angle followed by the axis.
+					slot.m_value = (curve.m_arrayIndex == 0) ? &pchan->rotAngle : &pchan->rotAxis[curve.m_arrayIndex - 1];
+					break;
+				}
+				case PROP_SCALE:
+				{
+					slot.m_value = &pchan->size[curve.m_arrayIndex];
+					break;
+				}
+				default:
+				{
+					continue;
+				}
+			}
+		}
+
+		slots.push_back(slot);
+	}
+}
+
+void BL_ActionData::Evaluate(const std::vector<Slot>& slots, float frame) const
+{
+	for (const Slot& slot : slots) {
+		const float value = (slot.m_fcurve) ? EvaluateCurve(slot.m_fcurve, frame) : GetSample(*slot.m_curve, frame);
+		*slot.m_value = std::min(std::max(value, slot.m_min), slot.m_max);
+	}
+}
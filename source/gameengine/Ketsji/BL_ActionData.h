@@ -0,0 +1,126 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file BL_ActionData.h
+ *  \ingroup ketsji
+ */
+
+#ifndef __BL_ACTIONDATA_H__
+#define __BL_ACTIONDATA_H__
+
+#include <string>
+#include <vector>
+
+struct bAction;
+struct bPose;
+struct Key;
+struct FCurve;
+
+/** \brief Compiled action shared by all the objects playing it.
+ *
+ * The RNA paths of the action F-curves animating pose channels and shape keys are
+ * resolved to a channel name and property once, an object playing the action binds
+ * them to its own values and writes them without any RNA lookup. The curves can be
+ * also pre-sampled at a fixed rate and looked up with a linear interpolation.
+ */
+class BL_ActionData
+{
+public:
+	/// Property animated by a curve.
+	enum Property {
+		PROP_LOCATION = 0,
+		PROP_ROTATION_EULER,
+		PROP_ROTATION_QUATERNION,
+		PROP_ROTATION_AXIS_ANGLE,
+		PROP_SCALE,
+		PROP_SHAPE_VALUE
+	};
+
+	/// A resolved curve of the action.
+	struct Curve
+	{
+		/// Index of the F-curve in the action.
+		unsigned int m_index;
+		/// Name of the pose channel or of the key block.
+		std::string m_name;
+		Property m_property;
+		int m_arrayIndex;
+		/// Index of the first sample, -1 if the curve is evaluated without sampling.
+		int m_firstSample;
+		unsigned int m_numSamples;
+		/// Frame of the first sample.
+		float m_startFrame;
+	};
+
+	/// A curve bound to the value of an object.
+	struct Slot
+	{
+		const Curve *m_curve;
+		/// F-curve evaluated when the curve is not sampled.
+		FCurve *m_fcurve;
+		float *m_value;
+		float m_min;
+		float m_max;
+	};
+
+private:
+	bAction *m_action;
+	std::vector<Curve> m_curves;
+	std::vector<float> m_samples;
+	/// Number of samples per frame, zero to disable sampling.
+	float m_sampleRate;
+	/// False if some curves can't be resolved, the action must be then evaluated by the animation system.
+	bool m_resolved;
+	/// True if all the curves are sampled.
+	bool m_sampled;
+
+	/// Return true if the curve values are the same between the samples and the F-curve.
+	static bool IsSampleable(FCurve *fcu);
+	static float EvaluateCurve(FCurve *fcu, float frame);
+
+	float GetSample(const Curve& curve, float frame) const;
+
+public:
+	/** Compile an action.
+	 * \param sampleRate The number of samples per frame, zero to disable sampling.
+	 */
+	BL_ActionData(bAction *action, float sampleRate);
+	~BL_ActionData();
+
+	bAction *GetAction() const;
+	/// Return true if the action can be evaluated with slots.
+	bool IsResolved() const;
+	/** Return true if all the curves are sampled, the slots then don't use the F-curves
+	 * of the action given to Bind.
+	 */
+	bool IsSampled() const;
+
+	/** Bind the curves to the values of a pose and of a shape key.
+	 * \param pose The pose animated by the action, can be nullptr.
+	 * \param key The shape key animated by the action, can be nullptr.
+	 * \param action The action owning the F-curves evaluated when the curves are not sampled,
+	 * a copy of the compiled action.
+	 */
+	void Bind(bPose *pose, Key *key, bAction *action, std::vector<Slot>& slots) const;
+	/// Write the action values at a frame in the bound values.
+	void Evaluate(const std::vector<Slot>& slots, float frame) const;
+};
+
+#endif  // __BL_ACTIONDATA_H__
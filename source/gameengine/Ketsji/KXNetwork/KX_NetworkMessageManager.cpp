@@ -31,58 +31,231 @@
  */
 
 #include "KX_NetworkMessageManager.h"
-#include <iostream>
+
+#include <algorithm>
+
+/// Number of names under which the name tables are never rebuilt.
+static const unsigned int MIN_PRUNED_KEYS = 1024;
+
+/// Order the messages by receiver and subject, the messages of a receiver are contiguous.
+static bool messageLess(const KX_NetworkMessageManager::Message& m1, const KX_NetworkMessageManager::Message& m2)
+{
+	return (m1.to < m2.to) || (m1.to == m2.to && m1.subject < m2.subject);
+}
+
+KX_NetworkMessageManager::MessageView::MessageView()
+	:m_manager(nullptr)
+{
+	m_ranges[0][0] = m_ranges[0][1] = m_ranges[1][0] = m_ranges[1][1] = 0;
+}
+
+KX_NetworkMessageManager::MessageView::MessageView(const KX_NetworkMessageManager *manager,
+		const std::shared_ptr<MessageBuffer>& buffer, const unsigned int ranges[2][2])
+	:m_manager(manager),
+	m_buffer(buffer)
+{
+	for (unsigned short i = 0; i < 2; ++i) {
+		m_ranges[i][0] = ranges[i][0];
+		m_ranges[i][1] = ranges[i][1];
+	}
+}
+
+unsigned int KX_NetworkMessageManager::MessageView::GetSize() const
+{
+	return (m_ranges[0][1] - m_ranges[0][0]) + (m_ranges[1][1] - m_ranges[1][0]);
+}
+
+const KX_NetworkMessageManager::Message& KX_NetworkMessageManager::MessageView::GetMessageAt(unsigned int index) const
+{
+	const unsigned int firstSize = m_ranges[0][1] - m_ranges[0][0];
+	if (index < firstSize) {
+		return m_buffer->m_messages[m_ranges[0][0] + index];
+	}
+	return m_buffer->m_messages[m_ranges[1][0] + index - firstSize];
+}
+
+std::string KX_NetworkMessageManager::MessageView::GetBody(unsigned int index) const
+{
+	const Message& message = GetMessageAt(index);
+	if (message.bodySize == 0) {
+		return std::string();
+	}
+	return std::string(&m_buffer->m_bodies[message.bodyOffset], message.bodySize);
+}
+
+const std::string& KX_NetworkMessageManager::MessageView::GetSubject(unsigned int index) const
+{
+	return m_manager->GetKeyName(GetMessageAt(index).subject);
+}
 
 KX_NetworkMessageManager::KX_NetworkMessageManager()
-	:m_currentList(0)
+	:m_currentBuffer(new MessageBuffer()),
+	m_lastBuffer(new MessageBuffer()),
+	m_prunedKeysCount(0)
 {
+	m_buffers.push_back(m_currentBuffer);
+	m_buffers.push_back(m_lastBuffer);
+	// The empty name is always the first key.
+	InternKey("");
 }
 
 KX_NetworkMessageManager::~KX_NetworkMessageManager()
 {
-	ClearMessages();
 }
 
-void KX_NetworkMessageManager::AddMessage(KX_NetworkMessageManager::Message message)
+KX_NetworkMessageManager::Key KX_NetworkMessageManager::InternKey(const std::string& name)
 {
-	// Put the new message in map for the given receiver and subject.
-	m_messages[m_currentList][message.to][message.subject].push_back(message);
+	std::unordered_map<std::string, Key>::const_iterator it = m_keys.find(name);
+	if (it != m_keys.end()) {
+		return it->second;
+	}
+
+	const Key key = m_keyNames.size();
+	m_keyNames.push_back(name);
+	m_keys.emplace(name, key);
+	return key;
+}
+
+bool KX_NetworkMessageManager::FindKey(const std::string& name, Key& key) const
+{
+	std::unordered_map<std::string, Key>::const_iterator it = m_keys.find(name);
+	if (it == m_keys.end()) {
+		return false;
+	}
+
+	key = it->second;
+	return true;
 }
 
-const std::vector<KX_NetworkMessageManager::Message> KX_NetworkMessageManager::GetMessages(std::string to, std::string subject)
+void KX_NetworkMessageManager::PruneKeys()
 {
-	std::vector<KX_NetworkMessageManager::Message> messages;
+	static const Key INVALID_KEY = (Key)-1;
+
+	std::vector<Key> remap(m_keyNames.size(), INVALID_KEY);
+	std::vector<std::string> keyNames;
+	// The empty name stays the first key.
+	remap[EMPTY_KEY] = EMPTY_KEY;
+	keyNames.push_back(std::string());
 
-	// look at messages without receiver.
-	std::map<std::string, std::vector<Message> >& messagesNoReceiver = m_messages[1 - m_currentList][""];
-	std::map<std::string, std::vector<Message> >& messagesReceiver = m_messages[1 - m_currentList][to];
-	if (subject.empty()) {
-		// Add all message without receiver and subject.
-		for (std::map<std::string, std::vector<Message> >::iterator it = messagesNoReceiver.begin(), end = messagesNoReceiver.end();
-			it != end; ++it)
-		{
-			messages.insert(messages.end(), it->second.begin(), it->second.end());
+	auto remapKey = [&remap, &keyNames, this](Key& key) {
+		if (remap[key] == INVALID_KEY) {
+			remap[key] = keyNames.size();
+			keyNames.push_back(std::move(m_keyNames[key]));
 		}
-		// Add all message with the given receiver and no subject.
-		for (std::map<std::string, std::vector<Message> >::iterator it = messagesReceiver.begin(), end = messagesReceiver.end();
-			 it != end; ++it)
-		{
-			messages.insert(messages.end(), it->second.begin(), it->second.end());
+		key = remap[key];
+	};
+
+	for (const std::shared_ptr<MessageBuffer>& buffer : m_buffers) {
+		if (buffer.use_count() == 1) {
+			// Not read anymore, the buffer is cleared when reused.
+			buffer->m_messages.clear();
+			buffer->m_bodies.clear();
+			continue;
+		}
+
+		/* The order of the messages is kept for the views, only the current buffer
+		 * is sorted after and the last buffer of the previous frame is not looked up anymore. */
+		for (Message& message : buffer->m_messages) {
+			remapKey(message.to);
+			remapKey(message.subject);
 		}
 	}
-	else {
-		std::vector<KX_NetworkMessageManager::Message>& messagesNoReceiverSubject = messagesNoReceiver[subject];
-		messages.insert(messages.end(), messagesNoReceiverSubject.begin(), messagesNoReceiverSubject.end());
-		std::vector<KX_NetworkMessageManager::Message>& messagesReceiverSubject = messagesReceiver[subject];
-		messages.insert(messages.end(), messagesReceiverSubject.begin(), messagesReceiverSubject.end());
+
+	m_keyNames = std::move(keyNames);
+	m_keys.clear();
+	for (Key key = 0, size = m_keyNames.size(); key < size; ++key) {
+		m_keys.emplace(m_keyNames[key], key);
 	}
 
-	return messages;
+	m_prunedKeysCount = m_keyNames.size();
+}
+
+const std::string& KX_NetworkMessageManager::GetKeyName(Key key) const
+{
+	return m_keyNames[key];
+}
+
+void KX_NetworkMessageManager::AddMessage(const std::string& to, SCA_IObject *from, const std::string& subject,
+		const std::string& body)
+{
+	std::vector<char>& bodies = m_currentBuffer->m_bodies;
+
+	Message message;
+	message.to = InternKey(to);
+	message.from = from;
+	message.subject = InternKey(subject);
+	message.bodyOffset = bodies.size();
+	message.bodySize = body.size();
+
+	bodies.insert(bodies.end(), body.begin(), body.end());
+	m_currentBuffer->m_messages.push_back(message);
+}
+
+KX_NetworkMessageManager::MessageView KX_NetworkMessageManager::GetMessages(const std::string& to,
+		const std::string& subject) const
+{
+	unsigned int ranges[2][2] = {{0, 0}, {0, 0}};
+
+	Key subjectKey = EMPTY_KEY;
+	if (!subject.empty() && !FindKey(subject, subjectKey)) {
+		// The subject was never sent.
+		return MessageView();
+	}
+
+	const std::vector<Message>& messages = m_lastBuffer->m_messages;
+	// Look at messages without receiver and then at the messages of the given receiver.
+	Key receiverKeys[2] = {EMPTY_KEY, EMPTY_KEY};
+	const bool receiverFound = FindKey(to, receiverKeys[1]) && receiverKeys[1] != EMPTY_KEY;
+
+	for (unsigned short i = 0, num = receiverFound ? 2 : 1; i < num; ++i) {
+		Message key;
+		key.to = receiverKeys[i];
+		key.subject = subjectKey;
+
+		std::pair<std::vector<Message>::const_iterator, std::vector<Message>::const_iterator> range;
+		if (subject.empty()) {
+			// All the subjects of the receiver.
+			range = std::equal_range(messages.begin(), messages.end(), key,
+					[](const Message& m1, const Message& m2) { return m1.to < m2.to; });
+		}
+		else {
+			range = std::equal_range(messages.begin(), messages.end(), key, messageLess);
+		}
+
+		ranges[i][0] = range.first - messages.begin();
+		ranges[i][1] = range.second - messages.begin();
+	}
+
+	return MessageView(this, m_lastBuffer, ranges);
 }
 
 void KX_NetworkMessageManager::ClearMessages()
 {
-	// Clear previous list.
-	m_messages[1 - m_currentList].clear();
-	m_currentList = 1 - m_currentList;
+	/* Names sent once, e.g. generated subjects, would make the tables grow for ever.
+	 * Rebuild them before the current buffer is sorted as the keys order changes. */
+	if (m_keyNames.size() > std::max(MIN_PRUNED_KEYS, m_prunedKeysCount * 2)) {
+		PruneKeys();
+	}
+
+	// The messages of the current frame become readable, sorted for the lookups.
+	std::stable_sort(m_currentBuffer->m_messages.begin(), m_currentBuffer->m_messages.end(), messageLess);
+	m_lastBuffer = m_currentBuffer;
+
+	// Reuse a buffer referenced by nothing else than the buffer list.
+	m_currentBuffer.reset();
+	for (const std::shared_ptr<MessageBuffer>& buffer : m_buffers) {
+		if (buffer.use_count() == 1) {
+			m_currentBuffer = buffer;
+			break;
+		}
+	}
+
+	if (!m_currentBuffer) {
+		m_currentBuffer.reset(new MessageBuffer());
+		m_buffers.push_back(m_currentBuffer);
+	}
+
+	// The memory of the buffer is kept, clearing plain data is constant time.
+	m_currentBuffer->m_messages.clear();
+	m_currentBuffer->m_bodies.clear();
 }
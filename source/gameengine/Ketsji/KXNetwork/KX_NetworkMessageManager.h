@@ -36,53 +36,113 @@ conflicts with KX_NetworkMessageManager::SendMessage */
 #endif
 
 #include <string>
-#include <map>
 #include <vector>
+#include <unordered_map>
+#include <memory>
 
 class SCA_IObject;
 
 class KX_NetworkMessageManager
 {
 public:
+	/// Index of an interned receiver or subject name.
+	typedef unsigned int Key;
+
+	/// Key of the empty name, used for messages without receiver or subject.
+	static const Key EMPTY_KEY = 0;
+
 	struct Message
 	{
-		/// Receiver object(s) name.
-		std::string to;
+		/// Receiver object(s) name key.
+		Key to;
 		/// Sender game object.
 		SCA_IObject *from;
-		/// Message subject, used as filter.
-		std::string subject;
-		/// Message body.
-		std::string body;
+		/// Message subject key, used as filter.
+		Key subject;
+		/// Range of the message body in the buffer bodies.
+		unsigned int bodyOffset;
+		unsigned int bodySize;
+	};
+
+	/// Messages sent during a frame, the buffer is reused once no view references it.
+	struct MessageBuffer
+	{
+		std::vector<Message> m_messages;
+		/// Bodies of all the messages put one after the other.
+		std::vector<char> m_bodies;
+	};
+
+	/** Messages matching a receiver and a subject, the messages are not copied
+	 * but referenced in the buffer they were sent to.
+	 */
+	class MessageView
+	{
+	private:
+		const KX_NetworkMessageManager *m_manager;
+		std::shared_ptr<MessageBuffer> m_buffer;
+		/// Range of the messages without receiver and range of the messages of the receiver.
+		unsigned int m_ranges[2][2];
+
+	public:
+		MessageView();
+		MessageView(const KX_NetworkMessageManager *manager, const std::shared_ptr<MessageBuffer>& buffer,
+				const unsigned int ranges[2][2]);
+
+		unsigned int GetSize() const;
+		const Message& GetMessageAt(unsigned int index) const;
+		/// Return a copy of the body of a message.
+		std::string GetBody(unsigned int index) const;
+		const std::string& GetSubject(unsigned int index) const;
 	};
 
 private:
-	/** List of all messages, filtered by receiver object(s) name and subject name.
-	 * We use two lists, one handle sended message in the current frame and the other
-	 * is used for handle message sended in the last frame for sensors.
+	/** Interned names, the key of a name is its index. The names are never removed when
+	 * added, instead the tables are rebuilt with only the names used by the live buffers
+	 * once they grew over twice their size after the last rebuild, see PruneKeys.
 	 */
-	std::map<std::string, std::map<std::string, std::vector<Message> > > m_messages[2];
+	std::vector<std::string> m_keyNames;
+	std::unordered_map<std::string, Key> m_keys;
+	/// Number of names after the last rebuild of the tables.
+	unsigned int m_prunedKeysCount;
 
-	/** Since we use two list for the current and last frame we have to switch of
-	 * current message list each frame. This value is only 0 or 1.
+	/** Buffers of the messages sent in the current frame and of the message sent
+	 * in the last frame, read by the sensors.
 	 */
-	unsigned short m_currentList;
+	std::shared_ptr<MessageBuffer> m_currentBuffer;
+	std::shared_ptr<MessageBuffer> m_lastBuffer;
+	/// All the allocated buffers, including the ones still referenced by views.
+	std::vector<std::shared_ptr<MessageBuffer> > m_buffers;
+
+	/// Return the key of a name, adding it if needed.
+	Key InternKey(const std::string& name);
+	/// Return the key of a name, false if the name was never used.
+	bool FindKey(const std::string& name, Key& key) const;
+	/** Rebuild the name tables with only the names used by the messages of the buffers
+	 * still referenced, the keys of these messages are remapped in place. The buffers
+	 * referenced only by the buffer list are emptied as their keys become invalid.
+	 */
+	void PruneKeys();
 
 public:
 	KX_NetworkMessageManager();
 	virtual ~KX_NetworkMessageManager();
 
-	/** Add a message in the next message list.
-	 * \param message The given message to add.
+	/** Add a message in the current message list.
+	 * \param to The receiver object(s) name.
+	 * \param from The sender game object.
+	 * \param subject The message subject.
+	 * \param body The message body.
 	 */
-	void AddMessage(Message message);
-	/** Get all messages for a given receiver object name and message subject.
+	void AddMessage(const std::string& to, SCA_IObject *from, const std::string& subject, const std::string& body);
+	/** Get all messages of the last frame for a given receiver object name and message subject.
 	 * \param to The object(s) name.
-	 * \param subject The message subject/filter.
+	 * \param subject The message subject/filter, all the subjects if empty.
 	 */
-	const std::vector<Message> GetMessages(std::string to, std::string subject);
+	MessageView GetMessages(const std::string& to, const std::string& subject) const;
+
+	const std::string& GetKeyName(Key key) const;
 
-	/// Clear all messages
+	/// Make the current messages readable and start a new message list.
 	void ClearMessages();
 };
 
@@ -100,37 +100,14 @@ bool KX_NetworkMessageSensor::Evaluate()
 		m_SubjectList = nullptr;
 	}
 
-	std::string toname = GetParent()->GetName();
-	std::string& subject = this->m_subject;
+	m_messages = m_NetworkScene->FindMessages(GetParent()->GetName(), m_subject);
+	m_frame_message_count = m_messages.GetSize();
 
-	const std::vector<KX_NetworkMessageManager::Message> messages =
-	    m_NetworkScene->FindMessages(toname, subject);
-
-	m_frame_message_count = messages.size();
-
-	if (!messages.empty()) {
+	if (m_frame_message_count > 0) {
 #ifdef NAN_NET_DEBUG
 		std::cout << "KX_NetworkMessageSensor found one or more messages" << std::endl;
 #endif
 		m_IsUp = true;
-		m_BodyList = new CListValue<CStringValue>();
-		m_SubjectList = new CListValue<CStringValue>();
-	}
-
-	std::vector<KX_NetworkMessageManager::Message>::const_iterator mesit;
-	for (mesit = messages.begin(); mesit != messages.end(); mesit++) {
-		// save the body
-		const std::string& body = (*mesit).body;
-		// save the subject
-		const std::string& messub = (*mesit).subject;
-#ifdef NAN_NET_DEBUG
-		if (body) {
-			cout << "body [" << body << "]\n";
-		}
-#endif
-		m_BodyList->Add(new CStringValue(body, "body"));
-		// Store Subject
-		m_SubjectList->Add(new CStringValue(messub, "subject"));
 	}
 
 	result = (WasUp != m_IsUp);
@@ -143,6 +120,30 @@ bool KX_NetworkMessageSensor::Evaluate()
 	return result;
 }
 
+CListValue<CStringValue> *KX_NetworkMessageSensor::GetBodyList()
+{
+	if (!m_BodyList && m_frame_message_count > 0) {
+		m_BodyList = new CListValue<CStringValue>();
+		for (unsigned int i = 0, size = m_messages.GetSize(); i < size; ++i) {
+			m_BodyList->Add(new CStringValue(m_messages.GetBody(i), "body"));
+		}
+	}
+
+	return m_BodyList;
+}
+
+CListValue<CStringValue> *KX_NetworkMessageSensor::GetSubjectList()
+{
+	if (!m_SubjectList && m_frame_message_count > 0) {
+		m_SubjectList = new CListValue<CStringValue>();
+		for (unsigned int i = 0, size = m_messages.GetSize(); i < size; ++i) {
+			m_SubjectList->Add(new CStringValue(m_messages.GetSubject(i), "subject"));
+		}
+	}
+
+	return m_SubjectList;
+}
+
 /// return true for being up (no flank needed)
 bool KX_NetworkMessageSensor::IsPositiveTrigger()
 {
@@ -196,8 +197,9 @@ PyAttributeDef KX_NetworkMessageSensor::Attributes[] = {
 PyObject *KX_NetworkMessageSensor::pyattr_get_bodies(PyObjectPlus *self_v, const KX_PYATTRIBUTE_DEF *attrdef)
 {
 	KX_NetworkMessageSensor *self = static_cast<KX_NetworkMessageSensor *>(self_v);
-	if (self->m_BodyList) {
-		return self->m_BodyList->GetProxy();
+	CListValue<CStringValue> *bodies = self->GetBodyList();
+	if (bodies) {
+		return bodies->GetProxy();
 	}
 	else {
 		return (new CListValue<CStringValue>())->NewProxy(true);
@@ -207,8 +209,9 @@ PyObject *KX_NetworkMessageSensor::pyattr_get_bodies(PyObjectPlus *self_v, const
 PyObject *KX_NetworkMessageSensor::pyattr_get_subjects(PyObjectPlus *self_v, const KX_PYATTRIBUTE_DEF *attrdef)
 {
 	KX_NetworkMessageSensor *self = static_cast<KX_NetworkMessageSensor *>(self_v);
-	if (self->m_SubjectList) {
-		return self->m_SubjectList->GetProxy();
+	CListValue<CStringValue> *subjects = self->GetSubjectList();
+	if (subjects) {
+		return subjects->GetProxy();
 	}
 	else {
 		return (new CListValue<CStringValue>())->NewProxy(true);
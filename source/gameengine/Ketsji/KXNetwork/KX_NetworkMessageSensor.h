@@ -33,6 +33,7 @@
 #define __KX_NETWORKMESSAGESENSOR_H__
 
 #include "SCA_ISensor.h"
+#include "KX_NetworkMessageManager.h"
 
 class KX_NetworkMessageScene;
 class CStringValue;
@@ -53,9 +54,16 @@ class KX_NetworkMessageSensor : public SCA_ISensor
 
 	bool m_IsUp;
 
+	// The messages caught since the last frame, referenced in the message manager.
+	KX_NetworkMessageManager::MessageView m_messages;
+
+	// The lists of the bodies and subjects, created on demand from the messages.
 	CListValue<CStringValue> *m_BodyList;
 	CListValue<CStringValue> *m_SubjectList;
 
+	CListValue<CStringValue> *GetBodyList();
+	CListValue<CStringValue> *GetSubjectList();
+
 public:
 	KX_NetworkMessageSensor(
 	    SCA_EventManager *eventmgr, // our eventmanager
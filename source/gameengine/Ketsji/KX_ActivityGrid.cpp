@@ -0,0 +1,279 @@
+#include "KX_ActivityGrid.h"
+#include "KX_GameObject.h"
+
+#include <algorithm>
+
+/// Size of the cells relative to the activity radius.
+static const float activityGridCellFactor = 0.5f;
+/// Limit of the cell coordinates to avoid integer overflows with far objects.
+static const MT_Scalar activityGridMaxCoord = 1 << 30;
+
+KX_ActivityGrid::KX_ActivityGrid(KX_ActivityChangedCallback callback, void *userdata)
+	:m_camera(0.0f, 0.0f, 0.0f),
+	m_radius(0.0f),
+	m_cellSize(0.0f),
+	m_invalid(true),
+	m_callback(callback),
+	m_userdata(userdata)
+{
+}
+
+int KX_ActivityGrid::GetCellCoord(MT_Scalar coord) const
+{
+	const MT_Scalar cell = std::floor(coord / m_cellSize);
+	return (int)std::max(-activityGridMaxCoord, std::min(activityGridMaxCoord, cell));
+}
+
+KX_ActivityGrid::CellKey KX_ActivityGrid::GetCell(const MT_Vector3& pos) const
+{
+	return {GetCellCoord(pos.x()), GetCellCoord(pos.y()), GetCellCoord(pos.z())};
+}
+
+bool KX_ActivityGrid::IsInside(const MT_Vector3& pos, const MT_Vector3& camera) const
+{
+	return (fabsf(camera[0] - pos[0]) <= m_radius &&
+	        fabsf(camera[1] - pos[1]) <= m_radius &&
+	        fabsf(camera[2] - pos[2]) <= m_radius);
+}
+
+KX_ActivityGrid::CellState KX_ActivityGrid::GetCellState(const CellKey& key, const MT_Vector3& camera) const
+{
+	// The cell is enlarged to stay conservative with the rounding of the cell coordinates.
+	const MT_Scalar margin = m_cellSize * 1.0e-3f;
+	const int coords[3] = {key.m_x, key.m_y, key.m_z};
+
+	CellState state = CELL_INSIDE;
+	for (unsigned short axis = 0; axis < 3; ++axis) {
+		const MT_Scalar min = coords[axis] * m_cellSize - margin;
+		const MT_Scalar max = (coords[axis] + 1) * m_cellSize + margin;
+		if (max < (camera[axis] - m_radius) || min > (camera[axis] + m_radius)) {
+			return CELL_OUTSIDE;
+		}
+		if (min < (camera[axis] - m_radius) || max > (camera[axis] + m_radius)) {
+			state = CELL_INTERSECT;
+		}
+	}
+
+	return state;
+}
+
+void KX_ActivityGrid::InsertObject(KX_GameObject *gameobj, Entry& entry)
+{
+	entry.m_cell = GetCell(gameobj->NodeGetWorldPosition());
+	m_cells[entry.m_cell].push_back(gameobj);
+}
+
+void KX_ActivityGrid::RemoveFromCell(KX_GameObject *gameobj, const CellKey& key)
+{
+	std::unordered_map<CellKey, std::vector<KX_GameObject *>, CellKeyHash>::iterator it = m_cells.find(key);
+	if (it == m_cells.end()) {
+		return;
+	}
+
+	std::vector<KX_GameObject *>& cell = it->second;
+	std::vector<KX_GameObject *>::iterator objit = std::find(cell.begin(), cell.end(), gameobj);
+	if (objit != cell.end()) {
+		*objit = cell.back();
+		cell.pop_back();
+	}
+
+	if (cell.empty()) {
+		m_cells.erase(it);
+	}
+}
+
+void KX_ActivityGrid::SetObjectActive(KX_GameObject *gameobj, Entry& entry, bool active)
+{
+	if (entry.m_active != active) {
+		entry.m_active = active;
+		m_callback(gameobj, active, m_userdata);
+	}
+}
+
+void KX_ActivityGrid::Invalidate()
+{
+	CM_ThreadSpinLock& mutex = m_mutex;
+	mutex.Lock();
+	m_invalid = true;
+	mutex.Unlock();
+}
+
+void KX_ActivityGrid::AddObject(KX_GameObject *gameobj)
+{
+	if (gameobj->GetIgnoreActivityCulling()) {
+		return;
+	}
+
+	CM_ThreadSpinLock& mutex = m_mutex;
+	mutex.Lock();
+	// The object will be inserted by the next build.
+	if (!m_invalid) {
+		Entry& entry = m_entries[gameobj];
+		InsertObject(gameobj, entry);
+		// The object is tested at the next update as its final position is not yet known.
+		entry.m_active = !gameobj->IsSuspended();
+		entry.m_modified = true;
+		m_modifiedObjects.push_back(gameobj);
+	}
+	mutex.Unlock();
+}
+
+void KX_ActivityGrid::RemoveObject(KX_GameObject *gameobj)
+{
+	CM_ThreadSpinLock& mutex = m_mutex;
+	mutex.Lock();
+	if (!m_invalid) {
+		std::unordered_map<KX_GameObject *, Entry>::iterator it = m_entries.find(gameobj);
+		if (it != m_entries.end()) {
+			RemoveFromCell(gameobj, it->second.m_cell);
+			m_entries.erase(it);
+		}
+	}
+	mutex.Unlock();
+}
+
+void KX_ActivityGrid::SetObjectModified(KX_GameObject *gameobj)
+{
+	CM_ThreadSpinLock& mutex = m_mutex;
+	mutex.Lock();
+	if (!m_invalid) {
+		std::unordered_map<KX_GameObject *, Entry>::iterator it = m_entries.find(gameobj);
+		if (it != m_entries.end() && !it->second.m_modified) {
+			it->second.m_modified = true;
+			m_modifiedObjects.push_back(gameobj);
+		}
+	}
+	mutex.Unlock();
+}
+
+void KX_ActivityGrid::Build(CListValue<KX_GameObject> *objects)
+{
+	m_cells.clear();
+	m_entries.clear();
+	m_modifiedObjects.clear();
+
+	for (KX_GameObject *gameobj : *objects) {
+		if (gameobj->GetIgnoreActivityCulling()) {
+			continue;
+		}
+
+		Entry& entry = m_entries[gameobj];
+		InsertObject(gameobj, entry);
+		entry.m_modified = false;
+
+		// Always notify the state of the objects as the grid was not tracking them.
+		entry.m_active = IsInside(gameobj->NodeGetWorldPosition(), m_camera);
+		m_callback(gameobj, entry.m_active, m_userdata);
+	}
+}
+
+void KX_ActivityGrid::UpdateModifiedObjects(const MT_Vector3& camera)
+{
+	for (KX_GameObject *gameobj : m_modifiedObjects) {
+		std::unordered_map<KX_GameObject *, Entry>::iterator it = m_entries.find(gameobj);
+		// The object was removed after its modification.
+		if (it == m_entries.end()) {
+			continue;
+		}
+
+		Entry& entry = it->second;
+		entry.m_modified = false;
+
+		const MT_Vector3 pos = gameobj->NodeGetWorldPosition();
+		const CellKey cell = GetCell(pos);
+		if (!(cell == entry.m_cell)) {
+			RemoveFromCell(gameobj, entry.m_cell);
+			entry.m_cell = cell;
+			m_cells[cell].push_back(gameobj);
+		}
+
+		SetObjectActive(gameobj, entry, IsInside(pos, camera));
+	}
+
+	m_modifiedObjects.clear();
+}
+
+void KX_ActivityGrid::UpdateCell(const CellKey& key, std::vector<KX_GameObject *>& cell, const MT_Vector3& camera)
+{
+	const CellState oldState = GetCellState(key, m_camera);
+	const CellState newState = GetCellState(key, camera);
+
+	// All the objects of the cell keep the same state.
+	if (oldState == newState && newState != CELL_INTERSECT) {
+		return;
+	}
+
+	for (KX_GameObject *gameobj : cell) {
+		Entry& entry = m_entries[gameobj];
+		switch (newState) {
+			case CELL_INSIDE:
+			{
+				SetObjectActive(gameobj, entry, true);
+				break;
+			}
+			case CELL_OUTSIDE:
+			{
+				SetObjectActive(gameobj, entry, false);
+				break;
+			}
+			case CELL_INTERSECT:
+			{
+				SetObjectActive(gameobj, entry, IsInside(gameobj->NodeGetWorldPosition(), camera));
+				break;
+			}
+		}
+	}
+}
+
+void KX_ActivityGrid::Update(CListValue<KX_GameObject> *objects, const MT_Vector3& camera, float radius)
+{
+	if (m_invalid || radius != m_radius) {
+		m_camera = camera;
+		m_radius = radius;
+		m_cellSize = radius * activityGridCellFactor;
+		Build(objects);
+		m_invalid = false;
+		return;
+	}
+
+	// Test the moved objects against the new activity box.
+	UpdateModifiedObjects(camera);
+
+	if (camera == m_camera) {
+		return;
+	}
+
+	// Only the cells overlapping the old or new activity box can change of state.
+	const MT_Vector3 extent(m_radius, m_radius, m_radius);
+	const CellKey oldMin = GetCell(m_camera - extent);
+	const CellKey oldMax = GetCell(m_camera + extent);
+	const CellKey newMin = GetCell(camera - extent);
+	const CellKey newMax = GetCell(camera + extent);
+	// Include one more cell in each direction for the rounding of the cell coordinates.
+	const CellKey min = {std::min(oldMin.m_x, newMin.m_x) - 1, std::min(oldMin.m_y, newMin.m_y) - 1, std::min(oldMin.m_z, newMin.m_z) - 1};
+	const CellKey max = {std::max(oldMax.m_x, newMax.m_x) + 1, std::max(oldMax.m_y, newMax.m_y) + 1, std::max(oldMax.m_z, newMax.m_z) + 1};
+
+	const double numRangeCells = ((double)max.m_x - min.m_x + 1) * ((double)max.m_y - min.m_y + 1) * ((double)max.m_z - min.m_z + 1);
+
+	// Iterate over the smallest set between the cells of the range and the non-empty cells.
+	if (numRangeCells < (double)m_cells.size()) {
+		CellKey key;
+		for (key.m_x = min.m_x; key.m_x <= max.m_x; ++key.m_x) {
+			for (key.m_y = min.m_y; key.m_y <= max.m_y; ++key.m_y) {
+				for (key.m_z = min.m_z; key.m_z <= max.m_z; ++key.m_z) {
+					std::unordered_map<CellKey, std::vector<KX_GameObject *>, CellKeyHash>::iterator it = m_cells.find(key);
+					if (it != m_cells.end()) {
+						UpdateCell(key, it->second, camera);
+					}
+				}
+			}
+		}
+	}
+	else {
+		for (auto& pair : m_cells) {
+			UpdateCell(pair.first, pair.second, camera);
+		}
+	}
+
+	m_camera = camera;
+}
@@ -0,0 +1,121 @@
+#ifndef __KX_ACTIVITY_GRID_H__
+#define __KX_ACTIVITY_GRID_H__
+
+#include "MT_Vector3.h"
+
+#include "EXP_ListValue.h"
+
+#include "CM_Thread.h"
+
+#include <vector>
+#include <unordered_map>
+
+class KX_GameObject;
+
+/// Function called when an object enters or leaves the activity box.
+typedef void (*KX_ActivityChangedCallback)(KX_GameObject *gameobj, bool active, void *userdata);
+
+/** \brief Uniform grid of the scene objects used for the activity culling.
+ *
+ * An object is active when its distance to the camera along each axis is lower
+ * or equal than the activity radius. The objects are stored in cells of half
+ * the activity radius and the state of each object is kept from the last update,
+ * when the camera moves only the cells crossing the boundary of the old or new
+ * activity box are tested per object, the others are only switched at once.
+ * Moved objects are tested individually and the callback is only called on a
+ * change of the activity state.
+ */
+class KX_ActivityGrid
+{
+private:
+	struct CellKey
+	{
+		int m_x;
+		int m_y;
+		int m_z;
+
+		inline bool operator==(const CellKey& other) const
+		{
+			return (m_x == other.m_x && m_y == other.m_y && m_z == other.m_z);
+		}
+	};
+
+	struct CellKeyHash
+	{
+		inline size_t operator()(const CellKey& key) const
+		{
+			return ((size_t)key.m_x * 73856093u) ^ ((size_t)key.m_y * 19349663u) ^ ((size_t)key.m_z * 83492791u);
+		}
+	};
+
+	struct Entry
+	{
+		CellKey m_cell;
+		bool m_active;
+		/// True if the object is already in the modified object list.
+		bool m_modified;
+	};
+
+	enum CellState {
+		CELL_INSIDE,
+		CELL_OUTSIDE,
+		CELL_INTERSECT
+	};
+
+	/// Objects of each non-empty cell.
+	std::unordered_map<CellKey, std::vector<KX_GameObject *>, CellKeyHash> m_cells;
+	/// Cell and activity state of each object.
+	std::unordered_map<KX_GameObject *, Entry> m_entries;
+	/// Objects moved since the last update.
+	std::vector<KX_GameObject *> m_modifiedObjects;
+
+	/// Camera position and activity radius of the last update.
+	MT_Vector3 m_camera;
+	float m_radius;
+	float m_cellSize;
+
+	/// True when the grid must be rebuilt from the object list.
+	bool m_invalid;
+
+	KX_ActivityChangedCallback m_callback;
+	void *m_userdata;
+
+	/// Objects can be modified from the scene graph update tasks.
+	CM_ThreadSpinLock m_mutex;
+
+	CellKey GetCell(const MT_Vector3& pos) const;
+	int GetCellCoord(MT_Scalar coord) const;
+	CellState GetCellState(const CellKey& key, const MT_Vector3& camera) const;
+	bool IsInside(const MT_Vector3& pos, const MT_Vector3& camera) const;
+
+	void InsertObject(KX_GameObject *gameobj, Entry& entry);
+	void RemoveFromCell(KX_GameObject *gameobj, const CellKey& key);
+	/// Change the state of an object and call the callback if it differs from the previous.
+	void SetObjectActive(KX_GameObject *gameobj, Entry& entry, bool active);
+
+	void Build(CListValue<KX_GameObject> *objects);
+	void UpdateModifiedObjects(const MT_Vector3& camera);
+	void UpdateCell(const CellKey& key, std::vector<KX_GameObject *>& cell, const MT_Vector3& camera);
+
+public:
+	KX_ActivityGrid(KX_ActivityChangedCallback callback, void *userdata);
+	~KX_ActivityGrid() = default;
+
+	/// Request a rebuild of the grid and a test of all the objects at the next update.
+	void Invalidate();
+	/// Add an object added in the scene.
+	void AddObject(KX_GameObject *gameobj);
+	/// Remove an object removed from the scene.
+	void RemoveObject(KX_GameObject *gameobj);
+	/// Notify that the world position of an object changed.
+	void SetObjectModified(KX_GameObject *gameobj);
+
+	/** Update the activity state of the objects.
+	 * \param objects The scene objects, used to rebuild the grid.
+	 * \param camera The center of the activity box.
+	 * \param radius The half size of the activity box.
+	 */
+	void Update(CListValue<KX_GameObject> *objects, const MT_Vector3& camera, float radius);
+};
+
+#endif  // __KX_ACTIVITY_GRID_H__
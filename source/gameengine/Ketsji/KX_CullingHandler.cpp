@@ -1,12 +1,46 @@
 #include "KX_CullingHandler.h"
 #include "KX_GameObject.h"
+#include "KX_Globals.h"
+#include "KX_KetsjiEngine.h"
 
 #include "SG_Node.h"
 
+#include "BLI_task.h"
+#include "BLI_threads.h"
+#include "BLI_utildefines.h"
+
+#include <algorithm>
+
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
+/// Minimum number of nodes to split the batch culling in tasks.
+static const unsigned int cullingParallelThreshold = 1024;
+/// Number of nodes culled by a task, it must be a multiple of 4.
+static const unsigned int cullingTaskChunkSize = 256;
+
 KX_CullingHandler::KX_CullingHandler(KX_CullingNodeList& nodes, const SG_Frustum& frustum)
 	:m_activeNodes(nodes),
-	m_frustum(frustum)
+	m_frustum(frustum),
+	m_batchNodes(nullptr)
+{
+}
+
+bool KX_CullingHandler::TestAabb(KX_CullingNode *node, const SG_Frustum::TestType sphereTest) const
 {
+	// First test if the sphere is in the frustum as it is faster to test than box.
+	if (sphereTest == SG_Frustum::INSIDE) {
+		return false;
+	}
+	// If the sphere intersects we made a box test because the box could be not homogeneous.
+	else if (sphereTest == SG_Frustum::INTERSECT) {
+		const SG_BBox& aabb = node->GetAabb();
+		const MT_Matrix4x4 mat = MT_Matrix4x4(node->GetObject()->GetSGNode()->GetWorldTransform());
+		return (m_frustum.AabbInsideFrustum(aabb.GetMin(), aabb.GetMax(), mat) == SG_Frustum::OUTSIDE);
+	}
+
+	return true;
 }
 
 void KX_CullingHandler::Process(KX_CullingNode *node)
@@ -16,21 +50,134 @@ void KX_CullingHandler::Process(KX_CullingNode *node)
 	const MT_Vector3 &scale = sgnode->GetWorldScaling();
 	const SG_BBox& aabb = node->GetAabb();
 
-	bool culled = true;
 	const SG_Frustum::TestType sphereTest = m_frustum.SphereInsideFrustum(trans(aabb.GetCenter()), fabs(scale[scale.closestAxis()]) * aabb.GetRadius());
-
-	// First test if the sphere is in the frustum as it is faster to test than box.
-	if (sphereTest == SG_Frustum::INSIDE) {
-		culled = false;
-	}
-	// If the sphere intersects we made a box test because the box could be not homogeneous.
-	else if (sphereTest == SG_Frustum::INTERSECT) {
-		const MT_Matrix4x4 mat = MT_Matrix4x4(trans);
-		culled = (m_frustum.AabbInsideFrustum(aabb.GetMin(), aabb.GetMax(), mat) == SG_Frustum::OUTSIDE);
-	}
+	const bool culled = TestAabb(node, sphereTest);
 
 	node->SetCulled(culled);
 	if (!culled) {
 		m_activeNodes.push_back(node);
 	}
 }
+
+void KX_CullingHandler::ProcessRange(unsigned int start, unsigned int end) const
+{
+	const KX_CullingNodeList& nodes = *m_batchNodes;
+	const std::array<MT_Vector4, 6>& planes = m_frustum.GetPlanes();
+
+	// Bounding spheres in world space, padded to a multiple of 4.
+	float centerx[cullingTaskChunkSize];
+	float centery[cullingTaskChunkSize];
+	float centerz[cullingTaskChunkSize];
+	float radius[cullingTaskChunkSize];
+
+	const unsigned int size = end - start;
+	const unsigned int paddedSize = (size + 3) & ~3;
+
+	for (unsigned int i = 0; i < size; ++i) {
+		KX_CullingNode *node = nodes[start + i];
+		SG_Node *sgnode = node->GetObject()->GetSGNode();
+		const MT_Transform trans = sgnode->GetWorldTransform();
+		const MT_Vector3 &scale = sgnode->GetWorldScaling();
+		const SG_BBox& aabb = node->GetAabb();
+
+		const MT_Vector3 center = trans(aabb.GetCenter());
+		centerx[i] = center.x();
+		centery[i] = center.y();
+		centerz[i] = center.z();
+		radius[i] = fabs(scale[scale.closestAxis()]) * aabb.GetRadius();
+	}
+	for (unsigned int i = size; i < paddedSize; ++i) {
+		centerx[i] = centery[i] = centerz[i] = radius[i] = 0.0f;
+	}
+
+	for (unsigned int i = 0; i < size; i += 4) {
+		SG_Frustum::TestType sphereTests[4];
+
+#ifdef __SSE2__
+		/* Same as SG_Frustum::SphereInsideFrustum for 4 spheres: the result of a sphere
+		 * is given by the first plane it is outside or intersecting, else it is inside. */
+		const __m128 signMask = _mm_set1_ps(-0.0f);
+		const __m128 x = _mm_loadu_ps(&centerx[i]);
+		const __m128 y = _mm_loadu_ps(&centery[i]);
+		const __m128 z = _mm_loadu_ps(&centerz[i]);
+		const __m128 r = _mm_loadu_ps(&radius[i]);
+		const __m128 negr = _mm_xor_ps(r, signMask);
+
+		__m128 decided = _mm_setzero_ps();
+		__m128 outside = _mm_setzero_ps();
+		__m128 intersect = _mm_setzero_ps();
+
+		for (const MT_Vector4& plane : planes) {
+			const __m128 distance = _mm_add_ps(_mm_add_ps(_mm_add_ps(
+				_mm_mul_ps(_mm_set1_ps(plane[0]), x),
+				_mm_mul_ps(_mm_set1_ps(plane[1]), y)),
+				_mm_mul_ps(_mm_set1_ps(plane[2]), z)),
+				_mm_set1_ps(plane[3]));
+
+			const __m128 out = _mm_cmplt_ps(distance, negr);
+			const __m128 inter = _mm_cmple_ps(_mm_andnot_ps(signMask, distance), r);
+
+			outside = _mm_or_ps(outside, _mm_andnot_ps(decided, out));
+			intersect = _mm_or_ps(intersect, _mm_andnot_ps(decided, inter));
+			decided = _mm_or_ps(decided, _mm_or_ps(out, inter));
+
+			if (_mm_movemask_ps(decided) == 0xF) {
+				break;
+			}
+		}
+
+		const int outsideMask = _mm_movemask_ps(outside);
+		const int intersectMask = _mm_movemask_ps(intersect);
+		for (unsigned short j = 0; j < 4; ++j) {
+			sphereTests[j] = (outsideMask & (1 << j)) ? SG_Frustum::OUTSIDE :
+			                 ((intersectMask & (1 << j)) ? SG_Frustum::INTERSECT : SG_Frustum::INSIDE);
+		}
+#else
+		for (unsigned short j = 0; j < 4; ++j) {
+			sphereTests[j] = m_frustum.SphereInsideFrustum(MT_Vector3(centerx[i + j], centery[i + j], centerz[i + j]), radius[i + j]);
+		}
+#endif
+
+		for (unsigned int j = 0, num = std::min(4U, size - i); j < num; ++j) {
+			KX_CullingNode *node = nodes[start + i + j];
+			node->SetCulled(TestAabb(node, sphereTests[j]));
+		}
+	}
+}
+
+void KX_CullingHandler::ProcessRangeTask(TaskPool *pool, void *UNUSED(taskdata), int start, int stop, int UNUSED(threadid))
+{
+	const KX_CullingHandler *handler = (KX_CullingHandler *)BLI_task_pool_userdata(pool);
+
+	handler->ProcessRange(start, stop);
+}
+
+void KX_CullingHandler::Process(const KX_CullingNodeList& nodes)
+{
+	m_batchNodes = &nodes;
+
+	const unsigned int size = nodes.size();
+	TaskScheduler *scheduler = KX_GetActiveEngine()->GetTaskScheduler();
+
+	// The culling can be called from the main thread only when using tasks.
+	if (size >= cullingParallelThreshold && BLI_thread_is_main() && BLI_task_scheduler_num_threads(scheduler) > 1) {
+		TaskPool *pool = BLI_task_pool_create(scheduler, this);
+		BLI_task_pool_push_range(pool, ProcessRangeTask, nullptr, 0, size, cullingTaskChunkSize, TASK_PRIORITY_HIGH);
+		BLI_task_pool_work_and_wait(pool);
+		BLI_task_pool_free(pool);
+	}
+	else {
+		for (unsigned int i = 0; i < size; i += cullingTaskChunkSize) {
+			ProcessRange(i, std::min(i + cullingTaskChunkSize, size));
+		}
+	}
+
+	// Keep the order of the nodes.
+	for (KX_CullingNode *node : nodes) {
+		if (!node->GetCulled()) {
+			m_activeNodes.push_back(node);
+		}
+	}
+
+	m_batchNodes = nullptr;
+}
@@ -4,6 +4,8 @@
 #include "KX_CullingNode.h"
 #include "SG_Frustum.h"
 
+struct TaskPool;
+
 class KX_CullingHandler
 {
 private:
@@ -11,6 +13,17 @@ private:
 	KX_CullingNodeList& m_activeNodes;
 	/// The camera frustum data.
 	const SG_Frustum& m_frustum;
+	/// Nodes of the batch being processed by Process(const KX_CullingNodeList&).
+	const KX_CullingNodeList *m_batchNodes;
+
+	/// Test the bounding box of a node and return true if the node is culled.
+	bool TestAabb(KX_CullingNode *node, const SG_Frustum::TestType sphereTest) const;
+	/** Test a range of nodes of m_batchNodes, the bounding spheres are packed
+	 * and tested several nodes at once. The result is stored in the node.
+	 */
+	void ProcessRange(unsigned int start, unsigned int end) const;
+
+	static void ProcessRangeTask(TaskPool *pool, void *taskdata, int start, int stop, int threadid);
 
 public:
 	KX_CullingHandler(KX_CullingNodeList& nodes, const SG_Frustum& frustum);
@@ -20,6 +33,10 @@ public:
 	 * node is added in m_activeNodes.
 	 */
 	void Process(KX_CullingNode *node);
+	/** Process the culling of a list of nodes, the result is the same as calling
+	 * Process for each node but the tests are batched and split in tasks for large lists.
+	 */
+	void Process(const KX_CullingNodeList& nodes);
 };
 
 #endif  // __KX_CULLING_HANDLER_H__
@@ -1,7 +1,9 @@
 #include "KX_CullingNode.h"
 
 KX_CullingNode::KX_CullingNode(KX_GameObject *object)
-	:m_object(object)
+	:m_object(object),
+	m_treeLeaf(-1),
+	m_treeModified(false)
 {
 }
 
@@ -14,3 +16,23 @@ void KX_CullingNode::SetObject(KX_GameObject *object)
 {
 	m_object = object;
 }
+
+int KX_CullingNode::GetTreeLeaf() const
+{
+	return m_treeLeaf;
+}
+
+void KX_CullingNode::SetTreeLeaf(int leaf)
+{
+	m_treeLeaf = leaf;
+}
+
+bool KX_CullingNode::GetTreeModified() const
+{
+	return m_treeModified;
+}
+
+void KX_CullingNode::SetTreeModified(bool modified)
+{
+	m_treeModified = modified;
+}
@@ -9,6 +9,10 @@ class KX_CullingNode : public SG_CullingNode
 {
 private:
 	KX_GameObject *m_object;
+	/// Index of the leaf in the scene KX_CullingTree, -1 if the node is not in the tree.
+	int m_treeLeaf;
+	/// True if the node is already in the list of the leafs to refit of the tree.
+	bool m_treeModified;
 
 public:
 	KX_CullingNode(KX_GameObject *object);
@@ -16,6 +20,11 @@ public:
 
 	KX_GameObject *GetObject() const;
 	void SetObject(KX_GameObject *object);
+
+	int GetTreeLeaf() const;
+	void SetTreeLeaf(int leaf);
+	bool GetTreeModified() const;
+	void SetTreeModified(bool modified);
 };
 
 using KX_CullingNodeList = std::vector<KX_CullingNode *>;
@@ -0,0 +1,282 @@
+#include "KX_CullingTree.h"
+#include "KX_GameObject.h"
+
+#include "SG_Node.h"
+
+#include <algorithm>
+
+/// Part of the AABB size added on each side of the leaf AABBs.
+static const float cullingTreeMargin = 0.1f;
+
+KX_CullingTree::KX_CullingTree()
+	:m_root(-1),
+	m_numLeafs(0),
+	m_numRemovedLeafs(0),
+	m_numRefits(0),
+	m_invalid(true)
+{
+}
+
+void KX_CullingTree::GetWorldAabb(KX_CullingNode *cullingNode, MT_Vector3& min, MT_Vector3& max)
+{
+	const MT_Transform trans = cullingNode->GetObject()->GetSGNode()->GetWorldTransform();
+	const SG_BBox& aabb = cullingNode->GetAabb();
+
+	const MT_Vector3 center = trans(aabb.GetCenter());
+	const MT_Vector3 extent = trans.getBasis().absolute() * ((aabb.GetMax() - aabb.GetMin()) * 0.5f);
+
+	min = center - extent;
+	max = center + extent;
+}
+
+void KX_CullingTree::GetLeafAabb(KX_CullingNode *cullingNode, MT_Vector3& min, MT_Vector3& max)
+{
+	GetWorldAabb(cullingNode, min, max);
+
+	const MT_Vector3 margin = (max - min) * cullingTreeMargin;
+	min -= margin;
+	max += margin;
+}
+
+bool KX_CullingTree::IsLeafOf(int leaf, KX_CullingNode *cullingNode) const
+{
+	// The leaf index can come from the tree of an other scene after a merge.
+	return (leaf >= 0 && (unsigned int)leaf < m_numLeafs && m_nodes[leaf].m_cullingNode == cullingNode);
+}
+
+void KX_CullingTree::Invalidate()
+{
+	CM_ThreadSpinLock& mutex = m_mutex;
+	mutex.Lock();
+	m_invalid = true;
+	mutex.Unlock();
+}
+
+void KX_CullingTree::AddNode(KX_CullingNode *cullingNode)
+{
+	CM_ThreadSpinLock& mutex = m_mutex;
+	mutex.Lock();
+	// The node will be inserted by the next build.
+	if (!m_invalid) {
+		m_pendingNodes.push_back(cullingNode);
+	}
+	mutex.Unlock();
+}
+
+void KX_CullingTree::RemoveNode(KX_CullingNode *cullingNode)
+{
+	CM_ThreadSpinLock& mutex = m_mutex;
+	mutex.Lock();
+
+	KX_CullingNodeList::iterator it = std::find(m_pendingNodes.begin(), m_pendingNodes.end(), cullingNode);
+	if (it != m_pendingNodes.end()) {
+		m_pendingNodes.erase(it);
+	}
+	else if (!m_invalid) {
+		const int leaf = cullingNode->GetTreeLeaf();
+		if (IsLeafOf(leaf, cullingNode)) {
+			m_nodes[leaf].m_cullingNode = nullptr;
+			++m_numRemovedLeafs;
+		}
+	}
+
+	cullingNode->SetTreeLeaf(-1);
+
+	mutex.Unlock();
+}
+
+void KX_CullingTree::SetNodeModified(KX_CullingNode *cullingNode)
+{
+	CM_ThreadSpinLock& mutex = m_mutex;
+	mutex.Lock();
+
+	const int leaf = cullingNode->GetTreeLeaf();
+	if (!m_invalid && !cullingNode->GetTreeModified() && IsLeafOf(leaf, cullingNode)) {
+		cullingNode->SetTreeModified(true);
+		m_modifiedLeafs.push_back(leaf);
+	}
+
+	mutex.Unlock();
+}
+
+void KX_CullingTree::Update(CListValue<KX_GameObject> *objects)
+{
+	// Rebuild when the tree contains too much disabled, pending or refitted leafs.
+	if (m_invalid || (m_numRemovedLeafs + m_pendingNodes.size()) * 4 > m_numLeafs || m_numRefits > m_numLeafs) {
+		Build(objects);
+		return;
+	}
+
+	for (int leaf : m_modifiedLeafs) {
+		KX_CullingNode *cullingNode = m_nodes[leaf].m_cullingNode;
+		// The node could be removed after its modification.
+		if (cullingNode) {
+			cullingNode->SetTreeModified(false);
+			Refit(leaf);
+		}
+	}
+	m_modifiedLeafs.clear();
+}
+
+void KX_CullingTree::Build(CListValue<KX_GameObject> *objects)
+{
+	for (int leaf : m_modifiedLeafs) {
+		KX_CullingNode *cullingNode = m_nodes[leaf].m_cullingNode;
+		if (cullingNode) {
+			cullingNode->SetTreeModified(false);
+		}
+	}
+
+	m_nodes.clear();
+	m_modifiedLeafs.clear();
+	m_pendingNodes.clear();
+	m_numRemovedLeafs = 0;
+	m_numRefits = 0;
+	m_invalid = false;
+
+	m_numLeafs = objects->GetCount();
+	if (m_numLeafs == 0) {
+		m_root = -1;
+		return;
+	}
+
+	m_nodes.reserve(m_numLeafs * 2 - 1);
+	std::vector<int> leafs(m_numLeafs);
+
+	for (unsigned int i = 0; i < m_numLeafs; ++i) {
+		KX_CullingNode *cullingNode = objects->GetValue(i)->GetCullingNode();
+		cullingNode->SetTreeLeaf(i);
+		cullingNode->SetTreeModified(false);
+
+		Node node;
+		GetLeafAabb(cullingNode, node.m_min, node.m_max);
+		node.m_parent = -1;
+		node.m_left = -1;
+		node.m_right = -1;
+		node.m_cullingNode = cullingNode;
+
+		m_nodes.push_back(node);
+		leafs[i] = i;
+	}
+
+	m_root = BuildRecursive(leafs, 0, m_numLeafs, -1);
+}
+
+int KX_CullingTree::BuildRecursive(std::vector<int>& leafs, unsigned int begin, unsigned int end, int parent)
+{
+	if ((end - begin) == 1) {
+		const int leaf = leafs[begin];
+		m_nodes[leaf].m_parent = parent;
+		return leaf;
+	}
+
+	Node node;
+	node.m_min = m_nodes[leafs[begin]].m_min;
+	node.m_max = m_nodes[leafs[begin]].m_max;
+	node.m_parent = parent;
+	node.m_cullingNode = nullptr;
+
+	MT_Vector3 centerMin = (node.m_min + node.m_max) * 0.5f;
+	MT_Vector3 centerMax = centerMin;
+	for (unsigned int i = begin + 1; i < end; ++i) {
+		const Node& leaf = m_nodes[leafs[i]];
+		const MT_Vector3 center = (leaf.m_min + leaf.m_max) * 0.5f;
+		for (unsigned short axis = 0; axis < 3; ++axis) {
+			node.m_min[axis] = std::min(node.m_min[axis], leaf.m_min[axis]);
+			node.m_max[axis] = std::max(node.m_max[axis], leaf.m_max[axis]);
+			centerMin[axis] = std::min(centerMin[axis], center[axis]);
+			centerMax[axis] = std::max(centerMax[axis], center[axis]);
+		}
+	}
+
+	// Split the leafs at the median of the largest axis of their centers.
+	const unsigned short axis = (centerMax - centerMin).closestAxis();
+	const unsigned int middle = (begin + end) / 2;
+	std::nth_element(leafs.begin() + begin, leafs.begin() + middle, leafs.begin() + end,
+		[this, axis](int a, int b) {
+			return (m_nodes[a].m_min[axis] + m_nodes[a].m_max[axis]) < (m_nodes[b].m_min[axis] + m_nodes[b].m_max[axis]);
+		});
+
+	const int index = m_nodes.size();
+	m_nodes.push_back(node);
+
+	const int left = BuildRecursive(leafs, begin, middle, index);
+	const int right = BuildRecursive(leafs, middle, end, index);
+	m_nodes[index].m_left = left;
+	m_nodes[index].m_right = right;
+
+	return index;
+}
+
+void KX_CullingTree::Refit(int leaf)
+{
+	Node& node = m_nodes[leaf];
+
+	MT_Vector3 min;
+	MT_Vector3 max;
+	GetWorldAabb(node.m_cullingNode, min, max);
+
+	// The node is still inside its leaf AABB.
+	if (min.x() >= node.m_min.x() && min.y() >= node.m_min.y() && min.z() >= node.m_min.z() &&
+		max.x() <= node.m_max.x() && max.y() <= node.m_max.y() && max.z() <= node.m_max.z())
+	{
+		return;
+	}
+
+	GetLeafAabb(node.m_cullingNode, node.m_min, node.m_max);
+	++m_numRefits;
+
+	for (int parent = node.m_parent; parent != -1; parent = m_nodes[parent].m_parent) {
+		Node& pnode = m_nodes[parent];
+		const Node& left = m_nodes[pnode.m_left];
+		const Node& right = m_nodes[pnode.m_right];
+		for (unsigned short axis = 0; axis < 3; ++axis) {
+			pnode.m_min[axis] = std::min(left.m_min[axis], right.m_min[axis]);
+			pnode.m_max[axis] = std::max(left.m_max[axis], right.m_max[axis]);
+		}
+	}
+}
+
+void KX_CullingTree::Query(const SG_Frustum& frustum, KX_CullingNodeList& nodes) const
+{
+	nodes.insert(nodes.end(), m_pendingNodes.begin(), m_pendingNodes.end());
+
+	if (m_root == -1) {
+		return;
+	}
+
+	const std::array<MT_Vector4, 6>& planes = frustum.GetPlanes();
+
+	std::vector<int> stack;
+	stack.push_back(m_root);
+	while (!stack.empty()) {
+		const Node& node = m_nodes[stack.back()];
+		stack.pop_back();
+
+		bool outside = false;
+		for (const MT_Vector4& plane : planes) {
+			// The farthest AABB point along the plane normal.
+			const MT_Vector3 far((plane[0] < 0.0f) ? node.m_min[0] : node.m_max[0],
+			                     (plane[1] < 0.0f) ? node.m_min[1] : node.m_max[1],
+			                     (plane[2] < 0.0f) ? node.m_min[2] : node.m_max[2]);
+			if (plane.dot(far) < 0.0f) {
+				outside = true;
+				break;
+			}
+		}
+
+		if (outside) {
+			continue;
+		}
+
+		if (node.m_left == -1) {
+			if (node.m_cullingNode) {
+				nodes.push_back(node.m_cullingNode);
+			}
+		}
+		else {
+			stack.push_back(node.m_left);
+			stack.push_back(node.m_right);
+		}
+	}
+}
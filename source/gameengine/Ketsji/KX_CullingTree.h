@@ -0,0 +1,90 @@
+#ifndef __KX_CULLING_TREE_H__
+#define __KX_CULLING_TREE_H__
+
+#include "KX_CullingNode.h"
+#include "SG_Frustum.h"
+
+#include "EXP_ListValue.h"
+
+#include "CM_Thread.h"
+
+class KX_GameObject;
+
+/** \brief Bounding volume hierarchy of the scene culling nodes, used for the frustum
+ * culling when the physics culling (DBVT) is not available.
+ *
+ * The tree is built lazily from the scene object list. Each leaf stores an enlarged world
+ * AABB of its node, a node transformed or resized outside of this AABB is refitted at the
+ * next update without touching the rest of the tree. Added nodes are kept in a pending
+ * list and removed leafs are only disabled until the tree is rebuilt.
+ */
+class KX_CullingTree
+{
+private:
+	struct Node
+	{
+		MT_Vector3 m_min;
+		MT_Vector3 m_max;
+		int m_parent;
+		/// Children indices, -1 for a leaf.
+		int m_left;
+		int m_right;
+		/// The culling node of a leaf, nullptr if removed.
+		KX_CullingNode *m_cullingNode;
+	};
+
+	/// All the tree nodes, the leafs are stored first.
+	std::vector<Node> m_nodes;
+	int m_root;
+	unsigned int m_numLeafs;
+	unsigned int m_numRemovedLeafs;
+	/// Number of leafs refitted since the last build.
+	unsigned int m_numRefits;
+
+	/// Leafs which need to be refitted.
+	std::vector<int> m_modifiedLeafs;
+	/// Nodes added after the last build, not part of the tree.
+	KX_CullingNodeList m_pendingNodes;
+
+	/// True when the tree must be rebuilt from the object list.
+	bool m_invalid;
+
+	/// Leafs can be modified from the scene graph update tasks.
+	CM_ThreadSpinLock m_mutex;
+
+	void Build(CListValue<KX_GameObject> *objects);
+	int BuildRecursive(std::vector<int>& leafs, unsigned int begin, unsigned int end, int parent);
+	void Refit(int leaf);
+	/// Return true if a leaf index of this tree refers to the culling node.
+	bool IsLeafOf(int leaf, KX_CullingNode *cullingNode) const;
+
+	/// Compute the world space AABB of a culling node.
+	static void GetWorldAabb(KX_CullingNode *cullingNode, MT_Vector3& min, MT_Vector3& max);
+	/// Compute the enlarged world space AABB stored in a leaf.
+	static void GetLeafAabb(KX_CullingNode *cullingNode, MT_Vector3& min, MT_Vector3& max);
+
+public:
+	KX_CullingTree();
+	~KX_CullingTree() = default;
+
+	/// Request a rebuild of the tree at the next update.
+	void Invalidate();
+	/// Add a culling node of an object added in the scene.
+	void AddNode(KX_CullingNode *cullingNode);
+	/// Remove the culling node of an object removed from the scene.
+	void RemoveNode(KX_CullingNode *cullingNode);
+	/// Notify that the transform or bounds of a culling node changed.
+	void SetNodeModified(KX_CullingNode *cullingNode);
+
+	/** Rebuild or refit the tree before a query.
+	 * \param objects The scene objects, used to rebuild the tree.
+	 */
+	void Update(CListValue<KX_GameObject> *objects);
+
+	/** Find all the culling nodes which could be in the frustum.
+	 * \param nodes The list receiving the nodes not proved outside of the frustum.
+	 */
+	void Query(const SG_Frustum& frustum, KX_CullingNodeList& nodes) const;
+};
+
+#endif  // __KX_CULLING_TREE_H__
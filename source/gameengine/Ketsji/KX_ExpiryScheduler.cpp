@@ -0,0 +1,129 @@
+#include "KX_ExpiryScheduler.h"
+
+KX_ExpiryScheduler::KX_ExpiryScheduler()
+	:m_time(0.0)
+{
+}
+
+void KX_ExpiryScheduler::SetEntry(unsigned int index, const Entry& entry)
+{
+	m_heap[index] = entry;
+	m_indices[entry.m_object] = index;
+}
+
+void KX_ExpiryScheduler::SiftUp(unsigned int index)
+{
+	const Entry entry = m_heap[index];
+	while (index > 0) {
+		const unsigned int parent = (index - 1) / 2;
+		if (m_heap[parent].m_time <= entry.m_time) {
+			break;
+		}
+		SetEntry(index, m_heap[parent]);
+		index = parent;
+	}
+	SetEntry(index, entry);
+}
+
+void KX_ExpiryScheduler::SiftDown(unsigned int index)
+{
+	const unsigned int size = m_heap.size();
+	const Entry entry = m_heap[index];
+	while (true) {
+		unsigned int child = index * 2 + 1;
+		if (child >= size) {
+			break;
+		}
+		if ((child + 1) < size && m_heap[child + 1].m_time < m_heap[child].m_time) {
+			++child;
+		}
+		if (entry.m_time <= m_heap[child].m_time) {
+			break;
+		}
+		SetEntry(index, m_heap[child]);
+		index = child;
+	}
+	SetEntry(index, entry);
+}
+
+void KX_ExpiryScheduler::Reorder(unsigned int index)
+{
+	// The entry can be earlier than its parent or later than its children.
+	if (index > 0 && m_heap[index].m_time < m_heap[(index - 1) / 2].m_time) {
+		SiftUp(index);
+	}
+	else {
+		SiftDown(index);
+	}
+}
+
+void KX_ExpiryScheduler::RemoveEntry(unsigned int index)
+{
+	m_indices.erase(m_heap[index].m_object);
+
+	const unsigned int last = m_heap.size() - 1;
+	if (index != last) {
+		SetEntry(index, m_heap[last]);
+		m_heap.pop_back();
+		Reorder(index);
+	}
+	else {
+		m_heap.pop_back();
+	}
+}
+
+void KX_ExpiryScheduler::AddObject(KX_GameObject *gameobj, double lifeTime)
+{
+	const Entry entry = {m_time + lifeTime, gameobj};
+
+	std::unordered_map<KX_GameObject *, unsigned int>::iterator it = m_indices.find(gameobj);
+	if (it != m_indices.end()) {
+		const unsigned int index = it->second;
+		m_heap[index] = entry;
+		Reorder(index);
+		return;
+	}
+
+	m_heap.push_back(entry);
+	SiftUp(m_heap.size() - 1);
+}
+
+void KX_ExpiryScheduler::RemoveObject(KX_GameObject *gameobj)
+{
+	std::unordered_map<KX_GameObject *, unsigned int>::iterator it = m_indices.find(gameobj);
+	if (it != m_indices.end()) {
+		RemoveEntry(it->second);
+	}
+}
+
+bool KX_ExpiryScheduler::GetLifeTime(KX_GameObject *gameobj, double& lifeTime) const
+{
+	std::unordered_map<KX_GameObject *, unsigned int>::const_iterator it = m_indices.find(gameobj);
+	if (it == m_indices.end()) {
+		return false;
+	}
+
+	lifeTime = m_heap[it->second].m_time - m_time;
+	return true;
+}
+
+void KX_ExpiryScheduler::Update(double framestep, std::vector<KX_GameObject *>& expiredObjects)
+{
+	m_time += framestep;
+
+	// An object expires when its remaining life time is not positive anymore.
+	while (!m_heap.empty() && m_heap.front().m_time <= m_time) {
+		expiredObjects.push_back(m_heap.front().m_object);
+		RemoveEntry(0);
+	}
+}
+
+void KX_ExpiryScheduler::Merge(KX_ExpiryScheduler *other)
+{
+	for (const Entry& entry : other->m_heap) {
+		AddObject(entry.m_object, entry.m_time - other->m_time);
+	}
+
+	other->m_heap.clear();
+	other->m_indices.clear();
+}
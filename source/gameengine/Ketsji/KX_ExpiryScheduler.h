@@ -0,0 +1,61 @@
+#ifndef __KX_EXPIRY_SCHEDULER_H__
+#define __KX_EXPIRY_SCHEDULER_H__
+
+#include <vector>
+#include <unordered_map>
+
+class KX_GameObject;
+
+/** \brief Schedule the removal of the objects added with a life time.
+ * The objects are stored in a binary min-heap sorted by their absolute expiry time,
+ * the cost of an update is proportional to the number of expiring objects.
+ */
+class KX_ExpiryScheduler
+{
+private:
+	struct Entry
+	{
+		double m_time;
+		KX_GameObject *m_object;
+	};
+
+	/// Min-heap of the objects sorted by expiry time.
+	std::vector<Entry> m_heap;
+	/// Index in m_heap of each scheduled object.
+	std::unordered_map<KX_GameObject *, unsigned int> m_indices;
+	/// Sum of the frame steps of all the updates.
+	double m_time;
+
+	void SetEntry(unsigned int index, const Entry& entry);
+	void SiftUp(unsigned int index);
+	void SiftDown(unsigned int index);
+	/// Move the entry at index after a change of its time.
+	void Reorder(unsigned int index);
+	/// Remove the entry at index from the heap.
+	void RemoveEntry(unsigned int index);
+
+public:
+	KX_ExpiryScheduler();
+	~KX_ExpiryScheduler() = default;
+
+	/** Schedule the removal of an object.
+	 * \param lifeTime The time in seconds before the object expire.
+	 */
+	void AddObject(KX_GameObject *gameobj, double lifeTime);
+	/// Unschedule an object, used when the object is removed before its expiry.
+	void RemoveObject(KX_GameObject *gameobj);
+	/** Get the remaining life time of an object.
+	 * \return False if the object is not scheduled.
+	 */
+	bool GetLifeTime(KX_GameObject *gameobj, double& lifeTime) const;
+
+	/** Advance the time and unschedule the expired objects.
+	 * \param expiredObjects Receive the objects which expired.
+	 */
+	void Update(double framestep, std::vector<KX_GameObject *>& expiredObjects);
+
+	/// Move the objects scheduled in an other scheduler, keeping their remaining life time.
+	void Merge(KX_ExpiryScheduler *other);
+};
+
+#endif  // __KX_EXPIRY_SCHEDULER_H__
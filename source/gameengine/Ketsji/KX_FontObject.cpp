@@ -63,6 +63,9 @@ extern "C" {
 /* proptotype */
 int GetFontId(VFont *font);
 
+/// Property used by the logic to set the text.
+static const CPropertyKey textKey("Text");
+
 static std::vector<std::string> split_string(std::string str)
 {
 	std::vector<std::string> text = std::vector<std::string>();
@@ -215,7 +218,7 @@ void KX_FontObject::SetText(const std::string& text)
 void KX_FontObject::UpdateTextFromProperty()
 {
 	// Allow for some logic brick control
-	CValue *prop = GetProperty("Text");
+	CValue *prop = GetProperty(textKey);
 	if (prop && prop->GetText() != m_text) {
 		SetText(prop->GetText());
 	}
@@ -371,10 +374,10 @@ int KX_FontObject::pyattr_set_text(PyObjectPlus *self_v, const KX_PYATTRIBUTE_DE
 	char *chars = _PyUnicode_AsString(value);
 
 	/* Allow for some logic brick control */
-	CValue *tprop = self->GetProperty("Text");
+	CValue *tprop = self->GetProperty(textKey);
 	if (tprop) {
 		CValue *newstringprop = new CStringValue(std::string(chars), "Text");
-		self->SetProperty("Text", newstringprop);
+		self->SetProperty(textKey, newstringprop);
 		newstringprop->Release();
 	}
 	else {
@@ -69,6 +69,9 @@
 #include "KX_LodManager.h"
 #include "KX_BoundingBox.h"
 #include "KX_CullingNode.h"
+#include "KX_CullingTree.h"
+#include "KX_ExpiryScheduler.h"
+#include "KX_ActivityGrid.h"
 #include "KX_BatchGroup.h"
 #include "KX_CollisionContactPoints.h"
 
@@ -97,6 +100,7 @@
 #include "BLI_math.h"
 
 #include "CM_Message.h"
+#include "CM_Profiler.h"
 
 static MT_Vector3 dummy_point= MT_Vector3(0.0f, 0.0f, 0.0f);
 static MT_Vector3 dummy_scaling = MT_Vector3(1.0f, 1.0f, 1.0f);
@@ -133,7 +137,7 @@ KX_GameObject::KX_GameObject(
 {
 	m_ignore_activity_culling = false;
 	m_pClient_info = new KX_ClientObjectInfo(this, KX_ClientObjectInfo::ACTOR);
-	m_pSGNode = new SG_Node(this,sgReplicationInfo,callbacks);
+	m_pSGNode = new SG_Node(this,sgReplicationInfo,callbacks,static_cast<KX_Scene *>(sgReplicationInfo)->GetTransformPool());
 
 	// define the relationship between this node and it's parent.
 	
@@ -512,6 +516,9 @@ void KX_GameObject::ProcessReplica()
 	m_pSGNode = nullptr;
 
 	m_cullingNode.SetObject(this);
+	// The replica is added in the culling tree of the scene separately.
+	m_cullingNode.SetTreeLeaf(-1);
+	m_cullingNode.SetTreeModified(false);
 
 	/* Dupli group and instance list are set later in replication.
 	 * See KX_Scene::DupliGroupRecurse. */
@@ -542,6 +549,42 @@ void KX_GameObject::ProcessReplica()
 #endif
 }
 
+void KX_GameObject::ResetReplica(KX_GameObject *original)
+{
+	CopyProperties(original);
+	// The name could have been changed from python.
+	SetName(original->GetName());
+
+	// Stop all the actions, the object is added again in the animated objects when needed.
+	if (m_actionManager) {
+		delete m_actionManager;
+		m_actionManager = nullptr;
+	}
+
+	m_bVisible = original->m_bVisible;
+	m_objectColor = original->m_objectColor;
+
+	// The state mask is restored from the initial state when the object is added again.
+	m_initState = original->m_initState;
+	for (SCA_ISensor *sensor : m_sensors) {
+		sensor->Reset();
+	}
+
+#ifdef WITH_PYTHON
+	if (m_attr_dict) {
+		PyDict_Clear(m_attr_dict);
+		Py_CLEAR(m_attr_dict);
+	}
+	if (original->m_attr_dict) {
+		m_attr_dict = PyDict_Copy(original->m_attr_dict);
+	}
+	if (m_collisionCallbacks) {
+		UnregisterCollisionCallbacks();
+		Py_CLEAR(m_collisionCallbacks);
+	}
+#endif
+}
+
 static void setGraphicController_recursive(SG_Node* node)
 {
 	NodeList& children = node->GetSGChildren();
@@ -711,18 +754,12 @@ void KX_GameObject::ApplyRotation(const MT_Vector3& drot,bool local)
  */
 float *KX_GameObject::GetOpenGLMatrix()
 {
-	// todo: optimize and only update if necessary
 	float *fl = m_OpenGL_4x4Matrix.getPointer();
 	if (GetSGNode()) {
-		MT_Transform trans;
-	
-		trans.setOrigin(GetSGNode()->GetWorldPosition());
-		trans.setBasis(GetSGNode()->GetWorldOrientation());
-	
-		MT_Vector3 scaling = GetSGNode()->GetWorldScaling();
+		const MT_Vector3& scaling = GetSGNode()->GetWorldScaling();
 		m_bIsNegativeScaling = ((scaling[0] < 0.0f) ^ (scaling[1] < 0.0f) ^ (scaling[2] < 0.0f)) ? true : false;
-		trans.scale(scaling[0], scaling[1], scaling[2]);
-		trans.getValue(fl);
+		// The matrix is computed by the scene transform pool, usually during the scene graph update.
+		memcpy(fl, GetSGNode()->GetWorldMatrix(), sizeof(float) * 16);
 		GetSGNode()->ClearDirty();
 	}
 	return fl;
@@ -824,6 +861,11 @@ KX_LodManager *KX_GameObject::GetLodManager() const
 	return m_lodManager;
 }
 
+short KX_GameObject::GetLodLevel() const
+{
+	return m_currentLodLevel;
+}
+
 void KX_GameObject::UpdateLod(const MT_Vector3& cam_pos, float lodfactor)
 {
 	if (!m_lodManager) {
@@ -853,6 +895,9 @@ void KX_GameObject::UpdateTransform()
 		// update the culling tree
 		m_pGraphicController->SetGraphicTransform();
 
+	KX_Scene *scene = GetScene();
+	scene->GetCullingTree()->SetNodeModified(&m_cullingNode);
+	scene->GetActivityGrid()->SetObjectModified(this);
 }
 
 void KX_GameObject::UpdateTransformFunc(SG_Node* node, void* gameobj, void* scene)
@@ -867,6 +912,10 @@ void KX_GameObject::SynchronizeTransform()
 		m_pPhysicsController->SetTransform();
 	if (m_pGraphicController)
 		m_pGraphicController->SetGraphicTransform();
+
+	KX_Scene *scene = GetScene();
+	scene->GetCullingTree()->SetNodeModified(&m_cullingNode);
+	scene->GetActivityGrid()->SetObjectModified(this);
 }
 
 void KX_GameObject::SynchronizeTransformFunc(SG_Node* node, void* gameobj, void* scene)
@@ -1469,6 +1518,11 @@ void KX_GameObject::SetBoundsAabb(MT_Vector3 aabbMin, MT_Vector3 aabbMax)
 	if (m_pGraphicController) {
 		m_pGraphicController->SetLocalAabb(aabbMin, aabbMax);
 	}
+
+	// Synchronize the AABB with the culling tree.
+	if (m_pSGNode) {
+		GetScene()->GetCullingTree()->SetNodeModified(&m_cullingNode);
+	}
 }
 
 void KX_GameObject::GetBoundsAabb(MT_Vector3 &aabbMin, MT_Vector3 &aabbMax) const
@@ -1636,6 +1690,8 @@ void KX_GameObject::UpdateComponents()
 	}
 
 	for (KX_PythonComponent *comp : m_components) {
+		CM_ProfilerScope profile("component", [this, comp]() { return GetName() + "." + comp->GetName(); });
+
 		comp->Update();
 	}
 
@@ -2447,11 +2503,11 @@ PyObject *KX_GameObject::pyattr_get_life(PyObjectPlus *self_v, const KX_PYATTRIB
 {
 	KX_GameObject* self = static_cast<KX_GameObject*>(self_v);
 
-	CValue *life = self->GetProperty("::timebomb");
-	if (life)
+	double life;
+	if (self->GetScene()->GetExpiryScheduler()->GetLifeTime(self, life))
 		// this convert the timebomb seconds to frames, hard coded 50.0f (assuming 50fps)
 		// value hardcoded in KX_Scene::AddReplicaObject()
-		return PyFloat_FromDouble(life->GetNumber() * 50.0);
+		return PyFloat_FromDouble(life * 50.0);
 	else
 		Py_RETURN_NONE;
 }
@@ -380,6 +380,13 @@ public:
 	 */
 	virtual void ProcessReplica();
 
+	/**
+	 * Reset the data of a recycled replica to the data of its original object:
+	 * name, properties, python attributes, collision callbacks, actions, visibility,
+	 * color, initial state and sensors.
+	 */
+	void ResetReplica(KX_GameObject *original);
+
 	/** 
 	 * Return the linear velocity of the game object.
 	 */
@@ -753,6 +760,8 @@ public:
 	void SetLodManager(KX_LodManager *lodManager);
 	/// Get current lod manager.
 	KX_LodManager *GetLodManager() const;
+	/// Get the lod level used by the last lod update.
+	short GetLodLevel() const;
 
 	/**
 	 * Updates the current lod level based on distance from camera.
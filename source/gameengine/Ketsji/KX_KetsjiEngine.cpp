@@ -35,6 +35,7 @@
 #endif
 
 #include "CM_Message.h"
+#include "CM_Profiler.h"
 
 #include <boost/format.hpp>
 
@@ -58,6 +59,7 @@
 #include "KX_Camera.h"
 #include "KX_Light.h"
 #include "KX_Globals.h"
+#include "KX_MotionState.h"
 #include "KX_PyConstraintBinding.h"
 #include "PHY_IPhysicsEnvironment.h"
 
@@ -146,6 +148,7 @@ KX_KetsjiEngine::KX_KetsjiEngine(KX_ISystem *system)
 	m_maxPhysicsFrame(5),
 	m_ticrate(DEFAULT_LOGIC_TIC_RATE),
 	m_anim_framerate(25.0),
+	m_actionSampleRate(0.0f),
 	m_doRender(true),
 	m_exitkey(130),
 	m_exitcode(KX_ExitRequest::NO_REQUEST),
@@ -159,15 +162,21 @@ KX_KetsjiEngine::KX_KetsjiEngine(KX_ISystem *system)
 	m_showCameraFrustum(KX_DebugOption::DISABLE),
 	m_showShadowFrustum(KX_DebugOption::DISABLE)
 {
+	m_logger.SetProfileTrack("Engine");
 	for (int i = tc_first; i < tc_numCategories; i++) {
-		m_logger.AddCategory((KX_TimeCategory)i);
+		m_logger.AddCategory((KX_TimeCategory)i, GetProfileName((KX_TimeCategory)i));
 	}
 
 #ifdef WITH_PYTHON
 	m_pyprofiledict = PyDict_New();
+	m_pysceneprofiledict = PyDict_New();
 #endif
 
-	m_taskscheduler = BLI_task_scheduler_create(TASK_SCHEDULER_AUTO_THREADS);
+	// Many small tasks are pushed each frame, the per thread deques avoid the global queue lock.
+	m_taskscheduler = BLI_task_scheduler_create_ex(TASK_SCHEDULER_AUTO_THREADS, TASK_SCHEDULER_QUEUE_WORK_STEALING);
+
+	m_scenePoolData.m_engine = this;
+	m_scenePool = BLI_task_pool_create(m_taskscheduler, &m_scenePoolData);
 
 	m_scenes = new CListValue<KX_Scene>();
 }
@@ -179,8 +188,15 @@ KX_KetsjiEngine::~KX_KetsjiEngine()
 {
 #ifdef WITH_PYTHON
 	Py_CLEAR(m_pyprofiledict);
+	Py_CLEAR(m_pysceneprofiledict);
 #endif
 
+	if (m_scenePool) {
+		// The engine is normally stopped before, never free the pool with running tasks.
+		BLI_task_pool_work_and_wait(m_scenePool);
+		BLI_task_pool_free(m_scenePool);
+	}
+
 	if (m_taskscheduler)
 		BLI_task_scheduler_free(m_taskscheduler);
 
@@ -216,6 +232,12 @@ PyObject *KX_KetsjiEngine::GetPyProfileDict()
 	Py_INCREF(m_pyprofiledict);
 	return m_pyprofiledict;
 }
+
+PyObject *KX_KetsjiEngine::GetPySceneProfileDict()
+{
+	Py_INCREF(m_pysceneprofiledict);
+	return m_pysceneprofiledict;
+}
 #endif
 
 void KX_KetsjiEngine::SetConverter(KX_BlenderConverter *converter)
@@ -265,12 +287,34 @@ void KX_KetsjiEngine::EndFrame()
 		PyDict_SetItemString(m_pyprofiledict, m_profileLabels[i].c_str(), val);
 		Py_DECREF(val);
 	}
+
+	PyDict_Clear(m_pysceneprofiledict);
+	for (KX_Scene *scene : m_scenes) {
+		KX_TimeCategoryLogger& sceneLogger = scene->GetTimeLogger();
+		PyObject *sceneDict = PyDict_New();
+		for (KX_TimeCategory tc : {tc_physics, tc_logic, tc_scenegraph}) {
+			double time = sceneLogger.GetAverage(tc);
+			PyObject *val = PyTuple_New(2);
+			PyTuple_SetItem(val, 0, PyFloat_FromDouble(time * 1000.0));
+			PyTuple_SetItem(val, 1, PyFloat_FromDouble(time / tottime * 100.0));
+
+			PyDict_SetItemString(sceneDict, m_profileLabels[tc].c_str(), val);
+			Py_DECREF(val);
+		}
+
+		PyDict_SetItemString(m_pysceneprofiledict, scene->GetName().c_str(), sceneDict);
+		Py_DECREF(sceneDict);
+	}
 #endif
 
 	m_average_framerate = 1.0 / tottime;
 
 	// Go to next profiling measurement, time spent after this call is shown in the next frame.
 	m_logger.NextMeasurement(m_kxsystem->GetTimeInSeconds());
+	CM_Profiler::NextFrame();
+	for (KX_Scene *scene : m_scenes) {
+		scene->GetTimeLogger().NextMeasurement(m_kxsystem->GetTimeInSeconds());
+	}
 
 	m_logger.StartLog(tc_rasterizer, m_kxsystem->GetTimeInSeconds());
 	m_rasterizer->EndFrame();
@@ -286,6 +330,10 @@ bool KX_KetsjiEngine::NextFrame()
 {
 	m_logger.StartLog(tc_services, m_kxsystem->GetTimeInSeconds());
 
+	/* Synchronization point, the logic and the scene management
+	 * read the physics proceeded during the render. */
+	FinishAsyncPhysics();
+
 	/*
 	 * Clock advancement. There is basically two case:
 	 *   - USE_EXTERNAL_CLOCK is true, the user is responsible to advance the time
@@ -373,18 +421,28 @@ bool KX_KetsjiEngine::NextFrame()
 		}
 #endif  // WITH_SDL
 
+		/* When the scenes are proceeded concurrently, the logic of all the scenes is
+		 * proceeded first in the main thread, then the physics and scene graph of the
+		 * scenes are proceeded in parallel. */
+		const bool concurrent = (m_flags & PARALLEL_SCENES) && CanProceedScenesConcurrently();
+		/* The physics of the last logic frame can be proceeded while the frame is rendered,
+		 * the logic of all the scenes is then proceeded first like for the concurrent scenes. */
+		const bool async = (frames == 1) && CanProceedScenesAsynchronously();
+		// The scenes which proceeded their logic and will proceed their physics concurrently.
+		std::vector<KX_Scene *> concurrentScenes;
+
 		// for each scene, call the proceed functions
 		for (KX_Scene *scene : m_scenes) {
 			/* Suspension holds the physics and logic processing for an
 			 * entire scene. Objects can be suspended individually, and
 			 * the settings for that precede the logic and physics
 			 * update. */
-			m_logger.StartLog(tc_logic, m_kxsystem->GetTimeInSeconds());
+			StartLog(scene, tc_logic, false);
 
 			scene->UpdateObjectActivity();
 
 			if (!scene->IsSuspended()) {
-				m_logger.StartLog(tc_physics, m_kxsystem->GetTimeInSeconds());
+				StartLog(scene, tc_physics, false);
 				// set Python hooks for each scene
 #ifdef WITH_PYTHON
 				PHY_SetActiveEnvironment(scene->GetPhysicsEnvironment());
@@ -394,37 +452,61 @@ bool KX_KetsjiEngine::NextFrame()
 				scene->GetPhysicsEnvironment()->EndFrame();
 
 				// Process sensors, and controllers
-				m_logger.StartLog(tc_logic, m_kxsystem->GetTimeInSeconds());
+				StartLog(scene, tc_logic, false);
 				scene->LogicBeginFrame(m_frameTime, framestep);
 
 				// Scenegraph needs to be updated again, because Logic Controllers
 				// can affect the local matrices.
-				m_logger.StartLog(tc_scenegraph, m_kxsystem->GetTimeInSeconds());
+				StartLog(scene, tc_scenegraph, false);
 				scene->UpdateParents(m_frameTime);
 
 				// Process actuators
 
 				// Do some cleanup work for this logic frame
-				m_logger.StartLog(tc_logic, m_kxsystem->GetTimeInSeconds());
+				StartLog(scene, tc_logic, false);
 				scene->LogicUpdateFrame(m_frameTime);
 
 				scene->LogicEndFrame();
 
 				// Actuators can affect the scenegraph
-				m_logger.StartLog(tc_scenegraph, m_kxsystem->GetTimeInSeconds());
+				StartLog(scene, tc_scenegraph, false);
 				scene->UpdateParents(m_frameTime);
 
-				m_logger.StartLog(tc_physics, m_kxsystem->GetTimeInSeconds());
+				StartLog(scene, tc_physics, false);
 				scene->GetPhysicsEnvironment()->BeginFrame();
 
-				// Perform physics calculations on the scene. This can involve
-				// many iterations of the physics solver.
-				scene->GetPhysicsEnvironment()->ProceedDeltaTime(m_frameTime, timestep, framestep);//m_deltatimerealDeltaTime);
+				if (async) {
+					m_asyncScenes.emplace_back();
+					m_asyncScenes.back().m_scene = scene;
+				}
+				else if (concurrent) {
+					concurrentScenes.push_back(scene);
+				}
+				else {
+					ProceedScenePhysics(scene, framestep, timestep, false);
+				}
+			}
+
+			scene->GetTimeLogger().EndLog(m_kxsystem->GetTimeInSeconds());
+			m_logger.StartLog(tc_services, m_kxsystem->GetTimeInSeconds());
+		}
 
-				m_logger.StartLog(tc_scenegraph, m_kxsystem->GetTimeInSeconds());
-				scene->UpdateParents(m_frameTime);
+		if (!m_asyncScenes.empty()) {
+			StartAsyncPhysics(framestep, timestep);
+		}
+		else if (!concurrentScenes.empty()) {
+			m_logger.StartLog(tc_physics, m_kxsystem->GetTimeInSeconds());
+
+			m_scenePoolData.m_framestep = framestep;
+			m_scenePoolData.m_timestep = timestep;
+			for (KX_Scene *scene : concurrentScenes) {
+				BLI_task_pool_push(m_scenePool, ProceedScenePhysicsTask, scene, false, TASK_PRIORITY_HIGH);
 			}
 
+			/* Synchronization point, no scene is proceeding its physics past this call.
+			 * The scene management, input and network cleanup can be done safely. */
+			BLI_task_pool_work_and_wait(m_scenePool);
+
 			m_logger.StartLog(tc_services, m_kxsystem->GetTimeInSeconds());
 		}
 
@@ -452,6 +534,139 @@ bool KX_KetsjiEngine::NextFrame()
 	return doRender && m_doRender;
 }
 
+void KX_KetsjiEngine::ProceedScenePhysics(KX_Scene *scene, double framestep, double timestep, bool concurrent)
+{
+	// Perform physics calculations on the scene. This can involve
+	// many iterations of the physics solver.
+	StartLog(scene, tc_physics, concurrent);
+	scene->GetPhysicsEnvironment()->ProceedDeltaTime(m_frameTime, timestep, framestep);//m_deltatimerealDeltaTime);
+
+	StartLog(scene, tc_scenegraph, concurrent);
+	scene->UpdateParents(m_frameTime);
+
+	if (concurrent) {
+		scene->GetTimeLogger().EndLog(m_kxsystem->GetTimeInSeconds());
+	}
+}
+
+bool KX_KetsjiEngine::CanProceedScenesConcurrently() const
+{
+	if (m_scenes->GetCount() < 2) {
+		return false;
+	}
+
+	/* Bullet uses global variables set by each physics environment in BeginFrame,
+	 * the scenes can't be proceeded concurrently if they don't agree on them. */
+	PHY_IPhysicsEnvironment *firstEnv = m_scenes->GetFront()->GetPhysicsEnvironment();
+	for (KX_Scene *scene : m_scenes) {
+		if (!firstEnv->CanProceedConcurrently(scene->GetPhysicsEnvironment())) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void KX_KetsjiEngine::ProceedScenePhysicsTask(TaskPool *__restrict pool, void *taskdata, int UNUSED(threadid))
+{
+	ScenePoolData *data = (ScenePoolData *)BLI_task_pool_userdata(pool);
+	KX_Scene *scene = (KX_Scene *)taskdata;
+
+	data->m_engine->ProceedScenePhysics(scene, data->m_framestep, data->m_timestep, true);
+}
+
+bool KX_KetsjiEngine::CanProceedScenesAsynchronously() const
+{
+	if (!(m_flags & ASYNC_PHYSICS)) {
+		return false;
+	}
+
+	for (KX_Scene *scene : m_scenes) {
+#ifdef WITH_PYTHON
+		// The draw callbacks could access any object during the render.
+		if (scene->HasDrawingCallbacks()) {
+			return false;
+		}
+#endif
+		if (!scene->GetPhysicsEnvironment()->CanProceedAsynchronously()) {
+			return false;
+		}
+	}
+
+	// The scenes are proceeded at the same time.
+	return (m_scenes->GetCount() < 2 || CanProceedScenesConcurrently());
+}
+
+void KX_KetsjiEngine::StartAsyncPhysics(double framestep, double timestep)
+{
+	// The scene management could free a scene proceeded in a task.
+	if (m_addingOverlayScenes.size() || m_addingBackgroundScenes.size() || m_replace_scenes.size() || m_removingScenes.size()) {
+		for (const AsyncPhysicsScene& asyncScene : m_asyncScenes) {
+			ProceedScenePhysics(asyncScene.m_scene, framestep, timestep, false);
+			asyncScene.m_scene->GetTimeLogger().EndLog(m_kxsystem->GetTimeInSeconds());
+		}
+		m_asyncScenes.clear();
+		m_logger.StartLog(tc_services, m_kxsystem->GetTimeInSeconds());
+		return;
+	}
+
+	m_scenePoolData.m_framestep = framestep;
+	m_scenePoolData.m_timestep = timestep;
+	for (AsyncPhysicsScene& asyncScene : m_asyncScenes) {
+		BLI_task_pool_push(m_scenePool, ProceedScenePhysicsAsyncTask, &asyncScene, false, TASK_PRIORITY_HIGH);
+	}
+}
+
+void KX_KetsjiEngine::FinishAsyncPhysics()
+{
+	if (m_asyncScenes.empty()) {
+		return;
+	}
+
+	// Time spent waiting for the physics not overlapped by the render.
+	m_logger.StartLog(tc_physics, m_kxsystem->GetTimeInSeconds());
+	BLI_task_pool_work_and_wait(m_scenePool);
+
+	m_logger.StartLog(tc_scenegraph, m_kxsystem->GetTimeInSeconds());
+	for (AsyncPhysicsScene& asyncScene : m_asyncScenes) {
+		KX_MotionState::ApplyBufferList(asyncScene.m_motionStates);
+		asyncScene.m_scene->UpdateParents(m_frameTime);
+	}
+	m_asyncScenes.clear();
+
+	m_logger.StartLog(tc_services, m_kxsystem->GetTimeInSeconds());
+}
+
+void KX_KetsjiEngine::ProceedScenePhysicsAsyncTask(TaskPool *__restrict pool, void *taskdata, int UNUSED(threadid))
+{
+	ScenePoolData *data = (ScenePoolData *)BLI_task_pool_userdata(pool);
+	AsyncPhysicsScene *asyncScene = (AsyncPhysicsScene *)taskdata;
+
+	/* The nodes are read by the render, the transforms are kept in the motion states
+	 * until the scene graph is updated in FinishAsyncPhysics. The time loggers are
+	 * used by the render and not updated. */
+	KX_MotionState::SetBufferList(&asyncScene->m_motionStates);
+	asyncScene->m_scene->GetPhysicsEnvironment()->ProceedDeltaTime(data->m_engine->m_frameTime, data->m_timestep, data->m_framestep);
+	KX_MotionState::SetBufferList(nullptr);
+}
+
+void KX_KetsjiEngine::StartLog(KX_Scene *scene, KX_TimeCategory tc, bool concurrent)
+{
+	const double now = m_kxsystem->GetTimeInSeconds();
+	// The engine time logger is only used from the main thread.
+	if (!concurrent) {
+		m_logger.StartLog(tc, now);
+	}
+	scene->GetTimeLogger().StartLog(tc, now);
+}
+
+std::string KX_KetsjiEngine::GetProfileName(KX_TimeCategory tc)
+{
+	const std::string& label = m_profileLabels[tc];
+	// Remove the trailing colon of the label.
+	return label.substr(0, label.size() - 1);
+}
+
 void KX_KetsjiEngine::UpdateSuspendedScenes(double framestep)
 {
 	for (KX_Scene *scene : m_scenes) {
@@ -1061,6 +1276,7 @@ RAS_OffScreen *KX_KetsjiEngine::PostRenderScene(KX_Scene *scene, RAS_OffScreen *
 void KX_KetsjiEngine::StopEngine()
 {
 	if (m_bInitialized) {
+		FinishAsyncPhysics();
 		m_converter->FinalizeAsyncLoads();
 
 		while (m_scenes->GetCount() > 0) {
@@ -1085,6 +1301,14 @@ void KX_KetsjiEngine::AddScene(KX_Scene *scene)
 
 void KX_KetsjiEngine::PostProcessScene(KX_Scene *scene)
 {
+	// Setup the scene time logger like the engine one for the categories logged per scene.
+	KX_TimeCategoryLogger& sceneLogger = scene->GetTimeLogger();
+	sceneLogger.SetMaxNumMeasurements(m_logger.GetMaxNumMeasurements());
+	sceneLogger.SetProfileTrack(scene->GetName());
+	for (KX_TimeCategory tc : {tc_physics, tc_logic, tc_scenegraph}) {
+		sceneLogger.AddCategory(tc, GetProfileName(tc));
+	}
+
 	bool override_camera = ((m_flags & CAMERA_OVERRIDE) && (scene->GetName() == m_overrideSceneName));
 
 	// if there is no activecamera, or the camera is being
@@ -1517,6 +1741,16 @@ void KX_KetsjiEngine::SetAnimFrameRate(double framerate)
 	m_anim_framerate = framerate;
 }
 
+float KX_KetsjiEngine::GetActionSampleRate() const
+{
+	return m_actionSampleRate;
+}
+
+void KX_KetsjiEngine::SetActionSampleRate(float rate)
+{
+	m_actionSampleRate = rate;
+}
+
 double KX_KetsjiEngine::GetAverageFrameRate()
 {
 	return m_average_framerate;
@@ -46,9 +46,11 @@
 #include <vector>
 
 struct TaskScheduler;
+struct TaskPool;
 class KX_ISystem;
 class KX_BlenderConverter;
 class KX_NetworkMessageManager;
+class KX_MotionState;
 class RAS_ICanvas;
 class RAS_OffScreen;
 class SCA_IInputDevice;
@@ -100,9 +102,29 @@ public:
 		/// Automatic add debug properties to the debug list.
 		AUTO_ADD_DEBUG_PROPERTIES = (1 << 6),
 		/// Use override camera?
-		CAMERA_OVERRIDE = (1 << 7)
+		CAMERA_OVERRIDE = (1 << 7),
+		/// Proceed the physics and scene graph of the scenes concurrently.
+		PARALLEL_SCENES = (1 << 8),
+		/// Proceed the physics of the last logic frame while the frame is rendered.
+		ASYNC_PHYSICS = (1 << 9)
 	};
 
+	/// Categories for profiling display.
+	typedef enum {
+		tc_first = 0,
+		tc_physics = 0,
+		tc_logic,
+		tc_animations,
+		tc_network,
+		tc_scenegraph,
+		tc_rasterizer,
+		tc_services, // time spent in miscelaneous activities
+		tc_overhead, // profile info drawing overhead
+		tc_outside, // time spent outside main loop
+		tc_latency, // time spent waiting on the gpu
+		tc_numCategories
+	} KX_TimeCategory;
+
 private:
 	struct CameraRenderData
 	{
@@ -144,6 +166,7 @@ private:
 	KX_NetworkMessageManager *m_networkMessageManager;
 #ifdef WITH_PYTHON
 	PyObject *m_pyprofiledict;
+	PyObject *m_pysceneprofiledict;
 #endif
 	SCA_IInputDevice *m_inputDevice;
 
@@ -183,6 +206,8 @@ private:
 	double m_ticrate;
 	/// for animation playback only - ipo and action
 	double m_anim_framerate;
+	/// Number of samples per frame of the compiled actions, zero to disable sampling.
+	float m_actionSampleRate;
 
 	bool m_doRender;  /* whether or not the scene should be rendered after the logic frame */
 
@@ -201,22 +226,6 @@ private:
 	/// Default camera zoom.
 	float m_overrideCamZoom;
 
-	/// Categories for profiling display.
-	typedef enum {
-		tc_first = 0,
-		tc_physics = 0,
-		tc_logic,
-		tc_animations,
-		tc_network,
-		tc_scenegraph,
-		tc_rasterizer,
-		tc_services, // time spent in miscelaneous activities
-		tc_overhead, // profile info drawing overhead
-		tc_outside, // time spent outside main loop
-		tc_latency, // time spent waiting on the gpu
-		tc_numCategories
-	} KX_TimeCategory;
-
 	/// Time logger.
 	KX_TimeCategoryLogger m_logger;
 
@@ -240,6 +249,29 @@ private:
 	/// Task scheduler for multi-threading
 	TaskScheduler *m_taskscheduler;
 
+	/// Data shared by the tasks proceeding the scenes concurrently.
+	struct ScenePoolData
+	{
+		KX_KetsjiEngine *m_engine;
+		double m_framestep;
+		double m_timestep;
+	};
+
+	ScenePoolData m_scenePoolData;
+	/// Task pool used to proceed the physics of the scenes concurrently.
+	TaskPool *m_scenePool;
+
+	/// A scene proceeding its physics while the frame is rendered.
+	struct AsyncPhysicsScene
+	{
+		KX_Scene *m_scene;
+		/// Motion states written by the physics, applied after the render.
+		std::vector<KX_MotionState *> m_motionStates;
+	};
+
+	/// Scenes proceeding their physics in m_scenePool during the render.
+	std::vector<AsyncPhysicsScene> m_asyncScenes;
+
 	/** Set scene's total pause duration for animations process.
 	 * This is done in a separate loop to get the proper state of each scenes.
 	 * eg: There's 2 scenes, the first is suspended and the second is active.
@@ -284,6 +316,34 @@ private:
 	void ReplaceScheduledScenes(void);
 	void PostProcessScene(KX_Scene *scene);
 
+	/** Proceed the physics and the scene graph of a scene after its logic.
+	 * \param concurrent True when called from a task of m_scenePool, in this case
+	 * only the scene time logger is used.
+	 */
+	void ProceedScenePhysics(KX_Scene *scene, double framestep, double timestep, bool concurrent);
+	/// Return true if all the scenes can proceed their physics concurrently.
+	bool CanProceedScenesConcurrently() const;
+	/// Task function proceeding the physics of a scene, see ProceedScenePhysics.
+	static void ProceedScenePhysicsTask(TaskPool *__restrict pool, void *taskdata, int threadid);
+
+	/// Return true if the physics of all the scenes can be proceeded during the render.
+	bool CanProceedScenesAsynchronously() const;
+	/** Start the physics of the scenes in m_asyncScenes, they are proceeded serially
+	 * if the scene management is about to change the scenes.
+	 */
+	void StartAsyncPhysics(double framestep, double timestep);
+	/** Synchronization point waiting for the physics proceeded during the render, the
+	 * physics transforms are then written to the objects and the scene graph updated.
+	 */
+	void FinishAsyncPhysics();
+	/// Task function proceeding the physics of a scene with buffered motion states.
+	static void ProceedScenePhysicsAsyncTask(TaskPool *__restrict pool, void *taskdata, int threadid);
+
+	/// Start logging time in the scene time logger and in the engine logger if not concurrent.
+	void StartLog(KX_Scene *scene, KX_TimeCategory tc, bool concurrent);
+	/// Return the name of the phases of a time category recorded by the profiler.
+	static std::string GetProfileName(KX_TimeCategory tc);
+
 	void BeginFrame();
 	void EndFrame();
 
@@ -298,6 +358,7 @@ public:
 	void SetNetworkMessageManager(KX_NetworkMessageManager *manager);
 #ifdef WITH_PYTHON
 	PyObject *GetPyProfileDict();
+	PyObject *GetPySceneProfileDict();
 #endif
 	void SetConverter(KX_BlenderConverter *converter);
 	KX_BlenderConverter *GetConverter()
@@ -424,6 +485,15 @@ public:
 	 */
 	void SetAnimFrameRate(double framerate);
 
+	/**
+	 * Gets the number of samples per frame of the compiled actions.
+	 */
+	float GetActionSampleRate() const;
+	/**
+	 * Sets the number of samples per frame of the actions compiled after this call, zero to disable sampling.
+	 */
+	void SetActionSampleRate(float rate);
+
 	/**
 	 * Gets the last estimated average framerate
 	 */
@@ -32,8 +32,11 @@
 #include "KX_MotionState.h"
 #include "SG_Node.h"
 
+thread_local std::vector<KX_MotionState *> *KX_MotionState::m_bufferList = nullptr;
+
 KX_MotionState::KX_MotionState(SG_Node *node)
-	:m_node(node)
+	:m_node(node),
+	m_bufferFlags(0)
 {
 }
 
@@ -41,6 +44,21 @@ KX_MotionState::~KX_MotionState()
 {
 }
 
+bool KX_MotionState::Buffer(BufferFlag flag)
+{
+	if (!m_bufferList) {
+		return false;
+	}
+
+	// Register the motion state only once.
+	if (m_bufferFlags == 0) {
+		m_bufferList->push_back(this);
+	}
+	m_bufferFlags |= flag;
+
+	return true;
+}
+
 MT_Vector3 KX_MotionState::GetWorldPosition() const
 {
 	return m_node->GetWorldPosition();
@@ -58,17 +76,27 @@ MT_Matrix3x3 KX_MotionState::GetWorldOrientation() const
 
 void KX_MotionState::SetWorldOrientation(const MT_Matrix3x3& ori)
 {
-	m_node->SetLocalOrientation(ori);
+	if (Buffer(BUFFER_ORIENTATION)) {
+		m_orientation = ori;
+	}
+	else {
+		m_node->SetLocalOrientation(ori);
+	}
 }
 
 void KX_MotionState::SetWorldPosition(const MT_Vector3& pos)
 {
-	m_node->SetLocalPosition(pos);
+	if (Buffer(BUFFER_POSITION)) {
+		m_position = pos;
+	}
+	else {
+		m_node->SetLocalPosition(pos);
+	}
 }
 
 void KX_MotionState::SetWorldOrientation(const MT_Quaternion& quat)
 {
-	m_node->SetLocalOrientation(MT_Matrix3x3(quat));
+	SetWorldOrientation(MT_Matrix3x3(quat));
 }
 
 void KX_MotionState::CalculateWorldTransformations()
@@ -78,4 +106,22 @@ void KX_MotionState::CalculateWorldTransformations()
 	//m_node->ComputeWorldTransforms(nullptr, parentUpdated);
 }
 
+void KX_MotionState::SetBufferList(std::vector<KX_MotionState *> *list)
+{
+	m_bufferList = list;
+}
 
+void KX_MotionState::ApplyBufferList(std::vector<KX_MotionState *>& list)
+{
+	for (KX_MotionState *motionState : list) {
+		if (motionState->m_bufferFlags & BUFFER_ORIENTATION) {
+			motionState->m_node->SetLocalOrientation(motionState->m_orientation);
+		}
+		if (motionState->m_bufferFlags & BUFFER_POSITION) {
+			motionState->m_node->SetLocalPosition(motionState->m_position);
+		}
+		motionState->m_bufferFlags = 0;
+	}
+
+	list.clear();
+}
@@ -34,12 +34,33 @@
 
 #include "PHY_IMotionState.h"
 
+#include "MT_Vector3.h"
+#include "MT_Matrix3x3.h"
+
+#include <vector>
+
 class SG_Node;
 
 class KX_MotionState : public PHY_IMotionState
 {
 	SG_Node *m_node;
 
+	enum BufferFlag {
+		BUFFER_POSITION = (1 << 0),
+		BUFFER_ORIENTATION = (1 << 1)
+	};
+
+	/// Transform written while the motion state is buffered, see SetBufferList.
+	MT_Vector3 m_position;
+	MT_Matrix3x3 m_orientation;
+	short m_bufferFlags;
+
+	/// List of the buffered motion states of the current thread, nullptr when not buffering.
+	static thread_local std::vector<KX_MotionState *> *m_bufferList;
+
+	/// Return true if the transform must be written in the buffer.
+	bool Buffer(BufferFlag flag);
+
 public:
 	KX_MotionState(SG_Node *spatial);
 	virtual ~KX_MotionState();
@@ -53,6 +74,16 @@ public:
 	virtual void SetWorldOrientation(const MT_Quaternion& quat);
 
 	virtual void CalculateWorldTransformations();
+
+	/** Buffer the transforms written in the motion states by the current thread instead
+	 * of writing them in the nodes. It allows to proceed the physics while the nodes are
+	 * read by an other thread. The getters still return the node transform as the world
+	 * transform is only updated after the scene graph update.
+	 * \param list The list receiving the buffered motion states, nullptr to stop buffering.
+	 */
+	static void SetBufferList(std::vector<KX_MotionState *> *list);
+	/// Write the buffered transforms to the nodes and clear the list.
+	static void ApplyBufferList(std::vector<KX_MotionState *>& list);
 };
 
 #endif  // __KX_MOTIONSTATE_H__
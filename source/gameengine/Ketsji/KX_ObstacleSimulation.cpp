@@ -28,9 +28,26 @@
 
 #include "KX_ObstacleSimulation.h"
 #include "KX_NavMeshObject.h"
+#include "KX_KetsjiEngine.h"
 #include "KX_Globals.h"
 #include "DNA_object_types.h"
 #include "BLI_math.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
+#include "BLI_utildefines.h"
+
+#include <algorithm>
+
+/// Minimum number of obstacles to update them in parallel.
+static const unsigned int obstacleParallelThreshold = 256;
+/// Number of obstacles updated by a task.
+static const unsigned int obstacleTaskChunkSize = 64;
+/// Minimum size of a grid cell.
+static const MT_Scalar minCellSize = 1.0f;
+/// Maximum number of grid cells per obstacle.
+static const unsigned int maxCellsPerObstacle = 4;
+/// Default maximum number of circles used to sample the velocity.
+static const unsigned int defaultMaxNeighbours = 16;
 
 namespace
 {
@@ -172,8 +189,14 @@ static float interpolateToi(float a, const float* dir, const float* toi, const i
 KX_ObstacleSimulation::KX_ObstacleSimulation(MT_Scalar levelHeight, bool enableVisualization)
 :	m_levelHeight(levelHeight)
 ,	m_enableVisualization(enableVisualization)
+,	m_cellSize(minCellSize)
+,	m_gridDirty(true)
+,	m_maxRadius(0.0f)
+,	m_maxSpeed(0.0f)
+,	m_maxNeighbours(defaultMaxNeighbours)
 {
-
+	m_gridOrigin[0] = m_gridOrigin[1] = 0.0f;
+	m_gridSize[0] = m_gridSize[1] = 0;
 }
 
 KX_ObstacleSimulation::~KX_ObstacleSimulation()
@@ -198,7 +221,9 @@ KX_Obstacle* KX_ObstacleSimulation::CreateObstacle(KX_GameObject* gameobj)
 		vset(&obstacle->hvel[i*2], 0,0);
 	obstacle->hhead = 0;
 
+	obstacle->m_index = m_obstacles.size();
 	m_obstacles.push_back(obstacle);
+	m_gridDirty = true;
 	return obstacle;
 }
 
@@ -209,6 +234,8 @@ void KX_ObstacleSimulation::AddObstacleForObj(KX_GameObject* gameobj)
 	obstacle->m_type = KX_OBSTACLE_OBJ;
 	obstacle->m_shape = KX_OBSTACLE_CIRCLE;
 	obstacle->m_rad = blenderobject->obstacleRad;
+	obstacle->m_pos = gameobj->NodeGetWorldPosition();
+	obstacle->m_worldPos = obstacle->m_worldPos2 = obstacle->m_pos;
 }
 
 void KX_ObstacleSimulation::AddObstaclesForNavMesh(KX_NavMeshObject* navmeshobj)
@@ -232,6 +259,8 @@ void KX_ObstacleSimulation::AddObstaclesForNavMesh(KX_NavMeshObject* navmeshobj)
 				obstacle->m_shape = KX_OBSTACLE_SEGMENT;
 				obstacle->m_pos = MT_Vector3(vj[0], vj[2], vj[1]);
 				obstacle->m_pos2 = MT_Vector3(vi[0], vi[2], vi[1]);
+				obstacle->m_worldPos = navmeshobj->TransformToWorldCoords(obstacle->m_pos);
+				obstacle->m_worldPos2 = navmeshobj->TransformToWorldCoords(obstacle->m_pos2);
 				obstacle->m_rad = 0;
 			}
 		}
@@ -246,22 +275,35 @@ void KX_ObstacleSimulation::DestroyObstacleForObj(KX_GameObject* gameobj)
 		{
 			KX_Obstacle* obstacle = m_obstacles[i];
 			m_obstacles[i] = m_obstacles.back();
+			m_obstacles[i]->m_index = i;
 			m_obstacles.pop_back();
 			delete obstacle;
+			m_gridDirty = true;
 		}
 		else
 			i++;
 	}
 }
 
-void KX_ObstacleSimulation::UpdateObstacles()
+void KX_ObstacleSimulation::UpdateObstacleRange(unsigned int start, unsigned int stop)
 {
-	for (size_t i=0; i<m_obstacles.size(); i++)
+	for (unsigned int i = start; i < stop; i++)
 	{
-		if (m_obstacles[i]->m_type==KX_OBSTACLE_NAV_MESH || m_obstacles[i]->m_shape==KX_OBSTACLE_SEGMENT)
+		KX_Obstacle* obs = m_obstacles[i];
+		if (obs->m_type==KX_OBSTACLE_NAV_MESH)
+		{
+			KX_NavMeshObject* navmeshobj = static_cast<KX_NavMeshObject*>(obs->m_gameObj);
+			obs->m_worldPos = navmeshobj->TransformToWorldCoords(obs->m_pos);
+			obs->m_worldPos2 = navmeshobj->TransformToWorldCoords(obs->m_pos2);
+			continue;
+		}
+		if (obs->m_shape==KX_OBSTACLE_SEGMENT)
+		{
+			obs->m_worldPos = obs->m_pos;
+			obs->m_worldPos2 = obs->m_pos2;
 			continue;
+		}
 
-		KX_Obstacle* obs = m_obstacles[i];
 		obs->m_pos = obs->m_gameObj->NodeGetWorldPosition();
 		obs->vel[0] = obs->m_gameObj->GetLinearVelocity().x();
 		obs->vel[1] = obs->m_gameObj->GetLinearVelocity().y();
@@ -276,6 +318,129 @@ void KX_ObstacleSimulation::UpdateObstacles()
 	}
 }
 
+void KX_ObstacleSimulation::UpdateObstaclesTask(TaskPool *pool, void *UNUSED(taskdata), int start, int stop,
+                                                int UNUSED(threadid))
+{
+	KX_ObstacleSimulation *simulation = (KX_ObstacleSimulation *)BLI_task_pool_userdata(pool);
+	simulation->UpdateObstacleRange(start, stop);
+}
+
+void KX_ObstacleSimulation::UpdateObstacles()
+{
+	const unsigned int size = m_obstacles.size();
+	TaskScheduler *scheduler = KX_GetActiveEngine()->GetTaskScheduler();
+
+	// The scenes can be updated in tasks, only use tasks from the main thread.
+	if (size >= obstacleParallelThreshold && BLI_thread_is_main() && BLI_task_scheduler_num_threads(scheduler) > 1)
+	{
+		TaskPool *pool = BLI_task_pool_create(scheduler, this);
+		BLI_task_pool_push_range(pool, UpdateObstaclesTask, nullptr, 0, size, obstacleTaskChunkSize, TASK_PRIORITY_HIGH);
+		BLI_task_pool_work_and_wait(pool);
+		BLI_task_pool_free(pool);
+	}
+	else
+		UpdateObstacleRange(0, size);
+
+	BuildGrid();
+}
+
+void KX_ObstacleSimulation::GetCellRange(MT_Scalar minx, MT_Scalar miny, MT_Scalar maxx, MT_Scalar maxy, int range[4]) const
+{
+	const MT_Scalar invCellSize = 1.0f / m_cellSize;
+	range[0] = (int)clamp(floorf((minx - m_gridOrigin[0]) * invCellSize), 0, m_gridSize[0] - 1);
+	range[1] = (int)clamp(floorf((miny - m_gridOrigin[1]) * invCellSize), 0, m_gridSize[1] - 1);
+	range[2] = (int)clamp(floorf((maxx - m_gridOrigin[0]) * invCellSize), 0, m_gridSize[0] - 1);
+	range[3] = (int)clamp(floorf((maxy - m_gridOrigin[1]) * invCellSize), 0, m_gridSize[1] - 1);
+}
+
+void KX_ObstacleSimulation::BuildGrid()
+{
+	m_gridDirty = false;
+	m_cellItems.clear();
+	m_maxRadius = 0.0f;
+	m_maxSpeed = 0.0f;
+
+	if (m_obstacles.empty())
+	{
+		m_gridSize[0] = m_gridSize[1] = 0;
+		m_cellStart.assign(1, 0);
+		return;
+	}
+
+	MT_Scalar bmin[2] = {FLT_MAX, FLT_MAX};
+	MT_Scalar bmax[2] = {-FLT_MAX, -FLT_MAX};
+	for (KX_Obstacle *obs : m_obstacles)
+	{
+		const MT_Vector3& p1 = (obs->m_shape == KX_OBSTACLE_SEGMENT) ? obs->m_worldPos : obs->m_pos;
+		const MT_Vector3& p2 = (obs->m_shape == KX_OBSTACLE_SEGMENT) ? obs->m_worldPos2 : obs->m_pos;
+		for (int i = 0; i < 2; ++i)
+		{
+			bmin[i] = std::min(bmin[i], std::min(p1[i], p2[i]));
+			bmax[i] = std::max(bmax[i], std::max(p1[i], p2[i]));
+		}
+		m_maxRadius = std::max(m_maxRadius, obs->m_rad);
+		if (obs->m_shape == KX_OBSTACLE_CIRCLE)
+			m_maxSpeed = std::max(m_maxSpeed, (MT_Scalar)len_v2(obs->vel));
+	}
+
+	// Cells about the size of the obstacles, enlarged to bound the number of cells.
+	const MT_Scalar extent[2] = {bmax[0] - bmin[0], bmax[1] - bmin[1]};
+	const MT_Scalar maxCells = maxCellsPerObstacle * m_obstacles.size() + 1;
+	m_cellSize = std::max(minCellSize, m_maxRadius * 4.0f);
+	const MT_Scalar area = (extent[0] + m_cellSize) * (extent[1] + m_cellSize);
+	if (area > maxCells * m_cellSize * m_cellSize)
+		m_cellSize = sqrtf(area / maxCells);
+
+	for (int i = 0; i < 2; ++i)
+	{
+		m_gridOrigin[i] = bmin[i];
+		m_gridSize[i] = (int)(extent[i] / m_cellSize) + 1;
+	}
+
+	const unsigned int numCells = m_gridSize[0] * m_gridSize[1];
+	m_cellStart.assign(numCells + 1, 0);
+
+	/* Counting sort of the obstacles per cell in two passes, the first pass counts
+	 * the items of every cell, the second pass decrements the end of every cell
+	 * while storing its items to finish with the start of every cell. */
+	for (int pass = 0; pass < 2; ++pass)
+	{
+		for (KX_Obstacle *obs : m_obstacles)
+		{
+			int range[4];
+			if (obs->m_shape == KX_OBSTACLE_SEGMENT)
+			{
+				GetCellRange(std::min(obs->m_worldPos.x(), obs->m_worldPos2.x()),
+				             std::min(obs->m_worldPos.y(), obs->m_worldPos2.y()),
+				             std::max(obs->m_worldPos.x(), obs->m_worldPos2.x()),
+				             std::max(obs->m_worldPos.y(), obs->m_worldPos2.y()), range);
+			}
+			else
+				GetCellRange(obs->m_pos.x(), obs->m_pos.y(), obs->m_pos.x(), obs->m_pos.y(), range);
+
+			for (int y = range[1]; y <= range[3]; ++y)
+			{
+				for (int x = range[0]; x <= range[2]; ++x)
+				{
+					const unsigned int cell = y * m_gridSize[0] + x;
+					if (pass == 0)
+						m_cellStart[cell]++;
+					else
+						m_cellItems[--m_cellStart[cell]] = obs;
+				}
+			}
+		}
+
+		if (pass == 0)
+		{
+			// Store the end of every cell.
+			for (unsigned int i = 1; i <= numCells; ++i)
+				m_cellStart[i] += m_cellStart[i - 1];
+			m_cellItems.resize(m_cellStart[numCells]);
+		}
+	}
+}
+
 KX_Obstacle* KX_ObstacleSimulation::GetObstacle(KX_GameObject* gameobj)
 {
 	for (size_t i=0; i<m_obstacles.size(); i++)
@@ -364,6 +529,66 @@ static bool filterObstacle(KX_Obstacle* activeObst, KX_NavMeshObject* activeNavM
 	return true;
 }
 
+void KX_ObstacleSimulation::FindNeighbours(KX_Obstacle *activeObst, KX_NavMeshObject *activeNavMeshObj,
+                                           MT_Scalar distance, KX_Obstacles& neighbours)
+{
+	if (m_gridDirty)
+		BuildGrid();
+
+	neighbours.clear();
+	m_candidates.clear();
+
+	const MT_Vector2 pos = activeObst->m_pos.to2d();
+	const MT_Scalar reach = distance + activeObst->m_rad + m_maxRadius;
+	int range[4];
+	GetCellRange(pos.x() - reach, pos.y() - reach, pos.x() + reach, pos.y() + reach, range);
+
+	for (int y = range[1]; y <= range[3]; ++y)
+	{
+		for (int x = range[0]; x <= range[2]; ++x)
+		{
+			const unsigned int cell = y * m_gridSize[0] + x;
+			for (unsigned int i = m_cellStart[cell], end = m_cellStart[cell + 1]; i < end; ++i)
+			{
+				KX_Obstacle* ob = m_cellItems[i];
+				if (!filterObstacle(activeObst, activeNavMeshObj, ob, m_levelHeight))
+					continue;
+
+				if (ob->m_shape == KX_OBSTACLE_CIRCLE)
+				{
+					// Distance between the circles.
+					const MT_Scalar dist = (ob->m_pos.to2d() - pos).length() - ob->m_rad - activeObst->m_rad;
+					if (dist <= distance)
+						m_candidates.emplace_back(dist, ob);
+				}
+				// The segments overlapping several cells are removed after.
+				else
+					neighbours.push_back(ob);
+			}
+		}
+	}
+
+	if (!neighbours.empty())
+	{
+		std::sort(neighbours.begin(), neighbours.end(), [](KX_Obstacle *a, KX_Obstacle *b) { return a->m_index < b->m_index; });
+		neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+	}
+
+	// Keep the nearest circles only.
+	if (m_candidates.size() > m_maxNeighbours)
+	{
+		std::nth_element(m_candidates.begin(), m_candidates.begin() + m_maxNeighbours, m_candidates.end(),
+		                 [](const std::pair<MT_Scalar, KX_Obstacle *>& a, const std::pair<MT_Scalar, KX_Obstacle *>& b)
+		{
+			return (a.first < b.first) || (a.first == b.first && a.second->m_index < b.second->m_index);
+		});
+		m_candidates.resize(m_maxNeighbours);
+	}
+
+	for (const std::pair<MT_Scalar, KX_Obstacle *>& candidate : m_candidates)
+		neighbours.push_back(candidate.second);
+}
+
 ///////////*********TOI_rays**********/////////////////
 KX_ObstacleSimulationTOI::KX_ObstacleSimulationTOI(MT_Scalar levelHeight, bool enableVisualization)
 :	KX_ObstacleSimulation(levelHeight, enableVisualization),
@@ -373,7 +598,8 @@ KX_ObstacleSimulationTOI::KX_ObstacleSimulationTOI(MT_Scalar levelHeight, bool e
 	m_velWeight(1.0f),
 	m_curVelWeight(1.0f),
 	m_toiWeight(1.0f),
-	m_collisionWeight(1.0f)
+	m_collisionWeight(1.0f),
+	m_maxSampleScale(1.0f)
 {
 }
 
@@ -381,15 +607,19 @@ KX_ObstacleSimulationTOI::KX_ObstacleSimulationTOI(MT_Scalar levelHeight, bool e
 void KX_ObstacleSimulationTOI::AdjustObstacleVelocity(KX_Obstacle* activeObst, KX_NavMeshObject* activeNavMeshObj, 
                                                       MT_Vector3& velocity, MT_Scalar maxDeltaSpeed, MT_Scalar maxDeltaAngle)
 {
-	int nobs = m_obstacles.size();
-	int obstidx = std::find(m_obstacles.begin(), m_obstacles.end(), activeObst) - m_obstacles.begin();
-	if (obstidx == nobs)
+	if (activeObst->m_index >= m_obstacles.size() || m_obstacles[activeObst->m_index] != activeObst)
 		return;
 
 	vset(activeObst->dvel, velocity.x(), velocity.y());
 
+	/* Only the obstacles reachable before the max TOI change the samples, the relative
+	 * velocity of a sample is bounded by 2 * sample + current velocity + obstacle velocity. */
+	const MT_Scalar sampleSpeed = m_maxSampleScale * len_v2(activeObst->dvel);
+	const MT_Scalar speed = 2.0f * sampleSpeed + len_v2(activeObst->vel) + m_maxSpeed;
+	FindNeighbours(activeObst, activeNavMeshObj, speed * m_maxToi, m_neighbours);
+
 	//apply RVO
-	sampleRVO(activeObst, activeNavMeshObj, maxDeltaAngle);
+	sampleRVO(activeObst, m_neighbours, maxDeltaAngle);
 
 	// Fake dynamic constraint.
 	float dv[2];
@@ -428,7 +658,7 @@ KX_ObstacleSimulationTOI_rays::KX_ObstacleSimulationTOI_rays(MT_Scalar levelHeig
 }
 
 
-void KX_ObstacleSimulationTOI_rays::sampleRVO(KX_Obstacle* activeObst, KX_NavMeshObject* activeNavMeshObj, 
+void KX_ObstacleSimulationTOI_rays::sampleRVO(KX_Obstacle* activeObst, const KX_Obstacles& obstacles,
 										const float maxDeltaAngle)
 {
 	MT_Vector2 vel(activeObst->dvel[0], activeObst->dvel[1]);
@@ -450,7 +680,7 @@ void KX_ObstacleSimulationTOI_rays::sampleRVO(KX_Obstacle* activeObst, KX_NavMes
 	const int iforw = m_maxSamples/2;
 	const float aoff = (float)iforw / (float)m_maxSamples;
 
-	size_t nobs = m_obstacles.size();
+	const int nobs = obstacles.size();
 	for (int iter = 0; iter < m_maxSamples; ++iter)
 	{
 		// Calculate sample velocity
@@ -465,11 +695,7 @@ void KX_ObstacleSimulationTOI_rays::sampleRVO(KX_Obstacle* activeObst, KX_NavMes
 		float tmine = 0.0f;
 		for (int i = 0; i < nobs; ++i)
 		{
-			KX_Obstacle* ob = m_obstacles[i];
-			bool res = filterObstacle(activeObst, activeNavMeshObj, ob, m_levelHeight);
-			if (!res)
-				continue;
-
+			KX_Obstacle* ob = obstacles[i];
 			float htmin,htmax;
 
 			if (ob->m_shape == KX_OBSTACLE_CIRCLE)
@@ -493,15 +719,8 @@ void KX_ObstacleSimulationTOI_rays::sampleRVO(KX_Obstacle* activeObst, KX_NavMes
 			}
 			else if (ob->m_shape == KX_OBSTACLE_SEGMENT)
 			{
-				MT_Vector3 p1 = ob->m_pos;
-				MT_Vector3 p2 = ob->m_pos2;
-				//apply world transform
-				if (ob->m_type == KX_OBSTACLE_NAV_MESH)
-				{
-					KX_NavMeshObject* navmeshobj = static_cast<KX_NavMeshObject*>(ob->m_gameObj);
-					p1 = navmeshobj->TransformToWorldCoords(p1);
-					p2 = navmeshobj->TransformToWorldCoords(p2);
-				}
+				const MT_Vector3& p1 = ob->m_worldPos;
+				const MT_Vector3& p2 = ob->m_worldPos2;
 
 				if (!sweepCircleSegment(activeObst->m_pos.to2d(), activeObst->m_rad, svel,
 				                        p1.to2d(), p2.to2d(), ob->m_rad, htmin, htmax))
@@ -575,8 +794,47 @@ void KX_ObstacleSimulationTOI_rays::sampleRVO(KX_Obstacle* activeObst, KX_NavMes
 
 ///////////********* TOI_cells**********/////////////////
 
-static void processSamples(KX_Obstacle* activeObst, KX_NavMeshObject* activeNavMeshObj, 
-                           KX_Obstacles& obstacles,  float levelHeight, const float vmax,
+/** Compute the side directions of the circle obstacles: the normalized direction to the obstacle
+ * and its normal on the side of the relative desired velocity.
+ */
+static void computeSideDirections(KX_Obstacle* activeObst, const KX_Obstacles& obstacles,
+                                  std::vector<float>& directions)
+{
+	directions.resize(obstacles.size() * 4);
+
+	const float orig[2] = {0, 0};
+	float pa[2];
+	vset(pa, activeObst->m_pos.x(), activeObst->m_pos.y());
+
+	for (int i = 0; i < obstacles.size(); ++i)
+	{
+		KX_Obstacle* ob = obstacles[i];
+		if (ob->m_shape != KX_OBSTACLE_CIRCLE)
+			continue;
+
+		float *dp = &directions[i * 4];
+		float *np = &directions[i * 4 + 2];
+
+		float pb[2], dv[2];
+		vset(pb, ob->m_pos.x(), ob->m_pos.y());
+		sub_v2_v2v2(dp, pb, pa);
+		normalize_v2(dp);
+		sub_v2_v2v2(dv, ob->dvel, activeObst->dvel);
+
+		/* TODO: use line_point_side_v2 */
+		if (area_tri_signed_v2(orig, dp, dv) < 0.01f) {
+			np[0] = -dp[1];
+			np[1] = dp[0];
+		}
+		else {
+			np[0] = dp[1];
+			np[1] = -dp[0];
+		}
+	}
+}
+
+static void processSamples(KX_Obstacle* activeObst, const KX_Obstacles& obstacles,
+                           const float* sideDirections, const float vmax,
                            const float* spos, const float cs, const int nspos, float* res,
                            float maxToi, float velWeight, float curVelWeight, float sideWeight,
                            float toiWeight)
@@ -609,9 +867,6 @@ static void processSamples(KX_Obstacle* activeObst, KX_NavMeshObject* activeNavM
 		for (int i = 0; i < obstacles.size(); ++i)
 		{
 			KX_Obstacle* ob = obstacles[i];
-			bool res = filterObstacle(activeObst, activeNavMeshObj, ob, levelHeight);
-			if (!res)
-				continue;
 			float htmin, htmax;
 
 			if (ob->m_shape==KX_OBSTACLE_CIRCLE)
@@ -623,29 +878,9 @@ static void processSamples(KX_Obstacle* activeObst, KX_NavMeshObject* activeNavM
 				sub_v2_v2v2(vab, vab, activeObst->vel);
 				sub_v2_v2v2(vab, vab, ob->vel);
 
-				// Side
-				// NOTE: dp, and dv are constant over the whole calculation,
-				// they can be precomputed per object. 
-				const float* pa = activeObstPos;
-				float pb[2];
-				vset(pb, ob->m_pos.x(), ob->m_pos.y());
-
-				const float orig[2] = {0, 0};
-				float dp[2], dv[2], np[2];
-				sub_v2_v2v2(dp, pb, pa);
-				normalize_v2(dp);
-				sub_v2_v2v2(dv, ob->dvel, activeObst->dvel);
-
-				/* TODO: use line_point_side_v2 */
-				if (area_tri_signed_v2(orig, dp, dv) < 0.01f) {
-					np[0] = -dp[1];
-					np[1] = dp[0];
-				}
-				else {
-					np[0] = dp[1];
-					np[1] = -dp[0];
-				}
-
+				// Side, the directions are constant over the whole calculation.
+				const float *dp = &sideDirections[i * 4];
+				const float *np = &sideDirections[i * 4 + 2];
 				side += clamp(std::min(dot_v2v2(dp, vab),
 				                  dot_v2v2(np, vab)) * 2.0f, 0.0f, 1.0f);
 				nside++;
@@ -665,15 +900,8 @@ static void processSamples(KX_Obstacle* activeObst, KX_NavMeshObject* activeNavM
 			}
 			else if (ob->m_shape == KX_OBSTACLE_SEGMENT)
 			{
-				MT_Vector3 p1 = ob->m_pos;
-				MT_Vector3 p2 = ob->m_pos2;
-				//apply world transform
-				if (ob->m_type == KX_OBSTACLE_NAV_MESH)
-				{
-					KX_NavMeshObject* navmeshobj = static_cast<KX_NavMeshObject*>(ob->m_gameObj);
-					p1 = navmeshobj->TransformToWorldCoords(p1);
-					p2 = navmeshobj->TransformToWorldCoords(p2);
-				}
+				const MT_Vector3& p1 = ob->m_worldPos;
+				const MT_Vector3& p2 = ob->m_worldPos2;
 				float p[2], q[2];
 				vset(p, p1.x(), p1.y());
 				vset(q, p2.x(), p2.y());
@@ -735,7 +963,7 @@ static void processSamples(KX_Obstacle* activeObst, KX_NavMeshObject* activeNavM
 	}
 }
 
-void KX_ObstacleSimulationTOI_cells::sampleRVO(KX_Obstacle* activeObst, KX_NavMeshObject* activeNavMeshObj, 
+void KX_ObstacleSimulationTOI_cells::sampleRVO(KX_Obstacle* activeObst, const KX_Obstacles& obstacles,
 					   const float maxDeltaAngle)
 {
 	vset(activeObst->nvel, 0.f, 0.f);
@@ -744,6 +972,8 @@ void KX_ObstacleSimulationTOI_cells::sampleRVO(KX_Obstacle* activeObst, KX_NavMe
 	float* spos = new float[2*m_maxSamples];
 	int nspos = 0;
 
+	computeSideDirections(activeObst, obstacles, m_sideDirections);
+
 	if (!m_adaptive)
 	{
 		const float cvx = activeObst->dvel[0]*m_bias;
@@ -767,7 +997,7 @@ void KX_ObstacleSimulationTOI_cells::sampleRVO(KX_Obstacle* activeObst, KX_NavMe
 				}
 			}
 		}
-		processSamples(activeObst, activeNavMeshObj, m_obstacles, m_levelHeight, vmax, spos, cs/2, 
+		processSamples(activeObst, obstacles, m_sideDirections.data(), vmax, spos, cs/2, 
 			nspos,  activeObst->nvel, m_maxToi, m_velWeight, m_curVelWeight, m_collisionWeight, m_toiWeight);
 	}
 	else
@@ -802,7 +1032,7 @@ void KX_ObstacleSimulationTOI_cells::sampleRVO(KX_Obstacle* activeObst, KX_NavMe
 				}
 			}
 
-			processSamples(activeObst, activeNavMeshObj, m_obstacles, m_levelHeight, vmax, spos, cs/2,
+			processSamples(activeObst, obstacles, m_sideDirections.data(), vmax, spos, cs/2,
 			               nspos,  res, m_maxToi, m_velWeight, m_curVelWeight, m_collisionWeight, m_toiWeight);
 
 			cs *= 0.5f;
@@ -825,4 +1055,6 @@ KX_ObstacleSimulationTOI_cells::KX_ObstacleSimulationTOI_cells(MT_Scalar levelHe
 	m_curVelWeight = 0.75f;
 	m_toiWeight = 2.5f;
 	m_collisionWeight = 0.75f; //side_weight
+	// The adaptive samples exceed the desired speed by a fifth at most.
+	m_maxSampleScale = 1.25f;
 }
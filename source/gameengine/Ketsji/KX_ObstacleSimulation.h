@@ -27,11 +27,13 @@
 #define __KX_OBSTACLESIMULATION_H__
 
 #include <vector>
+#include <utility>
 #include "MT_Vector2.h"
 #include "MT_Vector3.h"
 
 class KX_GameObject;
 class KX_NavMeshObject;
+struct TaskPool;
 
 enum KX_OBSTACLE_TYPE
 {
@@ -52,6 +54,9 @@ struct KX_Obstacle
 	KX_OBSTACLE_SHAPE m_shape;
 	MT_Vector3 m_pos;
 	MT_Vector3 m_pos2;
+	/// Segment ends in world coordinates, updated with the obstacles.
+	MT_Vector3 m_worldPos;
+	MT_Vector3 m_worldPos2;
 	MT_Scalar m_rad;
 	
 	float vel[2];
@@ -61,7 +66,9 @@ struct KX_Obstacle
 	float hvel[VEL_HIST_SIZE*2];
 	int hhead;
 
-	
+	/// Index of the obstacle in the simulation list.
+	unsigned int m_index;
+
 	KX_GameObject* m_gameObj;
 };
 typedef std::vector<KX_Obstacle*> KX_Obstacles;
@@ -74,7 +81,41 @@ protected:
 	MT_Scalar m_levelHeight;
 	bool m_enableVisualization;
 
+	/** Uniform grid of the obstacles in the XY plane, rebuilt by UpdateObstacles.
+	 * The circles are stored in the cell of their center and the segments in all
+	 * the cells overlapped by their bounding box.
+	 */
+	MT_Scalar m_cellSize;
+	MT_Scalar m_gridOrigin[2];
+	int m_gridSize[2];
+	/// Index of the first item of every cell in m_cellItems, plus the end of the last cell.
+	std::vector<unsigned int> m_cellStart;
+	KX_Obstacles m_cellItems;
+	/// True if obstacles were added or removed since the last grid build.
+	bool m_gridDirty;
+	/// Largest radius and speed of the circle obstacles.
+	MT_Scalar m_maxRadius;
+	MT_Scalar m_maxSpeed;
+	/// Maximum number of circle obstacles used to sample the velocity of an obstacle.
+	unsigned int m_maxNeighbours;
+
+	/// Neighbours of the obstacle currently adjusted.
+	KX_Obstacles m_neighbours;
+	std::vector<std::pair<MT_Scalar, KX_Obstacle *> > m_candidates;
+
 	KX_Obstacle* CreateObstacle(KX_GameObject* gameobj);
+
+	/// Update the position and velocity of the obstacles of a range.
+	void UpdateObstacleRange(unsigned int start, unsigned int stop);
+	static void UpdateObstaclesTask(TaskPool *pool, void *taskdata, int start, int stop, int threadid);
+	void BuildGrid();
+	void GetCellRange(MT_Scalar minx, MT_Scalar miny, MT_Scalar maxx, MT_Scalar maxy, int range[4]) const;
+	/** Find the obstacles reachable by an obstacle moving at most of \a distance relative to them.
+	 * Only the \a m_maxNeighbours nearest circles are kept, all the segments in range are kept.
+	 * \param neighbours The filtered obstacles, the segments followed by the circles.
+	 */
+	void FindNeighbours(KX_Obstacle *activeObst, KX_NavMeshObject *activeNavMeshObj, MT_Scalar distance,
+	                    KX_Obstacles& neighbours);
 public:
 	KX_ObstacleSimulation(MT_Scalar levelHeight, bool enableVisualization);
 	virtual ~KX_ObstacleSimulation();
@@ -86,6 +127,9 @@ public:
 	void DestroyObstacleForObj(KX_GameObject* gameobj);
 	void AddObstaclesForNavMesh(KX_NavMeshObject* navmesh);
 	KX_Obstacle* GetObstacle(KX_GameObject* gameobj);
+	/** Update the obstacles from their objects and rebuild the neighbours grid,
+	 * the obstacles are updated in parallel when they are numerous.
+	 */
 	void UpdateObstacles();
 	virtual void AdjustObstacleVelocity(KX_Obstacle* activeObst, KX_NavMeshObject* activeNavMeshObj, 
 	                                    MT_Vector3& velocity, MT_Scalar maxDeltaSpeed,MT_Scalar maxDeltaAngle);
@@ -102,7 +146,10 @@ protected:
 	float m_toiWeight;				// Sample selection TOI weight
 	float m_collisionWeight;		// Sample selection collision weight
 
-	virtual void sampleRVO(KX_Obstacle* activeObst, KX_NavMeshObject* activeNavMeshObj, 
+	/// Upper bound of the sampled velocities relative to the desired velocity.
+	float m_maxSampleScale;
+
+	virtual void sampleRVO(KX_Obstacle* activeObst, const KX_Obstacles& obstacles,
 							const float maxDeltaAngle) = 0;
 public:
 	KX_ObstacleSimulationTOI(MT_Scalar levelHeight, bool enableVisualization);
@@ -113,7 +160,7 @@ public:
 class KX_ObstacleSimulationTOI_rays: public KX_ObstacleSimulationTOI
 {
 protected:
-	virtual void sampleRVO(KX_Obstacle* activeObst, KX_NavMeshObject* activeNavMeshObj, 
+	virtual void sampleRVO(KX_Obstacle* activeObst, const KX_Obstacles& obstacles,
 							const float maxDeltaAngle);
 public:
 	KX_ObstacleSimulationTOI_rays(MT_Scalar levelHeight, bool enableVisualization);
@@ -125,7 +172,11 @@ protected:
 	float m_bias;
 	bool m_adaptive;
 	int m_sampleRadius;
-	virtual void sampleRVO(KX_Obstacle* activeObst, KX_NavMeshObject* activeNavMeshObj, 
+	/** Side directions of the neighbours of the obstacle currently adjusted, 4 floats per neighbour:
+	 * the direction to the neighbour and its normal. Constant for all the samples of an adjustment.
+	 */
+	std::vector<float> m_sideDirections;
+	virtual void sampleRVO(KX_Obstacle* activeObst, const KX_Obstacles& obstacles,
 							const float maxDeltaAngle);
 public:
 	KX_ObstacleSimulationTOI_cells(MT_Scalar levelHeight, bool enableVisualization);
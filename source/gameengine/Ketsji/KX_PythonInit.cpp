@@ -306,6 +306,15 @@ static PyObject *gPyGetProfileInfo(PyObject *)
 	return KX_GetActiveEngine()->GetPyProfileDict();
 }
 
+PyDoc_STRVAR(gPyGetSceneProfileInfo_doc,
+"getSceneProfileInfo()\n"
+"returns a dictionary with profiling information per scene"
+);
+static PyObject *gPyGetSceneProfileInfo(PyObject *)
+{
+	return KX_GetActiveEngine()->GetPySceneProfileDict();
+}
+
 PyDoc_STRVAR(gPySendMessage_doc,
 "sendMessage(subject, [body, to, from])\n"
 "sends a message in same manner as a message actuator"
@@ -363,6 +372,26 @@ static PyObject *gPyGetLogicTicRate(PyObject *)
 	return PyFloat_FromDouble(KX_GetActiveEngine()->GetTicRate());
 }
 
+static PyObject *gPySetActionSampleRate(PyObject *, PyObject *args)
+{
+	float rate;
+	if (!PyArg_ParseTuple(args, "f:setActionSampleRate", &rate))
+		return nullptr;
+
+	if (rate < 0.0f) {
+		PyErr_SetString(PyExc_ValueError, "bge.logic.setActionSampleRate(rate): expected a positive or null rate");
+		return nullptr;
+	}
+
+	KX_GetActiveEngine()->SetActionSampleRate(rate);
+	Py_RETURN_NONE;
+}
+
+static PyObject *gPyGetActionSampleRate(PyObject *)
+{
+	return PyFloat_FromDouble(KX_GetActiveEngine()->GetActionSampleRate());
+}
+
 static PyObject *gPySetExitKey(PyObject *, PyObject *args)
 {
 	short exitkey;
@@ -470,6 +499,38 @@ static PyObject *gPySetUseExternalClock(PyObject *, PyObject *args)
 	Py_RETURN_NONE;
 }
 
+static PyObject *gPyGetUseParallelScenes(PyObject *)
+{
+	return PyBool_FromLong(KX_GetActiveEngine()->GetFlag(KX_KetsjiEngine::PARALLEL_SCENES));
+}
+
+static PyObject *gPySetUseParallelScenes(PyObject *, PyObject *args)
+{
+	int useParallelScenes;
+
+	if (!PyArg_ParseTuple(args, "p:setUseParallelScenes", &useParallelScenes))
+		return nullptr;
+
+	KX_GetActiveEngine()->SetFlag(KX_KetsjiEngine::PARALLEL_SCENES, useParallelScenes);
+	Py_RETURN_NONE;
+}
+
+static PyObject *gPyGetUseAsyncPhysics(PyObject *)
+{
+	return PyBool_FromLong(KX_GetActiveEngine()->GetFlag(KX_KetsjiEngine::ASYNC_PHYSICS));
+}
+
+static PyObject *gPySetUseAsyncPhysics(PyObject *, PyObject *args)
+{
+	int useAsyncPhysics;
+
+	if (!PyArg_ParseTuple(args, "p:setUseAsyncPhysics", &useAsyncPhysics))
+		return nullptr;
+
+	KX_GetActiveEngine()->SetFlag(KX_KetsjiEngine::ASYNC_PHYSICS, useAsyncPhysics);
+	Py_RETURN_NONE;
+}
+
 static PyObject *gPyGetClockTime(PyObject *)
 {
 	return PyFloat_FromDouble(KX_GetActiveEngine()->GetClockTime());
@@ -688,6 +749,27 @@ static PyObject *gLibLoad(PyObject *, PyObject *args, PyObject *kwds)
 	Py_RETURN_FALSE;
 }
 
+static PyObject *gGetLibLoadMergeBudget(PyObject *)
+{
+	return PyFloat_FromDouble(KX_GetActiveEngine()->GetConverter()->GetMergeTimeBudget());
+}
+
+static PyObject *gSetLibLoadMergeBudget(PyObject *, PyObject *args)
+{
+	double budget;
+
+	if (!PyArg_ParseTuple(args, "d:setLibLoadMergeBudget", &budget))
+		return nullptr;
+
+	if (budget < 0.0) {
+		PyErr_SetString(PyExc_ValueError, "bge.logic.setLibLoadMergeBudget(budget): expected a positive time or zero");
+		return nullptr;
+	}
+
+	KX_GetActiveEngine()->GetConverter()->SetMergeTimeBudget(budget);
+	Py_RETURN_NONE;
+}
+
 static PyObject *gLibNew(PyObject *, PyObject *args)
 {
 	KX_Scene *kx_scene= KX_GetActiveScene();
@@ -812,6 +894,8 @@ static struct PyMethodDef game_methods[] = {
 	{"setMaxPhysicsFrame", (PyCFunction) gPySetMaxPhysicsFrame, METH_VARARGS, (const char *)"Sets the max number of physics farme per render frame"},
 	{"getLogicTicRate", (PyCFunction) gPyGetLogicTicRate, METH_NOARGS, (const char *)"Gets the logic tic rate"},
 	{"setLogicTicRate", (PyCFunction) gPySetLogicTicRate, METH_VARARGS, (const char *)"Sets the logic tic rate"},
+	{"getActionSampleRate", (PyCFunction) gPyGetActionSampleRate, METH_NOARGS, (const char *)"Gets the sample rate of the compiled actions"},
+	{"setActionSampleRate", (PyCFunction) gPySetActionSampleRate, METH_VARARGS, (const char *)"Sets the sample rate of the compiled actions"},
 	{"getPhysicsTicRate", (PyCFunction) gPyGetPhysicsTicRate, METH_NOARGS, (const char *)"Gets the physics tic rate"},
 	{"setPhysicsTicRate", (PyCFunction) gPySetPhysicsTicRate, METH_VARARGS, (const char *)"Sets the physics tic rate"},
 	{"getExitKey", (PyCFunction) gPyGetExitKey, METH_NOARGS, (const char *)"Gets the key used to exit the game engine"},
@@ -820,6 +904,10 @@ static struct PyMethodDef game_methods[] = {
 	{"getRender", (PyCFunction) gPyGetRender, METH_NOARGS, (const char *)"get the global render flag value"},
 	{"getUseExternalClock", (PyCFunction) gPyGetUseExternalClock, METH_NOARGS, (const char *)"Get if we use the time provided by an external clock"},
 	{"setUseExternalClock", (PyCFunction) gPySetUseExternalClock, METH_VARARGS, (const char *)"Set if we use the time provided by an external clock"},
+	{"getUseParallelScenes", (PyCFunction) gPyGetUseParallelScenes, METH_NOARGS, (const char *)"Get if the physics of the scenes are proceeded concurrently"},
+	{"setUseParallelScenes", (PyCFunction) gPySetUseParallelScenes, METH_VARARGS, (const char *)"Set if the physics of the scenes are proceeded concurrently"},
+	{"getUseAsyncPhysics", (PyCFunction) gPyGetUseAsyncPhysics, METH_NOARGS, (const char *)"Get if the physics is proceeded during the render"},
+	{"setUseAsyncPhysics", (PyCFunction) gPySetUseAsyncPhysics, METH_VARARGS, (const char *)"Set if the physics is proceeded during the render"},
 	{"getClockTime", (PyCFunction) gPyGetClockTime, METH_NOARGS, (const char *)"Get the last BGE render time. "
 	"The BGE render time is the simulated time corresponding to the next scene that will be renderered"},
 	{"setClockTime", (PyCFunction) gPySetClockTime, METH_VARARGS, (const char *)"Set the BGE render time. "
@@ -836,11 +924,14 @@ static struct PyMethodDef game_methods[] = {
 	{"PrintMemInfo", (PyCFunction)pyPrintStats, METH_NOARGS, (const char *)"Print engine statistics"},
 	{"NextFrame", (PyCFunction)gPyNextFrame, METH_NOARGS, (const char *)"Render next frame (if Python has control)"},
 	{"getProfileInfo", (PyCFunction)gPyGetProfileInfo, METH_NOARGS, gPyGetProfileInfo_doc},
+	{"getSceneProfileInfo", (PyCFunction)gPyGetSceneProfileInfo, METH_NOARGS, gPyGetSceneProfileInfo_doc},
 	/* library functions */
 	{"LibLoad", (PyCFunction)gLibLoad, METH_VARARGS|METH_KEYWORDS, (const char *)""},
 	{"LibNew", (PyCFunction)gLibNew, METH_VARARGS, (const char *)""},
 	{"LibFree", (PyCFunction)gLibFree, METH_VARARGS, (const char *)""},
 	{"LibList", (PyCFunction)gLibList, METH_VARARGS, (const char *)""},
+	{"getLibLoadMergeBudget", (PyCFunction)gGetLibLoadMergeBudget, METH_NOARGS, (const char *)"Get the time spent per logic frame to merge the asynchronously loaded scenes"},
+	{"setLibLoadMergeBudget", (PyCFunction)gSetLibLoadMergeBudget, METH_VARARGS, (const char *)"Set the time spent per logic frame to merge the asynchronously loaded scenes"},
 	
 	{nullptr, (PyCFunction) nullptr, 0, nullptr }
 };
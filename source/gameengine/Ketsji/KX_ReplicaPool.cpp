@@ -0,0 +1,95 @@
+#include "KX_ReplicaPool.h"
+
+#include <algorithm>
+
+KX_ReplicaPool::KX_ReplicaPool()
+	:m_maxParkedObjects(1024)
+{
+}
+
+void KX_ReplicaPool::AddObject(KX_GameObject *replica, KX_GameObject *original)
+{
+	m_entries[replica] = {original, false};
+}
+
+bool KX_ReplicaPool::IsActiveObject(KX_GameObject *replica) const
+{
+	std::unordered_map<KX_GameObject *, Entry>::const_iterator it = m_entries.find(replica);
+	return (it != m_entries.end() && !it->second.m_parked);
+}
+
+bool KX_ReplicaPool::ParkObject(KX_GameObject *replica)
+{
+	std::unordered_map<KX_GameObject *, Entry>::iterator it = m_entries.find(replica);
+	if (it == m_entries.end() || it->second.m_parked) {
+		return false;
+	}
+
+	std::vector<KX_GameObject *>& parkedObjects = m_parkedObjects[it->second.m_original];
+	if (parkedObjects.size() >= m_maxParkedObjects) {
+		m_entries.erase(it);
+		return false;
+	}
+
+	it->second.m_parked = true;
+	parkedObjects.push_back(replica);
+
+	return true;
+}
+
+KX_GameObject *KX_ReplicaPool::TakeObject(KX_GameObject *original)
+{
+	std::unordered_map<KX_GameObject *, std::vector<KX_GameObject *> >::iterator it = m_parkedObjects.find(original);
+	if (it == m_parkedObjects.end() || it->second.empty()) {
+		return nullptr;
+	}
+
+	KX_GameObject *replica = it->second.back();
+	it->second.pop_back();
+	m_entries[replica].m_parked = false;
+
+	return replica;
+}
+
+bool KX_ReplicaPool::RemoveObject(KX_GameObject *replica)
+{
+	std::unordered_map<KX_GameObject *, Entry>::iterator it = m_entries.find(replica);
+	if (it == m_entries.end()) {
+		return false;
+	}
+
+	const Entry entry = it->second;
+	m_entries.erase(it);
+
+	if (entry.m_parked) {
+		std::vector<KX_GameObject *>& parkedObjects = m_parkedObjects[entry.m_original];
+		parkedObjects.erase(std::find(parkedObjects.begin(), parkedObjects.end(), replica));
+		if (parkedObjects.empty()) {
+			m_parkedObjects.erase(entry.m_original);
+		}
+	}
+
+	return entry.m_parked;
+}
+
+void KX_ReplicaPool::GetParkedObjects(KX_GameObject *original, std::vector<KX_GameObject *>& objects) const
+{
+	if (original) {
+		std::unordered_map<KX_GameObject *, std::vector<KX_GameObject *> >::const_iterator it = m_parkedObjects.find(original);
+		if (it != m_parkedObjects.end()) {
+			objects.insert(objects.end(), it->second.begin(), it->second.end());
+		}
+		return;
+	}
+
+	for (const auto& pair : m_parkedObjects) {
+		objects.insert(objects.end(), pair.second.begin(), pair.second.end());
+	}
+}
+
+void KX_ReplicaPool::Merge(KX_ReplicaPool *other)
+{
+	m_entries.insert(other->m_entries.begin(), other->m_entries.end());
+	other->m_entries.clear();
+	other->m_parkedObjects.clear();
+}
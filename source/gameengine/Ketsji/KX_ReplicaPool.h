@@ -0,0 +1,64 @@
+#ifndef __KX_REPLICA_POOL_H__
+#define __KX_REPLICA_POOL_H__
+
+#include <vector>
+#include <unordered_map>
+
+class KX_GameObject;
+
+/** \brief Pools of the replicas added with recycling enabled, sorted by their original object.
+ *
+ * A pooled replica removed from the scene is parked instead of being freed and is reused by
+ * the next addition of the same original object. The pool only stores the objects, parking
+ * and reinitializing them is done by the scene. A parked object is owned by the pool which
+ * holds one reference on it.
+ */
+class KX_ReplicaPool
+{
+private:
+	struct Entry
+	{
+		KX_GameObject *m_original;
+		bool m_parked;
+	};
+
+	/// Original object and state of each pooled replica.
+	std::unordered_map<KX_GameObject *, Entry> m_entries;
+	/// Parked replicas of each original object.
+	std::unordered_map<KX_GameObject *, std::vector<KX_GameObject *> > m_parkedObjects;
+	/// Maximum number of parked replicas per original object.
+	unsigned int m_maxParkedObjects;
+
+public:
+	KX_ReplicaPool();
+	~KX_ReplicaPool() = default;
+
+	/// Register a replica created with recycling enabled.
+	void AddObject(KX_GameObject *replica, KX_GameObject *original);
+	/// Return true if the replica is registered and not parked.
+	bool IsActiveObject(KX_GameObject *replica) const;
+
+	/** Park a registered replica.
+	 * \return False if the pool of the original object is full, the replica is then unregistered.
+	 */
+	bool ParkObject(KX_GameObject *replica);
+	/** Take a parked replica of an original object.
+	 * \return A replica to reinitialize or nullptr if none is parked.
+	 */
+	KX_GameObject *TakeObject(KX_GameObject *original);
+
+	/** Unregister a replica.
+	 * \return True if the replica was parked, the pool reference must then be released.
+	 */
+	bool RemoveObject(KX_GameObject *replica);
+
+	/** Get the parked replicas to free.
+	 * \param original The original object of the replicas, nullptr for all the parked replicas.
+	 */
+	void GetParkedObjects(KX_GameObject *original, std::vector<KX_GameObject *>& objects) const;
+
+	/// Move the registered replicas of an other pool, the other pool must not contain parked replicas.
+	void Merge(KX_ReplicaPool *other);
+};
+
+#endif  // __KX_REPLICA_POOL_H__
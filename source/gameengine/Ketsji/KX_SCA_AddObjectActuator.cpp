@@ -50,14 +50,16 @@ KX_SCA_AddObjectActuator::KX_SCA_AddObjectActuator(KX_GameObject *gameobj,
 												   const float *linvel,
 												   bool linv_local,
 												   const float *angvel,
-												   bool angv_local)
+												   bool angv_local,
+												   bool usePool)
 	: 
 	SCA_IActuator(gameobj, KX_ACT_ADD_OBJECT),
 	m_OriginalObject(original),
 	m_scene(scene),
 	
 	m_localLinvFlag(linv_local),
-	m_localAngvFlag(angv_local)
+	m_localAngvFlag(angv_local),
+	m_usePool(usePool)
 {
 	m_linear_velocity[0] = linvel[0];
 	m_linear_velocity[1] = linvel[1];
@@ -203,6 +205,7 @@ PyAttributeDef KX_SCA_AddObjectActuator::Attributes[] = {
 	KX_PYATTRIBUTE_FLOAT_RW("time", 0.0f, FLT_MAX, KX_SCA_AddObjectActuator, m_timeProp),
 	KX_PYATTRIBUTE_FLOAT_ARRAY_RW("linearVelocity",-FLT_MAX,FLT_MAX,KX_SCA_AddObjectActuator,m_linear_velocity,3),
 	KX_PYATTRIBUTE_FLOAT_ARRAY_RW("angularVelocity",-FLT_MAX,FLT_MAX,KX_SCA_AddObjectActuator,m_angular_velocity,3),
+	KX_PYATTRIBUTE_BOOL_RW("usePool",KX_SCA_AddObjectActuator,m_usePool),
 	KX_PYATTRIBUTE_NULL	//Sentinel
 };
 
@@ -258,7 +261,7 @@ void	KX_SCA_AddObjectActuator::InstantAddObject()
 	{
 		// Add an identical object, with properties inherited from the original object
 		// Now it needs to be added to the current scene.
-		KX_GameObject *replica = m_scene->AddReplicaObject(m_OriginalObject, static_cast<KX_GameObject *>(GetParent()), m_timeProp);
+		KX_GameObject *replica = m_scene->AddReplicaObject(m_OriginalObject, static_cast<KX_GameObject *>(GetParent()), m_timeProp, m_usePool);
 		replica->setLinearVelocity(MT_Vector3(m_linear_velocity), m_localLinvFlag);
 		replica->setAngularVelocity(MT_Vector3(m_angular_velocity),m_localAngvFlag);
 		replica->ResolveCombinedVelocities(MT_Vector3(m_linear_velocity), MT_Vector3(m_angular_velocity), m_localLinvFlag, m_localAngvFlag);
@@ -65,6 +65,9 @@ class KX_SCA_AddObjectActuator : public SCA_IActuator
 	float  m_angular_velocity[3];
 	/// Apply the velocity locally 
 	bool m_localAngvFlag; 
+
+	/// Recycle the removed objects added by this actuator.
+	bool m_usePool;
 	
 	KX_GameObject*	m_lastCreatedObject;
 	
@@ -83,7 +86,8 @@ public:
 		const float *linvel,
 		bool linv_local,
 		const float *angvel,
-		bool angv_local
+		bool angv_local,
+		bool usePool
 	);
 
 	~KX_SCA_AddObjectActuator(void);
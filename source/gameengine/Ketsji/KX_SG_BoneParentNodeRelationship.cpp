@@ -39,6 +39,11 @@
 #include "MT_Matrix4x4.h"
 #include "BL_ArmatureObject.h"
 
+#include "CM_Thread.h"
+
+/* The bone matrix is computed by applying the pose on the blender armature object
+ * which is shared by all the replicas, the scene graph can be updated from multiple threads. */
+static CM_ThreadMutex boneMatrixMutex;
 
 /**
  * Implementation of classes defined in KX_SG_BoneParentNodeRelationship.h
@@ -87,7 +92,10 @@ UpdateChildCoordinates(
 		if (armature)
 		{
 			MT_Matrix4x4 parent_matrix;
-			if (armature->GetBoneMatrix(m_bone, parent_matrix))
+			boneMatrixMutex.Lock();
+			const bool valid_bone = armature->GetBoneMatrix(m_bone, parent_matrix);
+			boneMatrixMutex.Unlock();
+			if (valid_bone)
 			{
 				// Get the child's transform, and the bone matrix.
 				MT_Matrix4x4 child_transform ( 
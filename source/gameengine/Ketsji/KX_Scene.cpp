@@ -59,23 +59,30 @@
 #include "SCA_IScene.h"
 #include "KX_LodManager.h"
 #include "KX_CullingHandler.h"
+#include "KX_CullingTree.h"
+#include "KX_ExpiryScheduler.h"
+#include "KX_ActivityGrid.h"
+#include "KX_ReplicaPool.h"
 
 #include "RAS_Rasterizer.h"
 #include "RAS_ICanvas.h"
 #include "RAS_2DFilterData.h"
 #include "KX_2DFilterManager.h"
 #include "RAS_BoundingBoxManager.h"
+#include "RAS_MeshUser.h"
 #include "RAS_BucketManager.h"
 
 #include "EXP_FloatValue.h"
 #include "SCA_IController.h"
 #include "SCA_IActuator.h"
 #include "SG_Node.h"
+#include "SG_TransformPool.h"
 #include "SG_Controller.h"
 #include "SG_Node.h"
 #include "DNA_group_types.h"
 #include "DNA_scene_types.h"
 #include "DNA_property_types.h"
+#include "DNA_object_types.h" // for OB_MAX_COL_MASKS
 
 #include "KX_SG_NodeRelationships.h"
 
@@ -93,6 +100,7 @@
 
 #ifdef WITH_BULLET
 #  include "KX_SoftBodyDeformer.h"
+#  include "CcdPhysicsController.h"
 #endif
 
 #ifdef WITH_PYTHON
@@ -105,6 +113,9 @@
 
 #include "CM_Message.h"
 
+/// Property of a property telling that it is a timer.
+static const CPropertyKey timerKey("timer");
+
 static void *KX_SceneReplicationFunc(SG_Node* node,void* gameobj,void* scene)
 {
 	KX_GameObject* replica = ((KX_Scene*)scene)->AddNodeReplicaObject(node,(KX_GameObject*)gameobj);
@@ -155,7 +166,11 @@ KX_Scene::KX_Scene(SCA_IInputDevice *inputDevice,
 	m_suspendeddelta(0.0),
 	m_blenderScene(scene),
 	m_isActivedHysteresis(false),
-	m_lodHysteresisValue(0)
+	m_lodHysteresisValue(0),
+	m_animationLodDistance(0.0f),
+	m_animationLodMaxInterval(1),
+	m_animationLodInterpolation(false),
+	m_animationLodOffset(0)
 {
 
 	m_dbvt_culling = false;
@@ -171,6 +186,7 @@ KX_Scene::KX_Scene(SCA_IInputDevice *inputDevice,
 
 	m_filterManager = new KX_2DFilterManager();
 	m_logicmgr = new SCA_LogicManager();
+	m_logicmgr->SetTaskScheduler(KX_GetActiveEngine()->GetTaskScheduler());
 	
 	m_timemgr = new SCA_TimeEventManager(m_logicmgr);
 	m_keyboardmgr = new SCA_KeyboardManager(m_logicmgr, inputDevice);
@@ -191,10 +207,16 @@ KX_Scene::KX_Scene(SCA_IInputDevice *inputDevice,
 	m_networkScene = new KX_NetworkMessageScene(messageManager);
 	
 	m_rootnode = nullptr;
+	m_transformPool = new SG_TransformPool();
 
 	m_rendererManager = new KX_TextureRendererManager(this);
 	m_bucketmanager=new RAS_BucketManager();
 	m_boundingBoxManager = new RAS_BoundingBoxManager();
+	m_cullingTree = new KX_CullingTree();
+	m_deformedObjectsInvalid = true;
+	m_expiryScheduler = new KX_ExpiryScheduler();
+	m_activityGrid = new KX_ActivityGrid(ObjectActivityChanged, this);
+	m_replicaPool = new KX_ReplicaPool();
 	
 	bool showObstacleSimulation = (scene->gm.flag & GAME_SHOW_OBSTACLE_SIMULATION) != 0;
 	switch (scene->gm.obstacleSimulation)
@@ -209,7 +231,10 @@ KX_Scene::KX_Scene(SCA_IInputDevice *inputDevice,
 		m_obstacleSimulation = nullptr;
 	}
 
+	m_animationPoolData.curtime = 0.0;
+	m_animationPoolData.frame = 0;
 	m_animationPool = BLI_task_pool_create(KX_GetActiveEngine()->GetTaskScheduler(), &m_animationPoolData);
+	m_sceneGraphPool = BLI_task_pool_create(KX_GetActiveEngine()->GetTaskScheduler(), &m_sceneGraphPoolData);
 
 #ifdef WITH_PYTHON
 	m_attr_dict = nullptr;
@@ -235,6 +260,9 @@ KX_Scene::~KX_Scene()
 		this->RemoveObject(parentobj);
 	}
 
+	// The pooled replicas removed previously were parked.
+	FreeParkedObjects(nullptr);
+
 	if (m_obstacleSimulation)
 		delete m_obstacleSimulation;
 
@@ -242,6 +270,10 @@ KX_Scene::~KX_Scene()
 		BLI_task_pool_free(m_animationPool);
 	}
 
+	if (m_sceneGraphPool) {
+		BLI_task_pool_free(m_sceneGraphPool);
+	}
+
 	if (m_objectlist)
 		m_objectlist->Release();
 
@@ -288,6 +320,22 @@ KX_Scene::~KX_Scene()
 		delete m_boundingBoxManager;
 	}
 
+	if (m_cullingTree) {
+		delete m_cullingTree;
+	}
+
+	if (m_expiryScheduler) {
+		delete m_expiryScheduler;
+	}
+
+	if (m_activityGrid) {
+		delete m_activityGrid;
+	}
+
+	if (m_replicaPool) {
+		delete m_replicaPool;
+	}
+
 #ifdef WITH_PYTHON
 	if (m_attr_dict) {
 		PyDict_Clear(m_attr_dict);
@@ -300,6 +348,9 @@ KX_Scene::~KX_Scene()
 		Py_CLEAR(m_drawCallbacks[i]);
 	}
 #endif
+
+	// Deleted last as every scene graph node of the scene uses it.
+	delete m_transformPool;
 }
 
 std::string KX_Scene::GetName()
@@ -328,6 +379,31 @@ RAS_BoundingBoxManager *KX_Scene::GetBoundingBoxManager() const
 	return m_boundingBoxManager;
 }
 
+SG_TransformPool *KX_Scene::GetTransformPool() const
+{
+	return m_transformPool;
+}
+
+KX_CullingTree *KX_Scene::GetCullingTree() const
+{
+	return m_cullingTree;
+}
+
+KX_ExpiryScheduler *KX_Scene::GetExpiryScheduler() const
+{
+	return m_expiryScheduler;
+}
+
+KX_ActivityGrid *KX_Scene::GetActivityGrid() const
+{
+	return m_activityGrid;
+}
+
+KX_ReplicaPool *KX_Scene::GetReplicaPool() const
+{
+	return m_replicaPool;
+}
+
 CListValue<KX_GameObject> *KX_Scene::GetObjectList() const
 {
 	return m_objectlist;
@@ -408,6 +484,10 @@ void KX_Scene::Resume()
 
 void KX_Scene::SetActivityCulling(bool b)
 {
+	if (b != m_activity_culling) {
+		// The grid doesn't track the objects while the activity culling is disabled.
+		m_activityGrid->Invalidate();
+	}
 	m_activity_culling = b;
 }
 
@@ -473,7 +553,7 @@ KX_GameObject* KX_Scene::AddNodeReplicaObject(SG_Node* node, KX_GameObject *game
 	{
 		CValue* prop = newobj->GetProperty(i);
 
-		if (prop->GetProperty("timer"))
+		if (prop->GetProperty(timerKey))
 			this->m_timemgr->AddTimeProperty(prop);
 	}
 
@@ -483,7 +563,7 @@ KX_GameObject* KX_Scene::AddNodeReplicaObject(SG_Node* node, KX_GameObject *game
 	}
 	else
 	{
-		m_rootnode = new SG_Node(newobj,this,KX_Scene::m_callbacks);
+		m_rootnode = new SG_Node(newobj,this,KX_Scene::m_callbacks,m_transformPool);
 	
 		// this fixes part of the scaling-added object bug
 		SG_Node* orgnode = gameobj->GetSGNode();
@@ -511,6 +591,8 @@ KX_GameObject* KX_Scene::AddNodeReplicaObject(SG_Node* node, KX_GameObject *game
 
 	// this is the list of object that are send to the graphics pipeline
 	m_objectlist->Add(CM_AddRef(newobj));
+	AddCullingObject(newobj);
+	m_activityGrid->AddObject(newobj);
 	switch (newobj->GetGameObjectType()) {
 		case SCA_IObject::OBJ_LIGHT:
 		{
@@ -847,7 +929,7 @@ void KX_Scene::DupliGroupRecurse(KX_GameObject *groupobj, int level)
 }
 
 
-KX_GameObject *KX_Scene::AddReplicaObject(KX_GameObject *originalobject, KX_GameObject *referenceobject, float lifespan)
+KX_GameObject *KX_Scene::AddReplicaObject(KX_GameObject *originalobject, KX_GameObject *referenceobject, float lifespan, bool usePool)
 {
 	m_logicHierarchicalGameObjects.clear();
 	m_map_gameobject_to_replica.clear();
@@ -858,6 +940,15 @@ KX_GameObject *KX_Scene::AddReplicaObject(KX_GameObject *originalobject, KX_Game
 
 	m_ueberExecutionPriority++;
 
+	if (usePool) {
+		KX_GameObject *parkedobj = m_replicaPool->TakeObject(originalobj);
+		if (parkedobj) {
+			RecycleReplicaObject(parkedobj, originalobj, referenceobj, lifespan);
+			// Same as a new replica, the caller owns a reference.
+			return CM_AddRef(parkedobj);
+		}
+	}
+
 	// lets create a replica
 	KX_GameObject* replica = (KX_GameObject*) AddNodeReplicaObject(nullptr,originalobj);
 
@@ -865,13 +956,9 @@ KX_GameObject *KX_Scene::AddReplicaObject(KX_GameObject *originalobject, KX_Game
 	// lifespan of zero means 'this object lives forever'
 	if (lifespan > 0.0f)
 	{
-		// for now, convert between so called frames and realtime
-		m_tempObjectList.push_back(replica);
 		// this convert the life from frames to sort-of seconds, hard coded 0.02 that assumes we have 50 frames per second
 		// if you change this value, make sure you change it in KX_GameObject::pyattr_get_life property too
-		CValue *fval = new CFloatValue(lifespan*0.02f);
-		replica->SetProperty("::timebomb",fval);
-		fval->Release();
+		m_expiryScheduler->AddObject(replica, lifespan * 0.02f);
 	}
 
 	// add to 'rootparent' list (this is the list of top hierarchy objects, updated each frame)
@@ -890,24 +977,9 @@ KX_GameObject *KX_Scene::AddReplicaObject(KX_GameObject *originalobject, KX_Game
 			replica->GetSGNode()->AddChild(childreplicanode);
 	}
 
-	if (referenceobj) {
-		// At this stage all the objects in the hierarchy have been duplicated,
-		// we can update the scenegraph, we need it for the duplication of logic
-		MT_Vector3 newpos = referenceobj->NodeGetWorldPosition();
-		replica->NodeSetLocalPosition(newpos);
-
-		MT_Matrix3x3 newori = referenceobj->NodeGetWorldOrientation();
-		replica->NodeSetLocalOrientation(newori);
-
-		// get the rootnode's scale
-		MT_Vector3 newscale = referenceobj->GetSGNode()->GetRootSGParent()->GetLocalScale();
-		// set the replica's relative scale with the rootnode's scale
-		replica->NodeSetRelativeScale(newscale);
-	}
-
-	replica->GetSGNode()->UpdateWorldData(0);
-	// the size is correct, we can add the graphic controller to the physic engine
-	replica->ActivateGraphicController(true);
+	// At this stage all the objects in the hierarchy have been duplicated,
+	// we can update the scenegraph, we need it for the duplication of logic
+	SetReplicaTransform(replica, referenceobj);
 
 	// now replicate logic
 	for (KX_GameObject *gameobj : m_logicHierarchicalGameObjects) {
@@ -946,14 +1018,257 @@ KX_GameObject *KX_Scene::AddReplicaObject(KX_GameObject *originalobject, KX_Game
 		DupliGroupRecurse(gameobj, 0);
 	}
 
+	if (usePool && IsReplicaPoolable(originalobj)) {
+		m_replicaPool->AddObject(replica, originalobj);
+	}
+
 	//	don't release replica here because we are returning it, not done with it...
 	return replica;
 }
 
 
 
+void KX_Scene::SetReplicaTransform(KX_GameObject *replica, KX_GameObject *referenceobj)
+{
+	if (referenceobj) {
+		MT_Vector3 newpos = referenceobj->NodeGetWorldPosition();
+		replica->NodeSetLocalPosition(newpos);
+
+		MT_Matrix3x3 newori = referenceobj->NodeGetWorldOrientation();
+		replica->NodeSetLocalOrientation(newori);
+
+		// get the rootnode's scale
+		MT_Vector3 newscale = referenceobj->GetSGNode()->GetRootSGParent()->GetLocalScale();
+		// set the replica's relative scale with the rootnode's scale
+		replica->NodeSetRelativeScale(newscale);
+	}
+
+	replica->GetSGNode()->UpdateWorldData(0);
+	// the size is correct, we can add the graphic controller to the physic engine
+	replica->ActivateGraphicController(true);
+}
+
+bool KX_Scene::IsReplicaPoolable(KX_GameObject *gameobj) const
+{
+	/* Only the plain objects without children are recycled, the other kinds of objects
+	 * are registered in scene lists and a hierarchy would require to recycle all its objects. */
+	if (gameobj->GetGameObjectType() != -1 ||
+	    !gameobj->GetSGNode()->GetSGChildren().empty() ||
+	    gameobj->IsDupliGroup() ||
+	    gameobj->GetComponents())
+	{
+		return false;
+	}
+
+	/* The controllers of a replica are linked by ReplicateLogic to the sensors and actuators
+	 * of the other objects, these links would stay active while the replica is parked. */
+	for (SCA_IController *cont : gameobj->GetControllers()) {
+		for (SCA_ISensor *sensor : cont->GetLinkedSensors()) {
+			if (sensor->GetParent() != gameobj) {
+				return false;
+			}
+		}
+		for (SCA_IActuator *actua : cont->GetLinkedActuators()) {
+			if (actua->GetParent() != gameobj) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+void KX_Scene::RecycleReplicaObject(KX_GameObject *replica, KX_GameObject *originalobj, KX_GameObject *referenceobj, float lifespan)
+{
+	// Forget the previous life of the object: properties, sensors and initial state.
+	replica->ResetReplica(originalobj);
+	replica->Resume();
+
+	// The timer properties of the previous life were unregistered when the object was parked,
+	// register the new timer properties copied from the original object.
+	for (int i = 0, numprops = replica->GetPropertyCount(); i < numprops; ++i) {
+		CValue *prop = replica->GetProperty(i);
+		if (prop->GetProperty(timerKey)) {
+			m_timemgr->AddTimeProperty(prop);
+		}
+	}
+
+	if (m_obstacleSimulation && originalobj->GetBlenderObject()->gameflag & OB_HASOBSTACLE) {
+		m_obstacleSimulation->AddObstacleForObj(replica);
+	}
+
+	// The reference owned by the pool is given to the object list.
+	m_objectlist->Add(replica);
+	AddCullingObject(replica);
+	m_activityGrid->AddObject(replica);
+	m_parentlist->Add(CM_AddRef(replica));
+
+	if (lifespan > 0.0f) {
+		// See AddReplicaObject for the conversion of the life span.
+		m_expiryScheduler->AddObject(replica, lifespan * 0.02f);
+	}
+
+	// Restore the mesh of the original object if it was replaced during the previous life.
+	bool sameMeshes = (replica->GetMeshCount() == originalobj->GetMeshCount());
+	for (unsigned int i = 0, nummeshes = replica->GetMeshCount(); sameMeshes && i < nummeshes; ++i) {
+		sameMeshes = (replica->GetMesh(i) == originalobj->GetMesh(i));
+	}
+	if (!sameMeshes) {
+		if (originalobj->GetMeshCount() > 0) {
+			ReplaceMesh(replica, originalobj->GetMesh(0), true, false);
+		}
+		else {
+			replica->RemoveMeshes();
+		}
+	}
+
+	PHY_IPhysicsController *ctrl = replica->GetPhysicsController();
+	PHY_IPhysicsController *orgctrl = originalobj->GetPhysicsController();
+	if (ctrl) {
+		ctrl->RestorePhysics();
+		if (ctrl->IsDynamicsSuspended()) {
+			ctrl->RestoreDynamics();
+		}
+		ctrl->SetLinearVelocity(MT_Vector3(0.0f, 0.0f, 0.0f), false);
+		ctrl->SetAngularVelocity(MT_Vector3(0.0f, 0.0f, 0.0f), false);
+
+		if (orgctrl) {
+#ifdef WITH_BULLET
+			// The shape could have been replaced by an other object shape.
+			if (static_cast<CcdPhysicsController *>(ctrl)->GetShapeInfo() !=
+			    static_cast<CcdPhysicsController *>(orgctrl)->GetShapeInfo())
+			{
+				ctrl->ReplacePhysicsShape(orgctrl);
+			}
+#endif
+			if (ctrl->GetMass() != orgctrl->GetMass()) {
+				ctrl->SetMass(orgctrl->GetMass());
+			}
+		}
+	}
+
+	// Setting the collision filter refreshes the collisions of the whole world, only do it when changed.
+	if (replica->GetUserCollisionGroup() != originalobj->GetUserCollisionGroup()) {
+		replica->SetUserCollisionGroup(originalobj->GetUserCollisionGroup());
+	}
+	if (replica->GetUserCollisionMask() != originalobj->GetUserCollisionMask()) {
+		replica->SetUserCollisionMask(originalobj->GetUserCollisionMask());
+	}
+
+	// Restart from the transform of the original object like a new replica.
+	SG_Node *orgnode = originalobj->GetSGNode();
+	replica->NodeSetLocalScale(orgnode->GetLocalScale());
+	replica->NodeSetLocalPosition(orgnode->GetLocalPosition());
+	replica->NodeSetLocalOrientation(orgnode->GetLocalOrientation());
+	SetReplicaTransform(replica, referenceobj);
+
+	replica->SetLayer((referenceobj) ? referenceobj->GetLayer() : m_blenderScene->lay);
+
+	if (KX_GetActiveEngine()->GetFlag(KX_KetsjiEngine::AUTO_ADD_DEBUG_PROPERTIES)) {
+		AddObjectDebugProperties(replica);
+	}
+
+	/* The logic bricks are still linked, only the execution priority and the state are reset,
+	 * the state mask was cleared when the object was parked. */
+	for (SCA_IController *cont : replica->GetControllers()) {
+		cont->SetUeberExecutePriority(m_ueberExecutionPriority);
+	}
+	for (SCA_IActuator *actua : replica->GetActuators()) {
+		actua->SetUeberExecutePriority(m_ueberExecutionPriority);
+	}
+	replica->ResetState();
+}
+
+bool KX_Scene::ParkReplicaObject(KX_GameObject *gameobj)
+{
+	if (!m_replicaPool->IsActiveObject(gameobj)) {
+		return false;
+	}
+
+	// The object could have been parented or used as parent since its addition.
+	SG_Node *node = gameobj->GetSGNode();
+	if (!node || node->GetSGParent() || !node->GetSGChildren().empty()) {
+		m_replicaPool->RemoveObject(gameobj);
+		return false;
+	}
+
+	if (!m_replicaPool->ParkObject(gameobj)) {
+		return false;
+	}
+
+	RemoveObjectDebugProperties(gameobj);
+	// Python references to the removed object are invalid as for a freed object.
+	gameobj->InvalidateProxy();
+
+	m_logicmgr->DeactivateObjectLogic(gameobj);
+	gameobj->UnlinkAllClients();
+
+	/* A renamed replica or a replica of a merged scene is registered in the logic manager,
+	 * as for a freed object it must not be found anymore. A new replica is not registered,
+	 * so a recycled replica is not registered again. */
+	m_logicmgr->UnregisterGameObjectName(gameobj->GetName(), gameobj);
+	if (gameobj->GetBlenderObject()) {
+		m_logicmgr->UnregisterGameObj(gameobj->GetBlenderObject(), gameobj);
+	}
+
+	for (int i = 0, numprops = gameobj->GetPropertyCount(); i < numprops; ++i) {
+		CValue *prop = gameobj->GetProperty(i);
+		if (prop->GetProperty(timerKey)) {
+			m_timemgr->RemoveTimeProperty(prop);
+		}
+	}
+
+	if (m_obstacleSimulation) {
+		m_obstacleSimulation->DestroyObstacleForObj(gameobj);
+	}
+
+	m_rendererManager->InvalidateViewpoint(gameobj);
+
+	// Remove the physics body from the world and the object from the physics culling.
+	PHY_IPhysicsController *ctrl = gameobj->GetPhysicsController();
+	if (ctrl) {
+		ctrl->SuspendPhysics(true);
+	}
+	PHY_IGraphicController *graphicCtrl = gameobj->GetGraphicController();
+	if (graphicCtrl) {
+		graphicCtrl->Activate(false);
+	}
+
+	m_expiryScheduler->RemoveObject(gameobj);
+	// The reference of the object list is given to the pool.
+	m_objectlist->RemoveValue(gameobj);
+	RemoveCullingObject(gameobj);
+	m_activityGrid->RemoveObject(gameobj);
+	if (m_parentlist->RemoveValue(gameobj)) {
+		gameobj->Release();
+	}
+
+	const std::vector<KX_GameObject *>::const_iterator animit = std::find(m_animatedlist.begin(), m_animatedlist.end(), gameobj);
+	if (animit != m_animatedlist.end()) {
+		m_animatedlist.erase(animit);
+	}
+
+	return true;
+}
+
+void KX_Scene::FreeParkedObjects(KX_GameObject *originalobj)
+{
+	std::vector<KX_GameObject *> parkedObjects;
+	m_replicaPool->GetParkedObjects(originalobj, parkedObjects);
+
+	// The objects are unregistered from the pool in NewRemoveObject.
+	for (KX_GameObject *gameobj : parkedObjects) {
+		RemoveObject(gameobj);
+	}
+}
+
 void KX_Scene::RemoveObject(KX_GameObject *gameobj)
 {
+	// Pooled replicas are kept for a next addition.
+	if (ParkReplicaObject(gameobj)) {
+		return;
+	}
+
 	// disconnect child from parent
 	SG_Node* node = gameobj->GetSGNode();
 
@@ -979,7 +1294,7 @@ void KX_Scene::DelayedRemoveObject(KX_GameObject *gameobj)
 {
 	RemoveDupliGroup(gameobj);
 
-	if (std::find(m_euthanasyobjects.begin(), m_euthanasyobjects.end(), gameobj) != m_euthanasyobjects.end()) {
+	if (std::find(m_euthanasyobjects.begin(), m_euthanasyobjects.end(), gameobj) == m_euthanasyobjects.end()) {
 		m_euthanasyobjects.push_back(gameobj);
 	}
 }
@@ -1036,7 +1351,7 @@ bool KX_Scene::NewRemoveObject(KX_GameObject *gameobj)
 	for (int i = 0; i < numprops; i++)
 	{
 		CValue* propval = gameobj->GetProperty(i);
-		if (propval->GetProperty("timer"))
+		if (propval->GetProperty(timerKey))
 		{
 			m_timemgr->RemoveTimeProperty(propval);
 		}
@@ -1055,6 +1370,9 @@ bool KX_Scene::NewRemoveObject(KX_GameObject *gameobj)
 	if (group)
 		group->RemoveInstanceObject(gameobj);
 
+	// Free the parked replicas of an original object.
+	FreeParkedObjects(gameobj);
+
 	if (m_obstacleSimulation) {
 		m_obstacleSimulation->DestroyObstacleForObj(gameobj);
 	}
@@ -1066,8 +1384,14 @@ bool KX_Scene::NewRemoveObject(KX_GameObject *gameobj)
 	bool ret = true;
 	if (gameobj->GetGameObjectType()==SCA_IObject::OBJ_LIGHT && m_lightlist->RemoveValue(static_cast<KX_LightObject *>(gameobj)))
 		ret = (gameobj->Release() != nullptr);
-	if (m_objectlist->RemoveValue(gameobj))
+	if (m_replicaPool->RemoveObject(gameobj))
+		ret = (gameobj->Release() != nullptr);
+	m_expiryScheduler->RemoveObject(gameobj);
+	if (m_objectlist->RemoveValue(gameobj)) {
+		RemoveCullingObject(gameobj);
+		m_activityGrid->RemoveObject(gameobj);
 		ret = (gameobj->Release() != nullptr);
+	}
 	if (m_parentlist->RemoveValue(gameobj))
 		ret = (gameobj->Release() != nullptr);
 	if (m_inactivelist->RemoveValue(gameobj))
@@ -1251,6 +1575,8 @@ void KX_Scene::ReplaceMesh(KX_GameObject *gameobj, RAS_MeshObject *mesh, bool us
 	}
 	// Always make sure that the bounding box is updated to the new mesh.
 	gameobj->UpdateBounds(true);
+	// The deformer of the object could have changed.
+	m_deformedObjectsInvalid = true;
 }
 
 
@@ -1300,69 +1626,132 @@ void KX_Scene::PhysicsCullingCallback(KX_ClientObjectInfo *objectInfo, void *cul
 	info->m_nodes.push_back(gameobj->GetCullingNode());
 }
 
-void KX_Scene::CalculateVisibleMeshes(KX_CullingNodeList& nodes, KX_Camera *cam, int layer)
+void KX_Scene::AddCullingObject(KX_GameObject *gameobj)
 {
-	m_boundingBoxManager->Update(false);
+	m_cullingTree->AddNode(gameobj->GetCullingNode());
+	// A replica copies the culled flag of its original, it is not in the visible nodes.
+	gameobj->SetCulled(true);
 
-	// Update the object bounding volume box if the object had a deformer.
-	for (KX_GameObject *gameobj : m_objectlist) {
-		if (gameobj->GetDeformer()) {
-			/** Update all the deformer, not only per material.
-			 * One of the side effect is to clear some flags about AABB calculation.
-			 * like in KX_SoftBodyDeformer.
-			 */
-			gameobj->GetDeformer()->UpdateBuckets();
-		}
-		gameobj->UpdateBounds(false);
+	if (gameobj->GetDeformer()) {
+		m_deformedObjectsInvalid = true;
 	}
+}
 
-	m_boundingBoxManager->ClearModified();
+void KX_Scene::RemoveCullingObject(KX_GameObject *gameobj)
+{
+	KX_CullingNode *node = gameobj->GetCullingNode();
+	m_cullingTree->RemoveNode(node);
 
-	if (!cam->GetFrustumCulling()) {
-		for (KX_GameObject *gameobj : m_objectlist) {
-			KX_CullingNode *node = gameobj->GetCullingNode();
-			nodes.push_back(gameobj->GetCullingNode());
-			node->SetCulled(false);
+	if (!node->GetCulled()) {
+		KX_CullingNodeList::iterator nodeit = std::find(m_visibleNodes.begin(), m_visibleNodes.end(), node);
+		if (nodeit != m_visibleNodes.end()) {
+			m_visibleNodes.erase(nodeit);
 		}
+		// The object can be added again from the replica pool.
+		node->SetCulled(true);
+	}
 
-		return;
+	// The deformer could be already removed, look for the object itself.
+	std::vector<KX_GameObject *>::iterator it = std::find(m_deformedObjects.begin(), m_deformedObjects.end(), gameobj);
+	if (it != m_deformedObjects.end()) {
+		m_deformedObjects.erase(it);
 	}
+}
 
-	bool dbvt_culling = false;
-	if (m_dbvt_culling) {
-		/* Reset KX_GameObject m_bCulled to true before doing culling
-		 * since DBVT culling will only set it to false.
-		 * This is similar to what RAS_BucketManager does for RAS_MeshSlot culling.
-		 */
+void KX_Scene::UpdateObjectBounds()
+{
+	// Recompute the bounding boxes of the meshes with modified vertices.
+	m_boundingBoxManager->Update(false);
+
+	if (m_deformedObjectsInvalid) {
+		m_deformedObjects.clear();
 		for (KX_GameObject *gameobj : m_objectlist) {
-			gameobj->SetCulled(true);
+			if (gameobj->GetDeformer()) {
+				m_deformedObjects.push_back(gameobj);
+			}
 		}
+		m_deformedObjectsInvalid = false;
+	}
 
-		// test culling through Bullet
-		// get the clip planes
-		const std::array<MT_Vector4, 6>& cplanes = cam->GetFrustum().GetPlanes();
-		// and convert
-		MT_Vector4 planes[6] = {cplanes[4], cplanes[5], cplanes[0], cplanes[1], cplanes[2], cplanes[3]};
+	for (KX_GameObject *gameobj : m_deformedObjects) {
+		/** Update all the deformer, not only per material.
+		 * One of the side effect is to clear some flags about AABB calculation.
+		 * like in KX_SoftBodyDeformer.
+		 */
+		gameobj->GetDeformer()->UpdateBuckets();
+	}
 
-		CullingInfo info(layer, nodes);
+	// Update the object bounding volume box of the users of all the modified bounding boxes.
+	for (RAS_BoundingBox *boundingBox : m_boundingBoxManager->GetModifiedBoundingBoxList()) {
+		for (RAS_MeshUser *meshUser : boundingBox->GetUsers()) {
+			KX_GameObject *gameobj = KX_GameObject::GetClientObject((KX_ClientObjectInfo *)meshUser->GetClientObject());
+			gameobj->UpdateBounds(false);
+		}
+	}
 
-		float mvmat[16] = {0.0f};
-		cam->GetModelviewMatrix().getValue(mvmat);
-		float pmat[16] = {0.0f};
-		cam->GetProjectionMatrix().getValue(pmat);
+	m_boundingBoxManager->ClearModified();
+}
+
+void KX_Scene::CalculateVisibleMeshes(KX_CullingNodeList& nodes, KX_Camera *cam, int layer)
+{
+	UpdateObjectBounds();
 
-		dbvt_culling = m_physicsEnvironment->CullingTest(PhysicsCullingCallback,&info,planes,6,m_dbvt_occlusion_res,
-		                                                 KX_GetActiveEngine()->GetCanvas()->GetViewPort(),
-		                                                 mvmat, pmat);
+	/* Reset the culled flag to true before doing culling since the culling only set it to false.
+	 * This is similar to what RAS_BucketManager does for RAS_MeshSlot culling.
+	 */
+	for (KX_CullingNode *node : m_visibleNodes) {
+		node->SetCulled(true);
 	}
-	if (!dbvt_culling) {
-		KX_CullingHandler handler(nodes, cam->GetFrustum());
+
+	if (!cam->GetFrustumCulling()) {
 		for (KX_GameObject *gameobj : m_objectlist) {
-			if (gameobj->UseCulling() && gameobj->GetVisible() && (layer == 0 || gameobj->GetLayer() & layer)) {
-				handler.Process(gameobj->GetCullingNode());
+			KX_CullingNode *node = gameobj->GetCullingNode();
+			nodes.push_back(gameobj->GetCullingNode());
+			node->SetCulled(false);
+		}
+	}
+	else {
+		bool dbvt_culling = false;
+		if (m_dbvt_culling) {
+			// test culling through Bullet
+			// get the clip planes
+			const std::array<MT_Vector4, 6>& cplanes = cam->GetFrustum().GetPlanes();
+			// and convert
+			MT_Vector4 planes[6] = {cplanes[4], cplanes[5], cplanes[0], cplanes[1], cplanes[2], cplanes[3]};
+
+			CullingInfo info(layer, nodes);
+
+			float mvmat[16] = {0.0f};
+			cam->GetModelviewMatrix().getValue(mvmat);
+			float pmat[16] = {0.0f};
+			cam->GetProjectionMatrix().getValue(pmat);
+
+			dbvt_culling = m_physicsEnvironment->CullingTest(PhysicsCullingCallback,&info,planes,6,m_dbvt_occlusion_res,
+			                                                 KX_GetActiveEngine()->GetCanvas()->GetViewPort(),
+			                                                 mvmat, pmat);
+		}
+		if (!dbvt_culling) {
+			// The nodes not found by the tree are not tested, they stay culled.
+			const SG_Frustum& frustum = cam->GetFrustum();
+
+			KX_CullingNodeList treeNodes;
+			m_cullingTree->Update(m_objectlist);
+			m_cullingTree->Query(frustum, treeNodes);
+
+			KX_CullingNodeList testNodes;
+			for (KX_CullingNode *node : treeNodes) {
+				KX_GameObject *gameobj = node->GetObject();
+				if (gameobj->UseCulling() && gameobj->GetVisible() && (layer == 0 || gameobj->GetLayer() & layer)) {
+					testNodes.push_back(node);
+				}
 			}
+
+			KX_CullingHandler handler(nodes, frustum);
+			handler.Process(testNodes);
 		}
 	}
+
+	m_visibleNodes = nodes;
 }
 
 void KX_Scene::DrawDebug(RAS_DebugDraw& debugDraw, const KX_CullingNodeList& nodes)
@@ -1455,28 +1844,11 @@ void KX_Scene::RenderDebugProperties(RAS_DebugDraw& debugDraw, int xindent, int
 // logic stuff
 void KX_Scene::LogicBeginFrame(double curtime, double framestep)
 {
-	// have a look at temp objects ...
-	for (KX_GameObject *gameobj : m_tempObjectList) {
-		CFloatValue* propval = (CFloatValue *)gameobj->GetProperty("::timebomb");
-		
-		if (propval)
-		{
-			float timeleft = propval->GetNumber() - framestep;
-			
-			if (timeleft > 0)
-			{
-				propval->SetFloat(timeleft);
-			}
-			else
-			{
-				DelayedRemoveObject(gameobj);
-				// remove obj
-			}
-		}
-		else
-		{
-			// all object is the tempObjectList should have a clock
-		}
+	// Remove the temporary objects at the end of their life.
+	std::vector<KX_GameObject *> expiredObjects;
+	m_expiryScheduler->Update(framestep, expiredObjects);
+	for (KX_GameObject *gameobj : expiredObjects) {
+		DelayedRemoveObject(gameobj);
 	}
 	m_logicmgr->BeginFrame(curtime, framestep);
 }
@@ -1486,19 +1858,43 @@ void KX_Scene::AddAnimatedObject(KX_GameObject *gameobj)
 	const std::vector<KX_GameObject *>::const_iterator it = std::find(m_animatedlist.begin(), m_animatedlist.end(), gameobj);
 	if (it == m_animatedlist.end()) {
 		m_animatedlist.push_back(gameobj);
+
+		// Spread the updates of the throttled armatures over the frames.
+		if (gameobj->GetGameObjectType() == SCA_IObject::OBJ_ARMATURE) {
+			static_cast<BL_ArmatureObject *>(gameobj)->SetAnimationLodOffset(m_animationLodOffset++);
+		}
 	}
 }
 
-static void update_anim_thread_func(TaskPool *pool, void *taskdata, int UNUSED(threadid))
+/** Compute the number of frames between two updates of an armature from the distance
+ * to the camera, scaled as the mesh levels of detail, and the level of its meshes.
+ */
+static short animation_lod_interval(KX_GameObject *gameobj, CListValue<KX_GameObject> *children,
+		const KX_Scene::AnimationPoolData *data)
 {
-	KX_GameObject *gameobj, *parent;
+	short step = 0;
+
+	if (data->lodDistance > 0.0f) {
+		const float distance = gameobj->NodeGetWorldPosition().distance(data->cameraPosition) * data->lodFactor;
+		step = (short)std::min(distance / data->lodDistance, (float)data->lodMaxInterval);
+	}
+
+	for (KX_GameObject *child : children) {
+		if (child->GetLodManager()) {
+			step = std::max(step, child->GetLodLevel());
+		}
+	}
+
+	return std::min((short)(step + 1), data->lodMaxInterval);
+}
+
+static void update_anim_object(KX_GameObject *gameobj, const KX_Scene::AnimationPoolData *data)
+{
+	KX_GameObject *parent;
 	CListValue<KX_GameObject> *children;
 	bool needs_update;
-	KX_Scene::AnimationPoolData *data = (KX_Scene::AnimationPoolData *)BLI_task_pool_userdata(pool);
 	double curtime = data->curtime;
 
-	gameobj = (KX_GameObject*)taskdata;
-
 	// Non-armature updates are fast enough, so just update them
 	needs_update = gameobj->GetGameObjectType() != SCA_IObject::OBJ_ARMATURE;
 
@@ -1531,8 +1927,34 @@ static void update_anim_thread_func(TaskPool *pool, void *taskdata, int UNUSED(t
 		children->Release();
 	}
 
-	// If the object is a culled armature, then we manage only the animation time and end of its animations.
-	gameobj->UpdateActionManager(curtime, needs_update);
+	if (needs_update && data->lodMaxInterval > 1 && gameobj->GetGameObjectType() == SCA_IObject::OBJ_ARMATURE) {
+		BL_ArmatureObject *armature = static_cast<BL_ArmatureObject *>(gameobj);
+
+		children = gameobj->GetChildren();
+		const short interval = animation_lod_interval(gameobj, children, data);
+		children->Release();
+
+		if (interval == 1) {
+			armature->ClearLodPoses();
+			gameobj->UpdateActionManager(curtime, true);
+		}
+		else if ((data->frame + armature->GetAnimationLodOffset()) % interval == 0) {
+			gameobj->UpdateActionManager(curtime, true);
+			if (data->lodInterpolation) {
+				armature->StoreLodPose(curtime);
+				armature->InterpolateLodPose(curtime);
+			}
+		}
+		else {
+			// Skipped frame, manage only the animation time and use the last or an interpolated pose.
+			gameobj->UpdateActionManager(curtime, false);
+			needs_update = data->lodInterpolation && armature->InterpolateLodPose(curtime);
+		}
+	}
+	else {
+		// If the object is a culled armature, then we manage only the animation time and end of its animations.
+		gameobj->UpdateActionManager(curtime, needs_update);
+	}
 
 	if (needs_update) {
 		children = gameobj->GetChildren();
@@ -1553,13 +1975,37 @@ static void update_anim_thread_func(TaskPool *pool, void *taskdata, int UNUSED(t
 	}
 }
 
+static void update_anim_thread_func(TaskPool *pool, void *taskdata, int start, int stop, int UNUSED(threadid))
+{
+	const KX_Scene::AnimationPoolData *data = (KX_Scene::AnimationPoolData *)BLI_task_pool_userdata(pool);
+	const std::vector<KX_GameObject *>& objects = *(std::vector<KX_GameObject *> *)taskdata;
+
+	for (int i = start; i < stop; ++i) {
+		update_anim_object(objects[i], data);
+	}
+}
+
 void KX_Scene::UpdateAnimations(double curtime)
 {
+	// The animations can be updated several times for the same time by the renderers.
+	if (curtime != m_animationPoolData.curtime) {
+		++m_animationPoolData.frame;
+	}
 	m_animationPoolData.curtime = curtime;
-
-	for (KX_GameObject *gameobj : m_animatedlist) {
-		BLI_task_pool_push(m_animationPool, update_anim_thread_func, gameobj, false, TASK_PRIORITY_LOW);
+	m_animationPoolData.lodDistance = m_animationLodDistance;
+	m_animationPoolData.lodMaxInterval = m_animationLodMaxInterval;
+	m_animationPoolData.lodInterpolation = m_animationLodInterpolation;
+	// Use always the active camera to keep the same updated armatures for all the renderers.
+	if (m_active_camera) {
+		m_animationPoolData.cameraPosition = m_active_camera->NodeGetWorldPosition();
+		m_animationPoolData.lodFactor = m_active_camera->GetLodDistanceFactor();
 	}
+	else {
+		m_animationPoolData.lodMaxInterval = 1;
+	}
+
+	// Push ranges of objects, the grain size is chosen from the number of threads.
+	BLI_task_pool_push_range(m_animationPool, update_anim_thread_func, &m_animatedlist, 0, m_animatedlist.size(), 0, TASK_PRIORITY_LOW);
 
 	BLI_task_pool_work_and_wait(m_animationPool);
 }
@@ -1602,6 +2048,72 @@ void KX_Scene::LogicEndFrame()
 
 
 
+/// Minimum number of scheduled nodes to update the scene graph in parallel.
+static const unsigned int sceneGraphParallelThreshold = 256;
+/// Number of sub trees updated per task.
+static const int sceneGraphTaskChunkSize = 32;
+
+static void update_scenegraph_thread_func(TaskPool *pool, void *UNUSED(taskdata), int start, int stop, int UNUSED(threadid))
+{
+	KX_Scene::SceneGraphPoolData *data = (KX_Scene::SceneGraphPoolData *)BLI_task_pool_userdata(pool);
+
+	for (int i = start; i < stop; ++i) {
+		data->nodes[i]->UpdateWorldDataThreadSchedule(data->curtime);
+	}
+}
+
+bool KX_Scene::UpdateParentsParallel(double curtime)
+{
+	/* The pool is owned by the main thread, the scene graph of a scene proceeded
+	 * in a task (see KX_KetsjiEngine::PARALLEL_SCENES) is updated serially. */
+	if (!BLI_thread_is_main() || BLI_task_scheduler_num_threads(KX_GetActiveEngine()->GetTaskScheduler()) < 2) {
+		return false;
+	}
+
+	SG_DList::iterator<SG_Node> it(m_sghead);
+
+	unsigned int numScheduled = 0;
+	for (it.begin(); !it.end() && numScheduled < sceneGraphParallelThreshold; ++it) {
+		++numScheduled;
+	}
+
+	if (numScheduled < sceneGraphParallelThreshold) {
+		return false;
+	}
+
+	/* A scheduled node with a scheduled ancestor is updated by the recursion
+	 * of its ancestor, only the roots of the scheduled sub trees are kept.
+	 * This way the sub trees updated by the tasks are disjoint. */
+	std::vector<SG_Node *>& roots = m_sceneGraphPoolData.nodes;
+	roots.clear();
+	for (it.begin(); !it.end(); ++it) {
+		SG_Node *node = *it;
+		bool ancestorScheduled = false;
+		for (SG_Node *parent = node->GetSGParent(); parent; parent = parent->GetSGParent()) {
+			if (!parent->Empty()) {
+				ancestorScheduled = true;
+				break;
+			}
+		}
+
+		if (!ancestorScheduled) {
+			roots.push_back(node);
+		}
+	}
+
+	// Empty the schedule list, the controllers can schedule again their node during the update.
+	while (SG_Node::GetNextScheduled(m_sghead)) {
+	}
+
+	m_sceneGraphPoolData.curtime = curtime;
+	BLI_task_pool_push_range(m_sceneGraphPool, update_scenegraph_thread_func, nullptr, 0, roots.size(), sceneGraphTaskChunkSize,
+			TASK_PRIORITY_HIGH);
+
+	BLI_task_pool_work_and_wait(m_sceneGraphPool);
+
+	return true;
+}
+
 /**
  * UpdateParents: SceneGraph transformation update.
  */
@@ -1610,9 +2122,11 @@ void KX_Scene::UpdateParents(double curtime)
 	// we use the SG dynamic list
 	SG_Node* node;
 
-	while ((node = SG_Node::GetNextScheduled(m_sghead)) != nullptr)
-	{
-		node->UpdateWorldData(curtime);
+	if (!UpdateParentsParallel(curtime)) {
+		while ((node = SG_Node::GetNextScheduled(m_sghead)) != nullptr)
+		{
+			node->UpdateWorldData(curtime);
+		}
 	}
 
 	// the list must be empty here
@@ -1622,6 +2136,9 @@ void KX_Scene::UpdateParents(double curtime)
 	{
 		node->Schedule(m_sghead);
 	}
+
+	// Compute the OpenGL matrices of all the moved nodes in one pass over the pool.
+	m_transformPool->UpdateWorldMatrices();
 }
 
 
@@ -1680,29 +2197,23 @@ int KX_Scene::GetLodHysteresisValue(void)
 	return m_lodHysteresisValue;
 }
 
+void KX_Scene::ObjectActivityChanged(KX_GameObject *gameobj, bool active, void *scene)
+{
+	if (active) {
+		gameobj->Resume();
+	}
+	else {
+		gameobj->Suspend();
+	}
+}
+
 void KX_Scene::UpdateObjectActivity(void) 
 {
 	if (m_activity_culling) {
-		/* determine the activity criterium and set objects accordingly */
-		MT_Vector3 camloc = GetActiveCamera()->NodeGetWorldPosition(); //GetCameraLocation();
-
-		for (KX_GameObject *ob : *m_objectlist) {
-			if (!ob->GetIgnoreActivityCulling()) {
-				/* Simple test: more than 10 away from the camera, count
-				 * Manhattan distance. */
-				MT_Vector3 obpos = ob->NodeGetWorldPosition();
-				
-				if ((fabsf(camloc[0] - obpos[0]) > m_activity_box_radius) ||
-				    (fabsf(camloc[1] - obpos[1]) > m_activity_box_radius) ||
-				    (fabsf(camloc[2] - obpos[2]) > m_activity_box_radius) )
-				{
-					ob->Suspend();
-				}
-				else {
-					ob->Resume();
-				}
-			}
-		}
+		/* The grid only tests the moved objects and the objects close to the
+		 * activity box boundary, the objects are suspended or resumed on a change of state. */
+		const MT_Vector3 camloc = GetActiveCamera()->NodeGetWorldPosition();
+		m_activityGrid->Update(m_objectlist, camloc, m_activity_box_radius);
 	}
 }
 
@@ -1833,11 +2344,14 @@ static void MergeScene_GameObject(KX_GameObject* gameobj, KX_Scene *to, KX_Scene
 	if (sg) {
 		if (sg->GetSGClientInfo() == from) {
 			sg->SetSGClientInfo(to);
+			sg->SetTransformPool(to->GetTransformPool());
 
 			/* Make sure to grab the children too since they might not be tied to a game object */
 			NodeList children = sg->GetSGChildren();
-			for (int i=0; i<children.size(); i++)
-					children[i]->SetSGClientInfo(to);
+			for (int i=0; i<children.size(); i++) {
+				children[i]->SetSGClientInfo(to);
+				children[i]->SetTransformPool(to->GetTransformPool());
+			}
 		}
 	}
 	/* If the object is a light, update it's scene */
@@ -1871,6 +2385,9 @@ bool KX_Scene::MergeScene(KX_Scene *other)
 		return false;
 	}
 
+	// The parked replicas are not in the object lists and can't be merged.
+	other->FreeParkedObjects(nullptr);
+
 	GetBucketManager()->MergeBucketManager(other->GetBucketManager(), this);
 	GetBoundingBoxManager()->Merge(other->GetBoundingBoxManager());
 	GetTextureRendererManager()->Merge(other->GetTextureRendererManager());
@@ -1912,6 +2429,13 @@ bool KX_Scene::MergeScene(KX_Scene *other)
 
 	GetObjectList()->MergeList(other->GetObjectList());
 	other->GetObjectList()->ReleaseAndRemoveAll();
+	m_cullingTree->Invalidate();
+	m_visibleNodes.insert(m_visibleNodes.end(), other->m_visibleNodes.begin(), other->m_visibleNodes.end());
+	other->m_visibleNodes.clear();
+	m_deformedObjectsInvalid = true;
+	m_activityGrid->Invalidate();
+	m_expiryScheduler->Merge(other->GetExpiryScheduler());
+	m_replicaPool->Merge(other->GetReplicaPool());
 
 	GetInactiveList()->MergeList(other->GetInactiveList());
 	other->GetInactiveList()->ReleaseAndRemoveAll();
@@ -1994,6 +2518,17 @@ void KX_Scene::RunDrawingCallbacks(DrawingCallbackType callbackType, KX_Camera *
 	}
 }
 
+bool KX_Scene::HasDrawingCallbacks() const
+{
+	for (PyObject *list : m_drawCallbacks) {
+		if (list && PyList_GET_SIZE(list) > 0) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
 //----------------------------------------------------------------------------
 //Python
 
@@ -2030,6 +2565,7 @@ PyMethodDef KX_Scene::Methods[] = {
 	KX_PYMETHODTABLE(KX_Scene, suspend),
 	KX_PYMETHODTABLE(KX_Scene, resume),
 	KX_PYMETHODTABLE(KX_Scene, drawObstacleSimulation),
+	KX_PYMETHODTABLE(KX_Scene, rayCastBatch),
 
 	
 	/* dict style access */
@@ -2329,19 +2865,23 @@ PyAttributeDef KX_Scene::Attributes[] = {
 	KX_PYATTRIBUTE_BOOL_RO("activity_culling",		KX_Scene, m_activity_culling),
 	KX_PYATTRIBUTE_FLOAT_RW("activity_culling_radius", 0.5f, FLT_MAX, KX_Scene, m_activity_box_radius),
 	KX_PYATTRIBUTE_BOOL_RO("dbvt_culling",			KX_Scene, m_dbvt_culling),
+	KX_PYATTRIBUTE_FLOAT_RW("animationLodDistance", 0.0f, FLT_MAX, KX_Scene, m_animationLodDistance),
+	KX_PYATTRIBUTE_SHORT_RW("animationLodMaxInterval", 1, 100, true, KX_Scene, m_animationLodMaxInterval),
+	KX_PYATTRIBUTE_BOOL_RW("animationLodInterpolation", KX_Scene, m_animationLodInterpolation),
 	KX_PYATTRIBUTE_NULL	//Sentinel
 };
 
 KX_PYMETHODDEF_DOC(KX_Scene, addObject,
-"addObject(object, other, time=0)\n"
+"addObject(object, other, time=0, pool=False)\n"
 "Returns the added object.\n")
 {
 	PyObject *pyob, *pyreference = Py_None;
 	KX_GameObject *ob, *reference;
 
 	float time = 0.0f;
+	int pool = 0;
 
-	if (!PyArg_ParseTuple(args, "O|Of:addObject", &pyob, &pyreference, &time))
+	if (!PyArg_ParseTuple(args, "O|Ofp:addObject", &pyob, &pyreference, &time, &pool))
 		return nullptr;
 
 	if (!ConvertPythonToGameObject(m_logicmgr, pyob, &ob, false, "scene.addObject(object, reference, time): KX_Scene (first argument)") ||
@@ -2352,7 +2892,7 @@ KX_PYMETHODDEF_DOC(KX_Scene, addObject,
 		PyErr_Format(PyExc_ValueError, "scene.addObject(object, reference, time): KX_Scene (first argument): object must be in an inactive layer");
 		return nullptr;
 	}
-	KX_GameObject *replica = AddReplicaObject(ob, reference, time);
+	KX_GameObject *replica = AddReplicaObject(ob, reference, time, pool);
 	
 	// release here because AddReplicaObject AddRef's
 	// the object is added to the scene so we don't want python to own a reference
@@ -2423,6 +2963,113 @@ KX_PYMETHODDEF_DOC(KX_Scene, drawObstacleSimulation,
 	Py_RETURN_NONE;
 }
 
+/// Convert a sequence of vectors to an array of points.
+static bool convertPythonToPoints(PyObject *value, std::vector<float>& points, const char *error_prefix)
+{
+	PyObject *fast = PySequence_Fast(value, error_prefix);
+	if (!fast) {
+		return false;
+	}
+
+	const Py_ssize_t size = PySequence_Fast_GET_SIZE(fast);
+	points.resize(size * 3);
+	for (Py_ssize_t i = 0; i < size; ++i) {
+		MT_Vector3 point;
+		if (!PyVecTo(PySequence_Fast_GET_ITEM(fast, i), point)) {
+			Py_DECREF(fast);
+			return false;
+		}
+		points[i * 3] = point[0];
+		points[i * 3 + 1] = point[1];
+		points[i * 3 + 2] = point[2];
+	}
+
+	Py_DECREF(fast);
+	return true;
+}
+
+KX_PYMETHODDEF_DOC(KX_Scene, rayCastBatch,
+				   "rayCastBatch(froms, tos, mask)\n"
+				   "Cast several rays at once and return a list of 3-tuples (object, hit, normal) of the closest hit of each ray.\n"
+				   " froms = a list of start points or a single start point shared by all the rays\n"
+				   " tos = a list of end points\n"
+				   " mask = collision mask: the collision mask that the rays can hit, 0 < mask < 65536\n")
+{
+	PyObject *pyfroms;
+	PyObject *pytos;
+	int mask = (1 << OB_MAX_COL_MASKS) - 1;
+
+	if (!PyArg_ParseTuple(args, "OO|i:rayCastBatch", &pyfroms, &pytos, &mask)) {
+		return nullptr;
+	}
+
+	if (mask == 0 || mask & ~((1 << OB_MAX_COL_MASKS) - 1)) {
+		PyErr_Format(PyExc_TypeError, "scene.rayCastBatch(froms, tos, mask): KX_Scene, mask argument must be a int bitfield, 0 < mask < %i", (1 << OB_MAX_COL_MASKS));
+		return nullptr;
+	}
+
+	std::vector<float> tos;
+	if (!convertPythonToPoints(pytos, tos, "scene.rayCastBatch(froms, tos, mask): KX_Scene, tos must be a sequence of vectors")) {
+		return nullptr;
+	}
+	const unsigned int numRays = tos.size() / 3;
+
+	std::vector<float> froms;
+	MT_Vector3 sharedFrom;
+	if (PyVecTo(pyfroms, sharedFrom)) {
+		froms.resize(tos.size());
+		for (unsigned int i = 0; i < numRays; ++i) {
+			froms[i * 3] = sharedFrom[0];
+			froms[i * 3 + 1] = sharedFrom[1];
+			froms[i * 3 + 2] = sharedFrom[2];
+		}
+	}
+	else {
+		PyErr_Clear();
+		if (!convertPythonToPoints(pyfroms, froms, "scene.rayCastBatch(froms, tos, mask): KX_Scene, froms must be a vector or a sequence of vectors")) {
+			return nullptr;
+		}
+		if (froms.size() != tos.size()) {
+			PyErr_SetString(PyExc_ValueError, "scene.rayCastBatch(froms, tos, mask): KX_Scene, froms and tos must have the same length");
+			return nullptr;
+		}
+	}
+
+	std::vector<PHY_RayCastBatchResult> results(numRays);
+	if (m_physicsEnvironment && numRays > 0) {
+		m_physicsEnvironment->RayTestBatch(froms.data(), tos.data(), numRays, mask, results.data());
+	}
+	else {
+		for (PHY_RayCastBatchResult& result : results) {
+			result.m_controller = nullptr;
+		}
+	}
+
+	PyObject *list = PyList_New(numRays);
+	for (unsigned int i = 0; i < numRays; ++i) {
+		const PHY_RayCastBatchResult& result = results[i];
+		PyObject *item = PyTuple_New(3);
+
+		KX_GameObject *gameobj = (result.m_controller) ?
+			KX_GameObject::GetClientObject((KX_ClientObjectInfo *)result.m_controller->GetNewClientInfo()) : nullptr;
+		if (gameobj) {
+			PyTuple_SET_ITEM(item, 0, gameobj->GetProxy());
+			PyTuple_SET_ITEM(item, 1, PyObjectFrom(MT_Vector3(result.m_hitPoint)));
+			PyTuple_SET_ITEM(item, 2, PyObjectFrom(MT_Vector3(result.m_hitNormal)));
+		}
+		else {
+			for (unsigned short j = 0; j < 3; ++j) {
+				Py_INCREF(Py_None);
+				PyTuple_SET_ITEM(item, j, Py_None);
+			}
+		}
+
+		PyList_SET_ITEM(list, i, item);
+	}
+
+	return list;
+}
+
 /* Matches python dict.get(key, [default]) */
 KX_PYMETHODDEF_DOC(KX_Scene, get, "")
 {
@@ -36,6 +36,7 @@
 #include "KX_PhysicsEngineEnums.h"
 #include "KX_TextureRendererManager.h" // For KX_TextureRendererManager::RendererCategory.
 #include "KX_CullingNode.h" // For KX_CullingNodeList.
+#include "KX_TimeCategoryLogger.h"
 
 #include <vector>
 #include <set>
@@ -71,12 +72,16 @@ class SCA_IInputDevice;
 class KX_NetworkMessageScene;
 class KX_NetworkMessageManager;
 class SG_Node;
-class SG_Node;
+class SG_TransformPool;
 class KX_WorldInfo;
 class KX_Camera;
 class KX_FontObject;
 class KX_GameObject;
 class KX_LightObject;
+class KX_CullingTree;
+class KX_ActivityGrid;
+class KX_ReplicaPool;
+class KX_ExpiryScheduler;
 class RAS_MeshObject;
 class RAS_BoundingBoxManager;
 class RAS_BucketManager;
@@ -114,6 +119,21 @@ public:
 	struct AnimationPoolData
 	{
 		double curtime;
+		/// Number of distinct animation times, used to spread the throttled armature updates.
+		unsigned int frame;
+		/// Position of the active camera used by the animation level of detail.
+		MT_Vector3 cameraPosition;
+		float lodFactor;
+		float lodDistance;
+		short lodMaxInterval;
+		bool lodInterpolation;
+	};
+
+	struct SceneGraphPoolData
+	{
+		double curtime;
+		/// Roots of the disjoint sub trees to update.
+		std::vector<SG_Node *> nodes;
 	};
 
 private:
@@ -142,7 +162,29 @@ protected:
 	/// Manager used to update all the mesh bounding box.
 	RAS_BoundingBoxManager *m_boundingBoxManager;
 
-	std::vector<KX_GameObject *> m_tempObjectList;
+	/// Storage of the transforms of all the scene graph nodes of the scene.
+	SG_TransformPool *m_transformPool;
+
+	/// Tree of the object culling nodes used when the physics culling is not available.
+	KX_CullingTree *m_cullingTree;
+	/** Culling nodes found visible by the last culling, only these nodes can be not culled.
+	 * The next culling resets the culled flag of these nodes instead of all the objects.
+	 */
+	KX_CullingNodeList m_visibleNodes;
+
+	/// Objects using a deformer, their buckets and bounds are updated before the culling.
+	std::vector<KX_GameObject *> m_deformedObjects;
+	/// True when m_deformedObjects must be rebuilt from the object list.
+	bool m_deformedObjectsInvalid;
+
+	/// Removal scheduler of the objects added with a life time.
+	KX_ExpiryScheduler *m_expiryScheduler;
+
+	/// Grid of the objects used for the activity culling.
+	KX_ActivityGrid *m_activityGrid;
+
+	/// Pools of the parked replicas reused by AddReplicaObject.
+	KX_ReplicaPool *m_replicaPool;
 
 	/**
 	 * The list of objects which have been removed during the
@@ -296,6 +338,12 @@ protected:
 	 * Visibility testing functions.
 	 */
 	static void PhysicsCullingCallback(KX_ClientObjectInfo* objectInfo, void* cullingInfo);
+	/// Register an object added in the object list in the culling data.
+	void AddCullingObject(KX_GameObject *gameobj);
+	/// Unregister an object removed from the object list from the culling data.
+	void RemoveCullingObject(KX_GameObject *gameobj);
+	/// Update the deformers and the bounds of the objects whose bounds can have changed.
+	void UpdateObjectBounds();
 
 	struct Scene* m_blenderScene;
 
@@ -306,12 +354,31 @@ protected:
 	AnimationPoolData m_animationPoolData;
 	TaskPool *m_animationPool;
 
+	SceneGraphPoolData m_sceneGraphPoolData;
+	TaskPool *m_sceneGraphPool;
+
+	/// Time logger of the logic, physics and scene graph of this scene only.
+	KX_TimeCategoryLogger m_timeLogger;
+
 	/**
 	 * LOD Hysteresis settings
 	 */
 	bool m_isActivedHysteresis;
 	int m_lodHysteresisValue;
 
+	/**
+	 * Animation LOD settings, the visible armatures are updated every N frames
+	 * with N increasing with the camera distance and the level of their meshes.
+	 */
+	/// Distance between two update intervals, zero to use only the mesh levels.
+	float m_animationLodDistance;
+	/// Maximum update interval in frames, 1 disables the animation level of detail.
+	short m_animationLodMaxInterval;
+	/// Interpolate the poses of the skipped frames instead of keeping the last pose.
+	bool m_animationLodInterpolation;
+	/// Offset given to the next armature added in the animated objects.
+	unsigned int m_animationLodOffset;
+
 public:
 	KX_Scene(SCA_IInputDevice *inputDevice,
 		const std::string& scenename,
@@ -325,6 +392,11 @@ public:
 	RAS_BucketManager* GetBucketManager() const;
 	KX_TextureRendererManager *GetTextureRendererManager() const;
 	RAS_BoundingBoxManager *GetBoundingBoxManager() const;
+	SG_TransformPool *GetTransformPool() const;
+	KX_CullingTree *GetCullingTree() const;
+	KX_ExpiryScheduler *GetExpiryScheduler() const;
+	KX_ActivityGrid *GetActivityGrid() const;
+	KX_ReplicaPool *GetReplicaPool() const;
 	RAS_MaterialBucket*	FindBucket(RAS_IPolyMaterial* polymat, bool &bucketCreated);
 	void RenderBuckets(const KX_CullingNodeList& nodes, const MT_Transform& cameratransform, RAS_Rasterizer *rasty, RAS_OffScreen *offScreen);
 	void RenderTextureRenderers(KX_TextureRendererManager::RendererCategory category, RAS_Rasterizer *rasty, RAS_OffScreen *offScreen,
@@ -336,6 +408,10 @@ public:
 	static bool KX_ScenegraphUpdateFunc(SG_Node* node,void* gameobj,void* scene);
 	static bool KX_ScenegraphRescheduleFunc(SG_Node* node,void* gameobj,void* scene);
 	void UpdateParents(double curtime);
+	/** Update the scheduled nodes in parallel if there's enough of them.
+	 * \return False if nothing was updated and the serial update must be used.
+	 */
+	bool UpdateParentsParallel(double curtime);
 	void DupliGroupRecurse(KX_GameObject *groupobj, int level);
 	bool IsObjectInGroup(KX_GameObject* gameobj)
 	{ 
@@ -343,8 +419,26 @@ public:
 				m_groupGameObjects.find(gameobj) != m_groupGameObjects.end());
 	}
 	void AddObjectDebugProperties(KX_GameObject *gameobj);
-	KX_GameObject* AddReplicaObject(KX_GameObject *gameobj, KX_GameObject *locationobj, float lifespan=0.0f);
+	/** Add a replica of an object and its children.
+	 * \param usePool Recycle a parked replica of the object if possible and park the replica
+	 * when it is removed instead of freeing it.
+	 */
+	KX_GameObject* AddReplicaObject(KX_GameObject *gameobj, KX_GameObject *locationobj, float lifespan=0.0f, bool usePool=false);
 	KX_GameObject* AddNodeReplicaObject(SG_Node* node, KX_GameObject *gameobj);
+	/// Copy the transform of the reference object to a new replica.
+	void SetReplicaTransform(KX_GameObject *replica, KX_GameObject *referenceobj);
+	/// Return true if the replicas of an object can be parked in the replica pool.
+	bool IsReplicaPoolable(KX_GameObject *gameobj) const;
+	/// Reinitialize and add in the scene a parked replica.
+	void RecycleReplicaObject(KX_GameObject *replica, KX_GameObject *originalobj, KX_GameObject *referenceobj, float lifespan);
+	/** Remove a pooled replica from the scene without freeing it.
+	 * \return False if the object is not parked and must be freed.
+	 */
+	bool ParkReplicaObject(KX_GameObject *gameobj);
+	/** Free the parked replicas.
+	 * \param originalobj The original object of the replicas to free, nullptr for all the replicas.
+	 */
+	void FreeParkedObjects(KX_GameObject *originalobj);
 	void RemoveNodeDestructObject(SG_Node *node, KX_GameObject *gameobj);
 	void RemoveObject(KX_GameObject *gameobj);
 	void RemoveDupliGroup(KX_GameObject *gameobj);
@@ -497,6 +591,9 @@ public:
 	void SetLodHysteresisValue(int hysteresisvalue);
 	int GetLodHysteresisValue();
 	
+	/// Suspend or resume an object on a change of its activity state.
+	static void ObjectActivityChanged(KX_GameObject *gameobj, bool active, void *scene);
+
 	// Update the activity box settings for objects in this scene, if needed.
 	void UpdateObjectActivity(void);
 
@@ -534,6 +631,8 @@ public:
 
 	KX_ObstacleSimulation* GetObstacleSimulation() { return m_obstacleSimulation; }
 
+	KX_TimeCategoryLogger& GetTimeLogger() { return m_timeLogger; }
+
 	/**  Inherited from CValue -- returns the name of this object. */
 	virtual std::string GetName();
 
@@ -553,6 +652,7 @@ public:
 	KX_PYMETHOD_DOC(KX_Scene, resume);
 	KX_PYMETHOD_DOC(KX_Scene, get);
 	KX_PYMETHOD_DOC(KX_Scene, drawObstacleSimulation);
+	KX_PYMETHOD_DOC(KX_Scene, rayCastBatch);
 
 
 	/* attributes */
@@ -583,6 +683,8 @@ public:
 	 * Run the registered python drawing functions.
 	 */
 	void RunDrawingCallbacks(DrawingCallbackType callbackType, KX_Camera *camera);
+	/// Return true if the scene has python drawing callbacks.
+	bool HasDrawingCallbacks() const;
 #endif
 
 	/**
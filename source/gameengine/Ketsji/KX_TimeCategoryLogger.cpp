@@ -55,12 +55,18 @@ unsigned int KX_TimeCategoryLogger::GetMaxNumMeasurements() const
 	return m_maxNumMeasurements;
 }
 
-void KX_TimeCategoryLogger::AddCategory(TimeCategory tc)
+void KX_TimeCategoryLogger::SetProfileTrack(const std::string& name)
+{
+	m_profilePhase.SetTrack(name);
+}
+
+void KX_TimeCategoryLogger::AddCategory(TimeCategory tc, const std::string& profileName)
 {
 	// Only add if not already present
 	if (m_loggers.find(tc) == m_loggers.end()) {
 		m_loggers.emplace(TimeLoggerMap::value_type(tc, KX_TimeLogger(m_maxNumMeasurements)));
 	}
+	m_profileNames[tc] = profileName;
 }
 
 void KX_TimeCategoryLogger::StartLog(TimeCategory tc, double now)
@@ -70,17 +76,27 @@ void KX_TimeCategoryLogger::StartLog(TimeCategory tc, double now)
 	}
 	m_loggers[tc].StartLog(now);
 	m_lastCategory = tc;
+
+	if (CM_Profiler::IsEnabled()) {
+		m_profilePhase.Begin(m_profileNames[tc]);
+	}
 }
 
 void KX_TimeCategoryLogger::EndLog(TimeCategory tc, double now)
 {
 	m_loggers[tc].EndLog(now);
+
+	if (tc == m_lastCategory) {
+		m_profilePhase.End();
+	}
 }
 
 void KX_TimeCategoryLogger::EndLog(double now)
 {
 	m_loggers[m_lastCategory].EndLog(now);
 	m_lastCategory = -1;
+
+	m_profilePhase.End();
 }
 
 void KX_TimeCategoryLogger::NextMeasurement(double now)
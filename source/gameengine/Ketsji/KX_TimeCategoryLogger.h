@@ -39,6 +39,7 @@
 #include <map>
 
 #include "KX_TimeLogger.h"
+#include "CM_Profiler.h"
 
 /**
  * Stores and manages time measurements by category.
@@ -73,11 +74,17 @@ public:
 	 */
 	unsigned int GetMaxNumMeasurements() const;
 
+	/**
+	 * Changes the track name of the phases recorded by the profiler.
+	 */
+	void SetProfileTrack(const std::string& name);
+
 	/**
 	 * Adds a category.
 	 * \param category	The new category.
+	 * \param profileName	The name of the category phases recorded by the profiler.
 	 */
-	void AddCategory(TimeCategory tc);
+	void AddCategory(TimeCategory tc, const std::string& profileName);
 
 	/**
 	 * Starts logging in current measurement for the given category.
@@ -123,6 +130,11 @@ protected:
 	unsigned int m_maxNumMeasurements;
 
 	TimeCategory m_lastCategory;
+
+	/// Names of the categories for the profiler.
+	std::map<TimeCategory, std::string> m_profileNames;
+	/// Profiler phase of the last category.
+	CM_ProfilerPhase m_profilePhase;
 };
 
 #endif  /* __KX_TIMECATEGORYLOGGER_H__ */
@@ -0,0 +1,545 @@
+/** \file gameengine/Physics/Bullet/CcdDynamicsWorld.cpp
+ *  \ingroup physbullet
+ */
+/*
+   Bullet Continuous Collision Detection and Physics Library
+   Copyright (c) 2003-2006 Erwin Coumans  http://continuousphysics.com/Bullet/
+
+   This software is provided 'as-is', without any express or implied warranty.
+   In no event will the authors be held liable for any damages arising from the use of this software.
+   Permission is granted to anyone to use this software for any purpose,
+   including commercial applications, and to alter it and redistribute it freely,
+   subject to the following restrictions:
+
+   1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+   2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+   3. This notice may not be removed or altered from any source distribution.
+ */
+
+#include "CcdDynamicsWorld.h"
+
+#include "BulletCollision/CollisionDispatch/btSimulationIslandManager.h"
+#include "BulletCollision/CollisionDispatch/btConvexConvexAlgorithm.h"
+#include "LinearMath/btPoolAllocator.h"
+#include "BulletDynamics/ConstraintSolver/btSequentialImpulseConstraintSolver.h"
+
+#include "BLI_task.h"
+#include "BLI_utildefines.h"
+
+#include <algorithm>
+
+/// Minimum number of overlapping pairs to process them in parallel.
+static const int parallelPairsThreshold = 128;
+/// Minimum number of pairs per task.
+static const int dispatchTaskMinChunkSize = 32;
+
+/// Pair processed by the current thread during a parallel dispatch.
+static thread_local int dispatchPair = -1;
+/// Number of manifolds created or released by the current pair.
+static thread_local int dispatchSequence = 0;
+
+/** Return the number of items per task.
+ * \param numThreads The maximum number of tasks, 0 to use a few tasks per scheduler thread.
+ */
+static int taskChunkSize(TaskScheduler *scheduler, int numThreads, int size, int minChunkSize)
+{
+	const int numTasks = (numThreads > 0) ? numThreads : BLI_task_scheduler_num_threads(scheduler) * 4;
+	return std::max(minChunkSize, (size + numTasks - 1) / numTasks);
+}
+
+/** Convex algorithm owning its simplex solver, the solver of the collision configuration
+ * is shared by all the pairs and can't be used by concurrent pairs.
+ * The GJK resets the solver for every query, the collision is then the same than with
+ * the shared solver.
+ */
+class CcdConvexConvexAlgorithm : public btConvexConvexAlgorithm
+{
+private:
+	btVoronoiSimplexSolver m_ownSimplexSolver;
+
+public:
+	/// Create function using the settings of the create function of the collision configuration.
+	struct CreateFunc : public btCollisionAlgorithmCreateFunc
+	{
+		const btConvexConvexAlgorithm::CreateFunc *m_configCreateFunc;
+
+		CreateFunc(const btConvexConvexAlgorithm::CreateFunc *configCreateFunc)
+			:m_configCreateFunc(configCreateFunc)
+		{
+		}
+
+		virtual btCollisionAlgorithm *CreateCollisionAlgorithm(btCollisionAlgorithmConstructionInfo& ci,
+				const btCollisionObjectWrapper *body0Wrap, const btCollisionObjectWrapper *body1Wrap)
+		{
+			void *mem = ci.m_dispatcher1->allocateCollisionAlgorithm(sizeof(CcdConvexConvexAlgorithm));
+			return new(mem) CcdConvexConvexAlgorithm(ci.m_manifold, ci, body0Wrap, body1Wrap, m_configCreateFunc->m_pdSolver,
+					m_configCreateFunc->m_numPerturbationIterations, m_configCreateFunc->m_minimumPointsPerturbationThreshold);
+		}
+	};
+
+	// The base class only stores the address of the solver.
+	CcdConvexConvexAlgorithm(btPersistentManifold *mf, const btCollisionAlgorithmConstructionInfo& ci,
+			const btCollisionObjectWrapper *body0Wrap, const btCollisionObjectWrapper *body1Wrap,
+			btConvexPenetrationDepthSolver *pdSolver, int numPerturbationIterations, int minimumPointsPerturbationThreshold)
+		:btConvexConvexAlgorithm(mf, ci, body0Wrap, body1Wrap, &m_ownSimplexSolver, pdSolver,
+				numPerturbationIterations, minimumPointsPerturbationThreshold)
+	{
+	}
+};
+
+bool CcdCollisionDispatcher::ManifoldRecord::operator<(const ManifoldRecord& other) const
+{
+	return (m_pair < other.m_pair) || (m_pair == other.m_pair && m_sequence < other.m_sequence);
+}
+
+CcdCollisionDispatcher::CcdCollisionDispatcher(btCollisionConfiguration *collisionConfiguration)
+	:btCollisionDispatcher(collisionConfiguration),
+	m_scheduler(nullptr),
+	m_numThreads(0),
+	m_convexConvexCreateFunc(nullptr),
+	m_parallelDispatch(false)
+{
+	// Replace the convex algorithm for all the shape types using it, see btDefaultCollisionConfiguration.
+	btCollisionAlgorithmCreateFunc *configCreateFunc = collisionConfiguration->getCollisionAlgorithmCreateFunc(
+			CONVEX_HULL_SHAPE_PROXYTYPE, CONVEX_HULL_SHAPE_PROXYTYPE);
+	m_convexConvexCreateFunc = new CcdConvexConvexAlgorithm::CreateFunc(
+			static_cast<btConvexConvexAlgorithm::CreateFunc *>(configCreateFunc));
+
+	for (int i = 0; i < MAX_BROADPHASE_COLLISION_TYPES; ++i) {
+		for (int j = 0; j < MAX_BROADPHASE_COLLISION_TYPES; ++j) {
+			if (m_doubleDispatch[i][j] == configCreateFunc) {
+				registerCollisionCreateFunc(i, j, m_convexConvexCreateFunc);
+			}
+		}
+	}
+}
+
+CcdCollisionDispatcher::~CcdCollisionDispatcher()
+{
+	delete m_convexConvexCreateFunc;
+}
+
+int CcdCollisionDispatcher::GetCollisionAlgorithmMaxSize()
+{
+	return sizeof(CcdConvexConvexAlgorithm);
+}
+
+void CcdCollisionDispatcher::SetTaskScheduler(TaskScheduler *scheduler, int numThreads)
+{
+	m_scheduler = scheduler;
+	m_numThreads = numThreads;
+}
+
+static bool isSerialShape(const btCollisionShape *shape)
+{
+	// GImpact shapes lock their mesh and update their tree during the collision.
+	if (shape->getShapeType() == GIMPACT_SHAPE_PROXYTYPE) {
+		return true;
+	}
+
+	if (shape->isCompound()) {
+		const btCompoundShape *compoundShape = static_cast<const btCompoundShape *>(shape);
+		for (int i = 0, numChildren = compoundShape->getNumChildShapes(); i < numChildren; ++i) {
+			if (isSerialShape(compoundShape->getChildShape(i))) {
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+bool CcdCollisionDispatcher::IsSerialPair(const btBroadphasePair& pair)
+{
+	const btCollisionObject *object0 = (btCollisionObject *)pair.m_pProxy0->m_clientObject;
+	const btCollisionObject *object1 = (btCollisionObject *)pair.m_pProxy1->m_clientObject;
+
+	// Soft bodies store the contacts of all their pairs.
+	if ((object0->getInternalType() | object1->getInternalType()) & btCollisionObject::CO_SOFT_BODY) {
+		return true;
+	}
+
+	return (isSerialShape(object0->getCollisionShape()) || isSerialShape(object1->getCollisionShape()));
+}
+
+CcdCollisionDispatcher::ManifoldRecord CcdCollisionDispatcher::GetRecord(btPersistentManifold *manifold) const
+{
+	return {manifold, dispatchPair, dispatchSequence++};
+}
+
+btPersistentManifold *CcdCollisionDispatcher::getNewManifold(const btCollisionObject *b0, const btCollisionObject *b1)
+{
+	if (!m_parallelDispatch) {
+		return btCollisionDispatcher::getNewManifold(b0, b1);
+	}
+
+	m_lock.Lock();
+	btPersistentManifold *manifold = btCollisionDispatcher::getNewManifold(b0, b1);
+	m_newManifolds.push_back(GetRecord(manifold));
+	m_lock.Unlock();
+
+	return manifold;
+}
+
+void CcdCollisionDispatcher::releaseManifold(btPersistentManifold *manifold)
+{
+	if (!m_parallelDispatch) {
+		btCollisionDispatcher::releaseManifold(manifold);
+		return;
+	}
+
+	// The manifold is freed at the end of the dispatch to not reorder the manifold array.
+	m_lock.Lock();
+	m_releasedManifolds.push_back(GetRecord(manifold));
+	m_lock.Unlock();
+}
+
+void *CcdCollisionDispatcher::allocateCollisionAlgorithm(int size)
+{
+	// The pool of a configuration not sized with GetCollisionAlgorithmMaxSize is too small.
+	if (size > m_collisionAlgorithmPoolAllocator->getElementSize()) {
+		return btAlignedAlloc(size, 16);
+	}
+
+	if (!m_parallelDispatch) {
+		return btCollisionDispatcher::allocateCollisionAlgorithm(size);
+	}
+
+	m_lock.Lock();
+	void *ptr = btCollisionDispatcher::allocateCollisionAlgorithm(size);
+	m_lock.Unlock();
+
+	return ptr;
+}
+
+void CcdCollisionDispatcher::freeCollisionAlgorithm(void *ptr)
+{
+	if (!m_parallelDispatch) {
+		btCollisionDispatcher::freeCollisionAlgorithm(ptr);
+		return;
+	}
+
+	m_lock.Lock();
+	btCollisionDispatcher::freeCollisionAlgorithm(ptr);
+	m_lock.Unlock();
+}
+
+void CcdCollisionDispatcher::DispatchRangeTask(TaskPool *UNUSED(pool), void *taskdata, int start, int stop, int UNUSED(threadid))
+{
+	DispatchData *data = (DispatchData *)taskdata;
+	CcdCollisionDispatcher *dispatcher = data->m_dispatcher;
+	btNearCallback nearCallback = dispatcher->getNearCallback();
+
+	for (int i = start; i < stop; ++i) {
+		btBroadphasePair& pair = data->m_pairs[i];
+		if (IsSerialPair(pair)) {
+			continue;
+		}
+
+		dispatchPair = i;
+		dispatchSequence = 0;
+		nearCallback(pair, *dispatcher, *data->m_dispatchInfo);
+	}
+
+	dispatchPair = -1;
+}
+
+void CcdCollisionDispatcher::FinishParallelDispatch()
+{
+	// The new manifolds were appended in the order the threads created them.
+	const int firstNew = m_manifoldsPtr.size() - m_newManifolds.size();
+	std::sort(m_newManifolds.begin(), m_newManifolds.end());
+	for (unsigned int i = 0, size = m_newManifolds.size(); i < size; ++i) {
+		btPersistentManifold *manifold = m_newManifolds[i].m_manifold;
+		manifold->m_index1a = firstNew + i;
+		m_manifoldsPtr[firstNew + i] = manifold;
+	}
+
+	std::sort(m_releasedManifolds.begin(), m_releasedManifolds.end());
+	for (const ManifoldRecord& record : m_releasedManifolds) {
+		btCollisionDispatcher::releaseManifold(record.m_manifold);
+	}
+
+	m_newManifolds.clear();
+	m_releasedManifolds.clear();
+}
+
+void CcdCollisionDispatcher::dispatchAllCollisionPairs(btOverlappingPairCache *pairCache, const btDispatcherInfo& dispatchInfo, btDispatcher *dispatcher)
+{
+	const int numPairs = pairCache->getNumOverlappingPairs();
+	// The continuous collision writes the hit fraction of the objects.
+	if (!m_scheduler || numPairs == 0 || dispatchInfo.m_dispatchFunc != btDispatcherInfo::DISPATCH_DISCRETE) {
+		btCollisionDispatcher::dispatchAllCollisionPairs(pairCache, dispatchInfo, dispatcher);
+		return;
+	}
+
+	DispatchData data = {this, pairCache->getOverlappingPairArrayPtr(), &dispatchInfo};
+
+	/* The manifolds are recorded even for a serial dispatch to get the same simulation
+	 * for any number of threads. */
+	m_parallelDispatch = true;
+	if (numPairs >= parallelPairsThreshold && BLI_task_scheduler_num_threads(m_scheduler) > 1) {
+		TaskPool *pool = BLI_task_pool_create(m_scheduler, nullptr);
+		BLI_task_pool_push_range(pool, DispatchRangeTask, &data, 0, numPairs,
+				taskChunkSize(m_scheduler, m_numThreads, numPairs, dispatchTaskMinChunkSize), TASK_PRIORITY_HIGH);
+		BLI_task_pool_work_and_wait(pool);
+		BLI_task_pool_free(pool);
+	}
+	else {
+		DispatchRangeTask(nullptr, &data, 0, numPairs, 0);
+	}
+	m_parallelDispatch = false;
+
+	FinishParallelDispatch();
+
+	btNearCallback nearCallback = getNearCallback();
+	for (int i = 0; i < numPairs; ++i) {
+		btBroadphasePair& pair = data.m_pairs[i];
+		if (IsSerialPair(pair)) {
+			nearCallback(pair, *this, dispatchInfo);
+		}
+	}
+}
+
+/// Same as btGetConstraintIslandId of btDiscreteDynamicsWorld.
+static int constraintIslandId(const btTypedConstraint *constraint)
+{
+	const btCollisionObject& object0 = constraint->getRigidBodyA();
+	const btCollisionObject& object1 = constraint->getRigidBodyB();
+	return (object0.getIslandTag() >= 0) ? object0.getIslandTag() : object1.getIslandTag();
+}
+
+class SortConstraintOnIslandPredicate
+{
+public:
+	bool operator()(const btTypedConstraint *lhs, const btTypedConstraint *rhs) const
+	{
+		return constraintIslandId(lhs) < constraintIslandId(rhs);
+	}
+};
+
+/** Group the islands in batches like InplaceSolverIslandCallback of btDiscreteDynamicsWorld,
+ * but store the batches instead of solving them.
+ */
+class CcdDynamicsWorld::IslandBatchCallback : public btSimulationIslandManager::IslandCallback
+{
+private:
+	CcdDynamicsWorld *m_world;
+	const btContactSolverInfo& m_solverInfo;
+	btTypedConstraint **m_constraints;
+	int m_numConstraints;
+	/// The batch being filled.
+	IslandBatch m_batch;
+
+	void AppendIsland(btCollisionObject **bodies, int numBodies, btPersistentManifold **manifolds, int numManifolds,
+			btTypedConstraint **constraints, int numConstraints)
+	{
+		for (int i = 0; i < numBodies; ++i) {
+			m_world->m_batchBodies.push_back(bodies[i]);
+		}
+		for (int i = 0; i < numManifolds; ++i) {
+			m_world->m_batchManifolds.push_back(manifolds[i]);
+		}
+		for (int i = 0; i < numConstraints; ++i) {
+			m_world->m_batchConstraints.push_back(constraints[i]);
+		}
+	}
+
+public:
+	IslandBatchCallback(CcdDynamicsWorld *world, const btContactSolverInfo& solverInfo)
+		:m_world(world),
+		m_solverInfo(solverInfo),
+		m_constraints(world->m_sortedConstraints.size() ? &world->m_sortedConstraints[0] : nullptr),
+		m_numConstraints(world->m_sortedConstraints.size())
+	{
+		m_world->m_batchBodies.resize(0);
+		m_world->m_batchManifolds.resize(0);
+		m_world->m_batchConstraints.resize(0);
+		m_world->m_batches.clear();
+
+		m_batch.m_firstBody = 0;
+		m_batch.m_firstManifold = 0;
+		m_batch.m_firstConstraint = 0;
+	}
+
+	virtual ~IslandBatchCallback()
+	{
+	}
+
+	virtual void processIsland(btCollisionObject **bodies, int numBodies, btPersistentManifold **manifolds, int numManifolds, int islandId)
+	{
+		// The islands are not split, all the constraints are solved at once.
+		if (islandId < 0) {
+			AppendIsland(bodies, numBodies, manifolds, numManifolds, m_constraints, m_numConstraints);
+			FinishBatch();
+			return;
+		}
+
+		// The constraints are sorted by island.
+		btTypedConstraint **end = m_constraints + m_numConstraints;
+		btTypedConstraint **first = std::lower_bound(m_constraints, end, islandId,
+				[](const btTypedConstraint *constraint, int id) { return constraintIslandId(constraint) < id; });
+		btTypedConstraint **last = first;
+		while (last != end && constraintIslandId(*last) == islandId) {
+			++last;
+		}
+
+		AppendIsland(bodies, numBodies, manifolds, numManifolds, first, last - first);
+
+		const int batchSize = (m_world->m_batchManifolds.size() - m_batch.m_firstManifold) +
+		                      (m_world->m_batchConstraints.size() - m_batch.m_firstConstraint);
+		if (m_solverInfo.m_minimumSolverBatchSize <= 1 || batchSize > m_solverInfo.m_minimumSolverBatchSize) {
+			FinishBatch();
+		}
+	}
+
+	void FinishBatch()
+	{
+		m_batch.m_numBodies = m_world->m_batchBodies.size() - m_batch.m_firstBody;
+		m_batch.m_numManifolds = m_world->m_batchManifolds.size() - m_batch.m_firstManifold;
+		m_batch.m_numConstraints = m_world->m_batchConstraints.size() - m_batch.m_firstConstraint;
+
+		if (m_batch.m_numBodies > 0 || m_batch.m_numManifolds > 0 || m_batch.m_numConstraints > 0) {
+			m_batch.m_serial = false;
+			for (int i = 0; i < m_batch.m_numManifolds && !m_batch.m_serial; ++i) {
+				const btPersistentManifold *manifold = m_world->m_batchManifolds[m_batch.m_firstManifold + i];
+				m_batch.m_serial = (manifold->getBody0()->isKinematicObject() || manifold->getBody1()->isKinematicObject());
+			}
+			for (int i = 0; i < m_batch.m_numConstraints && !m_batch.m_serial; ++i) {
+				const btTypedConstraint *constraint = m_world->m_batchConstraints[m_batch.m_firstConstraint + i];
+				m_batch.m_serial = (constraint->getRigidBodyA().isKinematicObject() || constraint->getRigidBodyB().isKinematicObject());
+			}
+
+			m_world->m_batches.push_back(m_batch);
+		}
+
+		m_batch.m_firstBody = m_world->m_batchBodies.size();
+		m_batch.m_firstManifold = m_world->m_batchManifolds.size();
+		m_batch.m_firstConstraint = m_world->m_batchConstraints.size();
+	}
+};
+
+CcdDynamicsWorld::CcdDynamicsWorld(btDispatcher *dispatcher, btBroadphaseInterface *pairCache, btConstraintSolver *constraintSolver,
+		btCollisionConfiguration *collisionConfiguration)
+	:btSoftRigidDynamicsWorld(dispatcher, pairCache, constraintSolver, collisionConfiguration),
+	m_scheduler(nullptr),
+	m_numThreads(0)
+{
+}
+
+CcdDynamicsWorld::~CcdDynamicsWorld()
+{
+	for (btSequentialImpulseConstraintSolver *solver : m_solvers) {
+		delete solver;
+	}
+}
+
+void CcdDynamicsWorld::SetTaskScheduler(TaskScheduler *scheduler, int numThreads)
+{
+	m_scheduler = scheduler;
+	m_numThreads = numThreads;
+}
+
+btSequentialImpulseConstraintSolver *CcdDynamicsWorld::AcquireSolver()
+{
+	m_solversLock.Lock();
+
+	btSequentialImpulseConstraintSolver *solver;
+	if (m_freeSolvers.empty()) {
+		solver = new btSequentialImpulseConstraintSolver();
+		m_solvers.push_back(solver);
+	}
+	else {
+		solver = m_freeSolvers.back();
+		m_freeSolvers.pop_back();
+	}
+
+	m_solversLock.Unlock();
+
+	return solver;
+}
+
+void CcdDynamicsWorld::ReleaseSolver(btSequentialImpulseConstraintSolver *solver)
+{
+	m_solversLock.Lock();
+	m_freeSolvers.push_back(solver);
+	m_solversLock.Unlock();
+}
+
+void CcdDynamicsWorld::SolveBatch(const IslandBatch& batch, btSequentialImpulseConstraintSolver *solver, btContactSolverInfo& solverInfo)
+{
+	// Reset the random order of the solver rows to not depend on the previous batches of the solver.
+	solver->setRandSeed(0);
+	solver->solveGroup(batch.m_numBodies ? &m_batchBodies[batch.m_firstBody] : nullptr, batch.m_numBodies,
+			batch.m_numManifolds ? &m_batchManifolds[batch.m_firstManifold] : nullptr, batch.m_numManifolds,
+			batch.m_numConstraints ? &m_batchConstraints[batch.m_firstConstraint] : nullptr, batch.m_numConstraints,
+			solverInfo, m_debugDrawer, m_dispatcher1);
+}
+
+void CcdDynamicsWorld::SolveRangeTask(TaskPool *UNUSED(pool), void *taskdata, int start, int stop, int UNUSED(threadid))
+{
+	SolveData *data = (SolveData *)taskdata;
+	CcdDynamicsWorld *world = data->m_world;
+
+	btSequentialImpulseConstraintSolver *solver = world->AcquireSolver();
+	for (int i = start; i < stop; ++i) {
+		world->SolveBatch(world->m_batches[world->m_parallelBatches[i]], solver, *data->m_solverInfo);
+	}
+	world->ReleaseSolver(solver);
+}
+
+void CcdDynamicsWorld::solveConstraints(btContactSolverInfo& solverInfo)
+{
+	if (!m_scheduler || m_constraintSolver->getSolverType() != BT_SEQUENTIAL_IMPULSE_SOLVER) {
+		btSoftRigidDynamicsWorld::solveConstraints(solverInfo);
+		return;
+	}
+
+	m_sortedConstraints.resize(m_constraints.size());
+	for (int i = 0, size = m_constraints.size(); i < size; ++i) {
+		m_sortedConstraints[i] = m_constraints[i];
+	}
+	m_sortedConstraints.quickSort(SortConstraintOnIslandPredicate());
+
+	m_constraintSolver->prepareSolve(getNumCollisionObjects(), m_dispatcher1->getNumManifolds());
+
+	IslandBatchCallback callback(this, solverInfo);
+	m_islandManager->buildAndProcessIslands(m_dispatcher1, this, &callback);
+	callback.FinishBatch();
+
+	m_parallelBatches.clear();
+	for (unsigned int i = 0, size = m_batches.size(); i < size; ++i) {
+		if (!m_batches[i].m_serial) {
+			m_parallelBatches.push_back(i);
+		}
+	}
+
+	const int numParallelBatches = m_parallelBatches.size();
+	SolveData data = {this, &solverInfo};
+	if (numParallelBatches > 1 && BLI_task_scheduler_num_threads(m_scheduler) > 1) {
+		TaskPool *pool = BLI_task_pool_create(m_scheduler, nullptr);
+		BLI_task_pool_push_range(pool, SolveRangeTask, &data, 0, numParallelBatches,
+				taskChunkSize(m_scheduler, m_numThreads, numParallelBatches, 1), TASK_PRIORITY_HIGH);
+		BLI_task_pool_work_and_wait(pool);
+		BLI_task_pool_free(pool);
+	}
+	else if (numParallelBatches > 0) {
+		SolveRangeTask(nullptr, &data, 0, numParallelBatches, 0);
+	}
+
+	// The batches sharing kinematic objects are solved one after the other.
+	btSequentialImpulseConstraintSolver *solver = nullptr;
+	for (const IslandBatch& batch : m_batches) {
+		if (batch.m_serial) {
+			if (!solver) {
+				solver = AcquireSolver();
+			}
+			SolveBatch(batch, solver, solverInfo);
+		}
+	}
+	if (solver) {
+		ReleaseSolver(solver);
+	}
+
+	m_constraintSolver->allSolved(solverInfo, m_debugDrawer);
+}
@@ -0,0 +1,173 @@
+/*
+   Bullet Continuous Collision Detection and Physics Library
+   Copyright (c) 2003-2006 Erwin Coumans  http://continuousphysics.com/Bullet/
+
+   This software is provided 'as-is', without any express or implied warranty.
+   In no event will the authors be held liable for any damages arising from the use of this software.
+   Permission is granted to anyone to use this software for any purpose,
+   including commercial applications, and to alter it and redistribute it freely,
+   subject to the following restrictions:
+
+   1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+   2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+   3. This notice may not be removed or altered from any source distribution.
+ */
+
+/** \file CcdDynamicsWorld.h
+ *  \ingroup physbullet
+ */
+
+#ifndef __CCDDYNAMICSWORLD_H__
+#define __CCDDYNAMICSWORLD_H__
+
+#include "btBulletDynamicsCommon.h"
+#include "BulletSoftBody/btSoftRigidDynamicsWorld.h"
+
+#include "CM_Thread.h"
+
+#include <vector>
+
+struct TaskPool;
+struct TaskScheduler;
+class btSequentialImpulseConstraintSolver;
+
+/** \brief Collision dispatcher able to process the overlapping pairs in parallel.
+ *
+ * The manifolds created and released by the collision algorithms of concurrent pairs
+ * are recorded with the index of their pair. The new manifolds are then sorted and
+ * the released manifolds freed in the pair order, this keeps the manifold order and
+ * the simulation independent of the number of threads.
+ * The pairs of soft bodies and of GImpact shapes which modify shared data during the
+ * collision are processed after the others on the calling thread.
+ * The convex pairs use an algorithm owning its simplex solver instead of the solver
+ * shared by the collision configuration.
+ */
+class CcdCollisionDispatcher : public btCollisionDispatcher
+{
+private:
+	/// A manifold created or released during a parallel dispatch.
+	struct ManifoldRecord
+	{
+		btPersistentManifold *m_manifold;
+		int m_pair;
+		int m_sequence;
+
+		bool operator<(const ManifoldRecord& other) const;
+	};
+
+	TaskScheduler *m_scheduler;
+	int m_numThreads;
+
+	/// Create function of the convex algorithms replacing the one of the collision configuration.
+	btCollisionAlgorithmCreateFunc *m_convexConvexCreateFunc;
+
+	/// True while the pairs are processed in parallel.
+	bool m_parallelDispatch;
+	CM_ThreadSpinLock m_lock;
+	std::vector<ManifoldRecord> m_newManifolds;
+	std::vector<ManifoldRecord> m_releasedManifolds;
+
+	struct DispatchData
+	{
+		CcdCollisionDispatcher *m_dispatcher;
+		btBroadphasePair *m_pairs;
+		const btDispatcherInfo *m_dispatchInfo;
+	};
+
+	/// Return true if the pair must be processed on the calling thread.
+	static bool IsSerialPair(const btBroadphasePair& pair);
+	static void DispatchRangeTask(TaskPool *pool, void *taskdata, int start, int stop, int threadid);
+
+	ManifoldRecord GetRecord(btPersistentManifold *manifold) const;
+	/// Sort the new manifolds and free the released ones in the pair order.
+	void FinishParallelDispatch();
+
+public:
+	CcdCollisionDispatcher(btCollisionConfiguration *collisionConfiguration);
+	virtual ~CcdCollisionDispatcher();
+
+	/** Return the size of the largest collision algorithm created by the dispatcher, used as
+	 * custom element size of the collision configuration to allocate all the algorithms in its pool.
+	 */
+	static int GetCollisionAlgorithmMaxSize();
+
+	/** Set the scheduler processing the pairs.
+	 * \param numThreads The maximum number of tasks, 0 to use all the scheduler threads.
+	 */
+	void SetTaskScheduler(TaskScheduler *scheduler, int numThreads);
+
+	virtual btPersistentManifold *getNewManifold(const btCollisionObject *b0, const btCollisionObject *b1);
+	virtual void releaseManifold(btPersistentManifold *manifold);
+	virtual void *allocateCollisionAlgorithm(int size);
+	virtual void freeCollisionAlgorithm(void *ptr);
+
+	virtual void dispatchAllCollisionPairs(btOverlappingPairCache *pairCache, const btDispatcherInfo& dispatchInfo, btDispatcher *dispatcher);
+};
+
+/** \brief Dynamics world solving its simulation islands in parallel.
+ *
+ * The islands are grouped in batches exactly like btDiscreteDynamicsWorld does and
+ * every batch is solved by its own constraint solver. The batches touching a kinematic
+ * object are solved one after the other as the solver writes temporary data in the
+ * kinematic objects shared by several islands.
+ */
+class CcdDynamicsWorld : public btSoftRigidDynamicsWorld
+{
+private:
+	/// A group of islands solved together.
+	struct IslandBatch
+	{
+		int m_firstBody;
+		int m_numBodies;
+		int m_firstManifold;
+		int m_numManifolds;
+		int m_firstConstraint;
+		int m_numConstraints;
+		/// True if the batch touches a kinematic object.
+		bool m_serial;
+	};
+
+	class IslandBatchCallback;
+
+	TaskScheduler *m_scheduler;
+	int m_numThreads;
+
+	btAlignedObjectArray<btCollisionObject *> m_batchBodies;
+	btAlignedObjectArray<btPersistentManifold *> m_batchManifolds;
+	btAlignedObjectArray<btTypedConstraint *> m_batchConstraints;
+	std::vector<IslandBatch> m_batches;
+	/// Indices of the batches solved in parallel.
+	std::vector<int> m_parallelBatches;
+
+	/// Solvers not used by a task.
+	std::vector<btSequentialImpulseConstraintSolver *> m_freeSolvers;
+	std::vector<btSequentialImpulseConstraintSolver *> m_solvers;
+	CM_ThreadSpinLock m_solversLock;
+
+	struct SolveData
+	{
+		CcdDynamicsWorld *m_world;
+		btContactSolverInfo *m_solverInfo;
+	};
+
+	static void SolveRangeTask(TaskPool *pool, void *taskdata, int start, int stop, int threadid);
+
+	btSequentialImpulseConstraintSolver *AcquireSolver();
+	void ReleaseSolver(btSequentialImpulseConstraintSolver *solver);
+	void SolveBatch(const IslandBatch& batch, btSequentialImpulseConstraintSolver *solver, btContactSolverInfo& solverInfo);
+
+protected:
+	virtual void solveConstraints(btContactSolverInfo& solverInfo);
+
+public:
+	CcdDynamicsWorld(btDispatcher *dispatcher, btBroadphaseInterface *pairCache, btConstraintSolver *constraintSolver,
+			btCollisionConfiguration *collisionConfiguration);
+	virtual ~CcdDynamicsWorld();
+
+	/** Set the scheduler solving the islands, nullptr to solve them with the world solver.
+	 * \param numThreads The maximum number of tasks, 0 to use all the scheduler threads.
+	 */
+	void SetTaskScheduler(TaskScheduler *scheduler, int numThreads);
+};
+
+#endif  // __CCDDYNAMICSWORLD_H__
@@ -0,0 +1,614 @@
+/** \file gameengine/Physics/Bullet/CcdOcclusionBuffer.cpp
+ *  \ingroup physbullet
+ */
+/*
+   Bullet Continuous Collision Detection and Physics Library
+   Copyright (c) 2003-2006 Erwin Coumans  http://continuousphysics.com/Bullet/
+
+   This software is provided 'as-is', without any express or implied warranty.
+   In no event will the authors be held liable for any damages arising from the use of this software.
+   Permission is granted to anyone to use this software for any purpose,
+   including commercial applications, and to alter it and redistribute it freely,
+   subject to the following restrictions:
+
+   1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+   2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+   3. This notice may not be removed or altered from any source distribution.
+ */
+
+#include "CcdOcclusionBuffer.h"
+
+#include "LinearMath/btAlignedAllocator.h"
+
+#include "BLI_task.h"
+#include "BLI_utildefines.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
+/// Minimum number of occluder polygons to rasterize them in parallel.
+static const int parallelPolygonsThreshold = 512;
+/// Minimum number of polygons set up per task.
+static const int setupTaskMinChunkSize = 64;
+
+CcdOcclusionBuffer::CcdOcclusionBuffer()
+	:m_buffer(nullptr),
+	m_bufferSize(0),
+	m_occlusion(false),
+	m_chunkSize(1)
+{
+	m_tiles[0] = m_tiles[1] = 0;
+	m_sizes[0] = m_sizes[1] = 0;
+	m_scales[0] = m_scales[1] = 0.0f;
+}
+
+CcdOcclusionBuffer::~CcdOcclusionBuffer()
+{
+	if (m_buffer) {
+		btAlignedFree(m_buffer);
+	}
+}
+
+void CcdOcclusionBuffer::MultMatrix(float m[16], const float m1[16], const float m2[16])
+{
+	for (unsigned short col = 0; col < 4; ++col) {
+		for (unsigned short row = 0; row < 4; ++row) {
+			m[col * 4 + row] = m1[row] * m2[col * 4] + m1[4 + row] * m2[col * 4 + 1] +
+			                   m1[8 + row] * m2[col * 4 + 2] + m1[12 + row] * m2[col * 4 + 3];
+		}
+	}
+}
+
+void CcdOcclusionBuffer::Transform(const float m[16], const float x[3], btVector4& t)
+{
+	t[0] = x[0] * m[0] + x[1] * m[4] + x[2] * m[8] + m[12];
+	t[1] = x[0] * m[1] + x[1] * m[5] + x[2] * m[9] + m[13];
+	t[2] = x[0] * m[2] + x[1] * m[6] + x[2] * m[10] + m[14];
+	t[3] = x[0] * m[3] + x[1] * m[7] + x[2] * m[11] + m[15];
+}
+
+template <int NP>
+int CcdOcclusionBuffer::Clip(const btVector4 *pi, btVector4 *po)
+{
+	btScalar s[2 * NP];
+	btVector4 pn[2 * NP];
+	int i, j, m, n, ni;
+	// deal with near clipping
+	for (i = 0, m = 0; i < NP; ++i) {
+		s[i] = pi[i][2] + pi[i][3];
+		if (s[i] < 0) {
+			m += 1 << i;
+		}
+	}
+	if (m == ((1 << NP) - 1)) {
+		return 0;
+	}
+	if (m != 0) {
+		for (i = NP - 1, j = 0, n = 0; j < NP; i = j++) {
+			const btVector4 &a = pi[i];
+			const btVector4 &b = pi[j];
+			const btScalar t = s[i] / (a[3] + a[2] - b[3] - b[2]);
+			if ((t > 0) && (t < 1)) {
+				pn[n][0] = a[0] + (b[0] - a[0]) * t;
+				pn[n][1] = a[1] + (b[1] - a[1]) * t;
+				pn[n][2] = a[2] + (b[2] - a[2]) * t;
+				pn[n][3] = a[3] + (b[3] - a[3]) * t;
+				++n;
+			}
+			if (s[j] > 0) {
+				pn[n++] = b;
+			}
+		}
+		// ready to test far clipping, start from the modified polygon
+		pi = pn;
+		ni = n;
+	}
+	else {
+		// no clipping on the near plane, keep same vector
+		ni = NP;
+	}
+	// now deal with far clipping
+	for (i = 0, m = 0; i < ni; ++i) {
+		s[i] = pi[i][2] - pi[i][3];
+		if (s[i] > 0) {
+			m += 1 << i;
+		}
+	}
+	if (m == ((1 << ni) - 1)) {
+		return 0;
+	}
+	if (m != 0) {
+		for (i = ni - 1, j = 0, n = 0; j < ni; i = j++) {
+			const btVector4 &a = pi[i];
+			const btVector4 &b = pi[j];
+			const btScalar t = s[i] / (a[2] - a[3] - b[2] + b[3]);
+			if ((t > 0) && (t < 1)) {
+				po[n][0] = a[0] + (b[0] - a[0]) * t;
+				po[n][1] = a[1] + (b[1] - a[1]) * t;
+				po[n][2] = a[2] + (b[2] - a[2]) * t;
+				po[n][3] = a[3] + (b[3] - a[3]) * t;
+				++n;
+			}
+			if (s[j] < 0) {
+				po[n++] = b;
+			}
+		}
+		return n;
+	}
+	for (i = 0; i < ni; ++i) {
+		po[i] = pi[i];
+	}
+	return ni;
+}
+
+void CcdOcclusionBuffer::Setup(int size, const int *viewport, const float modelview[16], const float projection[16])
+{
+	m_occlusion = false;
+	// compute the size of the buffer
+	const int maxsize = std::max(viewport[2], viewport[3]);
+	BLI_assert(maxsize > 0);
+	const double ratio = 1.0 / (2 * maxsize);
+	// ensure even number
+	m_sizes[0] = 2 * ((int)(size * viewport[2] * ratio + 0.5));
+	m_sizes[1] = 2 * ((int)(size * viewport[3] * ratio + 0.5));
+	m_scales[0] = (float)(m_sizes[0] / 2);
+	m_scales[1] = (float)(m_sizes[1] / 2);
+	m_tiles[0] = (m_sizes[0] + TILE_SIZE - 1) / TILE_SIZE;
+	m_tiles[1] = (m_sizes[1] + TILE_SIZE - 1) / TILE_SIZE;
+
+	/* At this time of the rendering, the modelview matrix is the world to camera
+	 * transformation and the projection matrix is camera to clip transformation. */
+	MultMatrix(m_wtc, projection, modelview);
+
+	m_occluders.clear();
+	m_polygons.clear();
+	m_triangles.clear();
+}
+
+void CcdOcclusionBuffer::AddOccluder(const float modelMatrix[16])
+{
+	m_occluders.resize(m_occluders.size() + 16);
+	MultMatrix(&m_occluders[m_occluders.size() - 16], m_wtc, modelMatrix);
+}
+
+void CcdOcclusionBuffer::AddPolygon(const float *v1, const float *v2, const float *v3, const float *v4, float face)
+{
+	Polygon poly;
+	poly.m_vertices[0] = v1;
+	poly.m_vertices[1] = v2;
+	poly.m_vertices[2] = v3;
+	poly.m_vertices[3] = v4;
+	poly.m_numVertices = (v4) ? 4 : 3;
+	poly.m_occluder = m_occluders.size() / 16 - 1;
+	poly.m_face = face;
+
+	m_polygons.push_back(poly);
+}
+
+bool CcdOcclusionBuffer::SetupTriangle(const btVector4& a, const btVector4& b, const btVector4& c, float face, Triangle& tri) const
+{
+	// Device to buffer coordinates.
+	const float ax = a[0] * m_scales[0] + m_scales[0];
+	const float ay = a[1] * m_scales[1] + m_scales[1];
+	float bx = b[0] * m_scales[0] + m_scales[0];
+	float by = b[1] * m_scales[1] + m_scales[1];
+	float bz = b[2];
+	float cx = c[0] * m_scales[0] + m_scales[0];
+	float cy = c[1] * m_scales[1] + m_scales[1];
+	float cz = c[2];
+
+	float area = (bx - ax) * (cy - ay) - (by - ay) * (cx - ax);
+	if ((face * area) < 0.0f || area == 0.0f) {
+		return false;
+	}
+
+	// The edge functions are positive inside of counter clockwise triangles.
+	if (area < 0.0f) {
+		std::swap(bx, cx);
+		std::swap(by, cy);
+		std::swap(bz, cz);
+		area = -area;
+	}
+
+	tri.m_minX = std::max(0, (int)std::ceil(std::min(ax, std::min(bx, cx)) - 0.5f));
+	tri.m_maxX = std::min(m_sizes[0] - 1, (int)std::floor(std::max(ax, std::max(bx, cx)) - 0.5f));
+	tri.m_minY = std::max(0, (int)std::ceil(std::min(ay, std::min(by, cy)) - 0.5f));
+	tri.m_maxY = std::min(m_sizes[1] - 1, (int)std::floor(std::max(ay, std::max(by, cy)) - 0.5f));
+	// No pixel center is covered.
+	if (tri.m_minX > tri.m_maxX || tri.m_minY > tri.m_maxY) {
+		return false;
+	}
+
+	const float dx1 = bx - ax;
+	const float dy1 = by - ay;
+	const float dx2 = cx - ax;
+	const float dy2 = cy - ay;
+	const float dz1 = bz - a[2];
+	const float dz2 = cz - a[2];
+
+	tri.m_x = ax;
+	tri.m_y = ay;
+	tri.m_z = a[2];
+	// Edge ab.
+	tri.m_edgeA[0] = -dy1;
+	tri.m_edgeB[0] = dx1;
+	tri.m_edgeC[0] = 0.0f;
+	// Edge bc, its value at the first vertex.
+	tri.m_edgeA[1] = by - cy;
+	tri.m_edgeB[1] = cx - bx;
+	tri.m_edgeC[1] = (cx - bx) * (ay - by) - (cy - by) * (ax - bx);
+	// Edge ca.
+	tri.m_edgeA[2] = dy2;
+	tri.m_edgeB[2] = -dx2;
+	tri.m_edgeC[2] = 0.0f;
+
+	// The inverse of w is linear in screen space.
+	tri.m_dzdx = (dz1 * dy2 - dz2 * dy1) / area;
+	tri.m_dzdy = (dx1 * dz2 - dx2 * dz1) / area;
+	tri.m_maxZ = std::max(a[2], std::max(bz, cz));
+
+	return true;
+}
+
+void CcdOcclusionBuffer::SetupPolygons(int start, int stop, std::vector<Triangle>& triangles) const
+{
+	for (int i = start; i < stop; ++i) {
+		const Polygon& poly = m_polygons[i];
+		const float *mtc = &m_occluders[poly.m_occluder * 16];
+
+		btVector4 pi[4];
+		btVector4 po[8];
+		for (int j = 0; j < poly.m_numVertices; ++j) {
+			Transform(mtc, poly.m_vertices[j], pi[j]);
+		}
+
+		const int n = (poly.m_numVertices == 4) ? Clip<4>(pi, po) : Clip<3>(pi, po);
+
+		// Convert to device coordinates, z is then the inverse of w.
+		for (int j = 0; j < n; ++j) {
+			po[j][2] = 1.0f / po[j][3];
+			po[j][0] *= po[j][2];
+			po[j][1] *= po[j][2];
+		}
+
+		for (int j = 2; j < n; ++j) {
+			Triangle tri;
+			if (SetupTriangle(po[0], po[j - 1], po[j], poly.m_face, tri)) {
+				triangles.push_back(tri);
+			}
+		}
+	}
+}
+
+void CcdOcclusionBuffer::BinTriangles()
+{
+	const int numBands = (m_tiles[1] + BAND_TILES - 1) / BAND_TILES;
+	const int bandHeight = TILE_SIZE * BAND_TILES;
+
+	m_bins.resize(numBands);
+	for (std::vector<unsigned int>& bin : m_bins) {
+		bin.clear();
+	}
+
+	for (unsigned int i = 0, size = m_triangles.size(); i < size; ++i) {
+		const Triangle& tri = m_triangles[i];
+		for (int band = tri.m_minY / bandHeight, last = tri.m_maxY / bandHeight; band <= last; ++band) {
+			m_bins[band].push_back(i);
+		}
+	}
+}
+
+void CcdOcclusionBuffer::UpdateTileDepth(int tile)
+{
+	const float *pixels = m_buffer + tile * TILE_PIXELS;
+#ifdef __SSE2__
+	__m128 vmin = _mm_load_ps(pixels);
+	__m128 vmax = vmin;
+	for (unsigned short i = 4; i < TILE_PIXELS; i += 4) {
+		const __m128 q = _mm_load_ps(pixels + i);
+		vmin = _mm_min_ps(vmin, q);
+		vmax = _mm_max_ps(vmax, q);
+	}
+	// Reduce the four lanes.
+	vmin = _mm_min_ps(vmin, _mm_shuffle_ps(vmin, vmin, _MM_SHUFFLE(1, 0, 3, 2)));
+	vmin = _mm_min_ps(vmin, _mm_shuffle_ps(vmin, vmin, _MM_SHUFFLE(2, 3, 0, 1)));
+	vmax = _mm_max_ps(vmax, _mm_shuffle_ps(vmax, vmax, _MM_SHUFFLE(1, 0, 3, 2)));
+	vmax = _mm_max_ps(vmax, _mm_shuffle_ps(vmax, vmax, _MM_SHUFFLE(2, 3, 0, 1)));
+	m_tileMin[tile] = _mm_cvtss_f32(vmin);
+	m_tileMax[tile] = _mm_cvtss_f32(vmax);
+#else
+	float zmin = pixels[0];
+	float zmax = pixels[0];
+	for (unsigned short i = 1; i < TILE_PIXELS; ++i) {
+		zmin = std::min(zmin, pixels[i]);
+		zmax = std::max(zmax, pixels[i]);
+	}
+	m_tileMin[tile] = zmin;
+	m_tileMax[tile] = zmax;
+#endif
+}
+
+void CcdOcclusionBuffer::RasterizeTile(const Triangle& tri, int tx, int ty)
+{
+	const int tile = ty * m_tiles[0] + tx;
+	// All the pixels of the tile are already closer than the triangle.
+	if (tri.m_maxZ <= m_tileMin[tile]) {
+		return;
+	}
+
+	// Pixel centers of the first column and row relative to the first vertex.
+	const float x0 = (float)(tx * TILE_SIZE) + 0.5f - tri.m_x;
+	const float y0 = (float)(ty * TILE_SIZE) + 0.5f - tri.m_y;
+
+	// The edge functions are maximal at a corner of the tile, reject the tile if one is negative.
+	for (unsigned short e = 0; e < 3; ++e) {
+		const float ex = (tri.m_edgeA[e] >= 0.0f) ? x0 + (TILE_SIZE - 1) : x0;
+		const float ey = (tri.m_edgeB[e] >= 0.0f) ? y0 + (TILE_SIZE - 1) : y0;
+		if (tri.m_edgeA[e] * ex + tri.m_edgeB[e] * ey + tri.m_edgeC[e] < 0.0f) {
+			return;
+		}
+	}
+
+	const int firstRow = std::max(tri.m_minY - ty * TILE_SIZE, 0);
+	const int lastRow = std::min(tri.m_maxY - ty * TILE_SIZE, TILE_SIZE - 1);
+	float *pixels = m_buffer + tile * TILE_PIXELS;
+
+#ifdef __SSE2__
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 lanes = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+	const __m128 px[2] = {_mm_add_ps(_mm_set1_ps(x0), lanes), _mm_add_ps(_mm_set1_ps(x0 + 4.0f), lanes)};
+	const __m128 dzdx = _mm_set1_ps(tri.m_dzdx);
+
+	// The edge functions and depth of the columns, the row term is added per row.
+	__m128 edgeX[3][2];
+	for (unsigned short e = 0; e < 3; ++e) {
+		const __m128 a = _mm_set1_ps(tri.m_edgeA[e]);
+		edgeX[e][0] = _mm_mul_ps(a, px[0]);
+		edgeX[e][1] = _mm_mul_ps(a, px[1]);
+	}
+	const __m128 depthX[2] = {_mm_mul_ps(dzdx, px[0]), _mm_mul_ps(dzdx, px[1])};
+
+	for (int row = firstRow; row <= lastRow; ++row) {
+		const float dy = y0 + (float)row;
+		const __m128 edgeY[3] = {
+			_mm_set1_ps(tri.m_edgeB[0] * dy + tri.m_edgeC[0]),
+			_mm_set1_ps(tri.m_edgeB[1] * dy + tri.m_edgeC[1]),
+			_mm_set1_ps(tri.m_edgeB[2] * dy + tri.m_edgeC[2])
+		};
+		const __m128 depthY = _mm_set1_ps(tri.m_z + tri.m_dzdy * dy);
+
+		for (unsigned short half = 0; half < 2; ++half) {
+			const __m128 inside = _mm_and_ps(_mm_and_ps(
+				_mm_cmpge_ps(_mm_add_ps(edgeX[0][half], edgeY[0]), zero),
+				_mm_cmpge_ps(_mm_add_ps(edgeX[1][half], edgeY[1]), zero)),
+				_mm_cmpge_ps(_mm_add_ps(edgeX[2][half], edgeY[2]), zero));
+
+			float *scan = pixels + row * TILE_SIZE + half * 4;
+			const __m128 q = _mm_load_ps(scan);
+			const __m128 z = _mm_max_ps(q, _mm_add_ps(depthX[half], depthY));
+			_mm_store_ps(scan, _mm_or_ps(_mm_and_ps(inside, z), _mm_andnot_ps(inside, q)));
+		}
+	}
+#else
+	for (int row = firstRow; row <= lastRow; ++row) {
+		const float dy = y0 + (float)row;
+		float *scan = pixels + row * TILE_SIZE;
+		for (unsigned short col = 0; col < TILE_SIZE; ++col) {
+			const float dx = x0 + (float)col;
+			if ((tri.m_edgeA[0] * dx + tri.m_edgeB[0] * dy + tri.m_edgeC[0]) >= 0.0f &&
+			    (tri.m_edgeA[1] * dx + tri.m_edgeB[1] * dy + tri.m_edgeC[1]) >= 0.0f &&
+			    (tri.m_edgeA[2] * dx + tri.m_edgeB[2] * dy + tri.m_edgeC[2]) >= 0.0f)
+			{
+				scan[col] = std::max(scan[col], tri.m_z + tri.m_dzdx * dx + tri.m_dzdy * dy);
+			}
+		}
+	}
+#endif
+
+	UpdateTileDepth(tile);
+}
+
+void CcdOcclusionBuffer::RasterizeBands(int start, int stop)
+{
+	for (int band = start; band < stop; ++band) {
+		const int firstTileRow = band * BAND_TILES;
+		const int lastTileRow = std::min(firstTileRow + BAND_TILES, m_tiles[1]) - 1;
+
+		for (unsigned int index : m_bins[band]) {
+			const Triangle& tri = m_triangles[index];
+			const int minTileY = std::max(firstTileRow, tri.m_minY / TILE_SIZE);
+			const int maxTileY = std::min(lastTileRow, tri.m_maxY / TILE_SIZE);
+			for (int ty = minTileY; ty <= maxTileY; ++ty) {
+				for (int tx = tri.m_minX / TILE_SIZE, maxTileX = tri.m_maxX / TILE_SIZE; tx <= maxTileX; ++tx) {
+					RasterizeTile(tri, tx, ty);
+				}
+			}
+		}
+	}
+}
+
+void CcdOcclusionBuffer::SetupTask(TaskPool *pool, void *UNUSED(taskdata), int start, int stop, int UNUSED(threadid))
+{
+	CcdOcclusionBuffer *ocb = (CcdOcclusionBuffer *)BLI_task_pool_userdata(pool);
+	// The ranges are split on multiples of the chunk size.
+	ocb->SetupPolygons(start, stop, ocb->m_chunkTriangles[start / ocb->m_chunkSize]);
+}
+
+void CcdOcclusionBuffer::RasterizeTask(TaskPool *pool, void *UNUSED(taskdata), int start, int stop, int UNUSED(threadid))
+{
+	CcdOcclusionBuffer *ocb = (CcdOcclusionBuffer *)BLI_task_pool_userdata(pool);
+	ocb->RasterizeBands(start, stop);
+}
+
+void CcdOcclusionBuffer::Rasterize(TaskScheduler *scheduler)
+{
+	m_triangles.clear();
+
+	const int numPolygons = m_polygons.size();
+	const int numThreads = (scheduler) ? BLI_task_scheduler_num_threads(scheduler) : 1;
+	const bool parallel = (numThreads > 1 && numPolygons >= parallelPolygonsThreshold);
+	TaskPool *pool = (parallel) ? BLI_task_pool_create(scheduler, this) : nullptr;
+
+	if (parallel) {
+		const int numTasks = numThreads * 4;
+		m_chunkSize = std::max(setupTaskMinChunkSize, (numPolygons + numTasks - 1) / numTasks);
+		const int numChunks = (numPolygons + m_chunkSize - 1) / m_chunkSize;
+		if ((int)m_chunkTriangles.size() < numChunks) {
+			m_chunkTriangles.resize(numChunks);
+		}
+
+		BLI_task_pool_push_range(pool, SetupTask, nullptr, 0, numPolygons, m_chunkSize, TASK_PRIORITY_HIGH);
+		BLI_task_pool_work_and_wait(pool);
+
+		// Merge in the polygons order.
+		for (int i = 0; i < numChunks; ++i) {
+			std::vector<Triangle>& triangles = m_chunkTriangles[i];
+			m_triangles.insert(m_triangles.end(), triangles.begin(), triangles.end());
+			triangles.clear();
+		}
+	}
+	else {
+		SetupPolygons(0, numPolygons, m_triangles);
+	}
+
+	m_occlusion = !m_triangles.empty();
+
+	if (m_occlusion) {
+		const int numTiles = m_tiles[0] * m_tiles[1];
+		const size_t size = numTiles * TILE_PIXELS * sizeof(float);
+		if (size > m_bufferSize) {
+			if (m_buffer) {
+				btAlignedFree(m_buffer);
+			}
+			m_buffer = (float *)btAlignedAlloc(size, 16);
+			m_bufferSize = size;
+		}
+		// The buffer is cleared to the infinite depth.
+		memset(m_buffer, 0, size);
+		m_tileMin.assign(numTiles, 0.0f);
+		m_tileMax.assign(numTiles, 0.0f);
+
+		BinTriangles();
+
+		// The bands write disjoint tiles.
+		const int numBands = m_bins.size();
+		if (parallel && numBands > 1) {
+			BLI_task_pool_push_range(pool, RasterizeTask, nullptr, 0, numBands, 1, TASK_PRIORITY_HIGH);
+			BLI_task_pool_work_and_wait(pool);
+		}
+		else {
+			RasterizeBands(0, numBands);
+		}
+	}
+
+	if (pool) {
+		BLI_task_pool_free(pool);
+	}
+}
+
+bool CcdOcclusionBuffer::QueryBox(const btVector3& center, const btVector3& extent) const
+{
+	if (!m_occlusion) {
+		// no occlusion yet, no need to check
+		return true;
+	}
+
+	float minX = FLT_MAX;
+	float minY = FLT_MAX;
+	float maxX = -FLT_MAX;
+	float maxY = -FLT_MAX;
+	// Closest depth of the box.
+	float maxZ = 0.0f;
+	for (unsigned short i = 0; i < 8; ++i) {
+		const float corner[3] = {
+			(float)((i & 1) ? center[0] + extent[0] : center[0] - extent[0]),
+			(float)((i & 2) ? center[1] + extent[1] : center[1] - extent[1]),
+			(float)((i & 4) ? center[2] + extent[2] : center[2] - extent[2])
+		};
+		btVector4 t;
+		Transform(m_wtc, corner, t);
+		// the box is clipped, it's probably a large box, don't waste our time to check
+		if ((t[2] + t[3]) <= 0.0f) {
+			return true;
+		}
+
+		const float iw = 1.0f / t[3];
+		const float x = t[0] * iw * m_scales[0] + m_scales[0];
+		const float y = t[1] * iw * m_scales[1] + m_scales[1];
+		minX = std::min(minX, x);
+		minY = std::min(minY, y);
+		maxX = std::max(maxX, x);
+		maxY = std::max(maxY, y);
+		maxZ = std::max(maxZ, iw);
+	}
+
+	// Pixels touched by the screen rectangle of the box.
+	const int x0 = std::max(0, (int)std::floor(minX));
+	const int y0 = std::max(0, (int)std::floor(minY));
+	const int x1 = std::min(m_sizes[0] - 1, (int)std::floor(maxX));
+	const int y1 = std::min(m_sizes[1] - 1, (int)std::floor(maxY));
+	if (x0 > x1 || y0 > y1) {
+		return false;
+	}
+
+#ifdef __SSE2__
+	const __m128 vmaxZ = _mm_set1_ps(maxZ);
+	const __m128 lanes = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+#endif
+
+	for (int ty = y0 / TILE_SIZE, lastTileY = y1 / TILE_SIZE; ty <= lastTileY; ++ty) {
+		for (int tx = x0 / TILE_SIZE, lastTileX = x1 / TILE_SIZE; tx <= lastTileX; ++tx) {
+			const int tile = ty * m_tiles[0] + tx;
+			// The box is behind all the pixels of the tile.
+			if (maxZ < m_tileMin[tile]) {
+				continue;
+			}
+			// The box is in front of all the pixels of the tile.
+			if (maxZ >= m_tileMax[tile]) {
+				return true;
+			}
+
+			const int firstRow = std::max(y0 - ty * TILE_SIZE, 0);
+			const int lastRow = std::min(y1 - ty * TILE_SIZE, TILE_SIZE - 1);
+			const int firstCol = std::max(x0 - tx * TILE_SIZE, 0);
+			const int lastCol = std::min(x1 - tx * TILE_SIZE, TILE_SIZE - 1);
+			const float *pixels = m_buffer + tile * TILE_PIXELS;
+
+#ifdef __SSE2__
+			__m128 colMask[2];
+			for (unsigned short half = 0; half < 2; ++half) {
+				const __m128 cols = _mm_add_ps(_mm_set1_ps((float)(half * 4)), lanes);
+				colMask[half] = _mm_and_ps(_mm_cmpge_ps(cols, _mm_set1_ps((float)firstCol)),
+				                           _mm_cmple_ps(cols, _mm_set1_ps((float)lastCol)));
+			}
+
+			for (int row = firstRow; row <= lastRow; ++row) {
+				const float *scan = pixels + row * TILE_SIZE;
+				const __m128 visible = _mm_or_ps(
+					_mm_and_ps(colMask[0], _mm_cmple_ps(_mm_load_ps(scan), vmaxZ)),
+					_mm_and_ps(colMask[1], _mm_cmple_ps(_mm_load_ps(scan + 4), vmaxZ)));
+				if (_mm_movemask_ps(visible)) {
+					return true;
+				}
+			}
+#else
+			for (int row = firstRow; row <= lastRow; ++row) {
+				const float *scan = pixels + row * TILE_SIZE;
+				for (int col = firstCol; col <= lastCol; ++col) {
+					if (scan[col] <= maxZ) {
+						return true;
+					}
+				}
+			}
+#endif
+		}
+	}
+
+	return false;
+}
@@ -0,0 +1,161 @@
+/*
+   Bullet Continuous Collision Detection and Physics Library
+   Copyright (c) 2003-2006 Erwin Coumans  http://continuousphysics.com/Bullet/
+
+   This software is provided 'as-is', without any express or implied warranty.
+   In no event will the authors be held liable for any damages arising from the use of this software.
+   Permission is granted to anyone to use this software for any purpose,
+   including commercial applications, and to alter it and redistribute it freely,
+   subject to the following restrictions:
+
+   1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+   2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+   3. This notice may not be removed or altered from any source distribution.
+ */
+
+/** \file CcdOcclusionBuffer.h
+ *  \ingroup physbullet
+ */
+
+#ifndef __CCDOCCLUSIONBUFFER_H__
+#define __CCDOCCLUSIONBUFFER_H__
+
+#include "LinearMath/btVector3.h"
+
+#include <vector>
+
+struct TaskPool;
+struct TaskScheduler;
+
+/** \brief Software depth buffer of the occluders used by the occlusion culling.
+ *
+ * The occluder polygons are collected first, then transformed, clipped and rasterized
+ * in tiles of 8x8 pixels using half-space edge functions, four pixels at once with SSE2.
+ * Every tile keeps the minimum and maximum depth of its pixels, the box queries accept
+ * or reject most of the tiles without reading their pixels.
+ * The triangles are binned per band of tile rows and the bands are rasterized in parallel.
+ *
+ * The stored depth is the inverse of the clip w, a larger value is closer to the camera.
+ * The implementation is based on the CDTestFramework.
+ */
+class CcdOcclusionBuffer
+{
+private:
+	enum {
+		TILE_SIZE = 8,
+		TILE_PIXELS = TILE_SIZE * TILE_SIZE,
+		/// Number of tile rows rasterized by a task.
+		BAND_TILES = 2
+	};
+
+	/// A polygon of an occluder in model coordinates.
+	struct Polygon
+	{
+		const float *m_vertices[4];
+		int m_numVertices;
+		/// Index of the occluder transform.
+		int m_occluder;
+		float m_face;
+	};
+
+	/// A triangle in screen coordinates ready for the rasterization.
+	struct Triangle
+	{
+		/// Position of the first vertex, the edge functions and depth are relative to it.
+		float m_x;
+		float m_y;
+		float m_z;
+		/// Edge functions coefficients, e(x, y) = a * dx + b * dy + c.
+		float m_edgeA[3];
+		float m_edgeB[3];
+		float m_edgeC[3];
+		float m_dzdx;
+		float m_dzdy;
+		/// Closest depth of the triangle.
+		float m_maxZ;
+		/// Inclusive range of the pixels possibly covered.
+		int m_minX;
+		int m_minY;
+		int m_maxX;
+		int m_maxY;
+	};
+
+	/// Depth of the pixels stored tile after tile.
+	float *m_buffer;
+	size_t m_bufferSize;
+	/// Farthest and closest depth of every tile.
+	std::vector<float> m_tileMin;
+	std::vector<float> m_tileMax;
+	int m_tiles[2];
+
+	bool m_occlusion;
+	int m_sizes[2];
+	float m_scales[2];
+	/// World to clip transform.
+	float m_wtc[16];
+
+	/// Model to clip transform of the occluders.
+	std::vector<float> m_occluders;
+	std::vector<Polygon> m_polygons;
+	std::vector<Triangle> m_triangles;
+	/// Triangles produced by every setup task.
+	std::vector<std::vector<Triangle> > m_chunkTriangles;
+	int m_chunkSize;
+	/// Indices of the triangles overlapping every band.
+	std::vector<std::vector<unsigned int> > m_bins;
+
+	/// Multiply column major matrices: m = m1 * m2.
+	static void MultMatrix(float m[16], const float m1[16], const float m2[16]);
+	static void Transform(const float m[16], const float x[3], btVector4& t);
+	/** Clip a closed polygon against the near and far planes.
+	 * \param pi The polygon in clip coordinates of NP vertices.
+	 * \param po The clipped polygon.
+	 * \return The number of vertices of the clipped polygon.
+	 */
+	template <int NP>
+	static int Clip(const btVector4 *pi, btVector4 *po);
+
+	/// Clip, project and set up the triangles of a range of polygons.
+	void SetupPolygons(int start, int stop, std::vector<Triangle>& triangles) const;
+	/// Set up a triangle in device coordinates, return false if it's culled.
+	bool SetupTriangle(const btVector4& a, const btVector4& b, const btVector4& c, float face, Triangle& tri) const;
+	void BinTriangles();
+	void RasterizeBands(int start, int stop);
+	void RasterizeTile(const Triangle& tri, int tx, int ty);
+	void UpdateTileDepth(int tile);
+
+	static void SetupTask(TaskPool *pool, void *taskdata, int start, int stop, int threadid);
+	static void RasterizeTask(TaskPool *pool, void *taskdata, int start, int stop, int threadid);
+
+public:
+	CcdOcclusionBuffer();
+	~CcdOcclusionBuffer();
+
+	/** Prepare the buffer for a new culling, the previous occluders are removed.
+	 * \param size The largest dimension of the buffer, its size depends on the viewport aspect ratio.
+	 * \param modelview The world to camera transform.
+	 * \param projection The camera to clip transform.
+	 */
+	void Setup(int size, const int *viewport, const float modelview[16], const float projection[16]);
+	/** Add an occluder, the following polygons use its transform.
+	 * \param modelMatrix The object to world column major matrix.
+	 */
+	void AddOccluder(const float modelMatrix[16]);
+	/** Add a polygon of the last occluder, the vertices must be valid until Rasterize.
+	 * \param v4 The fourth vertex of a quad, nullptr for a triangle.
+	 * \param face 0 if the polygon is double sided, 1 if single sided and the
+	 * scale is positive, -1 if single sided and the scale is negative.
+	 */
+	void AddPolygon(const float *v1, const float *v2, const float *v3, const float *v4, float face);
+	/** Rasterize the polygons of all the occluders.
+	 * \param scheduler The scheduler used to rasterize in parallel, can be nullptr.
+	 */
+	void Rasterize(TaskScheduler *scheduler);
+
+	/** Return false if a box in world coordinates is entirely behind the occluders.
+	 * The query is conservative, it tests the screen rectangle of the box at its closest depth.
+	 */
+	bool QueryBox(const btVector3& center, const btVector3& extent) const;
+};
+
+#endif  // __CCDOCCLUSIONBUFFER_H__
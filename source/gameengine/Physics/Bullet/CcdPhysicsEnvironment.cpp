@@ -18,6 +18,8 @@
 
 #include "CcdPhysicsEnvironment.h"
 #include "CcdPhysicsController.h"
+#include "CcdDynamicsWorld.h"
+#include "CcdOcclusionBuffer.h"
 #include "CcdGraphicController.h"
 #include "CcdMathUtils.h"
 
@@ -40,6 +42,8 @@
 #include "PHY_Pro.h"
 #include "KX_GameObject.h"
 #include "KX_Globals.h" // for KX_RasterizerDrawDebugLine
+#include "KX_KetsjiEngine.h"
+#include "KX_ClientObjectInfo.h"
 #include "KX_BlenderSceneConverter.h"
 #include "RAS_MeshObject.h"
 #include "RAS_Polygon.h"
@@ -55,6 +59,13 @@ extern "C" {
 	#include "BKE_object.h"
 }
 
+#include "BLI_task.h"
+#include "BLI_threads.h"
+
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
 #define CCD_CONSTRAINT_DISABLE_LINKED_COLLISION 0x80
 
 #ifdef NEW_BULLET_VEHICLE_SUPPORT
@@ -413,11 +424,14 @@ CcdPhysicsEnvironment::CcdPhysicsEnvironment(bool useDbvtCulling, btDispatcher *
 	}
 
 //	m_collisionConfiguration = new btDefaultCollisionConfiguration();
-	m_collisionConfiguration = new btSoftBodyRigidBodyCollisionConfiguration();
+	// Size the algorithm pool for the convex algorithms of CcdCollisionDispatcher.
+	btDefaultCollisionConstructionInfo constructionInfo;
+	constructionInfo.m_customCollisionAlgorithmMaxElementSize = CcdCollisionDispatcher::GetCollisionAlgorithmMaxSize();
+	m_collisionConfiguration = new btSoftBodyRigidBodyCollisionConfiguration(constructionInfo);
 	//m_collisionConfiguration->setConvexConvexMultipointIterations();
 
 	if (!dispatcher) {
-		btCollisionDispatcher *disp = new btCollisionDispatcher(m_collisionConfiguration);
+		btCollisionDispatcher *disp = new CcdCollisionDispatcher(m_collisionConfiguration);
 		dispatcher = disp;
 		btGImpactCollisionAlgorithm::registerAlgorithm(disp);
 		m_ownDispatcher = dispatcher;
@@ -439,7 +453,7 @@ CcdPhysicsEnvironment::CcdPhysicsEnvironment(bool useDbvtCulling, btDispatcher *
 
 	SetSolverType(1);//issues with quickstep and memory allocations
 //	m_dynamicsWorld = new btDiscreteDynamicsWorld(dispatcher,m_broadphase,m_solver,m_collisionConfiguration);
-	m_dynamicsWorld = new btSoftRigidDynamicsWorld(dispatcher, m_broadphase, m_solver, m_collisionConfiguration);
+	m_dynamicsWorld = new CcdDynamicsWorld(dispatcher, m_broadphase, m_solver, m_collisionConfiguration);
 	m_dynamicsWorld->setInternalTickCallback(&CcdPhysicsEnvironment::StaticSimulationSubtickCallback, this);
 	//m_dynamicsWorld->getSolverInfo().m_linearSlop = 0.01f;
 	//m_dynamicsWorld->getSolverInfo().m_solverMode=	SOLVER_USE_WARMSTARTING +	SOLVER_USE_2_FRICTION_DIRECTIONS +	SOLVER_RANDMIZE_ORDER +	SOLVER_USE_FRICTION_WARMSTARTING;
@@ -706,6 +720,10 @@ void CcdPhysicsEnvironment::UpdateCcdPhysicsControllerShape(CcdShapeConstruction
 
 void CcdPhysicsEnvironment::BeginFrame()
 {
+	/* Update Bullet global variables. This is done here and not in ProceedDeltaTime
+	 * to never write them from the threads stepping the scenes concurrently. */
+	gDeactivationTime = m_deactivationTime;
+	gContactBreakingThreshold = m_contactBreakingThreshold;
 }
 
 void CcdPhysicsEnvironment::DebugDrawWorld()
@@ -735,10 +753,6 @@ bool CcdPhysicsEnvironment::ProceedDeltaTime(double curTime, float timeStep, flo
 	std::set<CcdPhysicsController *>::iterator it;
 	int i;
 
-	// Update Bullet global variables.
-	gDeactivationTime = m_deactivationTime;
-	gContactBreakingThreshold = m_contactBreakingThreshold;
-
 	for (it = m_controllers.begin(); it != m_controllers.end(); it++) {
 		(*it)->SynchronizeMotionStates(timeStep);
 	}
@@ -769,6 +783,26 @@ bool CcdPhysicsEnvironment::ProceedDeltaTime(double curTime, float timeStep, flo
 	return true;
 }
 
+bool CcdPhysicsEnvironment::CanProceedConcurrently(PHY_IPhysicsEnvironment *other) const
+{
+	const CcdPhysicsEnvironment *ccdOther = dynamic_cast<CcdPhysicsEnvironment *>(other);
+	// Bullet global variables are not used by other physics engines.
+	if (!ccdOther) {
+		return true;
+	}
+
+	// The global variables set in BeginFrame must match for both environments.
+	return (m_deactivationTime == ccdOther->m_deactivationTime &&
+	        m_contactBreakingThreshold == ccdOther->m_contactBreakingThreshold);
+}
+
+bool CcdPhysicsEnvironment::CanProceedAsynchronously() const
+{
+	/* The soft body meshes are deformed during the render and the debug drawing
+	 * reads the dynamics world. */
+	return (m_dynamicsWorld->getSoftBodyArray().size() == 0 && GetDebugMode() == 0);
+}
+
 class ClosestRayResultCallbackNotMe : public btCollisionWorld::ClosestRayResultCallback
 {
 	btCollisionObject *m_owner;
@@ -1015,6 +1049,18 @@ void CcdPhysicsEnvironment::SetSolverType(int solverType)
 	m_solverType = solverType;
 }
 
+void CcdPhysicsEnvironment::SetMultithreading(bool enable, int numThreads)
+{
+	TaskScheduler *scheduler = (enable) ? KX_GetActiveEngine()->GetTaskScheduler() : nullptr;
+
+	static_cast<CcdDynamicsWorld *>(m_dynamicsWorld)->SetTaskScheduler(scheduler, numThreads);
+	// A dispatcher given to the constructor can't process the pairs in parallel.
+	CcdCollisionDispatcher *dispatcher = dynamic_cast<CcdCollisionDispatcher *>(m_dynamicsWorld->getDispatcher());
+	if (dispatcher) {
+		dispatcher->SetTaskScheduler(scheduler, numThreads);
+	}
+}
+
 void CcdPhysicsEnvironment::GetGravity(MT_Vector3& grav)
 {
 	const btVector3& gravity = m_dynamicsWorld->getGravity();
@@ -1298,545 +1344,271 @@ SKIP_UV_NORMAL:
 	return result.m_controller;
 }
 
-// Handles occlusion culling.
-// The implementation is based on the CDTestFramework
-struct OcclusionBuffer {
-	struct WriteOCL {
-		static inline bool Process(btScalar &q, btScalar v)
-		{
-			if (q < v) {
-				q = v;
-			}
-			return false;
-		}
-		static inline void Occlusion(bool &flag)
-		{
-			flag = true;
-		}
-	};
-
-	struct QueryOCL {
-		static inline bool Process(btScalar &q, btScalar v)
-		{
-			return (q <= v);
-		}
-		static inline void Occlusion(bool &flag)
-		{
-		}
-	};
+/// Minimum number of rays to cast them in parallel.
+static const unsigned int rayBatchParallelThreshold = 64;
+/// Number of ray packets per task.
+static const int rayBatchTaskChunkSize = 8;
 
-	btScalar *m_buffer;
-	size_t m_bufferSize;
-	bool m_initialized;
-	bool m_occlusion;
-	int m_sizes[2];
-	btScalar m_scales[2];
-	btScalar m_offsets[2];
-	btScalar m_wtc[16]; // world to clip transform
-	btScalar m_mtc[16]; // model to clip transform
-	// constructor: size=largest dimension of the buffer.
-	// Buffer size depends on aspect ratio
-	OcclusionBuffer()
-	{
-		m_initialized = false;
-		m_occlusion = false;
-		m_buffer = nullptr;
-		m_bufferSize = 0;
-	}
-	// multiplication of column major matrices: m = m1 * m2
-	template<typename T1, typename T2>
-	void CMmat4mul(btScalar *m, const T1 *m1, const T2 *m2)
-	{
-		m[0] = btScalar(m1[0] * m2[0] + m1[4] * m2[1] + m1[8] * m2[2] + m1[12] * m2[3]);
-		m[1] = btScalar(m1[1] * m2[0] + m1[5] * m2[1] + m1[9] * m2[2] + m1[13] * m2[3]);
-		m[2] = btScalar(m1[2] * m2[0] + m1[6] * m2[1] + m1[10] * m2[2] + m1[14] * m2[3]);
-		m[3] = btScalar(m1[3] * m2[0] + m1[7] * m2[1] + m1[11] * m2[2] + m1[15] * m2[3]);
-
-		m[4] = btScalar(m1[0] * m2[4] + m1[4] * m2[5] + m1[8] * m2[6] + m1[12] * m2[7]);
-		m[5] = btScalar(m1[1] * m2[4] + m1[5] * m2[5] + m1[9] * m2[6] + m1[13] * m2[7]);
-		m[6] = btScalar(m1[2] * m2[4] + m1[6] * m2[5] + m1[10] * m2[6] + m1[14] * m2[7]);
-		m[7] = btScalar(m1[3] * m2[4] + m1[7] * m2[5] + m1[11] * m2[6] + m1[15] * m2[7]);
-
-		m[8] = btScalar(m1[0] * m2[8] + m1[4] * m2[9] + m1[8] * m2[10] + m1[12] * m2[11]);
-		m[9] = btScalar(m1[1] * m2[8] + m1[5] * m2[9] + m1[9] * m2[10] + m1[13] * m2[11]);
-		m[10] = btScalar(m1[2] * m2[8] + m1[6] * m2[9] + m1[10] * m2[10] + m1[14] * m2[11]);
-		m[11] = btScalar(m1[3] * m2[8] + m1[7] * m2[9] + m1[11] * m2[10] + m1[15] * m2[11]);
-
-		m[12] = btScalar(m1[0] * m2[12] + m1[4] * m2[13] + m1[8] * m2[14] + m1[12] * m2[15]);
-		m[13] = btScalar(m1[1] * m2[12] + m1[5] * m2[13] + m1[9] * m2[14] + m1[13] * m2[15]);
-		m[14] = btScalar(m1[2] * m2[12] + m1[6] * m2[13] + m1[10] * m2[14] + m1[14] * m2[15]);
-		m[15] = btScalar(m1[3] * m2[12] + m1[7] * m2[13] + m1[11] * m2[14] + m1[15] * m2[15]);
-	}
-
-	void setup(int size, const int *view, float modelview[16], float projection[16])
-	{
-		m_initialized = false;
-		m_occlusion = false;
-		// compute the size of the buffer
-		int maxsize = (view[2] > view[3]) ? view[2] : view[3];
-		BLI_assert(maxsize > 0);
-		double ratio = 1.0 / (2 * maxsize);
-		// ensure even number
-		m_sizes[0] = 2 * ((int)(size * view[2] * ratio + 0.5));
-		m_sizes[1] = 2 * ((int)(size * view[3] * ratio + 0.5));
-		m_scales[0] = btScalar(m_sizes[0] / 2);
-		m_scales[1] = btScalar(m_sizes[1] / 2);
-		m_offsets[0] = m_scales[0] + 0.5f;
-		m_offsets[1] = m_scales[1] + 0.5f;
-		// prepare matrix
-		// at this time of the rendering, the modelview matrix is the
-		// world to camera transformation and the projection matrix is
-		// camera to clip transformation. combine both so that
-		CMmat4mul(m_wtc, projection, modelview);
-	}
-
-	void initialize()
-	{
-		size_t newsize = (m_sizes[0] * m_sizes[1]) * sizeof(btScalar);
-		if (m_buffer) {
-			// see if we can reuse
-			if (newsize > m_bufferSize) {
-				free(m_buffer);
-				m_buffer = nullptr;
-				m_bufferSize = 0;
-			}
-		}
-		if (!m_buffer) {
-			m_buffer = (btScalar *)calloc(1, newsize);
-			m_bufferSize = newsize;
-		}
-		else {
-			// buffer exists already, just clears it
-			memset(m_buffer, 0, newsize);
-		}
-		// memory allocate must succeed
-		BLI_assert(m_buffer != nullptr);
-		m_initialized = true;
-		m_occlusion = false;
-	}
+/// Closest hit of a batched ray, ignoring the sensors and the objects out of the user collision group mask.
+struct BatchClosestRayResultCallback : public btCollisionWorld::ClosestRayResultCallback
+{
+	unsigned short m_mask;
 
-	void SetModelMatrix(float *fl)
+	BatchClosestRayResultCallback()
+		:btCollisionWorld::ClosestRayResultCallback(btVector3(0.0f, 0.0f, 0.0f), btVector3(0.0f, 0.0f, 0.0f)),
+		m_mask(0)
 	{
-		CMmat4mul(m_mtc, m_wtc, fl);
-		if (!m_initialized) {
-			initialize();
-		}
+		// Same as RayTest.
+		m_collisionFilterMask = CcdConstructionInfo::AllFilter ^ CcdConstructionInfo::SensorFilter;
+		m_flags |= btTriangleRaycastCallback::kF_UseSubSimplexConvexCastRaytest;
 	}
 
-	// transform a segment in world coordinate to clip coordinate
-	void transformW(const btVector3 &x, btVector4 &t)
+	virtual ~BatchClosestRayResultCallback()
 	{
-		t[0] = x[0] * m_wtc[0] + x[1] * m_wtc[4] + x[2] * m_wtc[8] + m_wtc[12];
-		t[1] = x[0] * m_wtc[1] + x[1] * m_wtc[5] + x[2] * m_wtc[9] + m_wtc[13];
-		t[2] = x[0] * m_wtc[2] + x[1] * m_wtc[6] + x[2] * m_wtc[10] + m_wtc[14];
-		t[3] = x[0] * m_wtc[3] + x[1] * m_wtc[7] + x[2] * m_wtc[11] + m_wtc[15];
 	}
 
-	void transformM(const float *x, btVector4 &t)
+	void Reset(const btVector3& rayFrom, const btVector3& rayTo, unsigned short mask)
 	{
-		t[0] = x[0] * m_mtc[0] + x[1] * m_mtc[4] + x[2] * m_mtc[8] + m_mtc[12];
-		t[1] = x[0] * m_mtc[1] + x[1] * m_mtc[5] + x[2] * m_mtc[9] + m_mtc[13];
-		t[2] = x[0] * m_mtc[2] + x[1] * m_mtc[6] + x[2] * m_mtc[10] + m_mtc[14];
-		t[3] = x[0] * m_mtc[3] + x[1] * m_mtc[7] + x[2] * m_mtc[11] + m_mtc[15];
+		m_rayFromWorld = rayFrom;
+		m_rayToWorld = rayTo;
+		m_mask = mask;
+		m_closestHitFraction = 1.0f;
+		m_collisionObject = nullptr;
 	}
-	// convert polygon to device coordinates
-	static bool project(btVector4 *p, int n)
+
+	virtual bool needsCollision(btBroadphaseProxy *proxy0) const
 	{
-		for (int i = 0; i < n; ++i) {
-			p[i][2] = 1 / p[i][3];
-			p[i][0] *= p[i][2];
-			p[i][1] *= p[i][2];
-		}
-		return true;
-	}
-	// pi: closed polygon in clip coordinate, NP = number of segments
-	// po: same polygon with clipped segments removed
-	template <const int NP>
-	static int clip(const btVector4 *pi, btVector4 *po)
-	{
-		btScalar s[2 * NP];
-		btVector4 pn[2 * NP];
-		int i, j, m, n, ni;
-		// deal with near clipping
-		for (i = 0, m = 0; i < NP; ++i) {
-			s[i] = pi[i][2] + pi[i][3];
-			if (s[i] < 0) {
-				m += 1 << i;
-			}
-		}
-		if (m == ((1 << NP) - 1)) {
-			return 0;
-		}
-		if (m != 0) {
-			for (i = NP - 1, j = 0, n = 0; j < NP; i = j++) {
-				const btVector4 &a = pi[i];
-				const btVector4 &b = pi[j];
-				const btScalar t = s[i] / (a[3] + a[2] - b[3] - b[2]);
-				if ((t > 0) && (t < 1)) {
-					pn[n][0] = a[0] + (b[0] - a[0]) * t;
-					pn[n][1] = a[1] + (b[1] - a[1]) * t;
-					pn[n][2] = a[2] + (b[2] - a[2]) * t;
-					pn[n][3] = a[3] + (b[3] - a[3]) * t;
-					++n;
-				}
-				if (s[j] > 0) {
-					pn[n++] = b;
-				}
-			}
-			// ready to test far clipping, start from the modified polygon
-			pi = pn;
-			ni = n;
+		if (!btCollisionWorld::ClosestRayResultCallback::needsCollision(proxy0)) {
+			return false;
 		}
-		else {
-			// no clipping on the near plane, keep same vector
-			ni = NP;
-		}
-		// now deal with far clipping
-		for (i = 0, m = 0; i < ni; ++i) {
-			s[i] = pi[i][2] - pi[i][3];
-			if (s[i] > 0) {
-				m += 1 << i;
-			}
+
+		btCollisionObject *object = (btCollisionObject *)proxy0->m_clientObject;
+		CcdPhysicsController *phyCtrl = static_cast<CcdPhysicsController *>(object->getUserPointer());
+		KX_ClientObjectInfo *info = (KX_ClientObjectInfo *)phyCtrl->GetNewClientInfo();
+		if (!info || info->m_type > KX_ClientObjectInfo::ACTOR) {
+			return false;
 		}
-		if (m == ((1 << ni) - 1)) {
-			return 0;
-		}
-		if (m != 0) {
-			for (i = ni - 1, j = 0, n = 0; j < ni; i = j++) {
-				const btVector4 &a = pi[i];
-				const btVector4 &b = pi[j];
-				const btScalar t = s[i] / (a[2] - a[3] - b[2] + b[3]);
-				if ((t > 0) && (t < 1)) {
-					po[n][0] = a[0] + (b[0] - a[0]) * t;
-					po[n][1] = a[1] + (b[1] - a[1]) * t;
-					po[n][2] = a[2] + (b[2] - a[2]) * t;
-					po[n][3] = a[3] + (b[3] - a[3]) * t;
-					++n;
-				}
-				if (s[j] < 0) {
-					po[n++] = b;
-				}
-			}
-			return n;
+
+		return (info->m_gameobject->GetUserCollisionGroup() & m_mask);
+	}
+};
+
+/** Packet of four rays traversing the broadphase tree together, the rays are stored
+ * by component to be tested against a node bounding box at once.
+ */
+struct RayPacket
+{
+	float m_origin[3][4];
+	float m_invDirection[3][4];
+	/// Closest hit fraction of the rays, negative for the unused rays.
+	float m_maxFraction[4];
+	btTransform m_fromTrans[4];
+	btTransform m_toTrans[4];
+	BatchClosestRayResultCallback m_callbacks[4];
+};
+
+/// Return a bit mask of the packet rays intersecting a bounding box before their closest hit.
+static int rayPacketTestVolume(const RayPacket& packet, const btDbvtVolume& volume)
+{
+	const btVector3& mins = volume.Mins();
+	const btVector3& maxs = volume.Maxs();
+
+#ifdef __SSE2__
+	__m128 tmin = _mm_setzero_ps();
+	__m128 tmax = _mm_loadu_ps(packet.m_maxFraction);
+	for (unsigned short axis = 0; axis < 3; ++axis) {
+		const __m128 origin = _mm_loadu_ps(packet.m_origin[axis]);
+		const __m128 invDirection = _mm_loadu_ps(packet.m_invDirection[axis]);
+		const __m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(mins[axis]), origin), invDirection);
+		const __m128 t2 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(maxs[axis]), origin), invDirection);
+		tmin = _mm_max_ps(tmin, _mm_min_ps(t1, t2));
+		tmax = _mm_min_ps(tmax, _mm_max_ps(t1, t2));
+	}
+
+	return _mm_movemask_ps(_mm_cmple_ps(tmin, tmax));
+#else
+	int hits = 0;
+	for (unsigned short i = 0; i < 4; ++i) {
+		float tmin = 0.0f;
+		float tmax = packet.m_maxFraction[i];
+		for (unsigned short axis = 0; axis < 3; ++axis) {
+			const float t1 = (mins[axis] - packet.m_origin[axis][i]) * packet.m_invDirection[axis][i];
+			const float t2 = (maxs[axis] - packet.m_origin[axis][i]) * packet.m_invDirection[axis][i];
+			tmin = std::max(tmin, std::min(t1, t2));
+			tmax = std::min(tmax, std::max(t1, t2));
 		}
-		for (int i = 0; i < ni; ++i) {
-			po[i] = pi[i];
+		if (tmin <= tmax) {
+			hits |= (1 << i);
 		}
-		return ni;
 	}
-	// write or check a triangle to buffer. a,b,c in device coordinates (-1,+1)
-	template <typename POLICY>
-	inline bool draw(const btVector4 &a,
-	                 const btVector4 &b,
-	                 const btVector4 &c,
-	                 const float face,
-	                 const btScalar minarea)
-	{
-		const btScalar a2 = btCross(b - a, c - a)[2];
-		if ((face * a2) < 0.0f || btFabs(a2) < minarea) {
-			return false;
+
+	return hits;
+#endif
+}
+
+/** Traverse a broadphase tree with a packet of rays and cast the rays on the objects
+ * of the leaves they intersect. The stack is local to the caller to keep the traversal
+ * thread safe, contrary to btDbvtBroadphase::rayTest.
+ */
+static void rayPacketTraverse(RayPacket& packet, const btDbvtNode *root, btAlignedObjectArray<const btDbvtNode *>& stack)
+{
+	if (!root) {
+		return;
+	}
+
+	const btVector3 origin(packet.m_origin[0][0], packet.m_origin[1][0], packet.m_origin[2][0]);
+
+	stack.resize(0);
+	stack.push_back(root);
+	while (stack.size() > 0) {
+		const btDbvtNode *node = stack[stack.size() - 1];
+		stack.pop_back();
+
+		const int hits = rayPacketTestVolume(packet, node->volume);
+		if (hits == 0) {
+			continue;
 		}
-		// further down we are normally going to write to the Zbuffer, mark it so
-		POLICY::Occlusion(m_occlusion);
-
-		int x[3], y[3], ib = 1, ic = 2;
-		btScalar z[3];
-		x[0] = (int)(a.x() * m_scales[0] + m_offsets[0]);
-		y[0] = (int)(a.y() * m_scales[1] + m_offsets[1]);
-		z[0] = a.z();
-		if (a2 < 0.f) {
-			// negative aire is possible with double face => must
-			// change the order of b and c otherwise the algorithm doesn't work
-			ib = 2;
-			ic = 1;
-		}
-		x[ib] = (int)(b.x() * m_scales[0] + m_offsets[0]);
-		x[ic] = (int)(c.x() * m_scales[0] + m_offsets[0]);
-		y[ib] = (int)(b.y() * m_scales[1] + m_offsets[1]);
-		y[ic] = (int)(c.y() * m_scales[1] + m_offsets[1]);
-		z[ib] = b.z();
-		z[ic] = c.z();
-		const int mix = btMax(0, btMin(x[0], btMin(x[1], x[2])));
-		const int mxx = btMin(m_sizes[0], 1 + btMax(x[0], btMax(x[1], x[2])));
-		const int miy = btMax(0, btMin(y[0], btMin(y[1], y[2])));
-		const int mxy = btMin(m_sizes[1], 1 + btMax(y[0], btMax(y[1], y[2])));
-		const int width = mxx - mix;
-		const int height = mxy - miy;
-		if ((width * height) <= 1) {
-			// degenerated in at most one single pixel
-			btScalar *scan = &m_buffer[miy * m_sizes[0] + mix];
-			// use for loop to detect the case where width or height == 0
-			for (int iy = miy; iy < mxy; ++iy) {
-				for (int ix = mix; ix < mxx; ++ix) {
-					if (POLICY::Process(*scan, z[0])) {
-						return true;
-					}
-					if (POLICY::Process(*scan, z[1])) {
-						return true;
-					}
-					if (POLICY::Process(*scan, z[2])) {
-						return true;
-					}
-				}
+
+		if (node->isinternal()) {
+			// Visit the nearest child first to shorten the rays sooner.
+			const btDbvtNode *nearChild = node->childs[0];
+			const btDbvtNode *farChild = node->childs[1];
+			if ((nearChild->volume.Center() - origin).length2() > (farChild->volume.Center() - origin).length2()) {
+				std::swap(nearChild, farChild);
 			}
+			stack.push_back(farChild);
+			stack.push_back(nearChild);
+			continue;
 		}
-		else if (width == 1) {
-			// Degenerated in at least 2 vertical lines
-			// The algorithm below doesn't work when face has a single pixel width
-			// We cannot use general formulas because the plane is degenerated.
-			// We have to interpolate along the 3 edges that overlaps and process each pixel.
-			// sort the y coord to make formula simpler
-			int ytmp;
-			btScalar ztmp;
-			if (y[0] > y[1]) {
-				ytmp = y[1];
-				y[1] = y[0];
-				y[0] = ytmp;
-				ztmp = z[1];
-				z[1] = z[0];
-				z[0] = ztmp;
-			}
-			if (y[0] > y[2]) {
-				ytmp = y[2];
-				y[2] = y[0];
-				y[0] = ytmp;
-				ztmp = z[2];
-				z[2] = z[0];
-				z[0] = ztmp;
-			}
-			if (y[1] > y[2]) {
-				ytmp = y[2];
-				y[2] = y[1];
-				y[1] = ytmp;
-				ztmp = z[2];
-				z[2] = z[1];
-				z[1] = ztmp;
-			}
-			int dy[] = {y[0] - y[1],
-				        y[1] - y[2],
-				        y[2] - y[0]};
-			btScalar dzy[3];
-			dzy[0] = (dy[0]) ? (z[0] - z[1]) / dy[0] : btScalar(0.0f);
-			dzy[1] = (dy[1]) ? (z[1] - z[2]) / dy[1] : btScalar(0.0f);
-			dzy[2] = (dy[2]) ? (z[2] - z[0]) / dy[2] : btScalar(0.0f);
-			btScalar v[3] = {dzy[0] * (miy - y[0]) + z[0],
-				             dzy[1] * (miy - y[1]) + z[1],
-				             dzy[2] * (miy - y[2]) + z[2]};
-			dy[0] = y[1] - y[0];
-			dy[1] = y[0] - y[1];
-			dy[2] = y[2] - y[0];
-			btScalar *scan = &m_buffer[miy * m_sizes[0] + mix];
-			for (int iy = miy; iy < mxy; ++iy) {
-				if (dy[0] >= 0 && POLICY::Process(*scan, v[0])) {
-					return true;
-				}
-				if (dy[1] >= 0 && POLICY::Process(*scan, v[1])) {
-					return true;
-				}
-				if (dy[2] >= 0 && POLICY::Process(*scan, v[2])) {
-					return true;
-				}
-				scan += m_sizes[0];
-				v[0] += dzy[0];
-				v[1] += dzy[1];
-				v[2] += dzy[2];
-				dy[0]--;
-				dy[1]++;
-				dy[2]--;
+
+		btBroadphaseProxy *proxy = (btBroadphaseProxy *)node->data;
+		btCollisionObject *object = (btCollisionObject *)proxy->m_clientObject;
+		for (unsigned short i = 0; i < 4; ++i) {
+			BatchClosestRayResultCallback& callback = packet.m_callbacks[i];
+			if (!(hits & (1 << i)) || !callback.needsCollision(proxy)) {
+				continue;
 			}
+
+			btCollisionWorld::rayTestSingle(packet.m_fromTrans[i], packet.m_toTrans[i], object,
+					object->getCollisionShape(), object->getWorldTransform(), callback);
+			packet.m_maxFraction[i] = callback.m_closestHitFraction;
 		}
-		else if (height == 1) {
-			// Degenerated in at least 2 horizontal lines
-			// The algorithm below doesn't work when face has a single pixel width
-			// We cannot use general formulas because the plane is degenerated.
-			// We have to interpolate along the 3 edges that overlaps and process each pixel.
-			int xtmp;
-			btScalar ztmp;
-			if (x[0] > x[1]) {
-				xtmp = x[1];
-				x[1] = x[0];
-				x[0] = xtmp;
-				ztmp = z[1];
-				z[1] = z[0];
-				z[0] = ztmp;
-			}
-			if (x[0] > x[2]) {
-				xtmp = x[2];
-				x[2] = x[0];
-				x[0] = xtmp;
-				ztmp = z[2];
-				z[2] = z[0];
-				z[0] = ztmp;
-			}
-			if (x[1] > x[2]) {
-				xtmp = x[2];
-				x[2] = x[1];
-				x[1] = xtmp;
-				ztmp = z[2];
-				z[2] = z[1];
-				z[1] = ztmp;
-			}
-			int dx[] = {x[0] - x[1],
-				        x[1] - x[2],
-				        x[2] - x[0]};
-			btScalar dzx[3];
-			dzx[0] = (dx[0]) ? (z[0] - z[1]) / dx[0] : btScalar(0.0f);
-			dzx[1] = (dx[1]) ? (z[1] - z[2]) / dx[1] : btScalar(0.0f);
-			dzx[2] = (dx[2]) ? (z[2] - z[0]) / dx[2] : btScalar(0.0f);
-			btScalar v[3] = {dzx[0] * (mix - x[0]) + z[0],
-				             dzx[1] * (mix - x[1]) + z[1],
-				             dzx[2] * (mix - x[2]) + z[2]};
-			dx[0] = x[1] - x[0];
-			dx[1] = x[0] - x[1];
-			dx[2] = x[2] - x[0];
-			btScalar *scan = &m_buffer[miy * m_sizes[0] + mix];
-			for (int ix = mix; ix < mxx; ++ix) {
-				if (dx[0] >= 0 && POLICY::Process(*scan, v[0])) {
-					return true;
-				}
-				if (dx[1] >= 0 && POLICY::Process(*scan, v[1])) {
-					return true;
-				}
-				if (dx[2] >= 0 && POLICY::Process(*scan, v[2])) {
-					return true;
+	}
+}
+
+struct RayBatchData
+{
+	btDbvtBroadphase *m_broadphase;
+	const float *m_from;
+	const float *m_to;
+	unsigned int m_numRays;
+	unsigned short m_mask;
+	PHY_RayCastBatchResult *m_results;
+};
+
+/// Cast the rays of a range of packets.
+static void rayTestBatchPackets(const RayBatchData& data, unsigned int start, unsigned int stop)
+{
+	RayPacket packet;
+	btAlignedObjectArray<const btDbvtNode *> stack;
+	stack.reserve(64);
+
+	for (unsigned int p = start; p < stop; ++p) {
+		const unsigned int first = p * 4;
+		const unsigned int num = std::min(4U, data.m_numRays - first);
+
+		for (unsigned int i = 0; i < 4; ++i) {
+			if (i >= num) {
+				// Unused rays never intersect.
+				for (unsigned short axis = 0; axis < 3; ++axis) {
+					packet.m_origin[axis][i] = 0.0f;
+					packet.m_invDirection[axis][i] = 0.0f;
 				}
-				scan++;
-				v[0] += dzx[0];
-				v[1] += dzx[1];
-				v[2] += dzx[2];
-				dx[0]--;
-				dx[1]++;
-				dx[2]--;
+				packet.m_maxFraction[i] = -1.0f;
+				packet.m_callbacks[i].Reset(btVector3(0.0f, 0.0f, 0.0f), btVector3(0.0f, 0.0f, 0.0f), 0);
+				continue;
 			}
-		}
-		else {
-			// general case
-			const int dx[] = {y[0] - y[1],
-				              y[1] - y[2],
-				              y[2] - y[0]};
-			const int dy[] = {x[1] - x[0] - dx[0] * width,
-				              x[2] - x[1] - dx[1] * width,
-				              x[0] - x[2] - dx[2] * width};
-			const int a = x[2] * y[0] + x[0] * y[1] - x[2] * y[1] - x[0] * y[2] + x[1] * y[2] - x[1] * y[0];
-			const btScalar ia = 1 / (btScalar)a;
-			const btScalar dzx = ia * (y[2] * (z[1] - z[0]) + y[1] * (z[0] - z[2]) + y[0] * (z[2] - z[1]));
-			const btScalar dzy = ia * (x[2] * (z[0] - z[1]) + x[0] * (z[1] - z[2]) + x[1] * (z[2] - z[0])) - (dzx * width);
-			int c[] = {miy *x[1] + mix * y[0] - x[1] * y[0] - mix * y[1] + x[0] * y[1] - miy * x[0],
-				miy *x[2] + mix * y[1] - x[2] * y[1] - mix * y[2] + x[1] * y[2] - miy * x[1],
-				miy *x[0] + mix * y[2] - x[0] * y[2] - mix * y[0] + x[2] * y[0] - miy * x[2]};
-			btScalar v = ia * ((z[2] * c[0]) + (z[0] * c[1]) + (z[1] * c[2]));
-			btScalar *scan = &m_buffer[miy * m_sizes[0]];
-
-			for (int iy = miy; iy < mxy; ++iy) {
-				for (int ix = mix; ix < mxx; ++ix) {
-					if ((c[0] >= 0) && (c[1] >= 0) && (c[2] >= 0)) {
-						if (POLICY::Process(scan[ix], v)) {
-							return true;
-						}
-					}
-					c[0] += dx[0]; c[1] += dx[1]; c[2] += dx[2]; v += dzx;
-				}
-				c[0] += dy[0]; c[1] += dy[1]; c[2] += dy[2]; v += dzy;
-				scan += m_sizes[0];
+
+			const float *from = &data.m_from[(first + i) * 3];
+			const float *to = &data.m_to[(first + i) * 3];
+			const btVector3 rayFrom(from[0], from[1], from[2]);
+			const btVector3 rayTo(to[0], to[1], to[2]);
+
+			for (unsigned short axis = 0; axis < 3; ++axis) {
+				// The direction is not normalized to get the hit fractions from the slab tests.
+				const float direction = to[axis] - from[axis];
+				packet.m_origin[axis][i] = from[axis];
+				packet.m_invDirection[axis][i] = (direction == 0.0f) ? BT_LARGE_FLOAT : 1.0f / direction;
 			}
+			packet.m_maxFraction[i] = 1.0f;
+			packet.m_fromTrans[i].setIdentity();
+			packet.m_fromTrans[i].setOrigin(rayFrom);
+			packet.m_toTrans[i].setIdentity();
+			packet.m_toTrans[i].setOrigin(rayTo);
+			packet.m_callbacks[i].Reset(rayFrom, rayTo, data.m_mask);
 		}
-		return false;
-	}
-	// clip than write or check a polygon
-	template <const int NP, typename POLICY>
-	inline bool clipDraw(const btVector4 *p,
-	                     const float face,
-	                     btScalar minarea)
-	{
-		btVector4 o[NP * 2];
-		int n = clip<NP>(p, o);
-		bool earlyexit = false;
-		if (n) {
-			project(o, n);
-			for (int i = 2; i < n && !earlyexit; ++i) {
-				earlyexit |= draw<POLICY>(o[0], o[i - 1], o[i], face, minarea);
+
+		// Dynamic and static objects.
+		rayPacketTraverse(packet, data.m_broadphase->m_sets[0].m_root, stack);
+		rayPacketTraverse(packet, data.m_broadphase->m_sets[1].m_root, stack);
+
+		for (unsigned int i = 0; i < num; ++i) {
+			BatchClosestRayResultCallback& callback = packet.m_callbacks[i];
+			PHY_RayCastBatchResult& result = data.m_results[first + i];
+
+			if (!callback.hasHit()) {
+				result.m_controller = nullptr;
+				result.m_hitFraction = 1.0f;
+				continue;
 			}
-		}
-		return earlyexit;
-	}
-	// add a triangle (in model coordinate)
-	// face =  0.f if face is double side,
-	//      =  1.f if face is single sided and scale is positive
-	//      = -1.f if face is single sided and scale is negative
-	void appendOccluderM(const float *a,
-	                     const float *b,
-	                     const float *c,
-	                     const float face)
-	{
-		btVector4 p[3];
-		transformM(a, p[0]);
-		transformM(b, p[1]);
-		transformM(c, p[2]);
-		clipDraw<3, WriteOCL>(p, face, btScalar(0.0f));
-	}
-	// add a quad (in model coordinate)
-	void appendOccluderM(const float *a,
-	                     const float *b,
-	                     const float *c,
-	                     const float *d,
-	                     const float face)
-	{
-		btVector4 p[4];
-		transformM(a, p[0]);
-		transformM(b, p[1]);
-		transformM(c, p[2]);
-		transformM(d, p[3]);
-		clipDraw<4, WriteOCL>(p, face, btScalar(0.0f));
-	}
-	// query occluder for a box (c=center, e=extend) in world coordinate
-	inline bool queryOccluderW(const btVector3 &c,
-	                           const btVector3 &e)
-	{
-		if (!m_occlusion) {
-			// no occlusion yet, no need to check
-			return true;
-		}
-		btVector4 x[8];
-		transformW(btVector3(c[0] - e[0], c[1] - e[1], c[2] - e[2]), x[0]);
-		transformW(btVector3(c[0] + e[0], c[1] - e[1], c[2] - e[2]), x[1]);
-		transformW(btVector3(c[0] + e[0], c[1] + e[1], c[2] - e[2]), x[2]);
-		transformW(btVector3(c[0] - e[0], c[1] + e[1], c[2] - e[2]), x[3]);
-		transformW(btVector3(c[0] - e[0], c[1] - e[1], c[2] + e[2]), x[4]);
-		transformW(btVector3(c[0] + e[0], c[1] - e[1], c[2] + e[2]), x[5]);
-		transformW(btVector3(c[0] + e[0], c[1] + e[1], c[2] + e[2]), x[6]);
-		transformW(btVector3(c[0] - e[0], c[1] + e[1], c[2] + e[2]), x[7]);
-
-		for (int i = 0; i < 8; ++i) {
-			// the box is clipped, it's probably a large box, don't waste our time to check
-			if ((x[i][2] + x[i][3]) <= 0) {
-				return true;
+
+			btVector3 normal = callback.m_hitNormalWorld;
+			if (normal.length2() > (SIMD_EPSILON * SIMD_EPSILON)) {
+				normal.normalize();
 			}
-		}
-		static const int d[] = {1, 0, 3, 2,
-			                    4, 5, 6, 7,
-			                    4, 7, 3, 0,
-			                    6, 5, 1, 2,
-			                    7, 6, 2, 3,
-			                    5, 4, 0, 1};
-		for (unsigned int i = 0; i < (sizeof(d) / sizeof(d[0])); ) {
-			const btVector4 p[] = {x[d[i + 0]],
-				                   x[d[i + 1]],
-				                   x[d[i + 2]],
-				                   x[d[i + 3]]};
-			i += 4;
-			if (clipDraw<4, QueryOCL>(p, 1.0f, 0.0f)) {
-				return true;
+			else {
+				normal.setValue(1.0f, 0.0f, 0.0f);
+			}
+
+			result.m_controller = static_cast<CcdPhysicsController *>(callback.m_collisionObject->getUserPointer());
+			result.m_hitFraction = callback.m_closestHitFraction;
+			for (unsigned short axis = 0; axis < 3; ++axis) {
+				result.m_hitPoint[axis] = callback.m_hitPointWorld[axis];
+				result.m_hitNormal[axis] = normal[axis];
 			}
 		}
-		return false;
 	}
-};
+}
 
+static void rayTestBatchTask(TaskPool *__restrict pool, void *UNUSED(taskdata), int start, int stop, int UNUSED(threadid))
+{
+	const RayBatchData *data = (RayBatchData *)BLI_task_pool_userdata(pool);
+
+	rayTestBatchPackets(*data, start, stop);
+}
 
-struct  DbvtCullingCallback : btDbvt::ICollide {
+void CcdPhysicsEnvironment::RayTestBatch(const float *from, const float *to, unsigned int numRays, unsigned short mask, PHY_RayCastBatchResult *results)
+{
+	RayBatchData data = {static_cast<btDbvtBroadphase *>(m_broadphase), from, to, numRays, mask, results};
+	const unsigned int numPackets = (numRays + 3) / 4;
+	TaskScheduler *scheduler = KX_GetActiveEngine()->GetTaskScheduler();
+
+	// The narrow phase ray tests only read the collision shapes and can run in parallel.
+	if (numRays >= rayBatchParallelThreshold && BLI_thread_is_main() && BLI_task_scheduler_num_threads(scheduler) > 1) {
+		TaskPool *pool = BLI_task_pool_create(scheduler, &data);
+		BLI_task_pool_push_range(pool, rayTestBatchTask, nullptr, 0, numPackets, rayBatchTaskChunkSize, TASK_PRIORITY_HIGH);
+		BLI_task_pool_work_and_wait(pool);
+		BLI_task_pool_free(pool);
+	}
+	else {
+		rayTestBatchPackets(data, 0, numPackets);
+	}
+}
+
+struct DbvtCullingCallback : btDbvt::ICollide {
 	PHY_CullingCallback m_clientCallback;
 	void *m_userData;
-	OcclusionBuffer *m_ocb;
+	CcdOcclusionBuffer *m_ocb;
 
 	DbvtCullingCallback(PHY_CullingCallback clientCallback, void *userData)
 	{
@@ -1846,7 +1618,7 @@ struct  DbvtCullingCallback : btDbvt::ICollide {
 	}
 	bool Descent(const btDbvtNode *node)
 	{
-		return(m_ocb->queryOccluderW(node->volume.Center(), node->volume.Extents()));
+		return(m_ocb->QueryBox(node->volume.Center(), node->volume.Extents()));
 	}
 	void Process(const btDbvtNode *node, btScalar depth)
 	{
@@ -1858,49 +1630,56 @@ struct  DbvtCullingCallback : btDbvt::ICollide {
 		// the client object is a graphic controller
 		CcdGraphicController *ctrl = static_cast<CcdGraphicController *>(proxy->m_clientObject);
 		KX_ClientObjectInfo *info = (KX_ClientObjectInfo *)ctrl->GetNewClientInfo();
-		if (m_ocb) {
-			// means we are doing occlusion culling. Check if this object is an occluders
-			KX_GameObject *gameobj = KX_GameObject::GetClientObject(info);
-			if (gameobj && gameobj->GetOccluder()) {
-				float *fl = gameobj->GetOpenGLMatrixPtr()->getPointer();
-				// this will create the occlusion buffer if not already done
-				// and compute the transformation from model local space to clip space
-				m_ocb->SetModelMatrix(fl);
-				float face = (gameobj->IsNegativeScaling()) ? -1.0f : 1.0f;
-				// walk through the meshes and for each add to buffer
-				for (int i = 0; i < gameobj->GetMeshCount(); i++) {
-					RAS_MeshObject *meshobj = gameobj->GetMesh(i);
-					const float *v1, *v2, *v3, *v4;
-
-					int polycount = meshobj->NumPolygons();
-					for (int j = 0; j < polycount; j++) {
-						RAS_Polygon *poly = meshobj->GetPolygon(j);
-						switch (poly->VertexCount())
-						{
-							case 3:
-								v1 = poly->GetVertex(0)->getXYZ();
-								v2 = poly->GetVertex(1)->getXYZ();
-								v3 = poly->GetVertex(2)->getXYZ();
-								m_ocb->appendOccluderM(v1, v2, v3, ((poly->IsTwoside()) ? 0.f : face));
-								break;
-							case 4:
-								v1 = poly->GetVertex(0)->getXYZ();
-								v2 = poly->GetVertex(1)->getXYZ();
-								v3 = poly->GetVertex(2)->getXYZ();
-								v4 = poly->GetVertex(3)->getXYZ();
-								m_ocb->appendOccluderM(v1, v2, v3, v4, ((poly->IsTwoside()) ? 0.f : face));
-								break;
-						}
-					}
+		if (info)
+			(*m_clientCallback)(info, m_userData);
+	}
+};
+
+/// Collect the polygons of the occluders inside the frustum.
+struct DbvtOccluderCallback : btDbvt::ICollide {
+	CcdOcclusionBuffer *m_ocb;
+
+	DbvtOccluderCallback(CcdOcclusionBuffer *ocb)
+		:m_ocb(ocb)
+	{
+	}
+	void Process(const btDbvtNode *leaf)
+	{
+		btBroadphaseProxy *proxy = (btBroadphaseProxy *)leaf->data;
+		// the client object is a graphic controller
+		CcdGraphicController *ctrl = static_cast<CcdGraphicController *>(proxy->m_clientObject);
+		KX_ClientObjectInfo *info = (KX_ClientObjectInfo *)ctrl->GetNewClientInfo();
+		KX_GameObject *gameobj = KX_GameObject::GetClientObject(info);
+		if (!gameobj || !gameobj->GetOccluder()) {
+			return;
+		}
+
+		m_ocb->AddOccluder(gameobj->GetOpenGLMatrixPtr()->getPointer());
+		const float face = (gameobj->IsNegativeScaling()) ? -1.0f : 1.0f;
+		// walk through the meshes and for each add to buffer
+		for (int i = 0; i < gameobj->GetMeshCount(); i++) {
+			RAS_MeshObject *meshobj = gameobj->GetMesh(i);
+
+			for (int j = 0, polycount = meshobj->NumPolygons(); j < polycount; j++) {
+				RAS_Polygon *poly = meshobj->GetPolygon(j);
+				const float polyface = (poly->IsTwoside()) ? 0.0f : face;
+				switch (poly->VertexCount())
+				{
+					case 3:
+						m_ocb->AddPolygon(poly->GetVertex(0)->getXYZ(), poly->GetVertex(1)->getXYZ(),
+						                  poly->GetVertex(2)->getXYZ(), nullptr, polyface);
+						break;
+					case 4:
+						m_ocb->AddPolygon(poly->GetVertex(0)->getXYZ(), poly->GetVertex(1)->getXYZ(),
+						                  poly->GetVertex(2)->getXYZ(), poly->GetVertex(3)->getXYZ(), polyface);
+						break;
 				}
 			}
 		}
-		if (info)
-			(*m_clientCallback)(info, m_userData);
 	}
 };
 
-static OcclusionBuffer gOcb;
+static CcdOcclusionBuffer gOcb;
 bool CcdPhysicsEnvironment::CullingTest(PHY_CullingCallback callback, void *userData, MT_Vector4 *planes, int nplanes, int occlusionRes, const int *viewport, float modelview[16], float projection[16])
 {
 	if (!m_cullingTree)
@@ -1916,7 +1695,14 @@ bool CcdPhysicsEnvironment::CullingTest(PHY_CullingCallback callback, void *user
 	}
 	// if occlusionRes != 0 => occlusion culling
 	if (occlusionRes) {
-		gOcb.setup(occlusionRes, viewport, modelview, projection);
+		/* The occluders inside the frustum are rasterized first, all the objects
+		 * are then tested against the complete occlusion buffer. */
+		gOcb.Setup(occlusionRes, viewport, modelview, projection);
+		DbvtOccluderCallback occluders(&gOcb);
+		btDbvt::collideKDOP(m_cullingTree->m_sets[1].m_root, planes_n, planes_o, nplanes, occluders);
+		btDbvt::collideKDOP(m_cullingTree->m_sets[0].m_root, planes_n, planes_o, nplanes, occluders);
+		gOcb.Rasterize(KX_GetActiveEngine()->GetTaskScheduler());
+
 		dispatcher.m_ocb = &gOcb;
 		// occlusion culling, the direction of the view is taken from the first plan which MUST be the near plane
 		btDbvt::collideOCL(m_cullingTree->m_sets[1].m_root, planes_n, planes_o, planes_n[0], nplanes, dispatcher);
@@ -2846,6 +2632,7 @@ CcdPhysicsEnvironment *CcdPhysicsEnvironment::Create(Scene *blenderscene, bool v
 	ccdPhysEnv->SetDeactivationLinearTreshold(blenderscene->gm.lineardeactthreshold);
 	ccdPhysEnv->SetDeactivationAngularTreshold(blenderscene->gm.angulardeactthreshold);
 	ccdPhysEnv->SetDeactivationTime(blenderscene->gm.deactivationtime);
+	ccdPhysEnv->SetMultithreading((blenderscene->gm.flag & GAME_PHYSICS_MULTITHREADING) != 0, blenderscene->gm.physicsThreads);
 
 	if (visualizePhysics)
 		ccdPhysEnv->SetDebugMode(btIDebugDraw::DBG_DrawWireframe | btIDebugDraw::DBG_DrawAabb | btIDebugDraw::DBG_DrawContactPoints | btIDebugDraw::DBG_DrawText | btIDebugDraw::DBG_DrawConstraintLimits | btIDebugDraw::DBG_DrawConstraints);
@@ -123,6 +123,11 @@ public:
 	virtual void SetContactBreakingTreshold(float contactBreakingTreshold);
 	virtual void SetCcdMode(int ccdMode);
 	virtual void SetSolverType(int solverType);
+	/** Solve the collisions and the simulation islands on the engine task scheduler.
+	 * The simulation doesn't depend on the number of threads.
+	 * \param numThreads The maximum number of tasks, 0 to use all the scheduler threads.
+	 */
+	void SetMultithreading(bool enable, int numThreads);
 	virtual void SetSolverSorConstant(float sor);
 	virtual void SetSolverTau(float tau);
 	virtual void SetSolverDamping(float damping);
@@ -140,6 +145,8 @@ public:
 	}
 	/// Perform an integration step of duration 'timeStep'.
 	virtual bool ProceedDeltaTime(double curTime, float timeStep, float interval);
+	virtual bool CanProceedConcurrently(PHY_IPhysicsEnvironment *other) const;
+	virtual bool CanProceedAsynchronously() const;
 
 	/**
 	 * Called by Bullet for every physical simulation (sub)tick.
@@ -200,6 +207,7 @@ public:
 	btTypedConstraint *GetConstraintById(int constraintId);
 
 	virtual PHY_IPhysicsController *RayTest(PHY_IRayCastFilterCallback &filterCallback, float fromX, float fromY, float fromZ, float toX, float toY, float toZ);
+	virtual void RayTestBatch(const float *from, const float *to, unsigned int numRays, unsigned short mask, PHY_RayCastBatchResult *results);
 	virtual bool CullingTest(PHY_CullingCallback callback, void *userData, MT_Vector4 * planes, int nplanes, int occlusionRes, const int *viewport, float modelview[16], float projection[16]);
 
 
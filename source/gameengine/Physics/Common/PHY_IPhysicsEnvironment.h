@@ -66,6 +66,16 @@ struct PHY_RayCastResult {
 	MT_Vector2 m_hitUV; // UV coordinates of hit point
 };
 
+/**
+ * Closest hit of a ray cast by RayTestBatch, m_controller is nullptr if the ray hit nothing.
+ */
+struct PHY_RayCastBatchResult {
+	PHY_IPhysicsController *m_controller;
+	float m_hitPoint[3];
+	float m_hitNormal[3];
+	float m_hitFraction; // fraction of the ray segment at the hit point
+};
+
 /**
  * This class replaces the ignoreController parameter of rayTest function.
  * It allows more sophisticated filtering on the physics controller before computing the ray intersection to save CPU.
@@ -112,6 +122,21 @@ public:
 	virtual void EndFrame() = 0;
 	/// Perform an integration step of duration 'timeStep'.
 	virtual bool ProceedDeltaTime(double curTime, float timeStep, float interval) = 0;
+	/** Return true if ProceedDeltaTime can be called in a thread concurrently with
+	 * the ProceedDeltaTime of an other environment. BeginFrame is always called
+	 * before from the main thread.
+	 */
+	virtual bool CanProceedConcurrently(PHY_IPhysicsEnvironment *other) const
+	{
+		return false;
+	}
+	/** Return true if ProceedDeltaTime can be called in a thread while the scene
+	 * is rendered, the physics must then not be read by the render.
+	 */
+	virtual bool CanProceedAsynchronously() const
+	{
+		return false;
+	}
 	/// draw debug lines (make sure to call this during the render phase, otherwise lines are not drawn properly)
 	virtual void DebugDrawWorld()
 	{
@@ -204,6 +229,13 @@ public:
 	virtual PHY_ICharacter *GetCharacterController(class KX_GameObject *ob) = 0;
 
 	virtual PHY_IPhysicsController *RayTest(PHY_IRayCastFilterCallback &filterCallback, float fromX, float fromY, float fromZ, float toX, float toY, float toZ) = 0;
+	/** Cast several rays at once, the sensor objects and the objects out of the user collision
+	 * group mask are ignored.
+	 * \param from The start points of the rays, numRays * 3 floats.
+	 * \param to The end points of the rays, numRays * 3 floats.
+	 * \param results The closest hit of each ray, numRays results.
+	 */
+	virtual void RayTestBatch(const float *from, const float *to, unsigned int numRays, unsigned short mask, PHY_RayCastBatchResult *results) = 0;
 
 	// culling based on physical broad phase
 	// the plane number must be set as follow: near, far, left, right, top, botton
@@ -66,6 +66,17 @@ bool DummyPhysicsEnvironment::ProceedDeltaTime(double curTime, float timeStep, f
 	return true;
 }
 
+bool DummyPhysicsEnvironment::CanProceedConcurrently(PHY_IPhysicsEnvironment *other) const
+{
+	// Nothing is shared, there's nothing to simulate.
+	return true;
+}
+
+bool DummyPhysicsEnvironment::CanProceedAsynchronously() const
+{
+	return true;
+}
+
 void DummyPhysicsEnvironment::SetFixedTimeStep(bool useFixedTimeStep, float fixedTimeStep)
 {
 }
@@ -109,3 +120,11 @@ PHY_IPhysicsController *DummyPhysicsEnvironment::RayTest(PHY_IRayCastFilterCallb
 	return nullptr;
 }
 
+void DummyPhysicsEnvironment::RayTestBatch(const float *from, const float *to, unsigned int numRays, unsigned short mask, PHY_RayCastBatchResult *results)
+{
+	for (unsigned int i = 0; i < numRays; ++i) {
+		results[i].m_controller = nullptr;
+		results[i].m_hitFraction = 1.0f;
+	}
+}
+
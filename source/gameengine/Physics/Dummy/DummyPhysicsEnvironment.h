@@ -52,6 +52,8 @@ public:
 	virtual void EndFrame();
 // Perform an integration step of duration 'timeStep'.
 	virtual bool ProceedDeltaTime(double curTime, float timeStep, float interval);
+	virtual bool CanProceedConcurrently(PHY_IPhysicsEnvironment *other) const;
+	virtual bool CanProceedAsynchronously() const;
 	virtual void SetFixedTimeStep(bool useFixedTimeStep, float fixedTimeStep);
 	virtual float GetFixedTimeStep();
 
@@ -81,6 +83,7 @@ public:
 	}
 
 	virtual PHY_IPhysicsController *RayTest(PHY_IRayCastFilterCallback &filterCallback, float fromX, float fromY, float fromZ, float toX, float toY, float toZ);
+	virtual void RayTestBatch(const float *from, const float *to, unsigned int numRays, unsigned short mask, PHY_RayCastBatchResult *results);
 	virtual bool CullingTest(PHY_CullingCallback callback, void *userData, class MT_Vector4 *planes, int nplanes, int occlusionRes, const int *viewport, float modelview[16], float projection[16])
 	{
 		return false;
@@ -32,7 +32,6 @@ RAS_BoundingBox::RAS_BoundingBox(RAS_BoundingBoxManager *manager)
 	:m_modified(false),
 	m_aabbMin(0.0f, 0.0f, 0.0f),
 	m_aabbMax(0.0f, 0.0f, 0.0f),
-	m_users(0),
 	m_manager(manager)
 {
 	BLI_assert(m_manager);
@@ -52,34 +51,52 @@ RAS_BoundingBox *RAS_BoundingBox::GetReplica()
 
 void RAS_BoundingBox::ProcessReplica()
 {
-	m_users = 1;
+	// The users are added by the mesh users of the replica object.
+	m_users.clear();
 	m_manager->m_boundingBoxList.push_back(this);
+	if (m_modified) {
+		m_manager->m_modifiedBoundingBoxList.push_back(this);
+	}
+}
+
+void RAS_BoundingBox::SetModified()
+{
+	if (!m_modified) {
+		m_modified = true;
+		m_manager->m_modifiedBoundingBoxList.push_back(this);
+	}
 }
 
-void RAS_BoundingBox::AddUser()
+void RAS_BoundingBox::AddUser(RAS_MeshUser *user)
 {
-	++m_users;
+	m_users.push_back(user);
 	/* No one was using this bounding box previously. Then add it to the active
 	 * bounding box list in the manager.*/
-	if (m_users == 1) {
+	if (m_users.size() == 1) {
 		m_manager->m_activeBoundingBoxList.push_back(this);
 	}
 }
 
-void RAS_BoundingBox::RemoveUser()
+void RAS_BoundingBox::RemoveUser(RAS_MeshUser *user)
 {
-	--m_users;
-	BLI_assert(m_users >= 0);
+	std::vector<RAS_MeshUser *>::iterator userit = std::find(m_users.begin(), m_users.end(), user);
+	BLI_assert(userit != m_users.end());
+	m_users.erase(userit);
 
 	/* Some one was using this bounding box previously. Then remove it from the
 	 * active bounding box list. */
-	if (m_users == 0) {
+	if (m_users.empty()) {
 		RAS_BoundingBoxList::const_iterator it = std::find(m_manager->m_activeBoundingBoxList.begin(),
 														   m_manager->m_activeBoundingBoxList.end(), this);
 		m_manager->m_activeBoundingBoxList.erase(it);
 	}
 }
 
+const std::vector<RAS_MeshUser *>& RAS_BoundingBox::GetUsers() const
+{
+	return m_users;
+}
+
 void RAS_BoundingBox::SetManager(RAS_BoundingBoxManager *manager)
 {
 	m_manager = manager;
@@ -105,7 +122,7 @@ void RAS_BoundingBox::SetAabb(const MT_Vector3& aabbMin, const MT_Vector3& aabbM
 {
 	m_aabbMin = aabbMin;
 	m_aabbMax = aabbMax;
-	m_modified = true;
+	SetModified();
 }
 
 void RAS_BoundingBox::ExtendAabb(const MT_Vector3& aabbMin, const MT_Vector3& aabbMax)
@@ -116,13 +133,13 @@ void RAS_BoundingBox::ExtendAabb(const MT_Vector3& aabbMin, const MT_Vector3& aa
 	m_aabbMax.x() = std::max(m_aabbMax.x(), aabbMax.x());
 	m_aabbMax.y() = std::max(m_aabbMax.y(), aabbMax.y());
 	m_aabbMax.z() = std::max(m_aabbMax.z(), aabbMax.z());
-	m_modified = true;
+	SetModified();
 }
 
 void RAS_BoundingBox::CopyAabb(RAS_BoundingBox *other)
 {
 	other->GetAabb(m_aabbMin, m_aabbMax);
-	m_modified = true;
+	SetModified();
 }
 
 void RAS_BoundingBox::Update(bool force)
@@ -142,7 +159,7 @@ RAS_MeshBoundingBox::~RAS_MeshBoundingBox()
 RAS_BoundingBox *RAS_MeshBoundingBox::GetReplica()
 {
 	RAS_MeshBoundingBox *boundingBox = new RAS_MeshBoundingBox(*this);
-	boundingBox->m_users = 0;
+	boundingBox->ProcessReplica();
 	return boundingBox;
 }
 
@@ -183,5 +200,5 @@ void RAS_MeshBoundingBox::Update(bool force)
 		}
 	}
 
-	m_modified = true;
+	SetModified();
 }
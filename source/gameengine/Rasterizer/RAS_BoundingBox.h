@@ -31,6 +31,7 @@
 #include "MT_Vector3.h"
 
 class RAS_BoundingBoxManager;
+class RAS_MeshUser;
 
 class RAS_BoundingBox
 {
@@ -43,11 +44,14 @@ protected:
 	/// The AABB maximum.
 	MT_Vector3 m_aabbMax;
 
-	/// The number of mesh user using this bounding box.
-	int m_users;
+	/// The mesh users using this bounding box.
+	std::vector<RAS_MeshUser *> m_users;
 	/// The manager of all the bounding boxes of a scene.
 	RAS_BoundingBoxManager *m_manager;
 
+	/// Set the bounding box modified and record it in the manager.
+	void SetModified();
+
 public:
 	RAS_BoundingBox(RAS_BoundingBoxManager *manager);
 	virtual ~RAS_BoundingBox();
@@ -56,9 +60,11 @@ public:
 	void ProcessReplica();
 
 	/// Notice that the bounding box is used by one more mesh user.
-	void AddUser();
+	void AddUser(RAS_MeshUser *user);
 	/// Notice that the bounding box is left by one mesh user.
-	void RemoveUser();
+	void RemoveUser(RAS_MeshUser *user);
+	/// Return the mesh users using this bounding box.
+	const std::vector<RAS_MeshUser *>& GetUsers() const;
 
 	/// Change the bounding box manager. Used only for the libloading scene merge.
 	void SetManager(RAS_BoundingBoxManager *manager);
@@ -61,11 +61,23 @@ void RAS_BoundingBoxManager::Update(bool force)
 	}
 }
 
+const RAS_BoundingBoxList& RAS_BoundingBoxManager::GetModifiedBoundingBoxList() const
+{
+	return m_modifiedBoundingBoxList;
+}
+
 void RAS_BoundingBoxManager::ClearModified()
 {
-	for (RAS_BoundingBoxList::iterator it = m_activeBoundingBoxList.begin(), end = m_activeBoundingBoxList.end(); it != end; ++it) {
-		(*it)->ClearModified();
+	RAS_BoundingBoxList::iterator last = m_modifiedBoundingBoxList.begin();
+	for (RAS_BoundingBox *boundingBox : m_modifiedBoundingBoxList) {
+		if (boundingBox->GetUsers().empty()) {
+			*last++ = boundingBox;
+		}
+		else {
+			boundingBox->ClearModified();
+		}
 	}
+	m_modifiedBoundingBoxList.erase(last, m_modifiedBoundingBoxList.end());
 }
 
 void RAS_BoundingBoxManager::Merge(RAS_BoundingBoxManager *other)
@@ -79,4 +91,7 @@ void RAS_BoundingBoxManager::Merge(RAS_BoundingBoxManager *other)
 
 	m_activeBoundingBoxList.insert(m_activeBoundingBoxList.begin(), other->m_activeBoundingBoxList.begin(), other->m_activeBoundingBoxList.end());
 	other->m_activeBoundingBoxList.clear();
+
+	m_modifiedBoundingBoxList.insert(m_modifiedBoundingBoxList.end(), other->m_modifiedBoundingBoxList.begin(), other->m_modifiedBoundingBoxList.end());
+	other->m_modifiedBoundingBoxList.clear();
 }
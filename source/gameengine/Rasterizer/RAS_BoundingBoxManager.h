@@ -40,6 +40,10 @@ private:
 	 * These bounding boxes will be updated each frames.
 	 */
 	RAS_BoundingBoxList m_activeBoundingBoxList;
+	/** All the bounding boxes modified since the last call to ClearModified.
+	 * The users of these bounding boxes must update their bounds.
+	 */
+	RAS_BoundingBoxList m_modifiedBoundingBoxList;
 
 public:
 	RAS_BoundingBoxManager();
@@ -60,7 +64,11 @@ public:
 	 * \param force Force updating bounding box even if the display arrays are not modified.
 	 */
 	void Update(bool force);
-	/// Set all the active bounding box unmodified.
+	/// Return the bounding boxes modified since the last call to ClearModified.
+	const RAS_BoundingBoxList& GetModifiedBoundingBoxList() const;
+	/** Set all the modified bounding box used by a mesh user unmodified, the bounding
+	 * boxes without users stay modified until a mesh user uses them.
+	 */
 	void ClearModified();
 
 	/** Merge an other bounding box manager.
@@ -46,7 +46,7 @@ RAS_MeshUser::~RAS_MeshUser()
 	m_meshSlots.clear();
 
 	if (m_boundingBox) {
-		m_boundingBox->RemoveUser();
+		m_boundingBox->RemoveUser(this);
 	}
 
 	if (m_batchGroup) {
@@ -113,13 +113,13 @@ void RAS_MeshUser::SetMatrix(float *matrix)
 void RAS_MeshUser::SetBoundingBox(RAS_BoundingBox *boundingBox)
 {
 	if (m_boundingBox) {
-		m_boundingBox->RemoveUser();
+		m_boundingBox->RemoveUser(this);
 	}
 
 	m_boundingBox = boundingBox;
 
 	if (m_boundingBox) {
-		m_boundingBox->AddUser();
+		m_boundingBox->AddUser(this);
 	}
 }
 
@@ -31,6 +31,7 @@
 
 #include "SG_Node.h"
 #include "SG_Familly.h"
+#include "SG_TransformPool.h"
 #include "SG_Controller.h"
 
 #include <algorithm>
@@ -38,23 +39,25 @@
 static CM_ThreadMutex scheduleMutex;
 static CM_ThreadMutex transformMutex;
 
-SG_Node::SG_Node(void *clientobj, void *clientinfo, SG_Callbacks& callbacks)
+SG_Node::SG_Node(void *clientobj, void *clientinfo, SG_Callbacks& callbacks, SG_TransformPool *transformPool)
 	:SG_QList(),
 	m_SGclientObject(clientobj),
 	m_SGclientInfo(clientinfo),
 	m_callbacks(callbacks),
 	m_SGparent(nullptr),
-	m_localPosition(0.0f, 0.0f, 0.0f),
-	m_localRotation(1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f),
-	m_localScaling(1.0f, 1.0f, 1.0f),
-	m_worldPosition(0.0f, 0.0f, 0.0f),
-	m_worldRotation(1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f),
-	m_worldScaling(1.0f, 1.0f, 1.0f),
+	m_transformPool(transformPool),
+	m_transformIndex(m_transformPool->Allocate()),
 	m_parent_relation(nullptr),
 	m_familly(new SG_Familly()),
 	m_modified(true),
 	m_ogldirty(false)
 {
+	m_transformPool->LocalPosition(m_transformIndex).setValue(0.0f, 0.0f, 0.0f);
+	m_transformPool->LocalRotation(m_transformIndex).setIdentity();
+	m_transformPool->LocalScaling(m_transformIndex).setValue(1.0f, 1.0f, 1.0f);
+	m_transformPool->WorldPosition(m_transformIndex).setValue(0.0f, 0.0f, 0.0f);
+	m_transformPool->WorldRotation(m_transformIndex).setIdentity();
+	m_transformPool->WorldScaling(m_transformIndex).setValue(1.0f, 1.0f, 1.0f);
 }
 
 SG_Node::SG_Node(const SG_Node & other)
@@ -64,16 +67,13 @@ SG_Node::SG_Node(const SG_Node & other)
 	m_callbacks(other.m_callbacks),
 	m_children(other.m_children),
 	m_SGparent(other.m_SGparent),
-	m_localPosition(other.m_localPosition),
-	m_localRotation(other.m_localRotation),
-	m_localScaling(other.m_localScaling),
-	m_worldPosition(other.m_worldPosition),
-	m_worldRotation(other.m_worldRotation),
-	m_worldScaling(other.m_worldScaling),
+	m_transformPool(other.m_transformPool),
+	m_transformIndex(m_transformPool->Allocate()),
 	m_parent_relation(other.m_parent_relation->NewCopy()),
 	m_familly(new SG_Familly()),
 	m_ogldirty(false)
 {
+	CopyTransform(m_transformPool, other.m_transformIndex);
 }
 
 SG_Node::~SG_Node()
@@ -83,6 +83,18 @@ SG_Node::~SG_Node()
 	for (contit = m_SGcontrollers.begin(); contit != m_SGcontrollers.end(); ++contit) {
 		delete (*contit);
 	}
+
+	m_transformPool->Free(m_transformIndex);
+}
+
+void SG_Node::CopyTransform(SG_TransformPool *pool, unsigned int index)
+{
+	m_transformPool->LocalPosition(m_transformIndex) = pool->LocalPosition(index);
+	m_transformPool->LocalRotation(m_transformIndex) = pool->LocalRotation(index);
+	m_transformPool->LocalScaling(m_transformIndex) = pool->LocalScaling(index);
+	m_transformPool->WorldPosition(m_transformIndex) = pool->WorldPosition(index);
+	m_transformPool->WorldRotation(m_transformIndex) = pool->WorldRotation(index);
+	m_transformPool->WorldScaling(m_transformIndex) = pool->WorldScaling(index);
 }
 
 SG_Node *SG_Node::GetSGReplica()
@@ -444,15 +456,16 @@ bool SG_Node::UpdateSpatialData(const SG_Node *parent, double time, bool& parent
  */
 void SG_Node::RelativeTranslate(const MT_Vector3& trans, const SG_Node *parent, bool local)
 {
+	MT_Vector3& position = m_transformPool->LocalPosition(m_transformIndex);
 	if (local) {
-		m_localPosition += m_localRotation * trans;
+		position += m_transformPool->LocalRotation(m_transformIndex) * trans;
 	}
 	else {
 		if (parent) {
-			m_localPosition += trans * parent->GetWorldOrientation();
+			position += trans * parent->GetWorldOrientation();
 		}
 		else {
-			m_localPosition += trans;
+			position += trans;
 		}
 	}
 	SetModified();
@@ -460,13 +473,14 @@ void SG_Node::RelativeTranslate(const MT_Vector3& trans, const SG_Node *parent,
 
 void SG_Node::SetLocalPosition(const MT_Vector3& trans)
 {
-	m_localPosition = trans;
+	m_transformPool->LocalPosition(m_transformIndex) = trans;
 	SetModified();
 }
 
 void SG_Node::SetWorldPosition(const MT_Vector3& trans)
 {
-	m_worldPosition = trans;
+	m_transformPool->WorldPosition(m_transformIndex) = trans;
+	m_transformPool->SetWorldModified(m_transformIndex);
 }
 
 /**
@@ -478,7 +492,8 @@ void SG_Node::SetWorldPosition(const MT_Vector3& trans)
  */
 void SG_Node::RelativeRotate(const MT_Matrix3x3& rot, bool local)
 {
-	m_localRotation = m_localRotation * (
+	MT_Matrix3x3& rotation = m_transformPool->LocalRotation(m_transformIndex);
+	rotation = rotation * (
 		local ?
 		rot
 		:
@@ -488,80 +503,111 @@ void SG_Node::RelativeRotate(const MT_Matrix3x3& rot, bool local)
 
 void SG_Node::SetLocalOrientation(const MT_Matrix3x3& rot)
 {
-	m_localRotation = rot;
+	m_transformPool->LocalRotation(m_transformIndex) = rot;
 	SetModified();
 }
 
 void SG_Node::SetLocalOrientation(const float *rot)
 {
-	m_localRotation.setValue(rot);
+	m_transformPool->LocalRotation(m_transformIndex).setValue(rot);
 	SetModified();
 }
 
 void SG_Node::SetWorldOrientation(const MT_Matrix3x3& rot)
 {
-	m_worldRotation = rot;
+	m_transformPool->WorldRotation(m_transformIndex) = rot;
+	m_transformPool->SetWorldModified(m_transformIndex);
 }
 
 void SG_Node::RelativeScale(const MT_Vector3& scale)
 {
-	m_localScaling = m_localScaling * scale;
+	MT_Vector3& scaling = m_transformPool->LocalScaling(m_transformIndex);
+	scaling = scaling * scale;
 	SetModified();
 }
 
 void SG_Node::SetLocalScale(const MT_Vector3& scale)
 {
-	m_localScaling = scale;
+	m_transformPool->LocalScaling(m_transformIndex) = scale;
 	SetModified();
 }
 
 void SG_Node::SetWorldScale(const MT_Vector3& scale)
 {
-	m_worldScaling = scale;
+	m_transformPool->WorldScaling(m_transformIndex) = scale;
+	m_transformPool->SetWorldModified(m_transformIndex);
 }
 
 const MT_Vector3& SG_Node::GetLocalPosition() const
 {
-	return m_localPosition;
+	return m_transformPool->LocalPosition(m_transformIndex);
 }
 
 const MT_Matrix3x3& SG_Node::GetLocalOrientation() const
 {
-	return m_localRotation;
+	return m_transformPool->LocalRotation(m_transformIndex);
 }
 
 const MT_Vector3& SG_Node::GetLocalScale() const
 {
-	return m_localScaling;
+	return m_transformPool->LocalScaling(m_transformIndex);
 }
 
 const MT_Vector3& SG_Node::GetWorldPosition() const
 {
-	return m_worldPosition;
+	return m_transformPool->WorldPosition(m_transformIndex);
 }
 
 const MT_Matrix3x3& SG_Node::GetWorldOrientation() const
 {
-	return m_worldRotation;
+	return m_transformPool->WorldRotation(m_transformIndex);
 }
 
 const MT_Vector3& SG_Node::GetWorldScaling() const
 {
-	return m_worldScaling;
+	return m_transformPool->WorldScaling(m_transformIndex);
 }
 
 void SG_Node::SetWorldFromLocalTransform()
 {
-	m_worldPosition = m_localPosition;
-	m_worldScaling = m_localScaling;
-	m_worldRotation = m_localRotation;
+	m_transformPool->WorldPosition(m_transformIndex) = m_transformPool->LocalPosition(m_transformIndex);
+	m_transformPool->WorldScaling(m_transformIndex) = m_transformPool->LocalScaling(m_transformIndex);
+	m_transformPool->WorldRotation(m_transformIndex) = m_transformPool->LocalRotation(m_transformIndex);
+	m_transformPool->SetWorldModified(m_transformIndex);
 }
 
 MT_Transform SG_Node::GetWorldTransform() const
 {
-	return MT_Transform(m_worldPosition,
-	                    m_worldRotation.scaled(
-							m_worldScaling[0], m_worldScaling[1], m_worldScaling[2]));
+	const MT_Vector3& scaling = m_transformPool->WorldScaling(m_transformIndex);
+	return MT_Transform(m_transformPool->WorldPosition(m_transformIndex),
+	                    m_transformPool->WorldRotation(m_transformIndex).scaled(
+							scaling[0], scaling[1], scaling[2]));
+}
+
+const float *SG_Node::GetWorldMatrix() const
+{
+	return m_transformPool->GetWorldMatrix(m_transformIndex);
+}
+
+SG_TransformPool *SG_Node::GetTransformPool() const
+{
+	return m_transformPool;
+}
+
+void SG_Node::SetTransformPool(SG_TransformPool *transformPool)
+{
+	if (transformPool == m_transformPool) {
+		return;
+	}
+
+	SG_TransformPool *oldPool = m_transformPool;
+	const unsigned int oldIndex = m_transformIndex;
+
+	m_transformPool = transformPool;
+	m_transformIndex = m_transformPool->Allocate();
+	CopyTransform(oldPool, oldIndex);
+
+	oldPool->Free(oldIndex);
 }
 
 bool SG_Node::ComputeWorldTransforms(const SG_Node *parent, bool& parentUpdated)
@@ -45,6 +45,7 @@
 class SG_Controller;
 class SG_Familly;
 class SG_Node;
+class SG_TransformPool;
 
 typedef std::vector<SG_Controller *> SGControllerList;
 
@@ -108,7 +109,7 @@ typedef std::vector<SG_Node *> NodeList;
 class SG_Node : public SG_QList
 {
 public:
-	SG_Node(void *clientobj, void *clientinfo, SG_Callbacks& callbacks);
+	SG_Node(void *clientobj, void *clientinfo, SG_Callbacks& callbacks, SG_TransformPool *transformPool);
 	SG_Node(const SG_Node & other);
 	virtual ~SG_Node();
 
@@ -182,6 +183,12 @@ public:
 	 */
 	void UpdateWorldData(double time, bool parentUpdated = false);
 	void UpdateWorldDataThread(double time, bool parentUpdated = false);
+	/**
+	 * Update the spatial data of this node and its children from a thread
+	 * without locking the familly. The caller must ensure that no other
+	 * thread is updating the same nodes.
+	 */
+	void UpdateWorldDataThreadSchedule(double time, bool parentUpdated = false);
 
 	/**
 	 * Update the simulation time of this node. Iterate through
@@ -275,6 +282,10 @@ public:
 	void *GetSGClientInfo() const;
 	void SetSGClientInfo(void *clientInfo);
 
+	SG_TransformPool *GetTransformPool() const;
+	/// Move the transforms of this node to the pool of an other scene.
+	void SetTransformPool(SG_TransformPool *transformPool);
+
 	/**
 	 * Set the current simulation time for this node.
 	 * The implementation of this function runs through
@@ -331,6 +342,8 @@ public:
 
 	void SetWorldFromLocalTransform();
 	MT_Transform GetWorldTransform() const;
+	/// Return the OpenGL world matrix including the scaling.
+	const float *GetWorldMatrix() const;
 
 	bool ComputeWorldTransforms(const SG_Node *parent, bool& parentUpdated);
 
@@ -360,9 +373,9 @@ protected:
 	bool UpdateSpatialData(const SG_Node *parent, double time, bool& parentUpdated);
 
 private:
-	void UpdateWorldDataThreadSchedule(double time, bool parentUpdated = false);
-
 	void ProcessSGReplica(SG_Node **replica);
+	/// Copy the transforms of the slot index of pool in the slot of this node.
+	void CopyTransform(SG_TransformPool *pool, unsigned int index);
 
 	void *m_SGclientObject;
 	void *m_SGclientInfo;
@@ -379,13 +392,10 @@ private:
 	 */
 	SG_Node *m_SGparent;
 
-	MT_Vector3 m_localPosition;
-	MT_Matrix3x3 m_localRotation;
-	MT_Vector3 m_localScaling;
-
-	MT_Vector3 m_worldPosition;
-	MT_Matrix3x3 m_worldRotation;
-	MT_Vector3 m_worldScaling;
+	/// The pool of the scene storing the local and world transforms.
+	SG_TransformPool *m_transformPool;
+	/// Index of the transforms in m_transformPool.
+	unsigned int m_transformIndex;
 
 	std::unique_ptr<SG_ParentRelation> m_parent_relation;
 
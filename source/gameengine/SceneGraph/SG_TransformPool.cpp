@@ -0,0 +1,157 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2001-2002 by NaN Holding BV.
+ * All rights reserved.
+ *
+ * The Original Code is: all of this file.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file gameengine/SceneGraph/SG_TransformPool.cpp
+ *  \ingroup bgesg
+ */
+
+#include "SG_TransformPool.h"
+
+#include "BLI_utildefines.h"
+
+#include <algorithm>
+#include <functional>
+
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
+SG_TransformPool::SG_TransformPool()
+	:m_size(0)
+{
+}
+
+SG_TransformPool::~SG_TransformPool()
+{
+	for (Chunk *chunk : m_chunks) {
+		delete chunk;
+	}
+}
+
+SG_TransformPool::Index SG_TransformPool::Allocate()
+{
+	Index index;
+	if (!m_freeIndices.empty()) {
+		// Reuse the lowest freed slot to keep the used slots packed.
+		std::pop_heap(m_freeIndices.begin(), m_freeIndices.end(), std::greater<Index>());
+		index = m_freeIndices.back();
+		m_freeIndices.pop_back();
+	}
+	else {
+		index = m_size++;
+		if ((index >> CHUNK_SHIFT) == m_chunks.size()) {
+			m_chunks.push_back(new Chunk);
+		}
+	}
+
+	SetWorldModified(index);
+
+	return index;
+}
+
+void SG_TransformPool::Free(Index index)
+{
+	BLI_assert(index < m_size);
+	m_freeIndices.push_back(index);
+	std::push_heap(m_freeIndices.begin(), m_freeIndices.end(), std::greater<Index>());
+}
+
+unsigned int SG_TransformPool::GetSize() const
+{
+	return m_size;
+}
+
+#ifdef __SSE2__
+/// Load 3 floats in the first lanes of a vector, the last lane is zero.
+static inline __m128 load3(const float *v)
+{
+	return _mm_movelh_ps(_mm_castpd_ps(_mm_load_sd((const double *)v)), _mm_load_ss(v + 2));
+}
+#endif
+
+void SG_TransformPool::UpdateChunkMatrices(Chunk *chunk, unsigned int start, unsigned int end)
+{
+#ifdef __SSE2__
+	// Clear the last lane of the columns, as the scalar code does even for an infinite scale.
+	const __m128 columnMask = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+	const __m128 zero = _mm_setzero_ps();
+#endif
+
+	for (unsigned int i = start; i < end; ++i) {
+		if (!chunk->m_worldModified[i]) {
+			continue;
+		}
+		chunk->m_worldModified[i] = false;
+
+		const MT_Matrix3x3& rot = chunk->m_worldRotations[i];
+		const MT_Vector3& scale = chunk->m_worldScalings[i];
+		const MT_Vector3& pos = chunk->m_worldPositions[i];
+		float *mat = chunk->m_worldMatrices[i];
+
+		// Same as MT_Transform::getValue of the world transform scaled.
+#ifdef __SSE2__
+		__m128 col0 = load3(rot[0].getValue());
+		__m128 col1 = load3(rot[1].getValue());
+		__m128 col2 = load3(rot[2].getValue());
+		__m128 col3 = zero;
+		// Transpose the rows to get the columns.
+		_MM_TRANSPOSE4_PS(col0, col1, col2, col3);
+
+		_mm_storeu_ps(mat, _mm_and_ps(_mm_mul_ps(col0, _mm_set1_ps(scale[0])), columnMask));
+		_mm_storeu_ps(mat + 4, _mm_and_ps(_mm_mul_ps(col1, _mm_set1_ps(scale[1])), columnMask));
+		_mm_storeu_ps(mat + 8, _mm_and_ps(_mm_mul_ps(col2, _mm_set1_ps(scale[2])), columnMask));
+#else
+		for (unsigned short j = 0; j < 3; ++j) {
+			mat[j * 4] = rot[0][j] * scale[j];
+			mat[j * 4 + 1] = rot[1][j] * scale[j];
+			mat[j * 4 + 2] = rot[2][j] * scale[j];
+			mat[j * 4 + 3] = 0.0f;
+		}
+#endif
+		mat[12] = pos[0];
+		mat[13] = pos[1];
+		mat[14] = pos[2];
+		mat[15] = 1.0f;
+	}
+}
+
+const float *SG_TransformPool::GetWorldMatrix(Index index)
+{
+	Chunk *chunk = GetChunk(index);
+	const unsigned int i = index & CHUNK_MASK;
+	UpdateChunkMatrices(chunk, i, i + 1);
+
+	return chunk->m_worldMatrices[i];
+}
+
+void SG_TransformPool::UpdateWorldMatrices()
+{
+	for (unsigned int i = 0, size = m_chunks.size(); i < size; ++i) {
+		const unsigned int end = std::min<unsigned int>(CHUNK_SIZE, m_size - (i << CHUNK_SHIFT));
+		UpdateChunkMatrices(m_chunks[i], 0, end);
+	}
+}
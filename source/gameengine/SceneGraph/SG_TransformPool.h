@@ -0,0 +1,146 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file SG_TransformPool.h
+ *  \ingroup bgesg
+ */
+
+#ifndef __SG_TRANSFORMPOOL_H__
+#define __SG_TRANSFORMPOOL_H__
+
+#include "MT_Vector3.h"
+#include "MT_Matrix3x3.h"
+
+#include <vector>
+
+/** Contiguous storage of the local and world transforms of the scene graph nodes of a scene.
+ * The transforms are stored as a structure of arrays split in fixed size chunks, a node
+ * only keeps its index in the pool. The pool grows by chunks which are never moved or freed
+ * until the pool is destructed, so a reference returned for an index stays valid until this
+ * index is freed.
+ *
+ * The pool also stores the OpenGL world matrix of every node. The matrices of the nodes
+ * whose world transform changed are recomputed by UpdateWorldMatrices in a linear sweep of
+ * the pool, or on demand by GetWorldMatrix for the nodes modified after the sweep.
+ *
+ * The transform propagation still walks the nodes through the scene graph as a parent must
+ * be updated before its children. The lowest free index is always reused so the used slots
+ * stay packed at the start of the pool.
+ */
+class SG_TransformPool
+{
+public:
+	typedef unsigned int Index;
+
+private:
+	enum {
+		CHUNK_SHIFT = 10,
+		CHUNK_SIZE = (1 << CHUNK_SHIFT),
+		CHUNK_MASK = (CHUNK_SIZE - 1)
+	};
+
+	struct Chunk
+	{
+		/// Column major world matrices, stored first to be aligned.
+		float m_worldMatrices[CHUNK_SIZE][16];
+
+		MT_Vector3 m_localPositions[CHUNK_SIZE];
+		MT_Matrix3x3 m_localRotations[CHUNK_SIZE];
+		MT_Vector3 m_localScalings[CHUNK_SIZE];
+
+		MT_Vector3 m_worldPositions[CHUNK_SIZE];
+		MT_Matrix3x3 m_worldRotations[CHUNK_SIZE];
+		MT_Vector3 m_worldScalings[CHUNK_SIZE];
+
+		/// True if the world transform changed since the world matrix was computed.
+		bool m_worldModified[CHUNK_SIZE];
+	};
+
+	std::vector<Chunk *> m_chunks;
+	/// Number of indices ever allocated, the next new index.
+	Index m_size;
+	/// Indices freed and available for the next allocations, a min-heap.
+	std::vector<Index> m_freeIndices;
+
+	inline Chunk *GetChunk(Index index) const
+	{
+		return m_chunks[index >> CHUNK_SHIFT];
+	}
+
+	/// Compute the world matrix of the slots [start, end) of a chunk.
+	static void UpdateChunkMatrices(Chunk *chunk, unsigned int start, unsigned int end);
+
+public:
+	SG_TransformPool();
+	~SG_TransformPool();
+
+	/** Reserve a slot for a node transform, the values of the slot are undefined.
+	 * The pool grows when all the slots are used.
+	 * \return The index of the slot.
+	 */
+	Index Allocate();
+	/// Release a slot previously returned by Allocate.
+	void Free(Index index);
+
+	/// Return the number of slots ever allocated, the end of the used indices.
+	unsigned int GetSize() const;
+
+	inline MT_Vector3& LocalPosition(Index index)
+	{
+		return GetChunk(index)->m_localPositions[index & CHUNK_MASK];
+	}
+	inline MT_Matrix3x3& LocalRotation(Index index)
+	{
+		return GetChunk(index)->m_localRotations[index & CHUNK_MASK];
+	}
+	inline MT_Vector3& LocalScaling(Index index)
+	{
+		return GetChunk(index)->m_localScalings[index & CHUNK_MASK];
+	}
+	/// The world accessors must be followed by SetWorldModified when the transform is written.
+	inline MT_Vector3& WorldPosition(Index index)
+	{
+		return GetChunk(index)->m_worldPositions[index & CHUNK_MASK];
+	}
+	inline MT_Matrix3x3& WorldRotation(Index index)
+	{
+		return GetChunk(index)->m_worldRotations[index & CHUNK_MASK];
+	}
+	inline MT_Vector3& WorldScaling(Index index)
+	{
+		return GetChunk(index)->m_worldScalings[index & CHUNK_MASK];
+	}
+
+	/// Notify that the world transform of a slot changed and its matrix must be recomputed.
+	inline void SetWorldModified(Index index)
+	{
+		GetChunk(index)->m_worldModified[index & CHUNK_MASK] = true;
+	}
+
+	/// Return the world matrix of a slot, recomputed if the world transform changed.
+	const float *GetWorldMatrix(Index index);
+
+	/// Recompute the world matrices of all the modified slots in the pool order.
+	void UpdateWorldMatrices();
+};
+
+#endif  /* __SG_TRANSFORMPOOL_H__ */
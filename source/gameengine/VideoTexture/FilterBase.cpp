@@ -34,6 +34,10 @@
 #include "EXP_PyObjectPlus.h"
 #include <structmember.h>
 
+#if defined(__SSE2__) && !defined(__BIG_ENDIAN__)
+#  include <emmintrin.h>
+#endif
+
 
 // FilterBase class implementation
 
@@ -85,6 +89,28 @@ FilterBase * FilterBase::findFirst (void)
 
 
 
+// swap blue and red channels of pixels
+void swapPixelsBR(const unsigned int *src, unsigned int *dst, unsigned int count)
+{
+	unsigned int i = 0;
+#if defined(__SSE2__) && !defined(__BIG_ENDIAN__)
+	// same as VT_SWAPBR on four pixels at once
+	const __m128i maskRB = _mm_set1_epi32(0xFF);
+	const __m128i maskGA = _mm_set1_epi32(0xFF00FF00);
+	for (; i + 4 <= count; i += 4) {
+		const __m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+		const __m128i r = _mm_slli_epi32(_mm_and_si128(v, maskRB), 16);
+		const __m128i b = _mm_and_si128(_mm_srli_epi32(v, 16), maskRB);
+		_mm_storeu_si128((__m128i *)(dst + i), _mm_or_si128(_mm_or_si128(r, b), _mm_and_si128(v, maskGA)));
+	}
+#endif
+	for (; i < count; ++i) {
+		const unsigned int v = src[i];
+		dst[i] = VT_SWAPBR(v);
+	}
+}
+
+
 // list offilter types
 PyTypeList pyFilterTypes;
 
@@ -83,6 +83,20 @@ public:
 			convertPrevious(src, x, y, size, pixSize));
 	}
 
+	/** convert a row of pixels at once
+	 * \return false if a filter of the chain can't convert rows, the pixels must then be converted one by one
+	 */
+	template <class SRC> bool convertRow (SRC src, unsigned int *dst, short y, short * size,
+		unsigned int pixSize)
+	{
+		// the first filter of the chain converts the source row
+		if (m_previous == nullptr)
+			return filterRow(src, dst, y, size, pixSize);
+		// the other filters are applied in place on the row converted by the previous filters
+		return m_previous->m_filter->convertRow(src, dst, y, size, pixSize)
+			&& filterSpan(src, dst, y, size, pixSize);
+	}
+
 	/// get previous filter
 	PyFilter * getPrevious (void) { return m_previous; }
 	/// set previous filter
@@ -111,6 +125,26 @@ protected:
 	                            short *size, unsigned int pixSize, unsigned int val = 0)
 	{ return val; }
 
+	/// filter row of size[0] pixels, source byte buffer
+	virtual bool filterRow(unsigned char *src, unsigned int *dst, short y, short *size, unsigned int pixSize)
+	{ return false; }
+	/// filter row of size[0] pixels, source int buffer
+	virtual bool filterRow(unsigned int *src, unsigned int *dst, short y, short *size, unsigned int pixSize)
+	{ return false; }
+	/// filter row of size[0] pixels, source float buffer
+	virtual bool filterRow(float *src, unsigned int *dst, short y, short *size, unsigned int pixSize)
+	{ return false; }
+
+	/// filter in place a row of size[0] pixels converted by the previous filters, source byte buffer
+	virtual bool filterSpan(unsigned char *src, unsigned int *dst, short y, short *size, unsigned int pixSize)
+	{ return false; }
+	/// filter in place a row of size[0] pixels converted by the previous filters, source int buffer
+	virtual bool filterSpan(unsigned int *src, unsigned int *dst, short y, short *size, unsigned int pixSize)
+	{ return false; }
+	/// filter in place a row of size[0] pixels converted by the previous filters, source float buffer
+	virtual bool filterSpan(float *src, unsigned int *dst, short y, short *size, unsigned int pixSize)
+	{ return false; }
+
 	/// get source pixel size
 	virtual unsigned int getPixelSize(void) { return 1; }
 
@@ -126,6 +160,10 @@ protected:
 };
 
 
+/// copy pixels swapping their blue and red channels, source and destination can be the same
+void swapPixelsBR(const unsigned int *src, unsigned int *dst, unsigned int count);
+
+
 // list of python filter types
 extern PyTypeList pyFilterTypes;
 
@@ -36,6 +36,12 @@
 #include "FilterBase.h"
 #include "PyTypeList.h"
 
+#include <algorithm>
+
+#if defined(__SSE2__) && !defined(__BIG_ENDIAN__)
+#  include <emmintrin.h>
+#endif
+
 // implementation FilterBlueScreen
 
 // constructor
@@ -67,6 +73,57 @@ void FilterBlueScreen::setLimits (unsigned short minLimit, unsigned short maxLim
 	m_limitDist = m_squareLimits[1] - m_squareLimits[0];
 }
 
+// filter pixels in place
+void FilterBlueScreen::filterPixels (unsigned int *pixels, unsigned int count)
+{
+	unsigned int i = 0;
+#if defined(__SSE2__) && !defined(__BIG_ENDIAN__)
+	// the distance can't exceed 3 * 255 * 255, clamp the limits to compare them as signed integers
+	const unsigned int maxDist = 3 * 255 * 255 + 1;
+	const __m128i minLimit = _mm_set1_epi32(std::min(m_squareLimits[0], maxDist));
+	const __m128i maxLimit = _mm_set1_epi32(std::min(m_squareLimits[1], maxDist));
+	// the alpha is ignored in the distance
+	const __m128i color = _mm_setr_epi16(m_color[0], m_color[1], m_color[2], 0, m_color[0], m_color[1], m_color[2], 0);
+	const __m128i colorMask = _mm_setr_epi16(-1, -1, -1, 0, -1, -1, -1, 0);
+	// the division is exact in double precision
+	const __m128d limitDist = _mm_set1_pd(double(m_limitDist));
+	const __m128i alphaMask = _mm_set1_epi32(0x00FFFFFF);
+	const __m128i opaque = _mm_set1_epi32(0xFF);
+	const __m128i zero = _mm_setzero_si128();
+	// four pixels at once
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128i pix = _mm_loadu_si128((__m128i *)(pixels + i));
+		// squared differences from the screen color
+		__m128i lo = _mm_and_si128(_mm_sub_epi16(_mm_unpacklo_epi8(pix, zero), color), colorMask);
+		__m128i hi = _mm_and_si128(_mm_sub_epi16(_mm_unpackhi_epi8(pix, zero), color), colorMask);
+		lo = _mm_madd_epi16(lo, lo);
+		hi = _mm_madd_epi16(hi, hi);
+		// add the pairs of differences of each pixel
+		__m128 loPs = _mm_castsi128_ps(lo);
+		__m128 hiPs = _mm_castsi128_ps(hi);
+		__m128i dist = _mm_add_epi32(
+			_mm_castps_si128(_mm_shuffle_ps(loPs, hiPs, _MM_SHUFFLE(2, 0, 2, 0))),
+			_mm_castps_si128(_mm_shuffle_ps(loPs, hiPs, _MM_SHUFFLE(3, 1, 3, 1))));
+		// alpha of the distances between the limits
+		__m128i dif = _mm_slli_epi32(_mm_sub_epi32(dist, minLimit), 8);
+		__m128d alphaLo = _mm_div_pd(_mm_cvtepi32_pd(dif), limitDist);
+		__m128d alphaHi = _mm_div_pd(_mm_cvtepi32_pd(_mm_unpackhi_epi64(dif, dif)), limitDist);
+		__m128i alpha = _mm_unpacklo_epi64(_mm_cvttpd_epi32(alphaLo), _mm_cvttpd_epi32(alphaHi));
+		// fully opaque color above the maximum limit
+		__m128i belowMax = _mm_cmplt_epi32(dist, maxLimit);
+		alpha = _mm_or_si128(_mm_and_si128(belowMax, alpha), _mm_andnot_si128(belowMax, opaque));
+		// fully transparent color below the minimum limit
+		alpha = _mm_and_si128(alpha, _mm_cmpgt_epi32(dist, minLimit));
+		pix = _mm_or_si128(_mm_and_si128(pix, alphaMask), _mm_slli_epi32(alpha, 24));
+		_mm_storeu_si128((__m128i *)(pixels + i), pix);
+	}
+#endif
+	// remaining pixels
+	for (; i < count; ++i)
+		pixels[i] = tFilter(pixels + i, 0, 0, nullptr, 1, pixels[i]);
+}
+
 
 
 // cast Filter pointer to FilterBlueScreen
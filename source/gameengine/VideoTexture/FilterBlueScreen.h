@@ -99,6 +99,18 @@ protected:
 	virtual unsigned int filter (unsigned int *src, short x, short y,
 	                             short * size, unsigned int pixSize, unsigned int val = 0)
 	{ return tFilter(src, x, y, size, pixSize, val); }
+
+	/// filter pixels in place
+	void filterPixels (unsigned int *pixels, unsigned int count);
+
+	/// virtual row filtering function for byte source
+	virtual bool filterSpan (unsigned char *src, unsigned int *dst, short y,
+	                         short * size, unsigned int pixSize)
+	{ filterPixels(dst, size[0]); return true; }
+	/// virtual row filtering function for unsigned int source
+	virtual bool filterSpan (unsigned int *src, unsigned int *dst, short y,
+	                         short * size, unsigned int pixSize)
+	{ filterPixels(dst, size[0]); return true; }
 };
 
 
@@ -36,8 +36,92 @@
 #include "FilterBase.h"
 #include "PyTypeList.h"
 
+#if defined(__SSE2__) && !defined(__BIG_ENDIAN__)
+#  include <emmintrin.h>
+#endif
+
+
+// color matrix calculation shared by the row filters
+
+// calculate one color component
+static inline unsigned char calcMatrixColor (const ColorMatrix & matrix, unsigned int val, short idx)
+{
+	return (((matrix[idx][0] * (VT_R(val)) + matrix[idx][1] * (VT_G(val)) +
+	          matrix[idx][2] * (VT_B(val)) + matrix[idx][3] * (VT_A(val)) +
+	          matrix[idx][4]) >> 8) & 0xFF);
+}
+
+#if defined(__SSE2__) && !defined(__BIG_ENDIAN__)
+// calculate the color of two pixels unpacked to 16 bits, return the components as 16 bits
+static inline __m128i calcMatrixColor2 (__m128i pix, const __m128i coefs[4], __m128i offset, __m128i mask)
+{
+	// sums of the products of the components pairs, for both pixels
+	__m128i sum0 = _mm_madd_epi16(pix, coefs[0]);
+	__m128i sum1 = _mm_madd_epi16(pix, coefs[1]);
+	__m128i sum2 = _mm_madd_epi16(pix, coefs[2]);
+	__m128i sum3 = _mm_madd_epi16(pix, coefs[3]);
+	// transpose to get the pairs of each pixel together
+	__m128i sum01lo = _mm_unpacklo_epi32(sum0, sum1);
+	__m128i sum01hi = _mm_unpackhi_epi32(sum0, sum1);
+	__m128i sum23lo = _mm_unpacklo_epi32(sum2, sum3);
+	__m128i sum23hi = _mm_unpackhi_epi32(sum2, sum3);
+	__m128i first = _mm_add_epi32(_mm_unpacklo_epi64(sum01lo, sum23lo), _mm_unpackhi_epi64(sum01lo, sum23lo));
+	__m128i second = _mm_add_epi32(_mm_unpacklo_epi64(sum01hi, sum23hi), _mm_unpackhi_epi64(sum01hi, sum23hi));
+	first = _mm_and_si128(_mm_srai_epi32(_mm_add_epi32(first, offset), 8), mask);
+	second = _mm_and_si128(_mm_srai_epi32(_mm_add_epi32(second, offset), 8), mask);
+	return _mm_packs_epi32(first, second);
+}
+#endif
+
+// apply color matrix to pixels in place
+static void applyColorMatrix (unsigned int * pixels, unsigned int count, const ColorMatrix & matrix)
+{
+	unsigned int i = 0;
+#if defined(__SSE2__) && !defined(__BIG_ENDIAN__)
+	// coefficients of each output component, repeated for two pixels
+	__m128i coefs[4];
+	for (int c = 0; c < 4; ++c)
+		coefs[c] = _mm_setr_epi16(matrix[c][0], matrix[c][1], matrix[c][2], matrix[c][3],
+		                          matrix[c][0], matrix[c][1], matrix[c][2], matrix[c][3]);
+	const __m128i offset = _mm_setr_epi32(matrix[0][4], matrix[1][4], matrix[2][4], matrix[3][4]);
+	const __m128i mask = _mm_set1_epi32(0xFF);
+	const __m128i zero = _mm_setzero_si128();
+	// four pixels at once
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128i pix = _mm_loadu_si128((__m128i *)(pixels + i));
+		__m128i lo = calcMatrixColor2(_mm_unpacklo_epi8(pix, zero), coefs, offset, mask);
+		__m128i hi = calcMatrixColor2(_mm_unpackhi_epi8(pix, zero), coefs, offset, mask);
+		_mm_storeu_si128((__m128i *)(pixels + i), _mm_packus_epi16(lo, hi));
+	}
+#endif
+	// remaining pixels
+	for (; i < count; ++i)
+	{
+		unsigned int val = pixels[i];
+		unsigned int color;
+		VT_RGBA(color, calcMatrixColor(matrix, val, 0), calcMatrixColor(matrix, val, 1),
+			calcMatrixColor(matrix, val, 2), calcMatrixColor(matrix, val, 3));
+		pixels[i] = color;
+	}
+}
+
+
 // implementation FilterGray
 
+// filter pixels in place
+void FilterGray::filterPixels (unsigned int * pixels, unsigned int count)
+{
+	// gray value in color components, alpha unchanged
+	static const ColorMatrix grayMatrix = {
+		{77, 151, 28, 0, 0},
+		{77, 151, 28, 0, 0},
+		{77, 151, 28, 0, 0},
+		{0, 0, 0, 256, 0}
+	};
+	applyColorMatrix(pixels, count, grayMatrix);
+}
+
 // attributes structure
 static PyGetSetDef filterGrayGetSets[] =
 { // attributes from FilterBase class
@@ -109,6 +193,12 @@ void FilterColor::setMatrix (ColorMatrix & mat)
 			m_matrix[r][c] = mat[r][c]; 
 }
 
+// filter pixels in place
+void FilterColor::filterPixels (unsigned int * pixels, unsigned int count)
+{
+	applyColorMatrix(pixels, count, m_matrix);
+}
+
 
 
 // cast Filter pointer to FilterColor
@@ -245,6 +335,13 @@ void FilterLevel::setLevels (ColorLevel & lev)
 	}
 }
 
+// filter pixels in place
+void FilterLevel::filterPixels (unsigned int * pixels, unsigned int count)
+{
+	for (unsigned int i = 0; i < count; ++i)
+		pixels[i] = tFilter(pixels + i, 0, 0, nullptr, 1, pixels[i]);
+}
+
 
 // cast Filter pointer to FilterLevel
 inline FilterLevel * getFilterLevel (PyFilter *self)
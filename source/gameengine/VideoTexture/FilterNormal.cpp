@@ -36,6 +36,10 @@
 #include "FilterBase.h"
 #include "PyTypeList.h"
 
+#if defined(__SSE2__) && !defined(__BIG_ENDIAN__)
+#  include <emmintrin.h>
+#endif
+
 // implementation FilterNormal
 
 // constructor
@@ -61,6 +65,58 @@ void FilterNormal::setDepth (float depth)
 	m_depthScale = depth / depthScaleKoef;
 }
 
+// filter pixels in place
+void FilterNormal::filterPixels (unsigned int * pixels, const unsigned int * up, unsigned int count)
+{
+	// the pixels are filtered from right to left to read the left pixels before they change
+	int x = count;
+#if defined(__SSE2__) && !defined(__BIG_ENDIAN__)
+	const __m128i shift = _mm_cvtsi32_si128(m_colIdx * 8);
+	const __m128i mask = _mm_set1_epi32(0xFF);
+	const __m128i alpha = _mm_set1_epi32(0xFF000000);
+	const __m128 depthScale = _mm_set1_ps(m_depthScale);
+	const __m128 scaleKoef = _mm_set1_ps(normScaleKoef);
+	// the scale is calculated in double precision like the pixel filter
+	const __m128d scaleKoefD = _mm_set1_pd(normScaleKoef);
+	const __m128d one = _mm_set1_pd(1.0);
+	// four pixels at once, the first pixel of the row has no left pixel
+	for (; x >= 5; )
+	{
+		x -= 4;
+		__m128i act = _mm_loadu_si128((__m128i *)(pixels + x));
+		__m128i left = _mm_loadu_si128((__m128i *)(pixels + x - 1));
+		__m128i upper = (up) ? _mm_loadu_si128((__m128i *)(up + x)) : act;
+		act = _mm_and_si128(_mm_srl_epi32(act, shift), mask);
+		left = _mm_and_si128(_mm_srl_epi32(left, shift), mask);
+		upper = _mm_and_si128(_mm_srl_epi32(upper, shift), mask);
+		// height differences
+		__m128 dx = _mm_mul_ps(_mm_cvtepi32_ps(_mm_sub_epi32(act, left)), depthScale);
+		__m128 dy = _mm_mul_ps(_mm_cvtepi32_ps(_mm_sub_epi32(act, upper)), depthScale);
+		// normalize vector
+		__m128 len = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+		__m128d lenLo = _mm_sqrt_pd(_mm_add_pd(_mm_cvtps_pd(len), one));
+		__m128d lenHi = _mm_sqrt_pd(_mm_add_pd(_mm_cvtps_pd(_mm_movehl_ps(len, len)), one));
+		__m128 dz = _mm_movelh_ps(_mm_cvtpd_ps(_mm_div_pd(scaleKoefD, lenLo)),
+		                          _mm_cvtpd_ps(_mm_div_pd(scaleKoefD, lenHi)));
+		dx = _mm_add_ps(_mm_mul_ps(dx, dz), scaleKoef);
+		dy = _mm_add_ps(_mm_mul_ps(dy, dz), scaleKoef);
+		dz = _mm_add_ps(dz, scaleKoef);
+		// normal vector converted to color
+		__m128i normal = _mm_or_si128(_mm_or_si128(_mm_cvttps_epi32(dx), _mm_slli_epi32(_mm_cvttps_epi32(dy), 8)),
+		                              _mm_or_si128(_mm_slli_epi32(_mm_cvttps_epi32(dz), 16), alpha));
+		_mm_storeu_si128((__m128i *)(pixels + x), normal);
+	}
+#endif
+	// remaining pixels
+	while (--x >= 0)
+	{
+		int actPix = int(VT_C(pixels[x],m_colIdx));
+		int leftPix = (x > 0) ? int(VT_C(pixels[x - 1],m_colIdx)) : actPix;
+		int upPix = (up) ? int(VT_C(up[x],m_colIdx)) : actPix;
+		pixels[x] = calcNormal(actPix, leftPix, upPix);
+	}
+}
+
 
 // cast Filter pointer to FilterNormal
 inline FilterNormal * getFilter (PyFilter *self)
@@ -35,6 +35,8 @@
 
 #include "FilterBase.h"
 
+#include <vector>
+
 
 // scale constants for normals
 const float depthScaleKoef = 255.0;
@@ -69,6 +71,26 @@ protected:
 	/// color index, 0=red, 1=green, 2=blue, 3=alpha
 	unsigned short m_colIdx;
 
+	/// upper row converted by the previous filters for the row filtering
+	std::vector<unsigned int> m_upRow;
+
+	/// calculate normal from heights of actual, left and upper pixels
+	unsigned int calcNormal (int actPix, int leftPix, int upPix)
+	{
+		// height differences (from blue color)
+		float dx = (actPix - leftPix) * m_depthScale;
+		float dy = (actPix - upPix) * m_depthScale;
+		// normalize vector
+		float dz = float(normScaleKoef / sqrt(dx * dx + dy * dy + 1.0));
+		dx = dx * dz + normScaleKoef;
+		dy = dy * dz + normScaleKoef;
+		dz += normScaleKoef;
+		// return normal vector converted to color
+		unsigned int val;
+		VT_RGBA(val, dx, dy, dz, 0xFF);
+		return val;
+	}
+
 	/// filter pixel, source int buffer
 	template <class SRC> unsigned int tFilter (SRC *src, short x, short y,
 	                                           short * size, unsigned int pixSize, unsigned int val = 0)
@@ -88,17 +110,29 @@ protected:
 			val = convertPrevious(src - pixSize, x - 1, y, size, pixSize);
 			leftPix = VT_C(val,m_colIdx);
 		}
-		// height differences (from blue color)
-		float dx = (actPix - leftPix) * m_depthScale;
-		float dy = (actPix - upPix) * m_depthScale;
-		// normalize vector
-		float dz = float(normScaleKoef / sqrt(dx * dx + dy * dy + 1.0));
-		dx = dx * dz + normScaleKoef;
-		dy = dy * dz + normScaleKoef;
-		dz += normScaleKoef;
-		// return normal vector converted to color
-		VT_RGBA(val, dx, dy, dz, 0xFF);
-		return val;
+		return calcNormal(actPix, leftPix, upPix);
+	}
+
+	/** filter pixels in place
+	 * \param up Upper row of pixels, nullptr for the first row
+	 */
+	void filterPixels (unsigned int * pixels, const unsigned int * up, unsigned int count);
+
+	/// filter row template, the pixels of the row are already converted by the previous filters
+	template <class SRC> bool tFilterSpan (SRC *src, unsigned int * dst, short y,
+	                                       short * size, unsigned int pixSize)
+	{
+		const unsigned int * up = nullptr;
+		// convert upper row with previous filters
+		if (y > 0)
+		{
+			m_upRow.resize(size[0]);
+			if (!m_previous->m_filter->convertRow(src - pixSize * size[0], m_upRow.data(), y - 1, size, pixSize))
+				return false;
+			up = m_upRow.data();
+		}
+		filterPixels(dst, up, size[0]);
+		return true;
 	}
 
 	/// filter pixel, source byte buffer
@@ -109,6 +143,15 @@ protected:
 	virtual unsigned int filter (unsigned int * src, short x, short y,
 		short * size, unsigned int pixSize, unsigned int val = 0)
 	{ return tFilter(src, x, y, size, pixSize, val); }
+
+	/// filter row, source byte buffer
+	virtual bool filterSpan (unsigned char * src, unsigned int * dst, short y,
+		short * size, unsigned int pixSize)
+	{ return tFilterSpan(src, dst, y, size, pixSize); }
+	/// filter row, source int buffer
+	virtual bool filterSpan (unsigned int * src, unsigned int * dst, short y,
+		short * size, unsigned int pixSize)
+	{ return tFilterSpan(src, dst, y, size, pixSize); }
 };
 
 
@@ -52,6 +52,15 @@ protected:
 	virtual unsigned int filter (unsigned char *src, short x, short y,
 		short * size, unsigned int pixSize, unsigned int val)
 	{ VT_RGBA(val,src[0],src[1],src[2],0xFF); return val; }
+
+	/// filter row, source byte buffer
+	virtual bool filterRow (unsigned char *src, unsigned int *dst, short y,
+		short * size, unsigned int pixSize)
+	{
+		for (short x = 0; x < size[0]; ++x, ++dst, src += pixSize)
+			VT_RGBA(*dst,src[0],src[1],src[2],0xFF);
+		return true;
+	}
 };
 
 /// class for RGBA32 conversion
@@ -79,6 +88,15 @@ protected:
 			return val; 
 		}
 	}
+
+	/// filter row, source byte buffer
+	virtual bool filterRow (unsigned char *src, unsigned int *dst, short y,
+		short * size, unsigned int pixSize)
+	{
+		// the pixels are already in the destination format
+		memcpy(dst, src, size[0] * sizeof(unsigned int));
+		return true;
+	}
 };
 
 /// class for BGRA32 conversion
@@ -102,6 +120,17 @@ protected:
 		VT_RGBA(val,src[2],src[1],src[0],src[3]);
 		return val;
 	}
+
+	/// filter row, source byte buffer
+	virtual bool filterRow (unsigned char *src, unsigned int *dst, short y,
+		short * size, unsigned int pixSize)
+	{
+		// the pixels are read as integers, the source must be aligned
+		if ((intptr_t(src)&0x3) != 0)
+			return false;
+		swapPixelsBR((unsigned int *)src, dst, size[0]);
+		return true;
+	}
 };
 
 
@@ -122,6 +151,15 @@ protected:
 	virtual unsigned int filter (unsigned char *src, short x, short y,
 	                             short * size, unsigned int pixSize, unsigned int val)
 	{ VT_RGBA(val,src[2],src[1],src[0],0xFF); return val; }
+
+	/// filter row, source byte buffer
+	virtual bool filterRow (unsigned char *src, unsigned int *dst, short y,
+		short * size, unsigned int pixSize)
+	{
+		for (short x = 0; x < size[0]; ++x, ++dst, src += pixSize)
+			VT_RGBA(*dst,src[2],src[1],src[0],0xFF);
+		return true;
+	}
 };
 
 /// class for Z_buffer conversion
@@ -124,18 +124,13 @@ unsigned int * ImageBase::getImage (unsigned int texId, double ts)
 
 bool ImageBase::loadImage(unsigned int *buffer, unsigned int size, unsigned int format, double ts)
 {
-	unsigned int *d, *s, v, len;
 	if (getImage(0, ts) != nullptr && size >= getBuffSize()) {
 		switch (format) {
 		case GL_RGBA:
 			memcpy(buffer, m_image, getBuffSize());
 			break;
 		case GL_BGRA:
-			len = (unsigned int)m_size[0] * m_size[1];
-			for (s=m_image, d=buffer; len; len--) {
-				v = *s++;
-				*d++ = VT_SWAPBR(v);
-			}
+			swapPixelsBR(m_image, buffer, (unsigned int)m_size[0] * m_size[1]);
 			break;
 		default:
 			THRWEXCP(InvalidImageMode,S_OK);
@@ -214,14 +209,8 @@ void ImageBase::setFilter (PyFilter * filt)
 
 void ImageBase::swapImageBR()
 {
-	unsigned int size, v, *s;
-
 	if (m_avail) {
-		size = 1 * m_size[0] * m_size[1];
-		for (s=m_image; size; size--) {
-			v = *s;
-			*s++ = VT_SWAPBR(v);
-		}
+		swapPixelsBR(m_image, m_image, (unsigned int)m_size[0] * m_size[1]);
 	}
 }
 
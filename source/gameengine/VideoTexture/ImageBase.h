@@ -183,9 +183,16 @@ protected:
 			if (!m_flip)
 				// copy bitmap
 				for (short y = 0; y < m_size[1]; ++y)
-					for (short x = 0; x < m_size[0]; ++x, ++dstBuff, srcBuff += pixSize)
-						// copy pixel
-						*dstBuff = filter.convert(srcBuff, x, y, srcSize, pixSize);
+					// convert whole row if the filter supports it
+					if (filter.convertRow(srcBuff, dstBuff, y, srcSize, pixSize))
+					{
+						dstBuff += m_size[0];
+						srcBuff += m_size[0] * pixSize;
+					}
+					else
+						for (short x = 0; x < m_size[0]; ++x, ++dstBuff, srcBuff += pixSize)
+							// copy pixel
+							*dstBuff = filter.convert(srcBuff, x, y, srcSize, pixSize);
 		// otherwise flip image top to bottom
 			else
 			{
@@ -193,9 +200,16 @@ protected:
 				srcBuff += srcSize[0] * (srcSize[1] - 1) * pixSize;
 				// copy bitmap
 				for (short y = m_size[1] - 1; y >= 0; --y, srcBuff -= 2 * srcSize[0] * pixSize)
-					for (short x = 0; x < m_size[0]; ++x, ++dstBuff, srcBuff += pixSize)
-						// copy pixel
-						*dstBuff = filter.convert(srcBuff, x, y, srcSize, pixSize);
+					// convert whole row if the filter supports it
+					if (filter.convertRow(srcBuff, dstBuff, y, srcSize, pixSize))
+					{
+						dstBuff += m_size[0];
+						srcBuff += m_size[0] * pixSize;
+					}
+					else
+						for (short x = 0; x < m_size[0]; ++x, ++dstBuff, srcBuff += pixSize)
+							// copy pixel
+							*dstBuff = filter.convert(srcBuff, x, y, srcSize, pixSize);
 			}
 			// else scale picture (nearest neighbor)
 		else
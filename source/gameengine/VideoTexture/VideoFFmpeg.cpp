@@ -57,27 +57,30 @@ const double defFrameRate = 25.0;
 #define CATCH_EXCP catch (Exception & exp) \
 { exp.report(); m_status = SourceError; }
 
+// maximum number of decoding threads of a codec when it is not set by the user,
+// above this the threads mostly wait on each other or on the other videos
+const int maxAutoThreadCount = 4;
+
+unsigned int VideoFFmpeg::m_openCodecs = 0;
+
 // class RenderVideo
 
 // constructor
 VideoFFmpeg::VideoFFmpeg (HRESULT * hRslt) : VideoBase(), 
 m_codec(nullptr), m_formatCtx(nullptr), m_codecCtx(nullptr), 
 m_frame(nullptr), m_frameDeinterlaced(nullptr), m_frameRGB(nullptr), m_imgConvertCtx(nullptr),
-m_deinterlace(false), m_preseek(0),	m_videoStream(-1), m_baseFrameRate(25.0),
+m_deinterlace(false), m_preseek(0), m_threadCount(0), m_videoStream(-1), m_baseFrameRate(25.0),
 m_lastFrame(-1),  m_eof(false), m_externTime(false), m_curPosition(-1), m_startTime(0), 
 m_captWidth(0), m_captHeight(0), m_captRate(0.f), m_isImage(false),
 m_isThreaded(false), m_isStreaming(false), m_stopThread(false), m_cacheStarted(false)
 {
 	// set video format
-	m_format = RGB24;
+	m_format = RGBA32;
 	// force flip because ffmpeg always return the image in the wrong orientation for texture
 	setFlip(true);
 	// construction is OK
 	*hRslt = S_OK;
 	BLI_listbase_clear(&m_thread);
-	pthread_mutex_init(&m_cacheMutex, nullptr);
-	BLI_listbase_clear(&m_frameCacheFree);
-	BLI_listbase_clear(&m_frameCacheBase);
 	BLI_listbase_clear(&m_packetCacheFree);
 	BLI_listbase_clear(&m_packetCacheBase);
 }
@@ -100,11 +103,7 @@ bool VideoFFmpeg::release()
 {
 	// release
 	stopCache();
-	if (m_codecCtx)
-	{
-		avcodec_close(m_codecCtx);
-		m_codecCtx = nullptr;
-	}
+	closeCodec();
 	if (m_formatCtx)
 	{
 		avformat_close_input(&m_formatCtx);
@@ -142,23 +141,12 @@ AVFrame	*VideoFFmpeg::allocFrameRGB()
 {
 	AVFrame *frame;
 	frame = av_frame_alloc();
-	if (m_format == RGBA32)
-	{
-		avpicture_fill((AVPicture*)frame, 
-			(uint8_t*)MEM_callocN(avpicture_get_size(
-				AV_PIX_FMT_RGBA,
-				m_codecCtx->width, m_codecCtx->height),
-				"ffmpeg rgba"),
-			AV_PIX_FMT_RGBA, m_codecCtx->width, m_codecCtx->height);
-	} else 
-	{
-		avpicture_fill((AVPicture*)frame, 
-			(uint8_t*)MEM_callocN(avpicture_get_size(
-				AV_PIX_FMT_RGB24,
-				m_codecCtx->width, m_codecCtx->height),
-				"ffmpeg rgb"),
-			AV_PIX_FMT_RGB24, m_codecCtx->width, m_codecCtx->height);
-	}
+	avpicture_fill((AVPicture*)frame, 
+		(uint8_t*)MEM_callocN(avpicture_get_size(
+			AV_PIX_FMT_RGBA,
+			m_codecCtx->width, m_codecCtx->height),
+			"ffmpeg rgba"),
+		AV_PIX_FMT_RGBA, m_codecCtx->width, m_codecCtx->height);
 	return frame;
 }
 
@@ -172,6 +160,25 @@ void VideoFFmpeg::initParams (short width, short height, float rate, bool image)
 }
 
 
+int VideoFFmpeg::getCodecThreadCount(void)
+{
+	if (m_threadCount > 0)
+		return m_threadCount;
+	// share the processors between this codec and the already open ones
+	int threadCount = BLI_system_thread_count() / (int)(m_openCodecs + 1);
+	return (threadCount < 1) ? 1 : ((threadCount > maxAutoThreadCount) ? maxAutoThreadCount : threadCount);
+}
+
+void VideoFFmpeg::closeCodec(void)
+{
+	if (m_codecCtx)
+	{
+		avcodec_close(m_codecCtx);
+		m_codecCtx = nullptr;
+		--m_openCodecs;
+	}
+}
+
 int VideoFFmpeg::openStream(const char *filename, AVInputFormat *inputFormat, AVDictionary **formatParams)
 {
 	AVFormatContext *formatCtx = nullptr;
@@ -217,6 +224,10 @@ int VideoFFmpeg::openStream(const char *filename, AVInputFormat *inputFormat, AV
 		return -1;
 	}
 	codecCtx->workaround_bugs = 1;
+	// decode with several threads, frame threading delays the frames by one per thread
+	// so it's only used for files and streams, an image or a camera only use slices
+	codecCtx->thread_count = getCodecThreadCount();
+	codecCtx->thread_type = (inputFormat || m_isImage) ? FF_THREAD_SLICE : (FF_THREAD_FRAME | FF_THREAD_SLICE);
 	if (avcodec_open2(codecCtx, codec, nullptr) < 0)
 	{
 		avformat_close_input(&formatCtx);
@@ -235,6 +246,7 @@ int VideoFFmpeg::openStream(const char *filename, AVInputFormat *inputFormat, AV
 
 	m_codec = codec;
 	m_codecCtx = codecCtx;
+	++m_openCodecs;
 	m_formatCtx = formatCtx;
 	m_videoStream = videoStream;
 	m_frame = av_frame_alloc();
@@ -248,44 +260,24 @@ int VideoFFmpeg::openStream(const char *filename, AVInputFormat *inputFormat, AV
 		"ffmpeg deinterlace"), 
 		m_codecCtx->pix_fmt, m_codecCtx->width, m_codecCtx->height);
 
-	// check if the pixel format supports Alpha
-	if (m_codecCtx->pix_fmt == AV_PIX_FMT_RGB32 ||
-		m_codecCtx->pix_fmt == AV_PIX_FMT_BGR32 ||
-		m_codecCtx->pix_fmt == AV_PIX_FMT_RGB32_1 ||
-		m_codecCtx->pix_fmt == AV_PIX_FMT_BGR32_1) 
-	{
-		// allocate buffer to store final decoded frame
-		m_format = RGBA32;
-		// allocate sws context
-		m_imgConvertCtx = sws_getContext(
-			m_codecCtx->width,
-			m_codecCtx->height,
-			m_codecCtx->pix_fmt,
-			m_codecCtx->width,
-			m_codecCtx->height,
-			AV_PIX_FMT_RGBA,
-			SWS_FAST_BILINEAR,
-			nullptr, nullptr, nullptr);
-	} else
-	{
-		// allocate buffer to store final decoded frame
-		m_format = RGB24;
-		// allocate sws context
-		m_imgConvertCtx = sws_getContext(
-			m_codecCtx->width,
-			m_codecCtx->height,
-			m_codecCtx->pix_fmt,
-			m_codecCtx->width,
-			m_codecCtx->height,
-			AV_PIX_FMT_RGB24,
-			SWS_FAST_BILINEAR,
-			nullptr, nullptr, nullptr);
-	}
+	// the frames are always converted to RGBA by the vectorized conversions of swscale,
+	// the alpha is opaque for pixel formats without alpha, the pixels are then copied
+	// row by row to the image without per pixel conversion
+	m_format = RGBA32;
+	// allocate sws context
+	m_imgConvertCtx = sws_getContext(
+		m_codecCtx->width,
+		m_codecCtx->height,
+		m_codecCtx->pix_fmt,
+		m_codecCtx->width,
+		m_codecCtx->height,
+		AV_PIX_FMT_RGBA,
+		SWS_FAST_BILINEAR,
+		nullptr, nullptr, nullptr);
 	m_frameRGB = allocFrameRGB();
 
 	if (!m_imgConvertCtx) {
-		avcodec_close(m_codecCtx);
-		m_codecCtx = nullptr;
+		closeCodec();
 		avformat_close_input(&m_formatCtx);
 		m_formatCtx = nullptr;
 		av_free(m_frame);
@@ -301,13 +293,49 @@ int VideoFFmpeg::openStream(const char *filename, AVInputFormat *inputFormat, AV
 	return 0;
 }
 
+// timestamp of the packet a decoded frame comes from
+static int64_t getFrameDts(AVFrame *frame, const AVPacket& packet)
+{
+	// with frame threading the decoded frame comes from a previous packet
+	return (frame->pkt_dts != AV_NOPTS_VALUE) ? frame->pkt_dts : packet.dts;
+}
+
+// convert a decoded frame to RGBA, deinterlace it first if needed
+void VideoFFmpeg::convertFrame(AVFrame *frame, AVFrame *frameRGB)
+{
+	AVFrame *input = frame;
+	if (m_deinterlace) 
+	{
+		if (avpicture_deinterlace(
+			(AVPicture*) m_frameDeinterlaced,
+			(const AVPicture*) frame,
+			m_codecCtx->pix_fmt,
+			m_codecCtx->width,
+			m_codecCtx->height) >= 0)
+		{
+			input = m_frameDeinterlaced;
+		}
+	}
+	// convert to RGBA
+	sws_scale(m_imgConvertCtx,
+		input->data,
+		input->linesize,
+		0,
+		m_codecCtx->height,
+		frameRGB->data,
+		frameRGB->linesize);
+}
+
 /*
  * This thread is used to load video frame asynchronously.
  * It provides a frame caching service. 
  * The main thread is responsible for positioning the frame pointer in the
  * file correctly before calling startCache() which starts this thread.
  * The cache is organized in two layers: 1) a cache of 20-30 undecoded packets to keep
- * memory and CPU low 2) a cache of 5 decoded frames. 
+ * memory and CPU low 2) a cache of 10 decoded frames. 
+ * The decoded frames are exchanged with the main thread through two lock free queues:
+ * this thread is the only one to fill the ready queue and to empty the free queue,
+ * the main thread is the only one to empty the ready queue and to fill the free queue.
  * If the main thread does not find the frame in the cache (because the video has restarted
  * or because the GE is lagging), it stops the cache with StopCache() (this is a synchronous
  * function: it sends a signal to stop the cache thread and wait for confirmation), then
@@ -323,12 +351,19 @@ void *VideoFFmpeg::cacheThread(void *data)
 	int frameFinished = 0;
 	double timeBase = av_q2d(video->m_formatCtx->streams[video->m_videoStream]->time_base);
 	int64_t startTs = video->m_formatCtx->streams[video->m_videoStream]->start_time;
+	// empty packet used to get the frames delayed by the decoder at the end of the file
+	AVPacket flushPacket;
+	av_init_packet(&flushPacket);
+	flushPacket.data = nullptr;
+	flushPacket.size = 0;
 
 	if (startTs == AV_NOPTS_VALUE)
 		startTs = 0;
 
 	while (!video->m_stopThread)
 	{
+		// true if nothing was read or decoded in this loop
+		bool idle = true;
 		// packet cache is used solely by this thread, no need to lock
 		// In case the stream/file contains other stream than the one we are looking for,
 		// allow a bit of cycling to get rid quickly of those frames
@@ -346,6 +381,7 @@ void *VideoFFmpeg::cacheThread(void *data)
 					av_dup_packet(&cachePacket->packet);
 					BLI_remlink(&video->m_packetCacheFree, cachePacket);
 					BLI_addtail(&video->m_packetCacheBase, cachePacket);
+					idle = false;
 					break;
 				} else {
 					// this is not a good packet for us, just leave it on free queue
@@ -362,14 +398,11 @@ void *VideoFFmpeg::cacheThread(void *data)
 				break;
 			}
 		}
-		// frame cache is also used by main thread, lock
 		if (currentFrame == nullptr) 
 		{
 			// no current frame being decoded, take free one
-			pthread_mutex_lock(&video->m_cacheMutex);
-			if ((currentFrame = (CacheFrame *)video->m_frameCacheFree.first) != nullptr)
-				BLI_remlink(&video->m_frameCacheFree, currentFrame);
-			pthread_mutex_unlock(&video->m_cacheMutex);
+			if ((currentFrame = video->m_frameCacheFree.front()) != nullptr)
+				video->m_frameCacheFree.pop();
 		}
 		if (currentFrame != nullptr)
 		{
@@ -383,6 +416,7 @@ void *VideoFFmpeg::cacheThread(void *data)
 				avcodec_decode_video2(video->m_codecCtx, 
 					video->m_frame, &frameFinished, 
 					&cachePacket->packet);
+				idle = false;
 				if (frameFinished) 
 				{
 					AVFrame * input = video->m_frame;
@@ -391,32 +425,11 @@ void *VideoFFmpeg::cacheThread(void *data)
 					if (   input->data[0]!=0 || input->data[1]!=0 
 						|| input->data[2]!=0 || input->data[3]!=0)
 					{
-						if (video->m_deinterlace) 
-						{
-							if (avpicture_deinterlace(
-								(AVPicture*) video->m_frameDeinterlaced,
-								(const AVPicture*) video->m_frame,
-								video->m_codecCtx->pix_fmt,
-								video->m_codecCtx->width,
-								video->m_codecCtx->height) >= 0)
-							{
-								input = video->m_frameDeinterlaced;
-							}
-						}
-						// convert to RGB24
-						sws_scale(video->m_imgConvertCtx,
-							input->data,
-							input->linesize,
-							0,
-							video->m_codecCtx->height,
-							currentFrame->frame->data,
-							currentFrame->frame->linesize);
+						video->convertFrame(input, currentFrame->frame);
 						// move frame to queue, this frame is necessarily the next one
-						video->m_curPosition = (long)((cachePacket->packet.dts-startTs) * (video->m_baseFrameRate*timeBase) + 0.5);
+						video->m_curPosition = (long)((getFrameDts(input, cachePacket->packet)-startTs) * (video->m_baseFrameRate*timeBase) + 0.5);
 						currentFrame->framePosition = video->m_curPosition;
-						pthread_mutex_lock(&video->m_cacheMutex);
-						BLI_addtail(&video->m_frameCacheBase, currentFrame);
-						pthread_mutex_unlock(&video->m_cacheMutex);
+						video->m_frameCacheBase.push(currentFrame);
 						currentFrame = nullptr;
 					}
 				}
@@ -425,26 +438,30 @@ void *VideoFFmpeg::cacheThread(void *data)
 			} 
 			if (currentFrame && endOfFile) 
 			{
+				// no more packet, get the frames still delayed in the decoder
+				avcodec_decode_video2(video->m_codecCtx, video->m_frame, &frameFinished, &flushPacket);
+				if (frameFinished)
+				{
+					video->convertFrame(video->m_frame, currentFrame->frame);
+					video->m_curPosition = (long)((getFrameDts(video->m_frame, flushPacket)-startTs) * (video->m_baseFrameRate*timeBase) + 0.5);
+					currentFrame->framePosition = video->m_curPosition;
+					video->m_frameCacheBase.push(currentFrame);
+					currentFrame = nullptr;
+					continue;
+				}
 				// no more packet and end of file => put a special frame that indicates that
 				currentFrame->framePosition = -1;
-				pthread_mutex_lock(&video->m_cacheMutex);
-				BLI_addtail(&video->m_frameCacheBase, currentFrame);
-				pthread_mutex_unlock(&video->m_cacheMutex);
+				video->m_frameCacheBase.push(currentFrame);
 				currentFrame = nullptr;
 				// no need to stay any longer in this thread
 				break;
 			}
 		}
 		// small sleep to avoid unnecessary looping
-		PIL_sleep_ms(10);
-	}
-	// before quitting, put back the current frame to queue to allow freeing
-	if (currentFrame)
-	{
-		pthread_mutex_lock(&video->m_cacheMutex);
-		BLI_addtail(&video->m_frameCacheFree, currentFrame);
-		pthread_mutex_unlock(&video->m_cacheMutex);
+		if (idle)
+			PIL_sleep_ms(10);
 	}
+	// the frame being decoded is freed with the cache
 	return 0;
 }
 
@@ -456,11 +473,13 @@ bool VideoFFmpeg::startCache()
 	if (!m_cacheStarted && m_isThreaded)
 	{
 		m_stopThread = false;
+		m_frameCacheBase.clear();
+		m_frameCacheFree.clear();
 		for (int i=0; i<CACHE_FRAME_SIZE; i++)
 		{
-			CacheFrame *frame = new CacheFrame();
+			CacheFrame *frame = &m_frameCache[i];
 			frame->frame = allocFrameRGB();
-			BLI_addtail(&m_frameCacheFree, frame);
+			m_frameCacheFree.push(frame);
 		}
 		for (int i=0; i<CACHE_PACKET_SIZE; i++) 
 		{
@@ -480,23 +499,17 @@ void VideoFFmpeg::stopCache()
 	{
 		m_stopThread = true;
 		BLI_end_threads(&m_thread);
-		// now delete the cache
-		CacheFrame *frame;
+		// now delete the cache, all the frames are owned by the cache whatever their queue
 		CachePacket *packet;
-		while ((frame = (CacheFrame *)m_frameCacheBase.first) != nullptr)
-		{
-			BLI_remlink(&m_frameCacheBase, frame);
-			MEM_freeN(frame->frame->data[0]);
-			av_free(frame->frame);
-			delete frame;
-		}
-		while ((frame = (CacheFrame *)m_frameCacheFree.first) != nullptr)
+		for (int i=0; i<CACHE_FRAME_SIZE; i++)
 		{
-			BLI_remlink(&m_frameCacheFree, frame);
+			CacheFrame *frame = &m_frameCache[i];
 			MEM_freeN(frame->frame->data[0]);
 			av_free(frame->frame);
-			delete frame;
+			frame->frame = nullptr;
 		}
+		m_frameCacheBase.clear();
+		m_frameCacheFree.clear();
 		while ((packet = (CachePacket *)m_packetCacheBase.first) != nullptr)
 		{
 			BLI_remlink(&m_packetCacheBase, packet);
@@ -520,12 +533,10 @@ void VideoFFmpeg::releaseFrame(AVFrame *frame)
 		return;
 	}
 	// this frame MUST be the first one of the queue
-	pthread_mutex_lock(&m_cacheMutex);
-	CacheFrame *cacheFrame = (CacheFrame *)m_frameCacheBase.first;
+	CacheFrame *cacheFrame = m_frameCacheBase.front();
 	assert (cacheFrame != nullptr && cacheFrame->frame == frame);
-	BLI_remlink(&m_frameCacheBase, cacheFrame);
-	BLI_addtail(&m_frameCacheFree, cacheFrame);
-	pthread_mutex_unlock(&m_cacheMutex);
+	m_frameCacheBase.pop();
+	m_frameCacheFree.push(cacheFrame);
 }
 
 // open video file
@@ -887,9 +898,7 @@ AVFrame *VideoFFmpeg::grabFrame(long position)
 	{
 		// when cache is active, we must not read the file directly
 		do {
-			pthread_mutex_lock(&m_cacheMutex);
-			frame = (CacheFrame *)m_frameCacheBase.first;
-			pthread_mutex_unlock(&m_cacheMutex);
+			frame = m_frameCacheBase.front();
 			// no need to remove the frame from the queue: the cache thread does not touch the head, only the tail
 			if (frame == nullptr)
 			{
@@ -924,10 +933,8 @@ AVFrame *VideoFFmpeg::grabFrame(long position)
 				return nullptr;
 			}
 			// this frame is not useful, release it
-			pthread_mutex_lock(&m_cacheMutex);
-			BLI_remlink(&m_frameCacheBase, frame);
-			BLI_addtail(&m_frameCacheFree, frame);
-			pthread_mutex_unlock(&m_cacheMutex);
+			m_frameCacheBase.pop();
+			m_frameCacheFree.push(frame);
 		} while (true);
 	}
 	double timeBase = av_q2d(m_formatCtx->streams[m_videoStream]->time_base);
@@ -955,7 +962,7 @@ AVFrame *VideoFFmpeg::grabFrame(long position)
 						&packet);
 					if (frameFinished)
 					{
-						m_curPosition = (long)((packet.dts-startTs) * (m_baseFrameRate*timeBase) + 0.5);
+						m_curPosition = (long)((getFrameDts(m_frame, packet)-startTs) * (m_baseFrameRate*timeBase) + 0.5);
 					}
 				}
 				av_free_packet(&packet);
@@ -1034,7 +1041,7 @@ AVFrame *VideoFFmpeg::grabFrame(long position)
 			} while ((input->data[0] == 0 && input->data[1] == 0 && input->data[2] == 0 && input->data[3] == 0) && counter < 10 && m_isImage);
 
 			// remember dts to compute exact frame number
-			dts = packet.dts;
+			dts = frameFinished ? getFrameDts(m_frame, packet) : packet.dts;
 			if (frameFinished && !posFound) 
 			{
 				if (dts >= targetTs)
@@ -1056,26 +1063,7 @@ AVFrame *VideoFFmpeg::grabFrame(long position)
 					break;
 				}
 
-				if (m_deinterlace) 
-				{
-					if (avpicture_deinterlace(
-						(AVPicture*) m_frameDeinterlaced,
-						(const AVPicture*) m_frame,
-						m_codecCtx->pix_fmt,
-						m_codecCtx->width,
-						m_codecCtx->height) >= 0)
-					{
-						input = m_frameDeinterlaced;
-					}
-				}
-				// convert to RGB24
-				sws_scale(m_imgConvertCtx,
-					input->data,
-					input->linesize,
-					0,
-					m_codecCtx->height,
-					m_frameRGB->data,
-					m_frameRGB->linesize);
+				convertFrame(input, m_frameRGB);
 				av_free_packet(&packet);
 				frameLoaded = true;
 				break;
@@ -1197,6 +1185,32 @@ static int VideoFFmpeg_setDeinterlace(PyImage *self, PyObject *value, void *clos
 	return 0;
 }
 
+// get number of decoding threads
+static PyObject *VideoFFmpeg_getThreads(PyImage *self, void *closure)
+{
+	return Py_BuildValue("i", getFFmpeg(self)->getThreadCount());
+}
+
+// set number of decoding threads
+static int VideoFFmpeg_setThreads(PyImage *self, PyObject *value, void *closure)
+{
+	// check validity of parameter
+	if (value == nullptr || !PyLong_Check(value))
+	{
+		PyErr_SetString(PyExc_TypeError, "The value must be an integer");
+		return -1;
+	}
+	if (PyLong_AsLong(value) < 0)
+	{
+		PyErr_SetString(PyExc_ValueError, "The value must be positive or 0");
+		return -1;
+	}
+	// set thread count, used when the video is opened
+	getFFmpeg(self)->setThreadCount(PyLong_AsLong(value));
+	// success
+	return 0;
+}
+
 // methods structure
 static PyMethodDef videoMethods[] =
 { // methods from VideoBase class
@@ -1222,6 +1236,7 @@ static PyGetSetDef videoGetSets[] =
 	{(char*)"filter", (getter)Image_getFilter, (setter)Image_setFilter, (char*)"pixel filter", nullptr},
 	{(char*)"preseek", (getter)VideoFFmpeg_getPreseek, (setter)VideoFFmpeg_setPreseek, (char*)"nb of frames of preseek", nullptr},
 	{(char*)"deinterlace", (getter)VideoFFmpeg_getDeinterlace, (setter)VideoFFmpeg_setDeinterlace, (char*)"deinterlace image", nullptr},
+	{(char*)"threads", (getter)VideoFFmpeg_getThreads, (setter)VideoFFmpeg_setThreads, (char*)"nb of decoding threads, 0 for automatic", nullptr},
 	{nullptr}
 };
 
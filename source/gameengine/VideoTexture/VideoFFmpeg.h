@@ -37,7 +37,6 @@
 #  include <inttypes.h>
 #endif
 extern "C" {
-#include <pthread.h>
 #include "ffmpeg_compat.h"
 #include "DNA_listBase.h"
 #include "BLI_threads.h"
@@ -64,6 +63,8 @@ static inline AVCodecContext *get_codec_from_stream(AVStream* stream)
 
 #include "VideoBase.h"
 
+#include <atomic>
+
 #define CACHE_FRAME_SIZE	10
 #define CACHE_PACKET_SIZE	30
 
@@ -102,6 +103,8 @@ public:
 	void setPreseek(int preseek) { if (preseek >= 0) m_preseek = preseek; }
 	bool getDeinterlace(void) { return m_deinterlace; }
 	void setDeinterlace(bool deinterlace) { m_deinterlace = deinterlace; }
+	int getThreadCount(void) { return m_threadCount; }
+	void setThreadCount(int threadCount) { if (threadCount >= 0) m_threadCount = threadCount; }
 	char *getImageName(void) { return (m_isImage) ? (char *)m_imageName.c_str() : nullptr; }
 
 protected:
@@ -121,6 +124,10 @@ protected:
 	bool m_deinterlace;
 	// number of frame of preseek
 	int m_preseek;
+	// number of decoding threads of the codec, 0 to share the processors between the videos
+	int m_threadCount;
+	/// number of open codecs sharing the processors, counted while m_codecCtx is set
+	static unsigned int m_openCodecs;
 	// order number of stream holding the video in format context
 	int m_videoStream;
 
@@ -175,19 +182,26 @@ protected:
 	/// common function to video file and capture
 	int openStream(const char *filename, AVInputFormat *inputFormat, AVDictionary **formatParams);
 
+	/// return the number of threads used to decode a newly opened codec
+	int getCodecThreadCount(void);
+	/// close the codec and remove it from the open codecs
+	void closeCodec(void);
+
 	/// check if a frame is available and load it in pFrame, return true if a frame could be retrieved
 	AVFrame* grabFrame(long frame);
 
 	/// in case of caching, put the frame back in free queue
 	void releaseFrame(AVFrame* frame);
 
+	/// convert a decoded frame to the RGBA frame
+	void convertFrame(AVFrame *frame, AVFrame *frameRGB);
+
 	/// start thread to load the video file/capture/stream 
 	bool startCache();
 	void stopCache();
 
 private:
 	typedef struct {
-		Link link;
 		long framePosition;
 		AVFrame *frame;
 	} CacheFrame;
@@ -196,14 +210,60 @@ private:
 		AVPacket packet;
 	} CachePacket;
 
+	/// lock free queue of frames filled by one thread and emptied by another thread
+	class CacheFrameQueue
+	{
+	private:
+		/// one more slot than frames to distinguish a full queue from an empty one
+		CacheFrame *m_frames[CACHE_FRAME_SIZE + 1];
+		/// index of the first frame, only modified by the reading thread
+		std::atomic<unsigned int> m_head;
+		/// index after the last frame, only modified by the writing thread
+		std::atomic<unsigned int> m_tail;
+
+	public:
+		CacheFrameQueue() : m_head(0), m_tail(0) {}
+
+		/// empty the queue, no thread must use it
+		void clear()
+		{
+			m_head = 0;
+			m_tail = 0;
+		}
+
+		/// get first frame or nullptr if the queue is empty, reading thread only
+		CacheFrame *front()
+		{
+			const unsigned int head = m_head.load(std::memory_order_relaxed);
+			if (head == m_tail.load(std::memory_order_acquire))
+				return nullptr;
+			return m_frames[head];
+		}
+
+		/// remove first frame, reading thread only
+		void pop()
+		{
+			const unsigned int head = m_head.load(std::memory_order_relaxed);
+			m_head.store((head + 1) % (CACHE_FRAME_SIZE + 1), std::memory_order_release);
+		}
+
+		/// add frame at the end, writing thread only
+		void push(CacheFrame *frame)
+		{
+			const unsigned int tail = m_tail.load(std::memory_order_relaxed);
+			m_frames[tail] = frame;
+			m_tail.store((tail + 1) % (CACHE_FRAME_SIZE + 1), std::memory_order_release);
+		}
+	};
+
 	bool m_stopThread;
 	bool m_cacheStarted;
 	ListBase m_thread;
-	ListBase m_frameCacheBase;	// list of frames that are ready
-	ListBase m_frameCacheFree;	// list of frames that are unused
+	CacheFrame m_frameCache[CACHE_FRAME_SIZE];
+	CacheFrameQueue m_frameCacheBase;	// frames that are ready, filled by the cache thread
+	CacheFrameQueue m_frameCacheFree;	// frames that are unused, filled by the main thread
 	ListBase m_packetCacheBase;	// list of packets that are ready for decoding
 	ListBase m_packetCacheFree;	// list of packets that are unused
-	pthread_mutex_t m_cacheMutex;
 
 	AVFrame	*allocFrameRGB();
 	static void *cacheThread(void *);
@@ -0,0 +1,175 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "atomic_ops.h"
+
+extern "C" {
+#include "BLI_task.h"
+#include "BLI_threads.h"
+#include "BLI_utildefines.h"
+#include "MEM_guardedalloc.h"
+};
+
+#define NUM_THREADS 4
+#define NUM_ITEMS 10000
+
+typedef struct TaskTestData {
+	uint32_t *counters;
+	uint32_t sum;
+	TaskScheduler *scheduler;
+} TaskTestData;
+
+static void task_test_item(TaskPool *__restrict pool, void *taskdata, int UNUSED(threadid))
+{
+	TaskTestData *data = (TaskTestData *)BLI_task_pool_userdata(pool);
+	const int index = GET_INT_FROM_POINTER(taskdata);
+	atomic_add_and_fetch_uint32(&data->counters[index], 1);
+	atomic_add_and_fetch_uint32(&data->sum, 1);
+}
+
+static void task_test_range(TaskPool *__restrict pool, void *taskdata, int start, int stop, int UNUSED(threadid))
+{
+	TaskTestData *data = (TaskTestData *)taskdata;
+	EXPECT_EQ(BLI_task_pool_userdata(pool), (void *)NULL);
+	for (int i = start; i < stop; ++i) {
+		atomic_add_and_fetch_uint32(&data->counters[i], 1);
+	}
+}
+
+static void task_test_nested(TaskPool *__restrict pool, void *taskdata, int UNUSED(threadid))
+{
+	TaskTestData *data = (TaskTestData *)BLI_task_pool_userdata(pool);
+	const int index = GET_INT_FROM_POINTER(taskdata);
+
+	TaskTestData subdata = {&data->counters[index * 100], 0, data->scheduler};
+	TaskPool *subpool = BLI_task_pool_create(data->scheduler, NULL);
+	BLI_task_pool_push_range(subpool, task_test_range, &subdata, 0, 100, 3, TASK_PRIORITY_HIGH);
+	BLI_task_pool_work_and_wait(subpool);
+	BLI_task_pool_free(subpool);
+}
+
+static void task_test_check_counters(const uint32_t *counters, int num, uint32_t value)
+{
+	for (int i = 0; i < num; ++i) {
+		EXPECT_EQ(counters[i], value);
+	}
+}
+
+static void task_test_push(TaskSchedulerQueue queue)
+{
+	BLI_threadapi_init();
+
+	TaskScheduler *scheduler = BLI_task_scheduler_create_ex(NUM_THREADS, queue);
+	uint32_t *counters = (uint32_t *)MEM_callocN(sizeof(uint32_t) * NUM_ITEMS, __func__);
+	TaskTestData data = {counters, 0, scheduler};
+
+	TaskPool *pool = BLI_task_pool_create(scheduler, &data);
+	for (int i = 0; i < NUM_ITEMS; ++i) {
+		BLI_task_pool_push(pool, task_test_item, SET_INT_IN_POINTER(i), false, TASK_PRIORITY_LOW);
+	}
+	BLI_task_pool_work_and_wait(pool);
+	BLI_task_pool_free(pool);
+
+	EXPECT_EQ(data.sum, NUM_ITEMS);
+	task_test_check_counters(counters, NUM_ITEMS, 1);
+
+	MEM_freeN(counters);
+	BLI_task_scheduler_free(scheduler);
+}
+
+static void task_test_push_range(TaskSchedulerQueue queue, int grain_size)
+{
+	BLI_threadapi_init();
+
+	TaskScheduler *scheduler = BLI_task_scheduler_create_ex(NUM_THREADS, queue);
+	uint32_t *counters = (uint32_t *)MEM_callocN(sizeof(uint32_t) * NUM_ITEMS, __func__);
+	TaskTestData data = {counters, 0, scheduler};
+
+	TaskPool *pool = BLI_task_pool_create(scheduler, NULL);
+	/* Reuse the pool to check the tasks count. */
+	for (int i = 0; i < 3; ++i) {
+		BLI_task_pool_push_range(pool, task_test_range, &data, 0, NUM_ITEMS, grain_size, TASK_PRIORITY_LOW);
+		BLI_task_pool_work_and_wait(pool);
+	}
+	BLI_task_pool_free(pool);
+
+	task_test_check_counters(counters, NUM_ITEMS, 3);
+
+	MEM_freeN(counters);
+	BLI_task_scheduler_free(scheduler);
+}
+
+static void task_test_nested_pools(TaskSchedulerQueue queue)
+{
+	BLI_threadapi_init();
+
+	TaskScheduler *scheduler = BLI_task_scheduler_create_ex(NUM_THREADS, queue);
+	uint32_t *counters = (uint32_t *)MEM_callocN(sizeof(uint32_t) * NUM_ITEMS, __func__);
+	TaskTestData data = {counters, 0, scheduler};
+
+	TaskPool *pool = BLI_task_pool_create(scheduler, &data);
+	for (int i = 0; i < NUM_ITEMS / 100; ++i) {
+		BLI_task_pool_push(pool, task_test_nested, SET_INT_IN_POINTER(i), false, TASK_PRIORITY_LOW);
+	}
+	BLI_task_pool_work_and_wait(pool);
+	BLI_task_pool_free(pool);
+
+	task_test_check_counters(counters, NUM_ITEMS, 1);
+
+	MEM_freeN(counters);
+	BLI_task_scheduler_free(scheduler);
+}
+
+TEST(task, PushGlobal)
+{
+	task_test_push(TASK_SCHEDULER_QUEUE_GLOBAL);
+}
+
+TEST(task, PushStealing)
+{
+	task_test_push(TASK_SCHEDULER_QUEUE_WORK_STEALING);
+}
+
+TEST(task, PushRangeGlobal)
+{
+	task_test_push_range(TASK_SCHEDULER_QUEUE_GLOBAL, 7);
+	task_test_push_range(TASK_SCHEDULER_QUEUE_GLOBAL, 0);
+}
+
+TEST(task, PushRangeStealing)
+{
+	task_test_push_range(TASK_SCHEDULER_QUEUE_WORK_STEALING, 7);
+	task_test_push_range(TASK_SCHEDULER_QUEUE_WORK_STEALING, 1);
+	task_test_push_range(TASK_SCHEDULER_QUEUE_WORK_STEALING, 0);
+}
+
+TEST(task, NestedPoolsGlobal)
+{
+	task_test_nested_pools(TASK_SCHEDULER_QUEUE_GLOBAL);
+}
+
+TEST(task, NestedPoolsStealing)
+{
+	task_test_nested_pools(TASK_SCHEDULER_QUEUE_WORK_STEALING);
+}
+
+TEST(task, SingleThreadStealing)
+{
+	/* Falls back to the global queue with a background thread only. */
+	BLI_threadapi_init();
+
+	TaskScheduler *scheduler = BLI_task_scheduler_create_ex(TASK_SCHEDULER_SINGLE_THREAD, TASK_SCHEDULER_QUEUE_WORK_STEALING);
+	uint32_t *counters = (uint32_t *)MEM_callocN(sizeof(uint32_t) * NUM_ITEMS, __func__);
+	TaskTestData data = {counters, 0, scheduler};
+
+	TaskPool *pool = BLI_task_pool_create(scheduler, NULL);
+	BLI_task_pool_push_range(pool, task_test_range, &data, 0, NUM_ITEMS, 0, TASK_PRIORITY_LOW);
+	BLI_task_pool_work_and_wait(pool);
+	BLI_task_pool_free(pool);
+
+	task_test_check_counters(counters, NUM_ITEMS, 1);
+
+	MEM_freeN(counters);
+	BLI_task_scheduler_free(scheduler);
+}
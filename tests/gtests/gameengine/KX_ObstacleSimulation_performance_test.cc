@@ -0,0 +1,100 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "KX_ObstacleSimulation.h"
+
+extern "C" {
+#include "BLI_compiler_attrs.h"
+#include "BLI_rand.h"
+#include "PIL_time_utildefines.h"
+}
+
+/* Simulation of agents without game objects, the obstacles are updated by the test. */
+class TestObstacleSimulation : public KX_ObstacleSimulationTOI_cells
+{
+public:
+	TestObstacleSimulation()
+		:KX_ObstacleSimulationTOI_cells(1.0f, false)
+	{
+	}
+
+	KX_Obstacle *AddAgent(float x, float y, float vx, float vy)
+	{
+		KX_Obstacle *obstacle = CreateObstacle(nullptr);
+		obstacle->m_type = KX_OBSTACLE_OBJ;
+		obstacle->m_shape = KX_OBSTACLE_CIRCLE;
+		obstacle->m_pos = MT_Vector3(x, y, 0.0f);
+		obstacle->m_rad = 0.5f;
+		obstacle->vel[0] = obstacle->dvel[0] = vx;
+		obstacle->vel[1] = obstacle->dvel[1] = vy;
+		return obstacle;
+	}
+
+	const KX_Obstacles& GetObstacles() const
+	{
+		return m_obstacles;
+	}
+};
+
+/* Agents walking in random directions in a square keeping the same density. */
+static void fill_crowd(TestObstacleSimulation& simulation, unsigned int count)
+{
+	RNG *rng = BLI_rng_new(0);
+	const float size = sqrtf((float)count) * 3.0f;
+
+	for (unsigned int i = 0; i < count; ++i) {
+		const float angle = BLI_rng_get_float(rng) * 2.0f * (float)M_PI;
+		simulation.AddAgent(BLI_rng_get_float(rng) * size, BLI_rng_get_float(rng) * size,
+		                    cosf(angle) * 2.0f, sinf(angle) * 2.0f);
+	}
+
+	BLI_rng_free(rng);
+}
+
+static double adjust_crowd(unsigned int count)
+{
+	TestObstacleSimulation simulation;
+	fill_crowd(simulation, count);
+
+	const double start = PIL_check_seconds_timer();
+	for (KX_Obstacle *obstacle : simulation.GetObstacles()) {
+		MT_Vector3 velocity(obstacle->dvel[0], obstacle->dvel[1], 0.0f);
+		simulation.AdjustObstacleVelocity(obstacle, nullptr, velocity, 1.0f, 1.0f);
+		EXPECT_TRUE(std::isfinite(velocity.x()) && std::isfinite(velocity.y()));
+	}
+	const double time = PIL_check_seconds_timer() - start;
+
+	printf("%u agents: %f s, %f us per agent\n", count, time, time / count * 1e6);
+	return time;
+}
+
+TEST(kx_obstacle_simulation, CrowdScaling)
+{
+	const double time1 = adjust_crowd(1000);
+	const double time16 = adjust_crowd(16000);
+
+	/* The cost per agent only depends on the density, a quadratic cost would be 256 times higher.
+	 * The bound is loose to not depend on the machine load. */
+	EXPECT_LT(time16, time1 * 16.0 * 8.0);
+}
+
+TEST(kx_obstacle_simulation, Avoidance)
+{
+	TestObstacleSimulation simulation;
+	// Two agents moving towards each other and a lonely agent.
+	KX_Obstacle *agent = simulation.AddAgent(0.0f, 0.0f, 2.0f, 0.0f);
+	simulation.AddAgent(3.0f, 0.1f, -2.0f, 0.0f);
+	KX_Obstacle *lonely = simulation.AddAgent(1000.0f, 1000.0f, 2.0f, 0.0f);
+
+	MT_Vector3 velocity(2.0f, 0.0f, 0.0f);
+	simulation.AdjustObstacleVelocity(agent, nullptr, velocity, 10.0f, 10.0f);
+	// The agent steers away from the other agent.
+	EXPECT_GT(fabsf(velocity.y()), 0.01f);
+
+	velocity = MT_Vector3(2.0f, 0.0f, 0.0f);
+	simulation.AdjustObstacleVelocity(lonely, nullptr, velocity, 10.0f, 10.0f);
+	// Without neighbour the desired velocity is kept.
+	EXPECT_NEAR(0.0f, velocity.y(), 0.5f);
+	EXPECT_GT(velocity.x(), 0.0f);
+}
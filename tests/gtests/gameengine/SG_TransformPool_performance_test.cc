@@ -0,0 +1,102 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "SG_TransformPool.h"
+
+#include "MT_Transform.h"
+#include "MT_Quaternion.h"
+
+#include <vector>
+
+extern "C" {
+#include "BLI_compiler_attrs.h"
+#include "BLI_rand.h"
+#include "PIL_time_utildefines.h"
+}
+
+#define NODES_COUNT 100000
+#define PASSES_COUNT 10
+
+static void fill_pool(SG_TransformPool& pool, std::vector<SG_TransformPool::Index>& indices)
+{
+	RNG *rng = BLI_rng_new(0);
+
+	for (unsigned int i = 0; i < NODES_COUNT; ++i) {
+		const SG_TransformPool::Index index = pool.Allocate();
+		indices.push_back(index);
+
+		MT_Quaternion quat(BLI_rng_get_float(rng) - 0.5f, BLI_rng_get_float(rng) - 0.5f,
+		                   BLI_rng_get_float(rng) - 0.5f, BLI_rng_get_float(rng) - 0.5f);
+		quat.normalize();
+
+		pool.WorldPosition(index).setValue(BLI_rng_get_float(rng) * 100.0f, BLI_rng_get_float(rng) * 100.0f,
+		                                   BLI_rng_get_float(rng) * 100.0f);
+		pool.WorldRotation(index).setRotation(quat);
+		pool.WorldScaling(index).setValue(BLI_rng_get_float(rng) * 2.0f - 1.0f, BLI_rng_get_float(rng) + 0.5f,
+		                                  BLI_rng_get_float(rng) + 0.5f);
+		pool.SetWorldModified(index);
+	}
+
+	BLI_rng_free(rng);
+}
+
+/* Same computation as the per-object matrix update done before the pool stored the matrices. */
+static void compute_matrix(SG_TransformPool& pool, SG_TransformPool::Index index, float mat[16])
+{
+	MT_Transform trans;
+	trans.setOrigin(pool.WorldPosition(index));
+	trans.setBasis(pool.WorldRotation(index));
+
+	const MT_Vector3& scaling = pool.WorldScaling(index);
+	trans.scale(scaling[0], scaling[1], scaling[2]);
+	trans.getValue(mat);
+}
+
+TEST(sg_transform_pool, WorldMatrices)
+{
+	SG_TransformPool pool;
+	std::vector<SG_TransformPool::Index> indices;
+	fill_pool(pool, indices);
+
+	std::vector<float> reference(NODES_COUNT * 16);
+
+	TIMEIT_START(per_node);
+	for (unsigned int pass = 0; pass < PASSES_COUNT; ++pass) {
+		for (unsigned int i = 0; i < NODES_COUNT; ++i) {
+			compute_matrix(pool, indices[i], &reference[i * 16]);
+		}
+	}
+	TIMEIT_END(per_node);
+
+	TIMEIT_START(pool_sweep);
+	for (unsigned int pass = 0; pass < PASSES_COUNT; ++pass) {
+		for (unsigned int i = 0; i < NODES_COUNT; ++i) {
+			pool.SetWorldModified(indices[i]);
+		}
+		pool.UpdateWorldMatrices();
+	}
+	TIMEIT_END(pool_sweep);
+
+	for (unsigned int i = 0; i < NODES_COUNT; ++i) {
+		const float *mat = pool.GetWorldMatrix(indices[i]);
+		for (unsigned short j = 0; j < 16; ++j) {
+			EXPECT_EQ(reference[i * 16 + j], mat[j]);
+		}
+	}
+}
+
+TEST(sg_transform_pool, ReuseAndGrow)
+{
+	SG_TransformPool pool;
+	std::vector<SG_TransformPool::Index> indices;
+	fill_pool(pool, indices);
+
+	EXPECT_EQ(NODES_COUNT, pool.GetSize());
+
+	pool.Free(indices[10]);
+	pool.Free(indices[5]);
+	EXPECT_EQ(indices[5], pool.Allocate());
+	EXPECT_EQ(indices[10], pool.Allocate());
+	EXPECT_EQ(NODES_COUNT, pool.Allocate());
+}
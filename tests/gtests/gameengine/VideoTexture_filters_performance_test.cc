@@ -0,0 +1,200 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "FilterSource.h"
+#include "FilterColor.h"
+#include "FilterBlueScreen.h"
+#include "FilterNormal.h"
+
+#include <vector>
+
+extern "C" {
+#include "BLI_compiler_attrs.h"
+#include "BLI_rand.h"
+#include "PIL_time_utildefines.h"
+}
+
+#define WIDTH 3840
+#define HEIGHT 2160
+
+static void filter_pixels(FilterBase& last, const std::vector<unsigned char>& src, short size[2],
+                          std::vector<unsigned int>& dst)
+{
+	unsigned int *pix = dst.data();
+	const unsigned char *srcPix = src.data();
+	for (short y = 0; y < size[1]; ++y) {
+		for (short x = 0; x < size[0]; ++x, ++pix, srcPix += 4) {
+			*pix = last.convert((unsigned char *)srcPix, x, y, size, 4);
+		}
+	}
+}
+
+static void filter_rows(FilterBase& last, const std::vector<unsigned char>& src, short size[2],
+                        std::vector<unsigned int>& dst)
+{
+	unsigned int *row = dst.data();
+	const unsigned char *srcRow = src.data();
+	for (short y = 0; y < size[1]; ++y, row += size[0], srcRow += size[0] * 4) {
+		ASSERT_TRUE(last.convertRow((unsigned char *)srcRow, row, y, size, 4));
+	}
+}
+
+/* Filter a RGBA32 image through the per pixel and the per row paths of the last filter of a chain,
+ * both paths must give the same image. */
+static void filter_image(FilterBase& last, const std::vector<unsigned char>& src, short width, short height,
+                         bool timeit)
+{
+	short size[2] = {width, height};
+	std::vector<unsigned int> pixelResult(width * height);
+	std::vector<unsigned int> rowResult(width * height);
+
+	if (timeit) {
+		TIMEIT_START(per_pixel);
+		filter_pixels(last, src, size, pixelResult);
+		TIMEIT_END(per_pixel);
+
+		TIMEIT_START(per_row);
+		filter_rows(last, src, size, rowResult);
+		TIMEIT_END(per_row);
+	}
+	else {
+		filter_pixels(last, src, size, pixelResult);
+		filter_rows(last, src, size, rowResult);
+	}
+
+	unsigned int mismatches = 0;
+	for (unsigned int i = 0, len = pixelResult.size(); i < len; ++i) {
+		if (pixelResult[i] != rowResult[i]) {
+			++mismatches;
+		}
+	}
+	EXPECT_EQ(0, mismatches);
+}
+
+static void fill_image(RNG *rng, std::vector<unsigned char>& image)
+{
+	for (unsigned char& comp : image) {
+		comp = BLI_rng_get_uint(rng) & 0xFF;
+	}
+}
+
+TEST(videotexture_filters, Chains)
+{
+	RNG *rng = BLI_rng_new(0);
+
+	std::vector<unsigned char> src(WIDTH * HEIGHT * 4);
+	fill_image(rng, src);
+
+	FilterRGBA32 rgba;
+	PyFilter pyRgba;
+	pyRgba.m_filter = &rgba;
+
+	FilterColor color;
+	ColorMatrix matrix;
+	for (int r = 0; r < 4; ++r) {
+		for (int c = 0; c < 5; ++c) {
+			matrix[r][c] = (short)(BLI_rng_get_uint(rng) % 1200) - 600;
+		}
+	}
+	color.setMatrix(matrix);
+	color.setPrevious(&pyRgba, false);
+	PyFilter pyColor;
+	pyColor.m_filter = &color;
+
+	FilterGray gray;
+	gray.setPrevious(&pyColor, false);
+	PyFilter pyGray;
+	pyGray.m_filter = &gray;
+
+	FilterBlueScreen blueScreen;
+	blueScreen.setColor(0, 0, 255);
+	blueScreen.setLimits(64, 256);
+	blueScreen.setPrevious(&pyGray, false);
+	PyFilter pyBlueScreen;
+	pyBlueScreen.m_filter = &blueScreen;
+
+	FilterNormal normal;
+	normal.setColor(1);
+	normal.setDepth(4.0f);
+
+	printf("color\n");
+	filter_image(color, src, WIDTH, HEIGHT, true);
+	printf("color, gray\n");
+	filter_image(gray, src, WIDTH, HEIGHT, true);
+	printf("color, gray, blue screen\n");
+	filter_image(blueScreen, src, WIDTH, HEIGHT, true);
+
+	normal.setPrevious(&pyBlueScreen, false);
+	printf("color, gray, blue screen, normal\n");
+	filter_image(normal, src, WIDTH, HEIGHT, true);
+
+	normal.setPrevious(&pyRgba, false);
+	printf("normal\n");
+	filter_image(normal, src, WIDTH, HEIGHT, true);
+
+	blueScreen.setPrevious(&pyRgba, false);
+	printf("blue screen\n");
+	filter_image(blueScreen, src, WIDTH, HEIGHT, true);
+
+	// The filters are on the stack, they must not release each other.
+	color.setPrevious(nullptr, false);
+	gray.setPrevious(nullptr, false);
+	blueScreen.setPrevious(nullptr, false);
+	normal.setPrevious(nullptr, false);
+
+	BLI_rng_free(rng);
+}
+
+/* Small images of random sizes with random settings, to cover the row ends not filtered by blocks. */
+TEST(videotexture_filters, RandomSizes)
+{
+	RNG *rng = BLI_rng_new(1);
+
+	for (int iter = 0; iter < 200; ++iter) {
+		const short width = 1 + BLI_rng_get_uint(rng) % 41;
+		const short height = 1 + BLI_rng_get_uint(rng) % 7;
+		std::vector<unsigned char> src(width * height * 4);
+		fill_image(rng, src);
+
+		FilterRGBA32 rgba;
+		PyFilter pyRgba;
+		pyRgba.m_filter = &rgba;
+
+		FilterColor color;
+		ColorMatrix matrix;
+		for (int r = 0; r < 4; ++r) {
+			for (int c = 0; c < 5; ++c) {
+				matrix[r][c] = (short)(BLI_rng_get_uint(rng) % 1200) - 600;
+			}
+		}
+		// Extreme coefficient.
+		if (iter % 3 == 0) {
+			matrix[0][0] = -32768;
+		}
+		color.setMatrix(matrix);
+		color.setPrevious(&pyRgba, false);
+		PyFilter pyColor;
+		pyColor.m_filter = &color;
+
+		FilterBlueScreen blueScreen;
+		blueScreen.setColor(BLI_rng_get_uint(rng) & 0xFF, BLI_rng_get_uint(rng) & 0xFF, BLI_rng_get_uint(rng) & 0xFF);
+		blueScreen.setLimits(BLI_rng_get_uint(rng) % 300, (iter % 5 == 0) ? 65535 : BLI_rng_get_uint(rng) % 400);
+		blueScreen.setPrevious(&pyColor, false);
+		PyFilter pyBlueScreen;
+		pyBlueScreen.m_filter = &blueScreen;
+
+		FilterNormal normal;
+		normal.setColor(BLI_rng_get_uint(rng) % 3);
+		normal.setDepth((BLI_rng_get_uint(rng) % 1000) / 50.0f);
+		normal.setPrevious(&pyBlueScreen, false);
+
+		filter_image(normal, src, width, height, false);
+
+		color.setPrevious(nullptr, false);
+		blueScreen.setPrevious(nullptr, false);
+		normal.setPrevious(nullptr, false);
+	}
+
+	BLI_rng_free(rng);
+}